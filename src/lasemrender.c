@@ -44,6 +44,9 @@ static char *option_offset = NULL;
 static char *option_size = NULL;
 double option_ppi = 72.0;
 double option_zoom = 1.0;
+int option_n_threads = 1;
+
+#define TILE_SIZE 256
 
 typedef enum {
 	FORMAT_SVG,
@@ -79,6 +82,8 @@ static const GOptionEntry entries[] =
 		&option_offset, 		N_("Offset"), NULL },
 	{ "size", 		's', 0, G_OPTION_ARG_STRING,
 		&option_size, 		N_("Size"), NULL },
+	{ "threads",		'j', 0, G_OPTION_ARG_INT,
+		&option_n_threads,		N_("Number of rendering threads (PNG output only)"), NULL },
 	{ "debug", 		'd', 0, G_OPTION_ARG_STRING,
 		&option_debug_domains,		N_("Debug domains"), NULL },
 	{ NULL }
@@ -157,6 +162,11 @@ main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
+	if (option_n_threads < 1) {
+		fprintf (stderr, "%s\n", _("Invalid number of threads"));
+		return EXIT_FAILURE;
+	}
+
 	if (option_offset != NULL) {
 		unsigned n_values;
 
@@ -324,22 +334,34 @@ main(int argc, char **argv)
 				break;
 		}
 
-		cairo = cairo_create (surface);
-		cairo_surface_destroy (surface);
-		cairo_scale (cairo, option_zoom, option_zoom);
+		if (format == FORMAT_PNG && option_n_threads > 1) {
+			cairo_matrix_t matrix;
 
-		lsm_dom_view_render (view, cairo, -offset_x_pt, -offset_y_pt);
+			cairo_matrix_init_scale (&matrix, option_zoom, option_zoom);
+			cairo_matrix_translate (&matrix, -offset_x_pt, -offset_y_pt);
 
-		switch (format) {
-			case FORMAT_PNG:
-				cairo_surface_write_to_png (cairo_get_target (cairo),
-							    output_filename);
-				break;
-			default:
-				break;
-		}
+			lsm_dom_view_render_tiled (view, surface, &matrix, option_n_threads, TILE_SIZE);
+
+			cairo_surface_write_to_png (surface, output_filename);
+			cairo_surface_destroy (surface);
+		} else {
+			cairo = cairo_create (surface);
+			cairo_surface_destroy (surface);
+			cairo_scale (cairo, option_zoom, option_zoom);
 
-		cairo_destroy (cairo);
+			lsm_dom_view_render (view, cairo, -offset_x_pt, -offset_y_pt);
+
+			switch (format) {
+				case FORMAT_PNG:
+					cairo_surface_write_to_png (cairo_get_target (cairo),
+								    output_filename);
+					break;
+				default:
+					break;
+			}
+
+			cairo_destroy (cairo);
+		}
 
 		g_object_unref (view);
 
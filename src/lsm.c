@@ -23,6 +23,8 @@
 
 #include <lsmdomimplementation.h>
 #include <lsmmathmloperatordictionary.h>
+#include <lsmsvgimagecache.h>
+#include <lsmsvgfiltersurface.h>
 #include <lsm.h>
 
 void
@@ -30,4 +32,6 @@ lsm_shutdown (void)
 {
 	lsm_dom_implementation_cleanup ();
 	lsm_mathml_operator_dictionary_cleanup ();
+	lsm_svg_image_cache_cleanup ();
+	lsm_svg_filter_surface_cleanup ();
 }
@@ -30,12 +30,33 @@
 #include <math.h>
 #include <string.h>
 
+typedef enum {
+	LSM_CAIRO_PATH_OP_MOVE_TO,
+	LSM_CAIRO_PATH_OP_LINE_TO,
+	LSM_CAIRO_PATH_OP_CURVE_TO,
+	LSM_CAIRO_PATH_OP_ARC,
+	LSM_CAIRO_PATH_OP_CLOSE_PATH
+} LsmCairoPathOp;
+
+/* Compiled path: one byte per command, followed by its absolute coordinates
+ * in the values array (2 for move/line, 6 for curve, 7 for arc, 0 for close). */
+
+struct _LsmCairoPath {
+	unsigned int n_ops;
+	guint8 *ops;
+	unsigned int n_values;
+	double *values;
+};
+
 typedef struct {
-	cairo_t *cr;
+	GArray *op_array;
+	GArray *value_array;
 	char *ptr;
 	char last_command;
-	double last_cp_x;
-	double last_cp_y;
+	gboolean has_current_point;
+	double x, y;
+	double start_x, start_y;
+	double cp_x, cp_y;
 	double values[7];
 } LsmSvgPathContext;
 
@@ -104,17 +125,16 @@ _calc_angle (double ux, double uy, double vx, double vy)
 	return angle;
 }
 
-void
-lsm_cairo_elliptical_arc (cairo_t *cairo, double rx, double ry, double x_axis_rotation,
-		       gboolean large_arc_flag, gboolean sweep_flag, double x, double y)
+static void
+_emit_elliptical_arc (cairo_t *cairo, double x1, double y1,
+		      double rx, double ry, double x_axis_rotation,
+		      gboolean large_arc_flag, gboolean sweep_flag, double x, double y)
 {
-	double x1, y1, x2, y2, lambda;
+	double x2, y2, lambda;
 	double v1, v2, angle, angle_sin, angle_cos, x11, y11;
 	double rx_squared, ry_squared, x11_squared, y11_squared, top, bottom;
 	double c, cx1, cy1, cx, cy, start_angle, angle_delta;
 
-	cairo_get_current_point (cairo, &x1, &y1);
-
 	x2 = x;
 	y2 = y;
 
@@ -207,6 +227,17 @@ lsm_cairo_elliptical_arc (cairo_t *cairo, double rx, double ry, double x_axis_ro
 	cairo_restore (cairo);
 }
 
+void
+lsm_cairo_elliptical_arc (cairo_t *cairo, double rx, double ry, double x_axis_rotation,
+		       gboolean large_arc_flag, gboolean sweep_flag, double x, double y)
+{
+	double x1, y1;
+
+	cairo_get_current_point (cairo, &x1, &y1);
+
+	_emit_elliptical_arc (cairo, x1, y1, rx, ry, x_axis_rotation, large_arc_flag, sweep_flag, x, y);
+}
+
 void
 lsm_cairo_rel_elliptical_arc (cairo_t *cairo, double rx, double ry, double x_axis_rotation,
 			   gboolean large_arc_flag, gboolean sweep_flag, double dx, double dy)
@@ -255,202 +286,414 @@ lsm_cairo_rel_horizontal (cairo_t *cairo, double dx)
 }
 
 static void
-_emit_function_1 (LsmSvgPathContext *ctxt,
-		  void (*cairo_func) (cairo_t *, double))
+_append_op (LsmSvgPathContext *ctxt, LsmCairoPathOp op, unsigned int n_values, const double *values)
 {
-	while (lsm_str_parse_double_list (&ctxt->ptr, 1, ctxt->values) == 1)
-		cairo_func (ctxt->cr, ctxt->values[0]);
+	guint8 code = op;
+
+	g_array_append_val (ctxt->op_array, code);
+	if (n_values > 0)
+		g_array_append_vals (ctxt->value_array, values, n_values);
 }
 
 static void
-_emit_function_2 (LsmSvgPathContext *ctxt,
-		  void (*cairo_func_a) (cairo_t *, double, double),
-		  void (*cairo_func_b) (cairo_t *, double, double))
+_move_to (LsmSvgPathContext *ctxt, double x, double y)
 {
+	double values[2] = {x, y};
+
+	_append_op (ctxt, LSM_CAIRO_PATH_OP_MOVE_TO, 2, values);
 
-	if (lsm_str_parse_double_list (&ctxt->ptr, 2, ctxt->values) == 2) {
-		cairo_func_a (ctxt->cr, ctxt->values[0], ctxt->values[1]);
+	ctxt->x = ctxt->start_x = x;
+	ctxt->y = ctxt->start_y = y;
+	ctxt->has_current_point = TRUE;
+}
+
+static void
+_line_to (LsmSvgPathContext *ctxt, double x, double y)
+{
+	double values[2] = {x, y};
+
+	_append_op (ctxt, LSM_CAIRO_PATH_OP_LINE_TO, 2, values);
+
+	ctxt->x = x;
+	ctxt->y = y;
+}
 
-		/* Why oh why does the specification say Line is implied here ? */
+static void
+_curve_to (LsmSvgPathContext *ctxt, double x1, double y1, double x2, double y2, double x, double y)
+{
+	double values[6] = {x1, y1, x2, y2, x, y};
+
+	_append_op (ctxt, LSM_CAIRO_PATH_OP_CURVE_TO, 6, values);
+
+	ctxt->cp_x = x2;
+	ctxt->cp_y = y2;
+	ctxt->x = x;
+	ctxt->y = y;
+}
+
+static void
+_quadratic_curve_to (LsmSvgPathContext *ctxt, double x1, double y1, double x, double y)
+{
+	double xx1, yy1, xx2, yy2;
 
-		while (lsm_str_parse_double_list (&ctxt->ptr, 2, ctxt->values) == 2)
-			cairo_func_b (ctxt->cr, ctxt->values[0], ctxt->values[1]);
+	/* We need to convert the quadratic into a cubic bezier. */
+
+	xx1 = ctxt->x + (x1 - ctxt->x) * 2.0 / 3.0;
+	yy1 = ctxt->y + (y1 - ctxt->y) * 2.0 / 3.0;
+
+	xx2 = xx1 + (x - ctxt->x) / 3.0;
+	yy2 = yy1 + (y - ctxt->y) / 3.0;
+
+	_curve_to (ctxt, xx1, yy1, xx2, yy2, x, y);
+
+	/* Smooth quadratic curves reflect the quadratic control point */
+
+	ctxt->cp_x = x1;
+	ctxt->cp_y = y1;
+}
+
+static void
+_elliptical_arc (LsmSvgPathContext *ctxt, double rx, double ry, double x_axis_rotation,
+		 gboolean large_arc_flag, gboolean sweep_flag, double x, double y)
+{
+	double values[7] = {rx, ry, x_axis_rotation, large_arc_flag, sweep_flag, x, y};
+
+	/* If the endpoints are exactly the same, just skip it (see SVG spec). */
+	if (ctxt->x == x && ctxt->y == y)
+		return;
+
+	/* If either rx or ry is 0, do a simple lineto (see SVG spec). */
+	if (rx == 0.0 || ry == 0.0) {
+		_line_to (ctxt, x, y);
+		return;
 	}
+
+	_append_op (ctxt, LSM_CAIRO_PATH_OP_ARC, 7, values);
+
+	ctxt->x = x;
+	ctxt->y = y;
 }
 
 static void
-_emit_function_4 (LsmSvgPathContext *ctxt,
-		  void (*cairo_func) (cairo_t *, double, double, double, double))
+_close_path (LsmSvgPathContext *ctxt)
 {
-	while (lsm_str_parse_double_list (&ctxt->ptr, 4, ctxt->values) == 4)
-		cairo_func (ctxt->cr, ctxt->values[0], ctxt->values[1], ctxt->values[2], ctxt->values[3]);
+	_append_op (ctxt, LSM_CAIRO_PATH_OP_CLOSE_PATH, 0, NULL);
+
+	ctxt->x = ctxt->start_x;
+	ctxt->y = ctxt->start_y;
 }
 
 static void
-_emit_smooth_curve (LsmSvgPathContext *ctxt, gboolean relative)
+_parse_move_line (LsmSvgPathContext *ctxt, gboolean relative, gboolean is_move)
 {
-	double x, y;
-	double x0, y0;
+	double *values = ctxt->values;
+	gboolean first = TRUE;
+
+	/* Why oh why does the specification say Line is implied here ? */
+
+	while (lsm_str_parse_double_list (&ctxt->ptr, 2, values) == 2) {
+		double x = relative ? ctxt->x + values[0] : values[0];
+		double y = relative ? ctxt->y + values[1] : values[1];
+
+		if (first && is_move)
+			_move_to (ctxt, x, y);
+		else
+			_line_to (ctxt, x, y);
+
+		first = FALSE;
+	}
+}
+
+static void
+_parse_horizontal_vertical (LsmSvgPathContext *ctxt, gboolean relative, gboolean is_horizontal)
+{
+	double *values = ctxt->values;
 
-	cairo_get_current_point (ctxt->cr, &x0, &y0);
+	while (lsm_str_parse_double_list (&ctxt->ptr, 1, values) == 1) {
+		if (is_horizontal)
+			_line_to (ctxt, relative ? ctxt->x + values[0] : values[0], ctxt->y);
+		else
+			_line_to (ctxt, ctxt->x, relative ? ctxt->y + values[0] : values[0]);
+	}
+}
+
+static void
+_parse_curve (LsmSvgPathContext *ctxt, gboolean relative)
+{
+	double *values = ctxt->values;
+
+	while (lsm_str_parse_double_list (&ctxt->ptr, 6, values) == 6) {
+		double x0 = relative ? ctxt->x : 0.0;
+		double y0 = relative ? ctxt->y : 0.0;
+
+		_curve_to (ctxt,
+			   x0 + values[0], y0 + values[1],
+			   x0 + values[2], y0 + values[3],
+			   x0 + values[4], y0 + values[5]);
+	}
+}
+
+static void
+_parse_smooth_curve (LsmSvgPathContext *ctxt, gboolean relative)
+{
+	double *values = ctxt->values;
+	double x1, y1;
 
 	switch (ctxt->last_command) {
 		case 'C':
-			x = 2 * x0 - ctxt->values[2];
-			y = 2 * y0 - ctxt->values[3];
-			break;
 		case 'c':
-			x = 2 * x0 - (ctxt->values[2] + x0 - ctxt->values[4]);
-			y = 2 * y0 - (ctxt->values[3] + y0 - ctxt->values[5]);
-			break;
 		case 'S':
-			x = 2 * x0 - ctxt->values[0];
-			y = 2 * y0 - ctxt->values[1];
-			break;
 		case 's':
-			x = 2 * x0 - (ctxt->values[0] + x0 - ctxt->values[2]);
-			y = 2 * y0 - (ctxt->values[1] + y0 - ctxt->values[3]);
+			x1 = 2 * ctxt->x - ctxt->cp_x;
+			y1 = 2 * ctxt->y - ctxt->cp_y;
 			break;
-		default: x = x0; y = y0; break;
+		default: x1 = ctxt->x; y1 = ctxt->y; break;
 	}
 
-	while (lsm_str_parse_double_list (&ctxt->ptr, 4, ctxt->values) == 4) {
-		if (relative) {
-			cairo_get_current_point (ctxt->cr, &x0, &y0);
-			cairo_curve_to (ctxt->cr,
-					x, y,
-					x0 + ctxt->values[0], y0 + ctxt->values[1],
-					x0 + ctxt->values[2], y0 + ctxt->values[3]);
-			x = 2 * (x0 + ctxt->values[2]) - (x0 + ctxt->values[0]);
-			y = 2 * (y0 + ctxt->values[3]) - (y0 + ctxt->values[1]);
-		} else {
-			cairo_curve_to (ctxt->cr, x, y,
-					ctxt->values[0], ctxt->values[1], ctxt->values[2], ctxt->values[3]);
-			x = 2 * ctxt->values[2] - ctxt->values[0];
-			y = 2 * ctxt->values[3] - ctxt->values[1];
-		}
+	while (lsm_str_parse_double_list (&ctxt->ptr, 4, values) == 4) {
+		double x0 = relative ? ctxt->x : 0.0;
+		double y0 = relative ? ctxt->y : 0.0;
+
+		_curve_to (ctxt, x1, y1,
+			   x0 + values[0], y0 + values[1],
+			   x0 + values[2], y0 + values[3]);
+
+		x1 = 2 * ctxt->x - ctxt->cp_x;
+		y1 = 2 * ctxt->y - ctxt->cp_y;
 	}
 }
 
 static void
-_emit_smooth_quadratic_curve (LsmSvgPathContext *ctxt, gboolean relative)
+_parse_quadratic_curve (LsmSvgPathContext *ctxt, gboolean relative)
 {
-	double x, y;
-	double x0, y0;
+	double *values = ctxt->values;
+
+	while (lsm_str_parse_double_list (&ctxt->ptr, 4, values) == 4) {
+		double x0 = relative ? ctxt->x : 0.0;
+		double y0 = relative ? ctxt->y : 0.0;
+
+		_quadratic_curve_to (ctxt,
+				     x0 + values[0], y0 + values[1],
+				     x0 + values[2], y0 + values[3]);
+	}
+}
 
-	cairo_get_current_point (ctxt->cr, &x0, &y0);
+static void
+_parse_smooth_quadratic_curve (LsmSvgPathContext *ctxt, gboolean relative)
+{
+	double *values = ctxt->values;
 
 	switch (ctxt->last_command) {
 		case 'Q':
-			ctxt->last_cp_x = ctxt->values[0];
-			ctxt->last_cp_y = ctxt->values[1];
-			break;
 		case 'q':
-			ctxt->last_cp_x = ctxt->values[0] + x0 - ctxt->values[2];
-			ctxt->last_cp_y = ctxt->values[1] + y0 - ctxt->values[3];
-			break;
 		case 'T':
 		case 't':
 			break;
-		default: ctxt->last_cp_x = x0; ctxt->last_cp_y = y0; break;
+		default: ctxt->cp_x = ctxt->x; ctxt->cp_y = ctxt->y; break;
 	}
 
-	while (lsm_str_parse_double_list (&ctxt->ptr, 2, ctxt->values) == 2) {
-		x = 2 * x0 - ctxt->last_cp_x;
-		y = 2 * y0 - ctxt->last_cp_y;
-		if (relative) {
-			cairo_get_current_point (ctxt->cr, &x0, &y0);
-			lsm_cairo_quadratic_curve_to (ctxt->cr, x, y, x0 + ctxt->values[0], y0 + ctxt->values[1]);
-		} else {
-			lsm_cairo_quadratic_curve_to (ctxt->cr, x, y, ctxt->values[0], ctxt->values[1]);
-		}
-		ctxt->last_cp_x = x;
-		ctxt->last_cp_y = y;
-		cairo_get_current_point (ctxt->cr, &x0, &y0);
+	while (lsm_str_parse_double_list (&ctxt->ptr, 2, values) == 2) {
+		double x0 = relative ? ctxt->x : 0.0;
+		double y0 = relative ? ctxt->y : 0.0;
+
+		_quadratic_curve_to (ctxt,
+				     2 * ctxt->x - ctxt->cp_x, 2 * ctxt->y - ctxt->cp_y,
+				     x0 + values[0], y0 + values[1]);
 	}
 }
 
 static void
-_emit_function_6 (LsmSvgPathContext *ctxt,
-		  void (*cairo_func) (cairo_t *, double, double, double ,double, double, double))
+_parse_elliptical_arc (LsmSvgPathContext *ctxt, gboolean relative)
 {
-	while (lsm_str_parse_double_list (&ctxt->ptr, 6, ctxt->values) == 6)
-		cairo_func (ctxt->cr, ctxt->values[0], ctxt->values[1], ctxt->values[2],
-			              ctxt->values[3], ctxt->values[4], ctxt->values[5]);
-}
+	double *values = ctxt->values;
 
-static void
-_emit_function_7 (LsmSvgPathContext *ctxt,
-		  void (*cairo_func) (cairo_t *, double, double, double ,gboolean, gboolean, double, double))
-{
-	while (lsm_str_parse_double_list (&ctxt->ptr, 7, ctxt->values) == 7)
-		cairo_func (ctxt->cr, ctxt->values[0], ctxt->values[1], ctxt->values[2],
-			              ctxt->values[3], ctxt->values[4], ctxt->values[5],
-				      ctxt->values[6]);
+	while (lsm_str_parse_double_list (&ctxt->ptr, 7, values) == 7) {
+		double x0 = relative ? ctxt->x : 0.0;
+		double y0 = relative ? ctxt->y : 0.0;
+
+		_elliptical_arc (ctxt, values[0], values[1], values[2],
+				 values[3] != 0.0, values[4] != 0.0,
+				 x0 + values[5], y0 + values[6]);
+	}
 }
 
-void
-lsm_cairo_emit_svg_path (cairo_t *cr, char const *path)
+/**
+ * lsm_cairo_path_new_from_svg_path:
+ * @path: an SVG path data string, as found in the d attribute of a path element
+ *
+ * Parses @path once into a compact list of absolute drawing commands, which
+ * can be replayed any number of times using lsm_cairo_emit_path(), without
+ * tokenizing the path string again.
+ *
+ * Returns: (transfer full): a new #LsmCairoPath, to be freed using lsm_cairo_path_free().
+ *
+ * Since: 0.6
+ */
+
+LsmCairoPath *
+lsm_cairo_path_new_from_svg_path (char const *path)
 {
 	LsmSvgPathContext ctxt;
+	LsmCairoPath *cairo_path;
 
-	g_return_if_fail (cr != NULL);
+	ctxt.op_array = g_array_new (FALSE, FALSE, sizeof (guint8));
+	ctxt.value_array = g_array_new (FALSE, FALSE, sizeof (double));
+	ctxt.ptr = (char *) path;
+	ctxt.last_command = '\0';
+	ctxt.has_current_point = FALSE;
+	ctxt.x = ctxt.y = 0.0;
+	ctxt.start_x = ctxt.start_y = 0.0;
+	ctxt.cp_x = ctxt.cp_y = 0.0;
+
+	if (path != NULL) {
+		lsm_str_skip_spaces (&ctxt.ptr);
 
+		while (*ctxt.ptr != '\0') {
+			char command;
+
+			command = *ctxt.ptr;
+			ctxt.ptr++;
+			lsm_str_skip_spaces (&ctxt.ptr);
+
+			if (!ctxt.has_current_point)
+				_move_to (&ctxt, 0.0, 0.0);
+
+			switch (command) {
+				case 'M': _parse_move_line (&ctxt, FALSE, TRUE); break;
+				case 'm': _parse_move_line (&ctxt, TRUE, TRUE); break;
+				case 'L': _parse_move_line (&ctxt, FALSE, FALSE); break;
+				case 'l': _parse_move_line (&ctxt, TRUE, FALSE); break;
+				case 'C': _parse_curve (&ctxt, FALSE); break;
+				case 'c': _parse_curve (&ctxt, TRUE); break;
+				case 'S': _parse_smooth_curve (&ctxt, FALSE); break;
+				case 's': _parse_smooth_curve (&ctxt, TRUE); break;
+				case 'V': _parse_horizontal_vertical (&ctxt, FALSE, FALSE); break;
+				case 'v': _parse_horizontal_vertical (&ctxt, TRUE, FALSE); break;
+				case 'H': _parse_horizontal_vertical (&ctxt, FALSE, TRUE); break;
+				case 'h': _parse_horizontal_vertical (&ctxt, TRUE, TRUE); break;
+				case 'Q': _parse_quadratic_curve (&ctxt, FALSE); break;
+				case 'q': _parse_quadratic_curve (&ctxt, TRUE); break;
+				case 'T': _parse_smooth_quadratic_curve (&ctxt, FALSE); break;
+				case 't': _parse_smooth_quadratic_curve (&ctxt, TRUE); break;
+				case 'A': _parse_elliptical_arc (&ctxt, FALSE); break;
+				case 'a': _parse_elliptical_arc (&ctxt, TRUE); break;
+				case 'Z':
+				case 'z': _close_path (&ctxt); break;
+				default: break;
+			}
+
+			ctxt.last_command = command;
+		}
+	}
+
+	cairo_path = g_new (LsmCairoPath, 1);
+	cairo_path->n_ops = ctxt.op_array->len;
+	cairo_path->n_values = ctxt.value_array->len;
+	cairo_path->ops = (guint8 *) g_array_free (ctxt.op_array, FALSE);
+	cairo_path->values = (double *) g_array_free (ctxt.value_array, FALSE);
+
+	return cairo_path;
+}
+
+/**
+ * lsm_cairo_path_free:
+ * @path: a #LsmCairoPath
+ *
+ * Frees a path created by lsm_cairo_path_new_from_svg_path().
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_cairo_path_free (LsmCairoPath *path)
+{
 	if (path == NULL)
 		return;
 
-	ctxt.cr = cr;
-	ctxt.ptr = (char *) path;
-	ctxt.last_command = '\0';
-	cairo_get_current_point (cr,
-				 &ctxt.values[0],
-				 &ctxt.values[1]);
-	ctxt.values[2] = ctxt.values[4] = ctxt.values[0];
-	ctxt.values[3] = ctxt.values[5] = ctxt.values[1];
+	g_free (path->ops);
+	g_free (path->values);
+	g_free (path);
+}
 
-	lsm_str_skip_spaces (&ctxt.ptr);
+/**
+ * lsm_cairo_emit_path:
+ * @cr: a cairo context
+ * @path: a #LsmCairoPath
+ *
+ * Appends the commands of a precompiled path to the current path of @cr.
+ *
+ * Since: 0.6
+ */
 
-	while (*ctxt.ptr != '\0') {
-		char command;
+void
+lsm_cairo_emit_path (cairo_t *cr, const LsmCairoPath *path)
+{
+	const double *values;
+	double x = 0.0, y = 0.0;
+	double start_x = 0.0, start_y = 0.0;
+	unsigned int i;
 
-		command = *ctxt.ptr;
-		ctxt.ptr++;
-		lsm_str_skip_spaces (&ctxt.ptr);
+	g_return_if_fail (cr != NULL);
 
-		if (!cairo_has_current_point (cr)) {
-			cairo_move_to (cr, 0, 0);
-			ctxt.values[2] = ctxt.values[4] = ctxt.values[0] = 0;
-			ctxt.values[3] = ctxt.values[5] = ctxt.values[1] = 0;
-		}
+	if (path == NULL)
+		return;
 
-		switch (command) {
-			case 'M': _emit_function_2 (&ctxt, cairo_move_to, cairo_line_to); break;
-			case 'm': _emit_function_2 (&ctxt, cairo_rel_move_to, cairo_rel_line_to); break;
-			case 'L': _emit_function_2 (&ctxt, cairo_line_to, cairo_line_to); break;
-			case 'l': _emit_function_2 (&ctxt, cairo_rel_line_to, cairo_rel_line_to); break;
-			case 'C': _emit_function_6 (&ctxt, cairo_curve_to); break;
-			case 'c': _emit_function_6 (&ctxt, cairo_rel_curve_to); break;
-			case 'S': _emit_smooth_curve (&ctxt, FALSE); break;
-			case 's': _emit_smooth_curve (&ctxt, TRUE); break;
-			case 'V': _emit_function_1 (&ctxt, lsm_cairo_vertical); break;
-			case 'v': _emit_function_1 (&ctxt, lsm_cairo_rel_vertical); break;
-			case 'H': _emit_function_1 (&ctxt, lsm_cairo_horizontal); break;
-			case 'h': _emit_function_1 (&ctxt, lsm_cairo_rel_horizontal); break;
-			case 'Q': _emit_function_4 (&ctxt, lsm_cairo_quadratic_curve_to); break;
-			case 'q': _emit_function_4 (&ctxt, lsm_cairo_rel_quadratic_curve_to); break;
-			case 'T': _emit_smooth_quadratic_curve (&ctxt, FALSE); break;
-			case 't': _emit_smooth_quadratic_curve (&ctxt, TRUE); break;
-			case 'A': _emit_function_7 (&ctxt, lsm_cairo_elliptical_arc); break;
-			case 'a': _emit_function_7 (&ctxt, lsm_cairo_rel_elliptical_arc); break;
-			case 'Z':
-			case 'z': cairo_close_path (cr); break;
-			default: break;
+	values = path->values;
+
+	for (i = 0; i < path->n_ops; i++) {
+		switch (path->ops[i]) {
+			case LSM_CAIRO_PATH_OP_MOVE_TO:
+				cairo_move_to (cr, values[0], values[1]);
+				x = start_x = values[0];
+				y = start_y = values[1];
+				values += 2;
+				break;
+			case LSM_CAIRO_PATH_OP_LINE_TO:
+				cairo_line_to (cr, values[0], values[1]);
+				x = values[0];
+				y = values[1];
+				values += 2;
+				break;
+			case LSM_CAIRO_PATH_OP_CURVE_TO:
+				cairo_curve_to (cr, values[0], values[1], values[2], values[3], values[4], values[5]);
+				x = values[4];
+				y = values[5];
+				values += 6;
+				break;
+			case LSM_CAIRO_PATH_OP_ARC:
+				_emit_elliptical_arc (cr, x, y, values[0], values[1], values[2],
+						      values[3] != 0.0, values[4] != 0.0,
+						      values[5], values[6]);
+				x = values[5];
+				y = values[6];
+				values += 7;
+				break;
+			case LSM_CAIRO_PATH_OP_CLOSE_PATH:
+				cairo_close_path (cr);
+				x = start_x;
+				y = start_y;
+				break;
+			default:
+				g_assert_not_reached ();
 		}
-
-		ctxt.last_command = command;
 	}
 }
 
+void
+lsm_cairo_emit_svg_path (cairo_t *cr, char const *path)
+{
+	LsmCairoPath *cairo_path;
+
+	g_return_if_fail (cr != NULL);
+
+	if (path == NULL)
+		return;
+
+	cairo_path = lsm_cairo_path_new_from_svg_path (path);
+	lsm_cairo_emit_path (cr, cairo_path);
+	lsm_cairo_path_free (cairo_path);
+}
+
 void
 lsm_cairo_box_user_to_device (cairo_t *cairo, LsmBox *to, const LsmBox *from)
 {
@@ -490,25 +733,19 @@ lsm_cairo_box_device_to_user (cairo_t *cairo, LsmBox *to, const LsmBox *from)
 }
 
 /**
- * lsm_cairo_set_source_pixbuf:
- * @cairo: a cairo context
+ * lsm_cairo_surface_new_from_pixbuf:
  * @pixbuf: a #GdkPixbuf
- * @pixbuf_x: X coordinate of location to place upper left corner of @pixbuf
- * @pixbuf_y: Y coordinate of location to place upper left corner of @pixbuf
  *
- * Sets the given pixbuf as the source pattern for @cairo.
+ * Creates an image surface with the content of @pixbuf, converted to the
+ * premultiplied cairo pixel format.
  *
- * The pattern has an extend mode of %CAIRO_EXTEND_NONE and is aligned
- * so that the origin of @pixbuf is @pixbuf_x, @pixbuf_y.
+ * Returns: (transfer full): a new image surface.
  *
- * Since: 0.4
+ * Since: 0.6
  */
 
-void
-lsm_cairo_set_source_pixbuf (cairo_t *cairo,
-                             const GdkPixbuf *pixbuf,
-                             double pixbuf_x,
-                             double pixbuf_y)
+cairo_surface_t *
+lsm_cairo_surface_new_from_pixbuf (const GdkPixbuf *pixbuf)
 {
 	gint width = gdk_pixbuf_get_width (pixbuf);
 	gint height = gdk_pixbuf_get_height (pixbuf);
@@ -592,7 +829,238 @@ lsm_cairo_set_source_pixbuf (cairo_t *cairo,
 		cairo_pixels += cairo_stride;
 	}
 
+	cairo_surface_mark_dirty (surface);
+
+	return surface;
+}
+
+/**
+ * lsm_cairo_set_source_pixbuf:
+ * @cairo: a cairo context
+ * @pixbuf: a #GdkPixbuf
+ * @pixbuf_x: X coordinate of location to place upper left corner of @pixbuf
+ * @pixbuf_y: Y coordinate of location to place upper left corner of @pixbuf
+ *
+ * Sets the given pixbuf as the source pattern for @cairo.
+ *
+ * The pattern has an extend mode of %CAIRO_EXTEND_NONE and is aligned
+ * so that the origin of @pixbuf is @pixbuf_x, @pixbuf_y.
+ *
+ * Since: 0.4
+ */
+
+void
+lsm_cairo_set_source_pixbuf (cairo_t *cairo,
+                             const GdkPixbuf *pixbuf,
+                             double pixbuf_x,
+                             double pixbuf_y)
+{
+	cairo_surface_t *surface;
+
+	surface = lsm_cairo_surface_new_from_pixbuf (pixbuf);
 	cairo_set_source_surface (cairo, surface, pixbuf_x, pixbuf_y);
 	cairo_surface_destroy (surface);
 }
 
+
+#define LSM_CAIRO_MIPMAP_MAX_LEVELS	16
+
+typedef struct {
+	cairo_surface_t *levels[LSM_CAIRO_MIPMAP_MAX_LEVELS];
+} LsmCairoMipmap;
+
+static const cairo_user_data_key_t mipmap_key;
+G_LOCK_DEFINE_STATIC (mipmap);
+
+static void
+_mipmap_free (void *data)
+{
+	LsmCairoMipmap *mipmap = data;
+	int i;
+
+	for (i = 0; i < LSM_CAIRO_MIPMAP_MAX_LEVELS; i++)
+		if (mipmap->levels[i] != NULL)
+			cairo_surface_destroy (mipmap->levels[i]);
+
+	g_free (mipmap);
+}
+
+/* 2x2 box filter. Averaging premultiplied components keeps them premultiplied,
+ * odd rows and columns are folded into the last destination pixel. */
+
+static cairo_surface_t *
+_mipmap_downsample (cairo_surface_t *source)
+{
+	cairo_surface_t *destination;
+	const guint8 *src_pixels;
+	guint8 *dst_pixels;
+	int width, height, src_stride;
+	int dst_width, dst_height, dst_stride;
+	int x, y, c;
+
+	width = cairo_image_surface_get_width (source);
+	height = cairo_image_surface_get_height (source);
+	dst_width = (width + 1) / 2;
+	dst_height = (height + 1) / 2;
+
+	destination = cairo_image_surface_create (cairo_image_surface_get_format (source),
+						  dst_width, dst_height);
+	if (cairo_surface_status (destination) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy (destination);
+		return NULL;
+	}
+
+	cairo_surface_flush (source);
+
+	src_pixels = cairo_image_surface_get_data (source);
+	src_stride = cairo_image_surface_get_stride (source);
+	dst_pixels = cairo_image_surface_get_data (destination);
+	dst_stride = cairo_image_surface_get_stride (destination);
+
+	for (y = 0; y < dst_height; y++) {
+		const guint8 *row_0 = src_pixels + 2 * y * src_stride;
+		const guint8 *row_1 = src_pixels + MIN (2 * y + 1, height - 1) * src_stride;
+		guint8 *dst = dst_pixels + y * dst_stride;
+
+		for (x = 0; x < dst_width; x++) {
+			int x_0 = 8 * x;
+			int x_1 = 4 * MIN (2 * x + 1, width - 1);
+
+			for (c = 0; c < 4; c++)
+				dst[4 * x + c] = (row_0[x_0 + c] + row_0[x_1 + c] +
+						  row_1[x_0 + c] + row_1[x_1 + c] + 2) >> 2;
+		}
+	}
+
+	cairo_surface_mark_dirty (destination);
+
+	return destination;
+}
+
+/**
+ * lsm_cairo_image_surface_get_mipmap:
+ * @surface: an image surface
+ * @scale: number of device pixels per pixel of @surface
+ *
+ * Returns the smallest level of the mip pyramid of @surface that is still at
+ * least as large as its device space footprint. Levels are built on demand and
+ * kept as user data of @surface, which must not be modified afterwards.
+ *
+ * Returns: (transfer full): @surface or one of its downscaled copies.
+ *
+ * Since: 0.6
+ */
+
+cairo_surface_t *
+lsm_cairo_image_surface_get_mipmap (cairo_surface_t *surface, double scale)
+{
+	LsmCairoMipmap *mipmap;
+	cairo_surface_t *result;
+	cairo_format_t format;
+	int width, height;
+	int level = 0;
+	int i;
+
+	g_return_val_if_fail (surface != NULL, NULL);
+
+	if (cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_IMAGE)
+		return cairo_surface_reference (surface);
+
+	format = cairo_image_surface_get_format (surface);
+	if (format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24)
+		return cairo_surface_reference (surface);
+
+	width = cairo_image_surface_get_width (surface);
+	height = cairo_image_surface_get_height (surface);
+
+	while (scale <= 0.5 && (width > 1 || height > 1) &&
+	       level < LSM_CAIRO_MIPMAP_MAX_LEVELS - 1) {
+		scale *= 2.0;
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+		level++;
+	}
+
+	if (level == 0)
+		return cairo_surface_reference (surface);
+
+	G_LOCK (mipmap);
+
+	mipmap = cairo_surface_get_user_data (surface, &mipmap_key);
+	if (mipmap == NULL) {
+		mipmap = g_new0 (LsmCairoMipmap, 1);
+		if (cairo_surface_set_user_data (surface, &mipmap_key, mipmap,
+						 _mipmap_free) != CAIRO_STATUS_SUCCESS) {
+			g_free (mipmap);
+			G_UNLOCK (mipmap);
+			return cairo_surface_reference (surface);
+		}
+	}
+
+	for (i = level; i > 0 && mipmap->levels[i] == NULL; i--);
+
+	result = cairo_surface_reference (i == 0 ? surface : mipmap->levels[i]);
+
+	G_UNLOCK (mipmap);
+
+	/* Missing levels are downsampled without holding the lock. An other
+	 * thread may build the same levels in the meantime, the first stored one
+	 * is kept. The pyramid lives as long as @surface, which the caller holds. */
+
+	for (i = i + 1; i <= level; i++) {
+		cairo_surface_t *downsampled;
+
+		downsampled = _mipmap_downsample (result);
+		if (downsampled == NULL)
+			break;
+
+		G_LOCK (mipmap);
+
+		if (mipmap->levels[i] == NULL)
+			mipmap->levels[i] = cairo_surface_reference (downsampled);
+		else {
+			cairo_surface_destroy (downsampled);
+			downsampled = cairo_surface_reference (mipmap->levels[i]);
+		}
+
+		G_UNLOCK (mipmap);
+
+		cairo_surface_destroy (result);
+		result = downsampled;
+	}
+
+	return result;
+}
+
+/**
+ * lsm_cairo_image_surface_get_mipmap_size:
+ * @surface: an image surface
+ *
+ * Returns: the size of the pixel data of the mip levels built so far for
+ * @surface, in bytes, not including @surface itself.
+ *
+ * Since: 0.6
+ */
+
+gsize
+lsm_cairo_image_surface_get_mipmap_size (cairo_surface_t *surface)
+{
+	LsmCairoMipmap *mipmap;
+	gsize size = 0;
+	int i;
+
+	g_return_val_if_fail (surface != NULL, 0);
+
+	G_LOCK (mipmap);
+
+	mipmap = cairo_surface_get_user_data (surface, &mipmap_key);
+	if (mipmap != NULL)
+		for (i = 1; i < LSM_CAIRO_MIPMAP_MAX_LEVELS; i++)
+			if (mipmap->levels[i] != NULL)
+				size += (gsize) cairo_image_surface_get_stride (mipmap->levels[i]) *
+					cairo_image_surface_get_height (mipmap->levels[i]);
+
+	G_UNLOCK (mipmap);
+
+	return size;
+}
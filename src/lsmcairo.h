@@ -30,6 +30,8 @@
 
 G_BEGIN_DECLS
 
+typedef struct _LsmCairoPath LsmCairoPath;
+
 void 			lsm_cairo_quadratic_curve_to 		(cairo_t *cr, double x1, double y1, double x, double y);
 void			lsm_cairo_rel_quadratic_curve_to 	(cairo_t *cr, double dx1, double dy1, double dx, double dy);
 void 			lsm_cairo_elliptical_arc 		(cairo_t *cairo, double rx, double ry, double x_axis_rotation,
@@ -41,8 +43,14 @@ void 			lsm_cairo_rel_vertical 			(cairo_t *cairo, double dy);
 void 			lsm_cairo_horizontal 			(cairo_t *cairo, double x);
 void 			lsm_cairo_rel_horizontal 		(cairo_t *cairo, double dx);
 void 			lsm_cairo_emit_svg_path 		(cairo_t *cr, char const *path);
+LsmCairoPath *		lsm_cairo_path_new_from_svg_path 	(char const *path);
+void			lsm_cairo_path_free 			(LsmCairoPath *path);
+void 			lsm_cairo_emit_path 			(cairo_t *cr, const LsmCairoPath *path);
 void 			lsm_cairo_box_user_to_device 		(cairo_t *cairo, LsmBox *to, const LsmBox *from);
 void 			lsm_cairo_box_device_to_user 		(cairo_t *cairo, LsmBox *to, const LsmBox *from);
+cairo_surface_t *	lsm_cairo_surface_new_from_pixbuf	(const GdkPixbuf *pixbuf);
+cairo_surface_t *	lsm_cairo_image_surface_get_mipmap	(cairo_surface_t *surface, double scale);
+gsize			lsm_cairo_image_surface_get_mipmap_size	(cairo_surface_t *surface);
 void 			lsm_cairo_set_source_pixbuf 		(cairo_t *cairo, const GdkPixbuf *pixbuf,
 								 double pixbuf_x, double pixbuf_y);
 
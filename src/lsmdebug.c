@@ -76,10 +76,12 @@ lsm_debug_category_free (LsmDebugCategory *category)
 static void
 lsm_debug_initialize (const char *debug_var)
 {
-	if (lsm_debug_categories != NULL)
+	GHashTable *debug_categories;
+
+	if (!g_once_init_enter (&lsm_debug_categories))
 		return;
 
-	lsm_debug_categories = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) lsm_debug_category_free);
+	debug_categories = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) lsm_debug_category_free);
 
 	if (debug_var != NULL) {
 		char **categories;
@@ -100,7 +102,7 @@ lsm_debug_initialize (const char *debug_var)
 				else
 					category->level = LSM_DEBUG_LEVEL_DEBUG;
 
-				g_hash_table_insert (lsm_debug_categories, category->name, category);
+				g_hash_table_insert (debug_categories, category->name, category);
 			} else
 				g_free (category);
 
@@ -108,6 +110,8 @@ lsm_debug_initialize (const char *debug_var)
 		}
 		g_strfreev (categories);
 	}
+
+	g_once_init_leave (&lsm_debug_categories, debug_categories);
 }
 
 gboolean
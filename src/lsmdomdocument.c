@@ -235,6 +235,54 @@ lsm_dom_document_get_href_data (LsmDomDocument *self, const char *href, gsize *s
 	return data;
 }
 
+/**
+ * lsm_dom_document_resolve_href:
+ * @self: document
+ * @href: href
+ *
+ * Resolves @href against the document url. Data URIs and URIs with a scheme
+ * are returned unchanged.
+ *
+ * Returns: (transfer full): a newly allocated string containing the resolved URI.
+ *
+ * Since: 0.6
+ */
+
+char *
+lsm_dom_document_resolve_href (LsmDomDocument *self, const char *href)
+{
+	GFile *document_file;
+	GFile *parent_file;
+	GFile *file;
+	char *scheme;
+	char *uri;
+
+	g_return_val_if_fail (LSM_IS_DOM_DOCUMENT (self), NULL);
+	g_return_val_if_fail (href != NULL, NULL);
+
+	scheme = g_uri_parse_scheme (href);
+	if (scheme != NULL || self->url == NULL) {
+		g_free (scheme);
+		return g_strdup (href);
+	}
+
+	document_file = g_file_new_for_uri (self->url);
+	parent_file = g_file_get_parent (document_file);
+	if (parent_file == NULL) {
+		g_object_unref (document_file);
+		return g_strdup (href);
+	}
+
+	file = g_file_resolve_relative_path (parent_file, href);
+	uri = g_file_get_uri (file);
+
+	g_object_unref (file);
+	g_object_unref (parent_file);
+	g_object_unref (document_file);
+
+	return uri;
+}
+
 static void
 lsm_dom_document_init (LsmDomDocument *document)
 {
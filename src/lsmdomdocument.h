@@ -44,6 +44,8 @@ struct _LsmDomDocument {
 	LsmDomNode node;
 
 	char *		url;
+
+	unsigned int	generation;
 };
 
 struct _LsmDomDocumentClass {
@@ -69,6 +71,7 @@ void		lsm_dom_document_set_url		(LsmDomDocument *self, const char *url);
 void 		lsm_dom_document_set_path 		(LsmDomDocument *self, const char *path);
 
 void * 		lsm_dom_document_get_href_data 		(LsmDomDocument *self, const char *href, gsize *size);
+char * 		lsm_dom_document_resolve_href 		(LsmDomDocument *self, const char *href);
 
 G_END_DECLS
 
@@ -2139,16 +2139,19 @@ lsm_dom_get_entities (void)
 	static GHashTable *entity_hash = NULL;
 	int i;
 
-	if (entity_hash != NULL)
-		return entity_hash;
+	if (g_once_init_enter (&entity_hash)) {
+		GHashTable *hash;
 
-	entity_hash = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, NULL);
+		hash = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, NULL);
 
-	for (i = 0; i < G_N_ELEMENTS (lsm_dom_entities); i++)
-			g_hash_table_insert (entity_hash,
+		for (i = 0; i < G_N_ELEMENTS (lsm_dom_entities); i++)
+			g_hash_table_insert (hash,
 					     (char *) lsm_dom_entities[i].name,
 					     (char *) lsm_dom_entities[i].utf8);
 
+		g_once_init_leave (&entity_hash, hash);
+	}
+
 	return entity_hash;
 }
 
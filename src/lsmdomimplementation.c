@@ -28,6 +28,7 @@
 #include <string.h>
 
 static GHashTable *document_types = NULL;
+G_LOCK_DEFINE_STATIC (document_types);
 
 static void
 lsm_dom_implementation_add_document_create_function (const char *qualified_name,
@@ -56,12 +57,17 @@ lsm_dom_implementation_create_document (const char *namespace_uri,
 
 	g_return_val_if_fail (qualified_name != NULL, NULL);
 
+	G_LOCK (document_types);
+
 	if (document_types == NULL) {
 		lsm_dom_implementation_add_document_create_function ("math", lsm_mathml_document_new);
 		lsm_dom_implementation_add_document_create_function ("svg", lsm_svg_document_new);
 	}
 
 	create_function = g_hash_table_lookup (document_types, qualified_name);
+
+	G_UNLOCK (document_types);
+
 	if (create_function == NULL) {
 		lsm_debug_dom ("[LsmDomImplementation::create_document] Unknow document type (%s)",
 			   qualified_name);
@@ -74,9 +80,12 @@ lsm_dom_implementation_create_document (const char *namespace_uri,
 void
 lsm_dom_implementation_cleanup (void)
 {
-	if (document_types == NULL)
-		return;
+	G_LOCK (document_types);
+
+	if (document_types != NULL) {
+		g_hash_table_unref (document_types);
+		document_types = NULL;
+	}
 
-	g_hash_table_unref (document_types);
-	document_types = NULL;
+	G_UNLOCK (document_types);
 }
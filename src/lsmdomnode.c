@@ -651,6 +651,11 @@ lsm_dom_node_changed (LsmDomNode *self)
 
 	g_return_if_fail (LSM_IS_DOM_NODE (self));
 
+	if (self->owner_document != NULL)
+		self->owner_document->generation++;
+	else if (LSM_IS_DOM_DOCUMENT (self))
+		LSM_DOM_DOCUMENT (self)->generation++;
+
 	node_class = LSM_DOM_NODE_GET_CLASS (self);
 
 	if (node_class->changed)
@@ -257,11 +257,31 @@ typedef enum {
 	LSM_DOM_DOCUMENT_ERROR_INVALID_XML
 } LsmDomDocumentError;
 
+static gpointer
+_init_libxml_cb (gpointer data)
+{
+	xmlInitParser ();
+
+	return NULL;
+}
+
+/* libxml2 global state must be initialized once, before any concurrent use of the parser */
+
+static void
+_init_libxml (void)
+{
+	static GOnce once = G_ONCE_INIT;
+
+	g_once (&once, _init_libxml_cb, NULL);
+}
+
 static LsmDomDocument *
 _parse_memory (LsmDomDocument *document, LsmDomNode *node,
 	       const char *buffer, gssize size, GError **error)
 {
-	static LsmDomSaxParserState state;
+	LsmDomSaxParserState state = {0};
+
+	_init_libxml ();
 
 	state.document = document;
 	if (node != NULL)
@@ -28,6 +28,7 @@
 
 #include <lsmdebug.h>
 #include <lsmdomdocument.h>
+#include <lsmdomparser.h>
 #include <lsmdomview.h>
 
 static GObjectClass *parent_class;
@@ -64,6 +65,8 @@ lsm_dom_view_set_resolution (LsmDomView *self, double ppi)
 		self->resolution_ppi = LSM_DOM_VIEW_DEFAULT_RESOLUTION;
 	else
 		self->resolution_ppi = ppi;
+
+	lsm_dom_view_clear_display_list (self);
 }
 
 /**
@@ -81,6 +84,8 @@ lsm_dom_view_set_viewport (LsmDomView *self, const LsmBox *viewport_pt)
 	g_return_if_fail (viewport_pt != NULL);
 
 	self->viewport_pt = *viewport_pt;
+
+	lsm_dom_view_clear_display_list (self);
 }
 
 /**
@@ -101,6 +106,8 @@ lsm_dom_view_set_viewport_pixels (LsmDomView *self, const LsmBox *viewport)
 	self->viewport_pt.y      = viewport->y      * 72.0 / self->resolution_ppi;
 	self->viewport_pt.width  = viewport->width  * 72.0 / self->resolution_ppi;
 	self->viewport_pt.height = viewport->height * 72.0 / self->resolution_ppi;
+
+	lsm_dom_view_clear_display_list (self);
 }
 
 /**
@@ -286,6 +293,8 @@ lsm_dom_view_render (LsmDomView *view, cairo_t *cairo, double x, double y)
 
 	cairo_translate (view->cairo, x, y);
 
+	view->is_resolution_dependent = FALSE;
+
 	view_class = LSM_DOM_VIEW_GET_CLASS (view);
 	if (view_class->render != NULL)
 		view_class->render (view);
@@ -299,6 +308,309 @@ lsm_dom_view_render (LsmDomView *view, cairo_t *cairo, double x, double y)
 	lsm_dom_view_set_cairo_context (view, NULL);
 }
 
+/**
+ * lsm_dom_view_clear_display_list:
+ * @view: a #LsmDomView
+ *
+ * Drop the display list recorded by lsm_dom_view_render_recorded().
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_dom_view_clear_display_list (LsmDomView *view)
+{
+	g_return_if_fail (LSM_IS_DOM_VIEW (view));
+
+	if (view->display_list == NULL)
+		return;
+
+	cairo_surface_destroy (view->display_list);
+	view->display_list = NULL;
+}
+
+static gboolean
+_is_display_list_valid (LsmDomView *view, const cairo_matrix_t *matrix)
+{
+	if (view->display_list == NULL ||
+	    view->display_list_generation != view->document->generation)
+		return FALSE;
+
+	/* Raster content (filters, masks, image patterns) was rendered at the recording scale */
+	if (view->is_display_list_resolution_dependent)
+		return (matrix->xx == view->display_list_matrix.xx &&
+			matrix->yx == view->display_list_matrix.yx &&
+			matrix->xy == view->display_list_matrix.xy &&
+			matrix->yy == view->display_list_matrix.yy);
+
+	return TRUE;
+}
+
+/**
+ * lsm_dom_view_render_recorded:
+ * @view: a #LsmDomView
+ * @cairo: cairo context
+ * @x: x position for rendering
+ * @y: y position for rendering
+ *
+ * Render @view in the @cairo context, like lsm_dom_view_render(). The first call records the drawing
+ * operations into a display list, which is replayed by the following calls without walking the document
+ * again, whatever the current transformation of @cairo and the position are.
+ *
+ * The display list is discarded when the document is modified, or when the resolution, the viewport or
+ * the debug features of @view are changed. If the render required intermediate raster surfaces, like
+ * for filters or masks, the display list is also discarded when the scale or rotation of @cairo changes.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_dom_view_render_recorded (LsmDomView *view, cairo_t *cairo, double x, double y)
+{
+	cairo_matrix_t matrix;
+	cairo_matrix_t inverse;
+
+	g_return_if_fail (LSM_IS_DOM_VIEW (view));
+	g_return_if_fail (LSM_IS_DOM_DOCUMENT (view->document));
+	g_return_if_fail (cairo != NULL);
+
+	cairo_get_matrix (cairo, &matrix);
+	matrix.x0 = 0.0;
+	matrix.y0 = 0.0;
+
+	inverse = matrix;
+	if (cairo_matrix_invert (&inverse) != CAIRO_STATUS_SUCCESS) {
+		lsm_dom_view_render (view, cairo, x, y);
+		return;
+	}
+
+	if (!_is_display_list_valid (view, &matrix)) {
+		cairo_t *record_cairo;
+
+		lsm_dom_view_clear_display_list (view);
+
+		lsm_debug_render ("[LsmDomView::render_recorded] Record display list");
+
+		/* Record in device orientation, so raster content is rendered at the right resolution */
+		view->display_list = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+		record_cairo = cairo_create (view->display_list);
+		cairo_set_matrix (record_cairo, &matrix);
+
+		lsm_dom_view_render (view, record_cairo, 0, 0);
+
+		cairo_destroy (record_cairo);
+
+		view->display_list_matrix = matrix;
+		view->is_display_list_resolution_dependent = view->is_resolution_dependent;
+		view->display_list_generation = view->document->generation;
+	} else {
+		inverse = view->display_list_matrix;
+		cairo_matrix_invert (&inverse);
+	}
+
+	cairo_save (cairo);
+	cairo_translate (cairo, x, y);
+	cairo_transform (cairo, &inverse);
+	cairo_set_source_surface (cairo, view->display_list, 0, 0);
+	cairo_paint (cairo);
+	cairo_restore (cairo);
+}
+
+typedef struct {
+	unsigned char *data;
+	int stride;
+	cairo_format_t format;
+	int width;
+	int height;
+	cairo_matrix_t matrix;
+
+	unsigned int tile_size;
+	unsigned int n_columns;
+	unsigned int n_tiles;
+
+	volatile gint next_tile;
+} LsmDomViewTiledRender;
+
+typedef struct {
+	LsmDomViewTiledRender *tiled_render;
+	LsmDomView *view;
+	GThread *thread;
+} LsmDomViewTileWorker;
+
+static void
+_render_tile (LsmDomView *view, LsmDomViewTiledRender *tiled_render, unsigned int index)
+{
+	cairo_surface_t *surface;
+	cairo_t *cairo;
+	int x, y;
+	int width, height;
+
+	x = (index % tiled_render->n_columns) * tiled_render->tile_size;
+	y = (index / tiled_render->n_columns) * tiled_render->tile_size;
+	width = MIN (tiled_render->tile_size, tiled_render->width - x);
+	height = MIN (tiled_render->tile_size, tiled_render->height - y);
+
+	lsm_debug_render ("[LsmDomView::render_tiled] Render tile %d,%d %dx%d", x, y, width, height);
+
+	/* Tiles share the pixel buffer of the destination surface. They don't overlap, so workers never write
+	 * to the same pixels. The tile surface bounds the device clip, which is what element culling is
+	 * tested against. */
+	surface = cairo_image_surface_create_for_data (tiled_render->data + y * tiled_render->stride + x * 4,
+						       tiled_render->format, width, height, tiled_render->stride);
+	cairo = cairo_create (surface);
+	cairo_translate (cairo, -x, -y);
+	cairo_transform (cairo, &tiled_render->matrix);
+
+	lsm_dom_view_render (view, cairo, 0, 0);
+
+	cairo_destroy (cairo);
+	cairo_surface_finish (surface);
+	cairo_surface_destroy (surface);
+}
+
+static void
+_render_tiles (LsmDomView *view, LsmDomViewTiledRender *tiled_render)
+{
+	gint index;
+
+	while ((index = g_atomic_int_add (&tiled_render->next_tile, 1)) < (gint) tiled_render->n_tiles)
+		_render_tile (view, tiled_render, index);
+}
+
+static gpointer
+_tile_worker_thread (gpointer data)
+{
+	LsmDomViewTileWorker *worker = data;
+
+	_render_tiles (worker->view, worker->tiled_render);
+
+	return NULL;
+}
+
+/**
+ * lsm_dom_view_render_tiled:
+ * @view: a #LsmDomView
+ * @surface: an image surface, in ARGB32 or RGB24 format
+ * @matrix: (allow-none): transformation applied before rendering, or %NULL
+ * @n_threads: number of rendering threads
+ * @tile_size: tile width and height, in pixels
+ *
+ * Render @view in @surface, split in square tiles of @tile_size pixels. Tiles are distributed over
+ * @n_threads worker threads. The DOM is not safe for concurrent rendering, so each worker renders its own
+ * copy of the view document, with its own view. Workers pull tiles from a shared counter and render them
+ * directly in the pixel buffer of @surface, so no stitching is needed.
+ *
+ * Each tile renders the whole document through a surface covering only the tile. Views which cull elements
+ * against the device clip, like #LsmSvgView, skip the elements lying outside of the tile; for other views
+ * tiles are only clipped.
+ *
+ * If @surface is not an image surface with a supported format, or if @n_threads is lower than 2, the
+ * tiles are rendered sequentially by @view.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_dom_view_render_tiled (LsmDomView *view, cairo_surface_t *surface, const cairo_matrix_t *matrix,
+			   unsigned int n_threads, unsigned int tile_size)
+{
+	LsmDomViewTiledRender tiled_render;
+	LsmDomViewTileWorker *workers;
+	cairo_format_t format;
+	unsigned int n_workers = 0;
+	unsigned int n_rows;
+	unsigned int i;
+	char *buffer = NULL;
+	gsize size;
+
+	g_return_if_fail (LSM_IS_DOM_VIEW (view));
+	g_return_if_fail (LSM_IS_DOM_DOCUMENT (view->document));
+	g_return_if_fail (surface != NULL);
+	g_return_if_fail (tile_size > 0);
+
+	format = cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE ?
+		cairo_image_surface_get_format (surface) : CAIRO_FORMAT_INVALID;
+
+	if (format != CAIRO_FORMAT_ARGB32 &&
+	    format != CAIRO_FORMAT_RGB24) {
+		cairo_t *cairo;
+
+		lsm_debug_render ("[LsmDomView::render_tiled] Unsupported surface, render without tiling");
+
+		cairo = cairo_create (surface);
+		if (matrix != NULL)
+			cairo_transform (cairo, matrix);
+		lsm_dom_view_render (view, cairo, 0, 0);
+		cairo_destroy (cairo);
+
+		return;
+	}
+
+	cairo_surface_flush (surface);
+
+	tiled_render.data = cairo_image_surface_get_data (surface);
+	tiled_render.stride = cairo_image_surface_get_stride (surface);
+	tiled_render.format = format;
+	tiled_render.width = cairo_image_surface_get_width (surface);
+	tiled_render.height = cairo_image_surface_get_height (surface);
+	if (matrix != NULL)
+		tiled_render.matrix = *matrix;
+	else
+		cairo_matrix_init_identity (&tiled_render.matrix);
+	tiled_render.tile_size = tile_size;
+	tiled_render.n_columns = (tiled_render.width + tile_size - 1) / tile_size;
+	n_rows = (tiled_render.height + tile_size - 1) / tile_size;
+	tiled_render.n_tiles = tiled_render.n_columns * n_rows;
+	tiled_render.next_tile = 0;
+
+	if (tiled_render.data == NULL || tiled_render.n_tiles == 0)
+		return;
+
+	n_threads = MIN (n_threads, tiled_render.n_tiles);
+	workers = g_new0 (LsmDomViewTileWorker, MAX (n_threads, 1));
+
+	if (n_threads > 1)
+		lsm_dom_document_save_to_memory (view->document, &buffer, &size, NULL);
+
+	if (buffer != NULL) {
+		for (i = 0; i < n_threads; i++) {
+			LsmDomDocument *document;
+
+			document = lsm_dom_document_new_from_memory (buffer, size, NULL);
+			if (document == NULL)
+				break;
+
+			lsm_dom_document_set_url (document, lsm_dom_document_get_url (view->document));
+
+			workers[i].tiled_render = &tiled_render;
+			workers[i].view = lsm_dom_document_create_view (document);
+			lsm_dom_view_set_resolution (workers[i].view, view->resolution_ppi);
+			lsm_dom_view_set_viewport (workers[i].view, &view->viewport_pt);
+			g_object_unref (document);
+
+			n_workers++;
+		}
+		g_free (buffer);
+	}
+
+	lsm_debug_render ("[LsmDomView::render_tiled] Render %d tiles of %d pixels with %d threads",
+			  tiled_render.n_tiles, tile_size, MAX (n_workers, 1));
+
+	if (n_workers > 1) {
+		for (i = 0; i < n_workers; i++)
+			workers[i].thread = g_thread_new ("lsm-tile", _tile_worker_thread, &workers[i]);
+		for (i = 0; i < n_workers; i++)
+			g_thread_join (workers[i].thread);
+	} else
+		_render_tiles (view, &tiled_render);
+
+	for (i = 0; i < n_workers; i++)
+		g_object_unref (workers[i].view);
+	g_free (workers);
+
+	cairo_surface_mark_dirty (surface);
+}
+
 /**
  * lsm_dom_view_set_document:
  * @view: a #LsmDomView
@@ -316,6 +628,8 @@ lsm_dom_view_set_document (LsmDomView *view, LsmDomDocument *document)
 	if (view->document == document)
 		return;
 
+	lsm_dom_view_clear_display_list (view);
+
 	if (view->document != NULL)
 		g_object_unref (view->document);
 
@@ -346,6 +660,8 @@ lsm_dom_view_set_debug (LsmDomView *view, const char *feature, gboolean enable)
 	view_class = LSM_DOM_VIEW_GET_CLASS (view);
 	if (view_class->set_debug)
 		view_class->set_debug (view, feature, enable);
+
+	lsm_dom_view_clear_display_list (view);
 }
 
 static void
@@ -388,6 +704,9 @@ lsm_dom_view_init (LsmDomView *view)
 	view->pango_layout = NULL;
 	view->cairo = NULL;
 	view->is_vector = FALSE;
+
+	view->is_resolution_dependent = FALSE;
+	view->display_list = NULL;
 }
 
 static void
@@ -403,6 +722,8 @@ lsm_dom_view_finalize (GObject *object)
 	if (view->cairo != NULL)
 		cairo_destroy (view->cairo);
 
+	lsm_dom_view_clear_display_list (view);
+
 	g_object_unref (view->measure_pango_layout);
 
 	pango_font_description_free (view->font_description);
@@ -57,6 +57,13 @@ struct _LsmDomView {
 
 	double resolution_ppi;
 	LsmBox viewport_pt;
+
+	gboolean		is_resolution_dependent;
+
+	cairo_surface_t *	display_list;
+	cairo_matrix_t		display_list_matrix;
+	gboolean		is_display_list_resolution_dependent;
+	unsigned int		display_list_generation;
 };
 
 struct _LsmDomViewClass {
@@ -80,6 +87,11 @@ LsmBox 		lsm_dom_view_get_viewport 	(LsmDomView *self);
 LsmBox 		lsm_dom_view_get_viewport_pixels(LsmDomView *self);
 
 void 		lsm_dom_view_render 		(LsmDomView *view, cairo_t *cairo, double x, double y);
+void		lsm_dom_view_render_recorded	(LsmDomView *view, cairo_t *cairo, double x, double y);
+void		lsm_dom_view_clear_display_list	(LsmDomView *view);
+void		lsm_dom_view_render_tiled	(LsmDomView *view, cairo_surface_t *surface,
+						 const cairo_matrix_t *matrix,
+						 unsigned int n_threads, unsigned int tile_size);
 
 void		lsm_dom_view_get_size		(LsmDomView *view, double *width, double *height, double *baseline);
 void 		lsm_dom_view_get_size_pixels 	(LsmDomView *view, unsigned int *width, unsigned int *height,
@@ -565,13 +565,16 @@ _get_glyph_table (void)
 	static GHashTable *glyph_table = NULL;
 	unsigned int i;
 
-	if (glyph_table != NULL)
-		return glyph_table;
+	if (g_once_init_enter (&glyph_table)) {
+		GHashTable *table;
 
-	glyph_table = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, NULL);
+		table = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, NULL);
 
-	for (i = 0; i < G_N_ELEMENTS (AMS_table); i++)
-		g_hash_table_insert (glyph_table, (void *) AMS_table[i].utf8, (void *) &AMS_table[i]);
+		for (i = 0; i < G_N_ELEMENTS (AMS_table); i++)
+			g_hash_table_insert (table, (void *) AMS_table[i].utf8, (void *) &AMS_table[i]);
+
+		g_once_init_leave (&glyph_table, table);
+	}
 
 	return glyph_table;
 }
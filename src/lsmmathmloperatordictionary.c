@@ -3214,18 +3214,29 @@ static const LsmMathmlOperatorDictionaryEntry lsm_mathml_operator_entries[] = {
 };
 
 static GHashTable *operator_hash = NULL;
+G_LOCK_DEFINE_STATIC (operator_hash);
 
 static GHashTable *
 _get_operator_dictionary (void)
 {
+	GHashTable *hash;
 	const char *utf8, *prefix;
 	char *key;
 	int i;
 
-	if (operator_hash != NULL)
-		return operator_hash;
+	hash = g_atomic_pointer_get (&operator_hash);
+	if (G_LIKELY (hash != NULL))
+		return hash;
 
-	operator_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	G_LOCK (operator_hash);
+
+	if (operator_hash != NULL) {
+		hash = operator_hash;
+		G_UNLOCK (operator_hash);
+		return hash;
+	}
+
+	hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
 	for (i = 0; i < G_N_ELEMENTS (lsm_mathml_operator_entries); i++) {
 		utf8 = lsm_dom_get_entity (lsm_mathml_operator_entries[i].name);
@@ -3244,14 +3255,19 @@ _get_operator_dictionary (void)
 		}
 		key = g_strconcat (prefix, utf8, NULL);
 
-		if (g_hash_table_lookup (operator_hash, key) == NULL)
-			g_hash_table_insert (operator_hash, key,
+		if (g_hash_table_lookup (hash, key) == NULL)
+			g_hash_table_insert (hash, key,
 					     (void *) &lsm_mathml_operator_entries[i]);
 		else
 			g_free (key);
 	}
 
-	return operator_hash;
+	/* Only publish the table once it is complete */
+	g_atomic_pointer_set (&operator_hash, hash);
+
+	G_UNLOCK (operator_hash);
+
+	return hash;
 }
 
 static const LsmMathmlOperatorDictionaryEntry lsm_mathml_operator_dictionary_default_entry =
@@ -3337,6 +3353,12 @@ lsm_mathml_operator_dictionary_lookup (const char *utf8, LsmMathmlForm form)
 void
 lsm_mathml_operator_dictionary_cleanup (void)
 {
-	if (operator_hash != NULL)
+	G_LOCK (operator_hash);
+
+	if (operator_hash != NULL) {
 		g_hash_table_unref (operator_hash);
+		g_atomic_pointer_set (&operator_hash, NULL);
+	}
+
+	G_UNLOCK (operator_hash);
 }
@@ -29,12 +29,12 @@
 GType
 lsm_mathml_style_get_type (void)
 {
-        static GType our_type = 0;
-        if (our_type == 0)
-                our_type = g_boxed_type_register_static
-                                ("LsmMathmlStyle",
-                                 (GBoxedCopyFunc) lsm_mathml_style_duplicate,
-                                 (GBoxedFreeFunc) lsm_mathml_style_free);
+        static gsize our_type = 0;
+        if (g_once_init_enter (&our_type))
+                g_once_init_leave (&our_type, g_boxed_type_register_static
+                                   ("LsmMathmlStyle",
+                                    (GBoxedCopyFunc) lsm_mathml_style_duplicate,
+                                    (GBoxedFreeFunc) lsm_mathml_style_free));
         return our_type;
 }
 
@@ -523,12 +523,12 @@ lsm_mathml_color_copy (LsmMathmlColor *color)
 GType
 lsm_mathml_color_get_type (void)
 {
-	static GType our_type = 0;
-	if (our_type == 0)
-		our_type = g_boxed_type_register_static
-			("LsmMathmlColor",
-			 (GBoxedCopyFunc) lsm_mathml_color_copy,
-			 (GBoxedFreeFunc) g_free);
+	static gsize our_type = 0;
+	if (g_once_init_enter (&our_type))
+		g_once_init_leave (&our_type, g_boxed_type_register_static
+				   ("LsmMathmlColor",
+				    (GBoxedCopyFunc) lsm_mathml_color_copy,
+				    (GBoxedFreeFunc) g_free));
 	return our_type;
 }
 
@@ -639,13 +639,13 @@ lsm_mathml_length_copy (LsmMathmlLength *length)
 GType
 lsm_mathml_length_get_type (void)
 {
-	static GType our_type = 0;
+	static gsize our_type = 0;
 
-	if (our_type == 0)
-		our_type = g_boxed_type_register_static
-			("LsmMathmlLength",
-			 (GBoxedCopyFunc) lsm_mathml_length_copy,
-			 (GBoxedFreeFunc) g_free);
+	if (g_once_init_enter (&our_type))
+		g_once_init_leave (&our_type, g_boxed_type_register_static
+				   ("LsmMathmlLength",
+				    (GBoxedCopyFunc) lsm_mathml_length_copy,
+				    (GBoxedFreeFunc) g_free));
 	return our_type;
 }
 
@@ -737,13 +737,13 @@ lsm_mathml_space_copy (LsmMathmlSpace *space)
 GType
 lsm_mathml_space_get_type (void)
 {
-	static GType our_type = 0;
+	static gsize our_type = 0;
 
-	if (our_type == 0)
-		our_type = g_boxed_type_register_static
-			("LsmMathmlSpace",
-			 (GBoxedCopyFunc) lsm_mathml_space_copy,
-			 (GBoxedFreeFunc) g_free);
+	if (g_once_init_enter (&our_type))
+		g_once_init_leave (&our_type, g_boxed_type_register_static
+				   ("LsmMathmlSpace",
+				    (GBoxedCopyFunc) lsm_mathml_space_copy,
+				    (GBoxedFreeFunc) g_free));
 	return our_type;
 }
 
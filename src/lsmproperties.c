@@ -34,10 +34,6 @@ struct _LsmPropertyManager {
 	const LsmPropertyInfos *property_infos;
 	GHashTable *		hash_by_name;
 
-	/* FIXME: Not thread safe */
-	unsigned int *		property_check;
-	unsigned int		property_check_count;
-
 	gint ref_count;
 };
 
@@ -56,8 +52,6 @@ lsm_property_manager_new (unsigned int n_properties, const LsmPropertyInfos *pro
 	manager->hash_by_name = g_hash_table_new (g_str_hash, g_str_equal);
 	manager->n_properties = n_properties;
 	manager->property_infos = property_infos;
-	manager->property_check_count = 0;
-	manager->property_check = g_new0 (unsigned int, n_properties);
 	manager->ref_count = 1;
 
 	for (i = 0; i < n_properties; i++) {
@@ -90,7 +84,6 @@ lsm_property_manager_unref (LsmPropertyManager *manager)
 
 	if (g_atomic_int_dec_and_test (&manager->ref_count)) {
 		g_hash_table_unref (manager->hash_by_name);
-		g_free (manager->property_check);
 		g_free (manager);
 	}
 }
@@ -325,21 +318,21 @@ lsm_property_manager_apply_property_bag (LsmPropertyManager *manager,
 	LsmProperty *property;
 	GSList *iter;
 	GSList *previous_iter = NULL;
+	gboolean *property_check;
 
 	g_return_if_fail (bag != NULL);
 	g_return_if_fail (manager != NULL);
 
-	manager->property_check_count++;
-	if (manager->property_check_count == 0) {
-		manager->property_check_count++;
-		memset (manager->property_check, 0, sizeof (unsigned int) * manager->n_properties);
-	}
+	/* The managers are shared by all documents, keep the seen property flags on the stack so several
+	 * threads can compute styles at the same time */
+	property_check = g_newa (gboolean, manager->n_properties);
+	memset (property_check, 0, sizeof (gboolean) * manager->n_properties);
 
 	for (iter = bag->properties; iter != NULL;) {
 		property = iter->data;
 
 		if (property->id < manager->n_properties) {
-			if (manager->property_check[property->id] != manager->property_check_count) {
+			if (!property_check[property->id]) {
 				if (g_strcmp0 (property->value, "inherit") != 0)
 					*((LsmProperty **) ((char *) style
 							    + LSM_PROPERTY_ID_TO_OFFSET (property->id))) = property;
@@ -351,7 +344,7 @@ lsm_property_manager_apply_property_bag (LsmPropertyManager *manager,
 									    + LSM_PROPERTY_ID_TO_OFFSET (property->id)));
 				}
 
-				manager->property_check[property->id] = manager->property_check_count;
+				property_check[property->id] = TRUE;
 				previous_iter = iter;
 				iter = iter->next;
 			} else {
@@ -192,40 +192,78 @@ lsm_str_parse_double_list (char **str, unsigned int n_values, double *values)
 	return i;
 }
 
-void
-lsm_str_point_list_exents (const char *point_list, LsmExtents *extents)
+/**
+ * lsm_str_parse_point_list:
+ * @point_list: a list of coordinate pairs, as found in the points attribute of polyline and polygon elements
+ * @n_points: (out): number of parsed points
+ * @extents: (out) (allow-none): extents of the parsed points
+ *
+ * Parses a point list into a packed array of x, y pairs. If the list ends with an
+ * incomplete pair, the list is considered in error, and %NULL is returned, but @extents still
+ * contains the extents of the complete pairs.
+ *
+ * Returns: (transfer full): a newly allocated array of 2 * @n_points values, or %NULL.
+ */
+
+double *
+lsm_str_parse_point_list (const char *point_list, unsigned int *n_points, LsmExtents *extents)
 {
+	GArray *array;
 	char *str = (char *) point_list;
-	int count = 0;
-	int n_values;
+	unsigned int n_values;
 	double values[2];
+	LsmExtents point_extents = {0.0, 0.0, 0.0, 0.0};
 
-	if (extents == NULL)
-		return;
+	g_return_val_if_fail (n_points != NULL, NULL);
+
+	*n_points = 0;
 
 	if (point_list == NULL) {
-		extents->x1 = 0;
-		extents->x2 = 0;
-		extents->y1 = 0;
-		extents->y2 = 0;
-		return;
+		if (extents != NULL)
+			*extents = point_extents;
+		return NULL;
 	}
 
+	array = g_array_new (FALSE, FALSE, sizeof (double));
+
 	do {
 		n_values = lsm_str_parse_double_list (&str, 2, values);
 		if (n_values == 2) {
-			if (count == 0) {
-				extents->x1 = values[0];
-				extents->x2 = values[0];
-				extents->y1 = values[1];
-				extents->y2 = values[1];
+			if (array->len == 0) {
+				point_extents.x1 = values[0];
+				point_extents.x2 = values[0];
+				point_extents.y1 = values[1];
+				point_extents.y2 = values[1];
 			} else {
-				extents->x1 = MIN (values[0], extents->x1);
-				extents->x2 = MAX (values[0], extents->x2);
-				extents->y1 = MIN (values[1], extents->y1);
-				extents->y2 = MAX (values[1], extents->y2);
+				point_extents.x1 = MIN (values[0], point_extents.x1);
+				point_extents.x2 = MAX (values[0], point_extents.x2);
+				point_extents.y1 = MIN (values[1], point_extents.y1);
+				point_extents.y2 = MAX (values[1], point_extents.y2);
 			}
+			g_array_append_vals (array, values, 2);
 		}
-		count++;
 	} while (n_values == 2);
+
+	if (extents != NULL)
+		*extents = point_extents;
+
+	if (n_values != 0 || array->len == 0) {
+		g_array_free (array, TRUE);
+		return NULL;
+	}
+
+	*n_points = array->len / 2;
+
+	return (double *) g_array_free (array, FALSE);
+}
+
+void
+lsm_str_point_list_exents (const char *point_list, LsmExtents *extents)
+{
+	unsigned int n_points;
+
+	if (extents == NULL)
+		return;
+
+	g_free (lsm_str_parse_point_list (point_list, &n_points, extents));
 }
@@ -34,6 +34,7 @@ char *   	lsm_str_to_uri 		(const char *str);
 gboolean 	lsm_str_parse_double 		(char **str, double *x);
 unsigned int 	lsm_str_parse_double_list 	(char **str, unsigned int n_values, double *values);
 
+double *	lsm_str_parse_point_list	(const char *point_list, unsigned int *n_points, LsmExtents *extents);
 void		lsm_str_point_list_exents	(const char *point_list, LsmExtents *extents);
 
 static inline void
@@ -34,6 +34,7 @@
 #include <lsmsvgcolors.h>
 #include <lsmsvglength.h>
 #include <lsmsvgview.h>
+#include <lsmsvgimagecache.h>
 #include <lsmsvgmatrix.h>
 #include <lsmsvgdocument.h>
 #include <lsmsvgelement.h>
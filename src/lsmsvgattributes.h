@@ -163,6 +163,11 @@ typedef struct {
 	LsmSvgChannelSelector value;
 } LsmSvgChannelSelectorAttribute;
 
+typedef struct {
+	LsmAttribute base;
+	LsmSvgTransferFunctionType value;
+} LsmSvgTransferFunctionTypeAttribute;
+
 G_END_DECLS
 
 #endif
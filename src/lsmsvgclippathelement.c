@@ -23,8 +23,10 @@
 
 #include <lsmsvgclippathelement.h>
 #include <lsmsvgview.h>
+#include <lsmdomdocument.h>
 #include <lsmdebug.h>
 #include <stdio.h>
+#include <string.h>
 
 static GObjectClass *parent_class;
 
@@ -38,10 +40,72 @@ _clip_path_element_get_node_name (LsmDomNode *node)
 
 /* LsmSvgElement implementation */
 
+/* The clip geometry is stored in the clip path user space, which is the unit
+ * box space for objectBoundingBox units. As cairo keeps path coordinates in
+ * device space with a 1/256 pixel precision, the stored geometry also depends
+ * on the scale and rotation it was captured with, and on the size of the object
+ * bounding box. A different translation only moves the rounding grid, within
+ * the same precision. */
+
+static void
+_get_path_key (LsmSvgClipPathElement *clip, LsmSvgView *view, const LsmBox *object_extents,
+	       LsmSvgClipPathKey *key)
+{
+	cairo_matrix_t matrix;
+
+	memset (key, 0, sizeof (LsmSvgClipPathKey));
+
+	key->document_generation = lsm_dom_node_get_owner_document (LSM_DOM_NODE (clip))->generation;
+	key->font_size_px = view->style->font_size_px;
+	key->viewbox = *((LsmSvgViewbox *) view->viewbox_stack->data);
+
+	if (view->dom_view.cairo != NULL) {
+		cairo_get_matrix (view->dom_view.cairo, &matrix);
+		key->xx = matrix.xx;
+		key->yx = matrix.yx;
+		key->xy = matrix.xy;
+		key->yy = matrix.yy;
+	}
+
+	if (object_extents != NULL) {
+		key->object_width = object_extents->width;
+		key->object_height = object_extents->height;
+	}
+}
+
+static gboolean
+_is_path_key_equal (const LsmSvgClipPathKey *a, const LsmSvgClipPathKey *b)
+{
+	return (a->document_generation == b->document_generation &&
+		a->font_size_px == b->font_size_px &&
+		a->viewbox.resolution_ppi == b->viewbox.resolution_ppi &&
+		a->viewbox.viewbox.x == b->viewbox.viewbox.x &&
+		a->viewbox.viewbox.y == b->viewbox.viewbox.y &&
+		a->viewbox.viewbox.width == b->viewbox.viewbox.width &&
+		a->viewbox.viewbox.height == b->viewbox.viewbox.height &&
+		a->xx == b->xx &&
+		a->yx == b->yx &&
+		a->xy == b->xy &&
+		a->yy == b->yy &&
+		a->object_width == b->object_width &&
+		a->object_height == b->object_height);
+}
+
+static void
+_clear_path (LsmSvgClipPathElement *clip)
+{
+	if (clip->path != NULL) {
+		cairo_path_destroy (clip->path);
+		clip->path = NULL;
+	}
+}
+
 static void
 lsm_svg_clip_path_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
 	LsmSvgClipPathElement *clip = LSM_SVG_CLIP_PATH_ELEMENT (self);
+	LsmSvgClipPathKey key;
+	const LsmBox *object_extents;
 	gboolean is_object_bounding_box;
 	LsmSvgStyle *style;
 
@@ -59,15 +123,28 @@ lsm_svg_clip_path_element_render (LsmSvgElement *self, LsmSvgView *view)
 	is_object_bounding_box = (clip->units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX);
 
 	if (is_object_bounding_box) {
-		const LsmBox *viewport;
 		static const LsmBox viewbox = {.x = 0.0, .y = 0.0, .width = 1.0, .height = 1.0};
 
-		viewport = lsm_svg_view_get_clip_extents (view);
+		object_extents = lsm_svg_view_get_clip_extents (view);
 
-		lsm_svg_view_push_viewport (view, viewport, &viewbox, NULL, LSM_SVG_OVERFLOW_HIDDEN);
-	}
+		lsm_svg_view_push_viewport (view, object_extents, &viewbox, NULL, LSM_SVG_OVERFLOW_HIDDEN);
+	} else
+		object_extents = NULL;
+
+	_get_path_key (clip, view, object_extents, &key);
+
+	if (clip->path == NULL || !_is_path_key_equal (&key, &clip->path_key)) {
+		_clear_path (clip);
+
+		LSM_SVG_ELEMENT_CLASS (parent_class)->render (self, view);
 
-	LSM_SVG_ELEMENT_CLASS (parent_class)->render (self, view);
+		clip->path = lsm_svg_view_copy_clip_path (view, &clip->fill_rule);
+		clip->path_key = key;
+	} else
+		lsm_debug_render ("[LsmSvgClipPathElement::render] Use cached path");
+
+	if (clip->path != NULL)
+		lsm_svg_view_append_clip_path (view, clip->path, clip->fill_rule);
 
 	if (is_object_bounding_box) {
 		lsm_svg_view_pop_viewport (view);
@@ -96,6 +173,16 @@ lsm_svg_clip_path_element_init (LsmSvgClipPathElement *self)
 {
 	self->enable_rendering = FALSE;
 	self->units.value = units_default;
+	self->path = NULL;
+	self->fill_rule = CAIRO_FILL_RULE_WINDING;
+}
+
+static void
+lsm_svg_clip_path_element_finalize (GObject *object)
+{
+	_clear_path (LSM_SVG_CLIP_PATH_ELEMENT (object));
+
+	parent_class->finalize (object);
 }
 
 /* LsmSvgClipPathElement class */
@@ -112,11 +199,14 @@ static const LsmAttributeInfos lsm_svg_clip_path_element_attribute_infos[] = {
 static void
 lsm_svg_clip_path_element_class_init (LsmSvgClipPathElementClass *klass)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
 	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
 	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
 
 	parent_class = g_type_class_peek_parent (klass);
 
+	object_class->finalize = lsm_svg_clip_path_element_finalize;
+
 	d_node_class->get_node_name = _clip_path_element_get_node_name;
 
 	s_element_class->category = LSM_SVG_ELEMENT_CATEGORY_NONE;
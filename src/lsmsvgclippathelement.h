@@ -38,12 +38,25 @@ G_BEGIN_DECLS
 
 typedef struct _LsmSvgClipPathElementClass LsmSvgClipPathElementClass;
 
+typedef struct {
+	unsigned int document_generation;
+	double font_size_px;
+	LsmSvgViewbox viewbox;
+	double xx, yx, xy, yy;
+	double object_width;
+	double object_height;
+} LsmSvgClipPathKey;
+
 struct _LsmSvgClipPathElement {
 	LsmSvgTransformable base;
 
 	LsmSvgPatternUnitsAttribute units;
 
 	gboolean enable_rendering;
+
+	cairo_path_t *path;
+	cairo_fill_rule_t fill_rule;
+	LsmSvgClipPathKey path_key;
 };
 
 struct _LsmSvgClipPathElementClass {
@@ -31,9 +31,12 @@
 #include <lsmsvgfilterelement.h>
 #include <lsmsvgfilterblend.h>
 #include <lsmsvgfiltercolormatrix.h>
+#include <lsmsvgfiltercomponenttransfer.h>
 #include <lsmsvgfiltercomposite.h>
 #include <lsmsvgfilterconvolvematrix.h>
+#include <lsmsvgfilterdiffuselighting.h>
 #include <lsmsvgfilterdisplacementmap.h>
+#include <lsmsvgfilterdistantlight.h>
 #include <lsmsvgfilterflood.h>
 #include <lsmsvgfiltergaussianblur.h>
 #include <lsmsvgfilterimage.h>
@@ -41,7 +44,10 @@
 #include <lsmsvgfiltermerge.h>
 #include <lsmsvgfiltermergenode.h>
 #include <lsmsvgfiltermorphology.h>
+#include <lsmsvgfilterpointlight.h>
 #include <lsmsvgfilterspecularlighting.h>
+#include <lsmsvgfilterspotlight.h>
+#include <lsmsvgfiltertransferfunction.h>
 #include <lsmsvgfilterturbulence.h>
 #include <lsmsvgfiltertile.h>
 #include <lsmsvggelement.h>
@@ -158,16 +164,30 @@ _create_element (LsmDomDocument *document, const char *tag_name)
 		node = lsm_svg_filter_element_new ();
 	else if (strcmp (tag_name, "feBlend") == 0)
 		node = lsm_svg_filter_blend_new ();
+	else if (strcmp (tag_name, "feComponentTransfer") == 0)
+		node = lsm_svg_filter_component_transfer_new ();
 	else if (strcmp (tag_name, "feComposite") == 0)
 		node = lsm_svg_filter_composite_new ();
 	else if (strcmp (tag_name, "feColorMatrix") == 0)
 		node = lsm_svg_filter_color_matrix_new ();
 	else if (strcmp (tag_name, "feConvolveMatrix") == 0)
 		node = lsm_svg_filter_convolve_matrix_new ();
+	else if (strcmp (tag_name, "feDiffuseLighting") == 0)
+		node = lsm_svg_filter_diffuse_lighting_new ();
 	else if (strcmp (tag_name, "feDisplacementMap") == 0)
 		node = lsm_svg_filter_displacement_map_new ();
+	else if (strcmp (tag_name, "feDistantLight") == 0)
+		node = lsm_svg_filter_distant_light_new ();
 	else if (strcmp (tag_name, "feFlood") == 0)
 		node = lsm_svg_filter_flood_new ();
+	else if (strcmp (tag_name, "feFuncA") == 0)
+		node = lsm_svg_filter_transfer_function_new (LSM_SVG_CHANNEL_SELECTOR_ALPHA);
+	else if (strcmp (tag_name, "feFuncB") == 0)
+		node = lsm_svg_filter_transfer_function_new (LSM_SVG_CHANNEL_SELECTOR_BLUE);
+	else if (strcmp (tag_name, "feFuncG") == 0)
+		node = lsm_svg_filter_transfer_function_new (LSM_SVG_CHANNEL_SELECTOR_GREEN);
+	else if (strcmp (tag_name, "feFuncR") == 0)
+		node = lsm_svg_filter_transfer_function_new (LSM_SVG_CHANNEL_SELECTOR_RED);
 	else if (strcmp (tag_name, "feGaussianBlur") == 0)
 		node = lsm_svg_filter_gaussian_blur_new ();
 	else if (strcmp (tag_name, "feImage") == 0)
@@ -180,8 +200,12 @@ _create_element (LsmDomDocument *document, const char *tag_name)
 		node = lsm_svg_filter_morphology_new ();
 	else if (strcmp (tag_name, "feOffset") == 0)
 		node = lsm_svg_filter_offset_new ();
+	else if (strcmp (tag_name, "fePointLight") == 0)
+		node = lsm_svg_filter_point_light_new ();
 	else if (strcmp (tag_name, "feSpecularLighting") == 0)
 		node = lsm_svg_filter_specular_lighting_new ();
+	else if (strcmp (tag_name, "feSpotLight") == 0)
+		node = lsm_svg_filter_spot_light_new ();
 	else if (strcmp (tag_name, "feTile") == 0)
 		node = lsm_svg_filter_tile_new ();
 	else if (strcmp (tag_name, "feTurbulence") == 0)
@@ -47,6 +47,14 @@ lsm_svg_element_can_append_child (LsmDomNode *self, LsmDomNode *child)
 	return (LSM_IS_SVG_ELEMENT (child));
 }
 
+static void
+lsm_svg_element_changed (LsmDomNode *self)
+{
+	LsmSvgElement *element = LSM_SVG_ELEMENT (self);
+
+	element->generation++;
+}
+
 static gboolean
 lsm_svg_element_child_changed (LsmDomNode *parent, LsmDomNode *child)
 {
@@ -156,18 +164,67 @@ _render (LsmSvgElement *element, LsmSvgView *view)
 }
 
 static void
-_transformed_render (LsmSvgElement *element, LsmSvgView *view)
+_clear_computed_style (LsmSvgElement *element)
+{
+	if (element->computed_style != NULL)
+		lsm_svg_style_unref (element->computed_style);
+	if (element->computed_parent_style != NULL)
+		lsm_svg_style_unref (element->computed_parent_style);
+
+	element->computed_style = NULL;
+	element->computed_parent_style = NULL;
+}
+
+/* The computed style only depends on the parent style and on the element
+ * property bag. The parent style is kept referenced, so that its address can
+ * not be reused by another style while the cache entry is alive. */
+
+static LsmSvgStyle *
+_get_computed_style (LsmSvgElement *element, LsmSvgStyle *parent_style)
 {
 	LsmSvgElementClass *element_class;
-	const LsmSvgStyle *parent_style;
 	LsmSvgStyle *style;
 
+	if (element->computed_style != NULL &&
+	    element->computed_parent_style == parent_style &&
+	    element->computed_style_generation == element->generation)
+		return element->computed_style;
+
+	_clear_computed_style (element);
+
 	element_class = LSM_SVG_ELEMENT_GET_CLASS (element);
 
-	parent_style = lsm_svg_view_get_current_style (view);
 	style = lsm_svg_style_new_inherited (parent_style, &element->property_bag);
 	style->ignore_group_opacity = element_class->is_shape_element;
 
+	element->computed_style = style;
+	element->computed_parent_style = parent_style != NULL ? lsm_svg_style_ref (parent_style) : NULL;
+	element->computed_style_generation = element->generation;
+
+	return style;
+}
+
+/* Returns the computed style of @element, for @parent_style being the style of its parent. The returned
+ * style is owned by @element and stays valid until the next call with another parent style. */
+
+LsmSvgStyle *
+lsm_svg_element_get_computed_style (LsmSvgElement *element, LsmSvgStyle *parent_style)
+{
+	g_return_val_if_fail (LSM_IS_SVG_ELEMENT (element), NULL);
+
+	return _get_computed_style (element, parent_style);
+}
+
+static void
+_transformed_render (LsmSvgElement *element, LsmSvgView *view)
+{
+	LsmSvgElementClass *element_class;
+	LsmSvgStyle *style;
+
+	element_class = LSM_SVG_ELEMENT_GET_CLASS (element);
+
+	style = lsm_svg_style_ref (_get_computed_style (element, lsm_svg_view_get_current_style (view)));
+
 	if (style->visibility->value == LSM_SVG_VISIBILITY_VISIBLE &&
 	    style->display->value != LSM_SVG_DISPLAY_NONE) {
 
@@ -175,11 +232,15 @@ _transformed_render (LsmSvgElement *element, LsmSvgView *view)
 				  lsm_dom_node_get_node_name (LSM_DOM_NODE (element)),
 				  element->id.value != NULL ? element->id.value : "no id");
 		lsm_svg_view_push_element (view, element);
-		lsm_svg_view_push_composition (view, style);
 
-		element_class->render (element, view);
+		if (!lsm_svg_view_is_element_culled (view, element, style)) {
+			lsm_svg_view_push_composition (view, style);
+
+			element_class->render (element, view);
+
+			lsm_svg_view_pop_composition (view);
+		}
 
-		lsm_svg_view_pop_composition (view);
 		lsm_svg_view_pop_element (view);
 	}
 
@@ -306,6 +367,11 @@ lsm_svg_element_get_extents (LsmSvgElement *element, LsmSvgView *view, LsmExtent
 static void
 lsm_svg_element_init (LsmSvgElement *element)
 {
+	element->generation = 0;
+	element->computed_style = NULL;
+	element->computed_parent_style = NULL;
+	element->computed_style_generation = 0;
+	element->painted_extents_style = NULL;
 }
 
 static void
@@ -314,6 +380,10 @@ lsm_svg_element_finalize (GObject *object)
 	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_GET_CLASS (object);
 	LsmSvgElement *svg_element = LSM_SVG_ELEMENT (object);
 
+	_clear_computed_style (svg_element);
+	if (svg_element->painted_extents_style != NULL)
+		lsm_svg_style_unref (svg_element->painted_extents_style);
+
 	lsm_svg_property_bag_clean (&svg_element->property_bag);
 	lsm_attribute_manager_clean_attributes (s_element_class->attribute_manager, svg_element);
 
@@ -352,6 +422,7 @@ lsm_svg_element_class_init (LsmSvgElementClass *s_element_class)
 	object_class->finalize = lsm_svg_element_finalize;
 
 	d_node_class->can_append_child = lsm_svg_element_can_append_child;
+	d_node_class->changed = lsm_svg_element_changed;
 	d_node_class->child_changed = lsm_svg_element_child_changed;
 
 	d_element_class->get_attribute = lsm_svg_element_get_attribute;
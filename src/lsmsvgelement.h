@@ -48,6 +48,21 @@ struct _LsmSvgElement {
 
 	LsmAttribute			id;
 	LsmAttribute			class_name;
+
+	/* Bumped each time the element is changed */
+	unsigned int			generation;
+
+	/* Computed style cache */
+	LsmSvgStyle *			computed_style;
+	LsmSvgStyle *			computed_parent_style;
+	unsigned int			computed_style_generation;
+
+	/* Painted extents cache, used for culling */
+	LsmSvgStyle *			painted_extents_style;
+	unsigned int			painted_extents_generation;
+	LsmSvgViewbox			painted_extents_viewbox;
+	gboolean			is_painted_extents_bounded;
+	LsmExtents			painted_extents;
 };
 
 struct _LsmSvgElementClass {
@@ -70,6 +85,8 @@ GType lsm_svg_element_get_type (void);
 
 LsmSvgElementCategory	lsm_svg_element_get_category	(LsmSvgElement *element);
 
+LsmSvgStyle *	lsm_svg_element_get_computed_style		(LsmSvgElement *element, LsmSvgStyle *parent_style);
+
 void 		lsm_svg_element_render 				(LsmSvgElement *element, LsmSvgView *view);
 void 		lsm_svg_element_force_render 			(LsmSvgElement *element, LsmSvgView *view);
 void		lsm_svg_element_get_extents			(LsmSvgElement *element, LsmSvgView *view, LsmExtents *extents);
@@ -459,6 +459,31 @@ lsm_svg_text_anchor_from_string (const char *string)
 					   G_N_ELEMENTS (lsm_svg_text_anchor_strings));
 }
 
+static const char *lsm_svg_filter_input_strings[] = {
+	"SourceGraphic",
+	"SourceAlpha",
+	"BackgroundImage",
+	"BackgroundAlpha",
+	"FillPaint",
+	"StrokePaint"
+};
+
+const char *
+lsm_svg_filter_input_to_string (LsmSvgFilterInput filter_input)
+{
+	if (filter_input < 0 || filter_input > LSM_SVG_FILTER_INPUT_STROKE_PAINT)
+		return NULL;
+
+	return lsm_svg_filter_input_strings[filter_input];
+}
+
+LsmSvgFilterInput
+lsm_svg_filter_input_from_string (const char *string)
+{
+	return lsm_enum_value_from_string (string, lsm_svg_filter_input_strings,
+					   G_N_ELEMENTS (lsm_svg_filter_input_strings));
+}
+
 static const char *lsm_svg_display_strings[] = {
 	"none",
 	"inline",
@@ -672,3 +697,27 @@ lsm_svg_channel_selector_from_string (const char *string)
 	return lsm_enum_value_from_string (string, lsm_svg_channel_selector_strings,
 					   G_N_ELEMENTS (lsm_svg_channel_selector_strings));
 }
+
+static const char *lsm_svg_transfer_function_type_strings[] = {
+	"identity",
+	"table",
+	"discrete",
+	"linear",
+	"gamma"
+};
+
+const char *
+lsm_svg_transfer_function_type_to_string (LsmSvgTransferFunctionType transfer_function_type)
+{
+	if (transfer_function_type < 0 || transfer_function_type > LSM_SVG_TRANSFER_FUNCTION_TYPE_GAMMA)
+		return NULL;
+
+	return lsm_svg_transfer_function_type_strings[transfer_function_type];
+}
+
+LsmSvgTransferFunctionType
+lsm_svg_transfer_function_type_from_string (const char *string)
+{
+	return lsm_enum_value_from_string (string, lsm_svg_transfer_function_type_strings,
+					   G_N_ELEMENTS (lsm_svg_transfer_function_type_strings));
+}
@@ -289,6 +289,9 @@ typedef enum {
 	LSM_SVG_FILTER_INPUT_STROKE_PAINT
 } LsmSvgFilterInput;
 
+const char * 		lsm_svg_filter_input_to_string 		(LsmSvgFilterInput filter_input);
+LsmSvgFilterInput	lsm_svg_filter_input_from_string	(const char *string);
+
 typedef enum {
 	LSM_SVG_DISPLAY_ERROR = -1,
 	LSM_SVG_DISPLAY_NONE,
@@ -411,6 +414,18 @@ typedef enum {
 const char * 		lsm_svg_channel_selector_to_string 	(LsmSvgChannelSelector channel_selector);
 LsmSvgChannelSelector	lsm_svg_channel_selector_from_string	(const char *string);
 
+typedef enum {
+	LSM_SVG_TRANSFER_FUNCTION_TYPE_ERROR = -1,
+	LSM_SVG_TRANSFER_FUNCTION_TYPE_IDENTITY,
+	LSM_SVG_TRANSFER_FUNCTION_TYPE_TABLE,
+	LSM_SVG_TRANSFER_FUNCTION_TYPE_DISCRETE,
+	LSM_SVG_TRANSFER_FUNCTION_TYPE_LINEAR,
+	LSM_SVG_TRANSFER_FUNCTION_TYPE_GAMMA
+} LsmSvgTransferFunctionType;
+
+const char * 			lsm_svg_transfer_function_type_to_string 	(LsmSvgTransferFunctionType transfer_function_type);
+LsmSvgTransferFunctionType	lsm_svg_transfer_function_type_from_string	(const char *string);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,115 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfiltercomponenttransfer.h>
+#include <lsmsvgfiltertransferfunction.h>
+#include <lsmsvgview.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static const char *
+lsm_svg_filter_component_transfer_get_node_name (LsmDomNode *node)
+{
+	return "feComponentTransfer";
+}
+
+static gboolean
+lsm_svg_filter_component_transfer_can_append_child (LsmDomNode *self, LsmDomNode *child)
+{
+	return LSM_IS_SVG_FILTER_TRANSFER_FUNCTION (child);
+}
+
+/* LsmSvgElement implementation */
+
+static void
+lsm_svg_filter_component_transfer_apply  (LsmSvgFilterPrimitive *self, LsmSvgView *view,
+					  const char *input, const char *output, const LsmBox *subregion)
+{
+	LsmSvgFilterTransferFunction *transfer_function;
+	LsmDomNode *iter;
+	guint8 tables[4][256];
+	unsigned int i;
+
+	for (i = 0; i < 256; i++)
+		tables[0][i] = tables[1][i] = tables[2][i] = tables[3][i] = i;
+
+	/* The last function of a channel wins */
+
+	for (iter = LSM_DOM_NODE (self)->first_child; iter != NULL; iter = iter->next_sibling) {
+		if (!LSM_IS_SVG_FILTER_TRANSFER_FUNCTION (iter))
+			continue;
+
+		transfer_function = LSM_SVG_FILTER_TRANSFER_FUNCTION (iter);
+		if (transfer_function->channel >= LSM_SVG_CHANNEL_SELECTOR_RED &&
+		    transfer_function->channel <= LSM_SVG_CHANNEL_SELECTOR_ALPHA)
+			lsm_svg_filter_transfer_function_get_table (transfer_function, tables[transfer_function->channel]);
+	}
+
+	lsm_svg_view_apply_component_transfer (view, input, output, subregion,
+					       tables[LSM_SVG_CHANNEL_SELECTOR_RED],
+					       tables[LSM_SVG_CHANNEL_SELECTOR_GREEN],
+					       tables[LSM_SVG_CHANNEL_SELECTOR_BLUE],
+					       tables[LSM_SVG_CHANNEL_SELECTOR_ALPHA]);
+}
+
+/* LsmSvgFilterComponentTransfer implementation */
+
+LsmDomNode *
+lsm_svg_filter_component_transfer_new (void)
+{
+	return g_object_new (LSM_TYPE_SVG_FILTER_COMPONENT_TRANSFER, NULL);
+}
+
+static void
+lsm_svg_filter_component_transfer_init (LsmSvgFilterComponentTransfer *self)
+{
+}
+
+static void
+lsm_svg_filter_component_transfer_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterComponentTransfer class */
+
+static void
+lsm_svg_filter_component_transfer_class_init (LsmSvgFilterComponentTransferClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgFilterPrimitiveClass *f_primitive_class = LSM_SVG_FILTER_PRIMITIVE_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_component_transfer_finalize;
+
+	d_node_class->get_node_name = lsm_svg_filter_component_transfer_get_node_name;
+	d_node_class->can_append_child = lsm_svg_filter_component_transfer_can_append_child;
+
+	f_primitive_class->apply = lsm_svg_filter_component_transfer_apply;
+}
+
+G_DEFINE_TYPE (LsmSvgFilterComponentTransfer, lsm_svg_filter_component_transfer, LSM_TYPE_SVG_FILTER_PRIMITIVE)
@@ -0,0 +1,141 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfilterdiffuselighting.h>
+#include <lsmsvgfilterlightsource.h>
+#include <lsmsvgview.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static const char *
+lsm_svg_filter_diffuse_lighting_get_node_name (LsmDomNode *node)
+{
+	return "feDiffuseLighting";
+}
+
+static gboolean
+lsm_svg_filter_diffuse_lighting_can_append_child (LsmDomNode *self, LsmDomNode *child)
+{
+	return LSM_IS_SVG_FILTER_LIGHT_SOURCE (child);
+}
+
+/* LsmSvgElement implementation */
+
+static void
+lsm_svg_filter_diffuse_lighting_apply  (LsmSvgFilterPrimitive *self, LsmSvgView *view,
+					const char *input, const char *output, const LsmBox *subregion)
+{
+	LsmSvgFilterDiffuseLighting *diffuse_lighting = LSM_SVG_FILTER_DIFFUSE_LIGHTING (self);
+	LsmSvgFilterLight light;
+	LsmDomNode *iter;
+
+	for (iter = LSM_DOM_NODE (self)->first_child; iter != NULL; iter = iter->next_sibling)
+		if (LSM_IS_SVG_FILTER_LIGHT_SOURCE (iter))
+			break;
+
+	if (iter != NULL)
+		lsm_svg_filter_light_source_get_light (LSM_SVG_FILTER_LIGHT_SOURCE (iter), &light);
+
+	lsm_svg_view_apply_diffuse_lighting (view, input, output, subregion, iter != NULL ? &light : NULL,
+					     diffuse_lighting->surface_scale.value,
+					     diffuse_lighting->diffuse_constant.value,
+					     diffuse_lighting->kernel_unit_length.value.a,
+					     diffuse_lighting->kernel_unit_length.value.b);
+}
+
+/* LsmSvgFilterDiffuseLighting implementation */
+
+static const double surface_scale_default = 1.0;
+static const double diffuse_constant_default = 1.0;
+static const LsmSvgOneOrTwoDouble kernel_unit_length_default = {1.0, 1.0};
+
+LsmDomNode *
+lsm_svg_filter_diffuse_lighting_new (void)
+{
+	return g_object_new (LSM_TYPE_SVG_FILTER_DIFFUSE_LIGHTING, NULL);
+}
+
+static void
+lsm_svg_filter_diffuse_lighting_init (LsmSvgFilterDiffuseLighting *self)
+{
+	self->surface_scale.value = surface_scale_default;
+	self->diffuse_constant.value = diffuse_constant_default;
+	self->kernel_unit_length.value = kernel_unit_length_default;
+}
+
+static void
+lsm_svg_filter_diffuse_lighting_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterDiffuseLighting class */
+
+static const LsmAttributeInfos lsm_svg_filter_diffuse_lighting_attribute_infos[] = {
+	{
+		.name = "surfaceScale",
+		.attribute_offset = offsetof (LsmSvgFilterDiffuseLighting, surface_scale),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &surface_scale_default
+	},
+	{
+		.name = "diffuseConstant",
+		.attribute_offset = offsetof (LsmSvgFilterDiffuseLighting, diffuse_constant),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &diffuse_constant_default
+	},
+	{
+		.name = "kernelUnitLength",
+		.attribute_offset = offsetof (LsmSvgFilterDiffuseLighting, kernel_unit_length),
+		.trait_class = &lsm_svg_one_or_two_double_trait_class,
+		.trait_default = &kernel_unit_length_default
+	}
+};
+
+static void
+lsm_svg_filter_diffuse_lighting_class_init (LsmSvgFilterDiffuseLightingClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
+	LsmSvgFilterPrimitiveClass *f_primitive_class = LSM_SVG_FILTER_PRIMITIVE_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_diffuse_lighting_finalize;
+
+	d_node_class->get_node_name = lsm_svg_filter_diffuse_lighting_get_node_name;
+	d_node_class->can_append_child = lsm_svg_filter_diffuse_lighting_can_append_child;
+
+	s_element_class->attribute_manager = lsm_attribute_manager_duplicate (s_element_class->attribute_manager);
+
+	lsm_attribute_manager_add_attributes (s_element_class->attribute_manager,
+					      G_N_ELEMENTS (lsm_svg_filter_diffuse_lighting_attribute_infos),
+					      lsm_svg_filter_diffuse_lighting_attribute_infos);
+
+	f_primitive_class->apply = lsm_svg_filter_diffuse_lighting_apply;
+}
+
+G_DEFINE_TYPE (LsmSvgFilterDiffuseLighting, lsm_svg_filter_diffuse_lighting, LSM_TYPE_SVG_FILTER_PRIMITIVE)
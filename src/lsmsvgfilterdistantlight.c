@@ -0,0 +1,111 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfilterdistantlight.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static const char *
+lsm_svg_filter_distant_light_get_node_name (LsmDomNode *node)
+{
+	return "feDistantLight";
+}
+
+/* LsmSvgFilterLightSource implementation */
+
+static void
+lsm_svg_filter_distant_light_get_light (LsmSvgFilterLightSource *self, LsmSvgFilterLight *light)
+{
+	LsmSvgFilterDistantLight *distant_light = LSM_SVG_FILTER_DISTANT_LIGHT (self);
+
+	light->type = LSM_SVG_FILTER_LIGHT_TYPE_DISTANT;
+	light->azimuth = distant_light->azimuth.value;
+	light->elevation = distant_light->elevation.value;
+}
+
+/* LsmSvgFilterDistantLight implementation */
+
+static const double angle_default = 0.0;
+
+LsmDomNode *
+lsm_svg_filter_distant_light_new (void)
+{
+	return g_object_new (LSM_TYPE_SVG_FILTER_DISTANT_LIGHT, NULL);
+}
+
+static void
+lsm_svg_filter_distant_light_init (LsmSvgFilterDistantLight *self)
+{
+	self->azimuth.value = angle_default;
+	self->elevation.value = angle_default;
+}
+
+static void
+lsm_svg_filter_distant_light_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterDistantLight class */
+
+static const LsmAttributeInfos lsm_svg_filter_distant_light_attribute_infos[] = {
+	{
+		.name = "azimuth",
+		.attribute_offset = offsetof (LsmSvgFilterDistantLight, azimuth),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &angle_default
+	},
+	{
+		.name = "elevation",
+		.attribute_offset = offsetof (LsmSvgFilterDistantLight, elevation),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &angle_default
+	}
+};
+
+static void
+lsm_svg_filter_distant_light_class_init (LsmSvgFilterDistantLightClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
+	LsmSvgFilterLightSourceClass *f_light_source_class = LSM_SVG_FILTER_LIGHT_SOURCE_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_distant_light_finalize;
+
+	d_node_class->get_node_name = lsm_svg_filter_distant_light_get_node_name;
+
+	s_element_class->attribute_manager = lsm_attribute_manager_duplicate (s_element_class->attribute_manager);
+
+	lsm_attribute_manager_add_attributes (s_element_class->attribute_manager,
+					      G_N_ELEMENTS (lsm_svg_filter_distant_light_attribute_infos),
+					      lsm_svg_filter_distant_light_attribute_infos);
+
+	f_light_source_class->get_light = lsm_svg_filter_distant_light_get_light;
+}
+
+G_DEFINE_TYPE (LsmSvgFilterDistantLight, lsm_svg_filter_distant_light, LSM_TYPE_SVG_FILTER_LIGHT_SOURCE)
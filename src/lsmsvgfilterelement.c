@@ -21,9 +21,15 @@
  * 	Emmanuel Pacaud <emmanuel@gnome.org>
  */
 
-#include <lsmsvgfilterelement.h>
+#include <lsmsvgfilterelementprivate.h>
 #include <lsmsvgfilterprimitive.h>
-#include <lsmsvgview.h>
+#include <lsmsvgfilterflood.h>
+#include <lsmsvgfilterimage.h>
+#include <lsmsvgfilterturbulence.h>
+#include <lsmsvgfiltermerge.h>
+#include <lsmsvgfiltermergenode.h>
+#include <lsmdomdocument.h>
+#include <lsmsvgviewprivate.h>
 #include <lsmdebug.h>
 
 static GObjectClass *parent_class;
@@ -85,14 +91,174 @@ lsm_svg_filter_element_get_effect_viewport (LsmSvgFilterElement *filter, const L
 	return viewport;
 }
 
+static void
+_graph_free (LsmSvgFilterGraph *graph)
+{
+	unsigned int i;
+
+	if (graph == NULL)
+		return;
+
+	for (i = 0; i < graph->n_nodes; i++)
+		g_free (graph->nodes[i].inputs);
+	g_free (graph->nodes);
+	g_free (graph->last_uses);
+	g_free (graph);
+}
+
+static int
+_resolve_input (GHashTable *results, const char *name, int previous)
+{
+	gpointer slot;
+
+	if (name == NULL)
+		return previous;
+
+	/* Results may override the standard input names */
+	if (g_hash_table_lookup_extended (results, name, NULL, &slot))
+		return GPOINTER_TO_INT (slot);
+
+	return lsm_svg_filter_input_from_string (name);
+}
+
+static void
+_add_input (GArray *inputs, GHashTable *results, const char *name, int previous)
+{
+	LsmSvgFilterNodeInput input;
+
+	input.name = name;
+	input.slot = _resolve_input (results, name, previous);
+
+	g_array_append_val (inputs, input);
+}
+
+/* Resolve the in, in2 and merge node inputs of each primitive to the slot of the surface they read, and
+ * record for each slot the index of the last primitive reading it, so intermediate surfaces can be
+ * released as soon as they are not needed anymore. */
+
+static LsmSvgFilterGraph *
+_graph_new (LsmSvgFilterElement *filter)
+{
+	LsmSvgFilterGraph *graph;
+	LsmDomNode *node;
+	GHashTable *results;
+	unsigned int n_nodes = 0;
+	unsigned int i, j;
+	int previous = LSM_SVG_FILTER_INPUT_SOURCE_GRAPHIC;
+
+	for (node = LSM_DOM_NODE (filter)->first_child; node != NULL; node = node->next_sibling)
+		if (LSM_IS_SVG_FILTER_PRIMITIVE (node))
+			n_nodes++;
+
+	graph = g_new0 (LsmSvgFilterGraph, 1);
+	graph->nodes = g_new0 (LsmSvgFilterNode, n_nodes);
+	graph->n_nodes = n_nodes;
+	graph->n_slots = LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS + n_nodes;
+	graph->last_uses = g_new (int, graph->n_slots);
+	for (i = 0; i < graph->n_slots; i++)
+		graph->last_uses[i] = -1;
+	graph->is_object_bounding_box = (filter->primitive_units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX);
+
+	results = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (node = LSM_DOM_NODE (filter)->first_child, i = 0; node != NULL; node = node->next_sibling) {
+		LsmSvgFilterPrimitive *primitive;
+		LsmSvgFilterNode *graph_node;
+		GArray *inputs;
+		const char *in2;
+		int output;
+
+		if (!LSM_IS_SVG_FILTER_PRIMITIVE (node))
+			continue;
+
+		primitive = LSM_SVG_FILTER_PRIMITIVE (node);
+		graph_node = &graph->nodes[i];
+		graph_node->primitive = primitive;
+
+		inputs = g_array_new (FALSE, FALSE, sizeof (LsmSvgFilterNodeInput));
+
+		if (LSM_IS_SVG_FILTER_MERGE (primitive)) {
+			LsmDomNode *merge_node;
+
+			for (merge_node = node->first_child; merge_node != NULL; merge_node = merge_node->next_sibling)
+				if (LSM_IS_SVG_FILTER_MERGE_NODE (merge_node))
+					_add_input (inputs, results,
+						    LSM_SVG_FILTER_PRIMITIVE (merge_node)->in.value, previous);
+		} else if (!LSM_IS_SVG_FILTER_FLOOD (primitive) &&
+			   !LSM_IS_SVG_FILTER_IMAGE (primitive) &&
+			   !LSM_IS_SVG_FILTER_TURBULENCE (primitive))
+			_add_input (inputs, results, primitive->in.value, previous);
+
+		in2 = lsm_dom_element_get_attribute (LSM_DOM_ELEMENT (primitive), "in2");
+		if (in2 != NULL)
+			_add_input (inputs, results, in2, previous);
+
+		graph_node->n_inputs = inputs->len;
+		graph_node->inputs = (LsmSvgFilterNodeInput *) g_array_free (inputs, FALSE);
+
+		for (j = 0; j < graph_node->n_inputs; j++)
+			if (graph_node->inputs[j].slot >= 0)
+				graph->last_uses[graph_node->inputs[j].slot] = i;
+
+		output = LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS + i;
+		if (primitive->result.value != NULL)
+			g_hash_table_insert (results, (char *) primitive->result.value, GINT_TO_POINTER (output));
+		previous = output;
+
+		i++;
+	}
+
+	g_hash_table_unref (results);
+
+	/* SourceGraphic gives the default primitive subregion, and the last result is the filter output */
+	graph->last_uses[LSM_SVG_FILTER_INPUT_SOURCE_GRAPHIC] = n_nodes;
+	if (n_nodes > 0)
+		graph->last_uses[LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS + n_nodes - 1] = n_nodes;
+
+	return graph;
+}
+
+/**
+ * lsm_svg_filter_element_get_graph:
+ * @filter: a #LsmSvgFilterElement
+ *
+ * Returns the filter primitives of @filter, with their inputs resolved to surface slots. The graph is
+ * compiled on first use and rebuilt after any change of the document.
+ *
+ * Returns: (transfer none): the compiled filter graph.
+ *
+ * Since: 0.6
+ */
+
+const LsmSvgFilterGraph *
+lsm_svg_filter_element_get_graph (LsmSvgFilterElement *filter)
+{
+	unsigned int generation;
+
+	g_return_val_if_fail (LSM_IS_SVG_FILTER_ELEMENT (filter), NULL);
+
+	generation = lsm_dom_node_get_owner_document (LSM_DOM_NODE (filter))->generation;
+
+	if (filter->graph == NULL || filter->graph->document_generation != generation) {
+		_graph_free (filter->graph);
+		filter->graph = _graph_new (filter);
+		filter->graph->document_generation = generation;
+
+		lsm_debug_render ("[LsmSvgFilterElement::get_graph] Compiled %u primitives", filter->graph->n_nodes);
+	}
+
+	return filter->graph;
+}
+
 static void
 lsm_svg_filter_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
 	LsmSvgFilterElement *filter = LSM_SVG_FILTER_ELEMENT (self);
-	LsmDomNode *node;
+	const LsmSvgFilterGraph *graph;
 	LsmBox viewbox = {.x = 0.0, .y = .0, .width = 1.0, .height = 1.0};
 	const LsmBox *object_extents;
 	gboolean is_object_bounding_box;
+	unsigned int i;
 
 	if (!filter->enable_rendering) {
 		lsm_debug_render ("[LsmSvgFilterElement::render] Direct rendering not allowed");
@@ -103,16 +269,18 @@ lsm_svg_filter_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	object_extents = lsm_svg_view_get_object_extents (view);
 
-	is_object_bounding_box = (filter->primitive_units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX);
+	graph = lsm_svg_filter_element_get_graph (filter);
+
+	/* Light sources rely on the graph telling the view about the primitive units */
+	is_object_bounding_box = graph->is_object_bounding_box;
 
 	if (is_object_bounding_box) {
 		lsm_svg_view_push_viewport (view, object_extents,
 					    is_object_bounding_box ? &viewbox : NULL, NULL, LSM_SVG_OVERFLOW_VISIBLE); 
 	}
 
-	for (node = LSM_DOM_NODE (filter)->first_child; node != NULL; node = node->next_sibling)
-		if (LSM_IS_SVG_FILTER_PRIMITIVE (node))
-		    lsm_svg_filter_primitive_apply (LSM_SVG_FILTER_PRIMITIVE (node), view);
+	for (i = 0; i < graph->n_nodes; i++)
+		lsm_svg_view_apply_filter_node (view, graph, i);
 
 	if (is_object_bounding_box) {
 		lsm_svg_view_pop_viewport (view);
@@ -188,11 +356,16 @@ lsm_svg_filter_element_init (LsmSvgFilterElement *self)
 	self->height.length = width_height_default;
 	self->units.value = units_default;
 	self->primitive_units.value = primitive_units_default;
+	self->graph = NULL;
 }
 
 static void
 lsm_svg_filter_element_finalize (GObject *object)
 {
+	LsmSvgFilterElement *filter = LSM_SVG_FILTER_ELEMENT (object);
+
+	_graph_free (filter->graph);
+
 	parent_class->finalize (object);
 }
 
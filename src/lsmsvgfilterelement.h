@@ -49,6 +49,8 @@ struct _LsmSvgFilterElement {
 	LsmSvgPatternUnitsAttribute	primitive_units;
 
 	gboolean enable_rendering;
+
+	LsmSvgFilterGraph *graph;
 };
 
 struct _LsmSvgFilterElementClass {
@@ -0,0 +1,60 @@
+/* Lasem
+ *
+ * Copyright © 2010 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#ifndef LSM_SVG_FILTER_ELEMENT_PRIVATE_H
+#define LSM_SVG_FILTER_ELEMENT_PRIVATE_H
+
+#include <lsmsvgfilterelement.h>
+
+G_BEGIN_DECLS
+
+/* Surface slots of a filter graph are indexed by LsmSvgFilterInput for the standard inputs, followed by
+ * one slot per primitive output. */
+
+#define LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS	(LSM_SVG_FILTER_INPUT_STROKE_PAINT + 1)
+
+typedef struct {
+	const char *name;
+	int slot;
+} LsmSvgFilterNodeInput;
+
+typedef struct {
+	LsmSvgFilterPrimitive *primitive;
+	LsmSvgFilterNodeInput *inputs;
+	unsigned int n_inputs;
+} LsmSvgFilterNode;
+
+struct _LsmSvgFilterGraph {
+	LsmSvgFilterNode *nodes;
+	unsigned int n_nodes;
+	unsigned int n_slots;
+	int *last_uses;
+	gboolean is_object_bounding_box;
+	unsigned int document_generation;
+};
+
+const LsmSvgFilterGraph *	lsm_svg_filter_element_get_graph	(LsmSvgFilterElement *filter);
+
+G_END_DECLS
+
+#endif
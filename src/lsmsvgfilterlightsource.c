@@ -0,0 +1,85 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfilterlightsource.h>
+#include <string.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static gboolean
+lsm_svg_filter_light_source_can_append_child (LsmDomNode *self, LsmDomNode *child)
+{
+	return FALSE;
+}
+
+/* LsmSvgFilterLightSource implementation */
+
+void
+lsm_svg_filter_light_source_get_light (LsmSvgFilterLightSource *self, LsmSvgFilterLight *light)
+{
+	LsmSvgFilterLightSourceClass *light_source_class;
+
+	g_return_if_fail (LSM_IS_SVG_FILTER_LIGHT_SOURCE (self));
+	g_return_if_fail (light != NULL);
+
+	light_source_class = LSM_SVG_FILTER_LIGHT_SOURCE_GET_CLASS (self);
+
+	memset (light, 0, sizeof (LsmSvgFilterLight));
+
+	if (light_source_class->get_light != NULL)
+		light_source_class->get_light (self, light);
+}
+
+static void
+lsm_svg_filter_light_source_init (LsmSvgFilterLightSource *self)
+{
+}
+
+static void
+lsm_svg_filter_light_source_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterLightSource class */
+
+static void
+lsm_svg_filter_light_source_class_init (LsmSvgFilterLightSourceClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_light_source_finalize;
+
+	d_node_class->can_append_child = lsm_svg_filter_light_source_can_append_child;
+
+	s_element_class->category = LSM_SVG_ELEMENT_CATEGORY_NONE;
+	s_element_class->render = NULL;
+}
+
+G_DEFINE_ABSTRACT_TYPE (LsmSvgFilterLightSource, lsm_svg_filter_light_source, LSM_TYPE_SVG_ELEMENT)
@@ -0,0 +1,119 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfilterpointlight.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static const char *
+lsm_svg_filter_point_light_get_node_name (LsmDomNode *node)
+{
+	return "fePointLight";
+}
+
+/* LsmSvgFilterLightSource implementation */
+
+static void
+lsm_svg_filter_point_light_get_light (LsmSvgFilterLightSource *self, LsmSvgFilterLight *light)
+{
+	LsmSvgFilterPointLight *point_light = LSM_SVG_FILTER_POINT_LIGHT (self);
+
+	light->type = LSM_SVG_FILTER_LIGHT_TYPE_POINT;
+	light->x = point_light->x.value;
+	light->y = point_light->y.value;
+	light->z = point_light->z.value;
+}
+
+/* LsmSvgFilterPointLight implementation */
+
+static const double position_default = 0.0;
+
+LsmDomNode *
+lsm_svg_filter_point_light_new (void)
+{
+	return g_object_new (LSM_TYPE_SVG_FILTER_POINT_LIGHT, NULL);
+}
+
+static void
+lsm_svg_filter_point_light_init (LsmSvgFilterPointLight *self)
+{
+	self->x.value = position_default;
+	self->y.value = position_default;
+	self->z.value = position_default;
+}
+
+static void
+lsm_svg_filter_point_light_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterPointLight class */
+
+static const LsmAttributeInfos lsm_svg_filter_point_light_attribute_infos[] = {
+	{
+		.name = "x",
+		.attribute_offset = offsetof (LsmSvgFilterPointLight, x),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "y",
+		.attribute_offset = offsetof (LsmSvgFilterPointLight, y),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "z",
+		.attribute_offset = offsetof (LsmSvgFilterPointLight, z),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	}
+};
+
+static void
+lsm_svg_filter_point_light_class_init (LsmSvgFilterPointLightClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
+	LsmSvgFilterLightSourceClass *f_light_source_class = LSM_SVG_FILTER_LIGHT_SOURCE_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_point_light_finalize;
+
+	d_node_class->get_node_name = lsm_svg_filter_point_light_get_node_name;
+
+	s_element_class->attribute_manager = lsm_attribute_manager_duplicate (s_element_class->attribute_manager);
+
+	lsm_attribute_manager_add_attributes (s_element_class->attribute_manager,
+					      G_N_ELEMENTS (lsm_svg_filter_point_light_attribute_infos),
+					      lsm_svg_filter_point_light_attribute_infos);
+
+	f_light_source_class->get_light = lsm_svg_filter_point_light_get_light;
+}
+
+G_DEFINE_TYPE (LsmSvgFilterPointLight, lsm_svg_filter_point_light, LSM_TYPE_SVG_FILTER_LIGHT_SOURCE)
@@ -22,6 +22,7 @@
  */
 
 #include <lsmsvgfilterspecularlighting.h>
+#include <lsmsvgfilterlightsource.h>
 #include <lsmsvgview.h>
 
 static GObjectClass *parent_class;
@@ -34,6 +35,12 @@ lsm_svg_filter_specular_lighting_get_node_name (LsmDomNode *node)
 	return "feSpecularLighting";
 }
 
+static gboolean
+lsm_svg_filter_specular_lighting_can_append_child (LsmDomNode *self, LsmDomNode *child)
+{
+	return LSM_IS_SVG_FILTER_LIGHT_SOURCE (child);
+}
+
 /* LsmSvgElement implementation */
 
 static void
@@ -41,8 +48,17 @@ lsm_svg_filter_specular_lighting_apply  (LsmSvgFilterPrimitive *self, LsmSvgView
 					 const char *input, const char *output, const LsmBox *subregion)
 {
 	LsmSvgFilterSpecularLighting *specular_lighting = LSM_SVG_FILTER_SPECULAR_LIGHTING (self);
+	LsmSvgFilterLight light;
+	LsmDomNode *iter;
 
-	lsm_svg_view_apply_specular_lighting (view, output, subregion,
+	for (iter = LSM_DOM_NODE (self)->first_child; iter != NULL; iter = iter->next_sibling)
+		if (LSM_IS_SVG_FILTER_LIGHT_SOURCE (iter))
+			break;
+
+	if (iter != NULL)
+		lsm_svg_filter_light_source_get_light (LSM_SVG_FILTER_LIGHT_SOURCE (iter), &light);
+
+	lsm_svg_view_apply_specular_lighting (view, input, output, subregion, iter != NULL ? &light : NULL,
 					      specular_lighting->surface_scale.value,
 					      specular_lighting->specular_constant.value,
 					      specular_lighting->specular_exponent.value,
@@ -70,7 +86,6 @@ lsm_svg_filter_specular_lighting_init (LsmSvgFilterSpecularLighting *self)
 	self->specular_constant.value = specular_constant_default;
 	self->specular_exponent.value = specular_exponent_default;
 	self->kernel_unit_length.value = kernel_unit_length_default;
-
 }
 
 static void
@@ -83,7 +98,7 @@ lsm_svg_filter_specular_lighting_finalize (GObject *object)
 
 static const LsmAttributeInfos lsm_svg_filter_specular_lighting_attribute_infos[] = {
 	{
-		.name = "sufaceScale",
+		.name = "surfaceScale",
 		.attribute_offset = offsetof (LsmSvgFilterSpecularLighting, surface_scale),
 		.trait_class = &lsm_double_trait_class,
 		.trait_default = &surface_scale_default
@@ -121,6 +136,7 @@ lsm_svg_filter_specular_lighting_class_init (LsmSvgFilterSpecularLightingClass *
 	object_class->finalize = lsm_svg_filter_specular_lighting_finalize;
 
 	d_node_class->get_node_name = lsm_svg_filter_specular_lighting_get_node_name;
+	d_node_class->can_append_child = lsm_svg_filter_specular_lighting_can_append_child;
 
 	s_element_class->attribute_manager = lsm_attribute_manager_duplicate (s_element_class->attribute_manager);
 
@@ -0,0 +1,162 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfilterspotlight.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static const char *
+lsm_svg_filter_spot_light_get_node_name (LsmDomNode *node)
+{
+	return "feSpotLight";
+}
+
+/* LsmSvgFilterLightSource implementation */
+
+static void
+lsm_svg_filter_spot_light_get_light (LsmSvgFilterLightSource *self, LsmSvgFilterLight *light)
+{
+	LsmSvgFilterSpotLight *spot_light = LSM_SVG_FILTER_SPOT_LIGHT (self);
+
+	light->type = LSM_SVG_FILTER_LIGHT_TYPE_SPOT;
+	light->x = spot_light->x.value;
+	light->y = spot_light->y.value;
+	light->z = spot_light->z.value;
+	light->points_at_x = spot_light->points_at_x.value;
+	light->points_at_y = spot_light->points_at_y.value;
+	light->points_at_z = spot_light->points_at_z.value;
+	light->specular_exponent = spot_light->specular_exponent.value;
+	light->limiting_cone_angle = spot_light->limiting_cone_angle.value;
+	light->is_cone_limited = lsm_attribute_is_defined (&spot_light->limiting_cone_angle.base);
+}
+
+/* LsmSvgFilterSpotLight implementation */
+
+static const double position_default = 0.0;
+static const double specular_exponent_default = 1.0;
+static const double limiting_cone_angle_default = 90.0;
+
+LsmDomNode *
+lsm_svg_filter_spot_light_new (void)
+{
+	return g_object_new (LSM_TYPE_SVG_FILTER_SPOT_LIGHT, NULL);
+}
+
+static void
+lsm_svg_filter_spot_light_init (LsmSvgFilterSpotLight *self)
+{
+	self->x.value = position_default;
+	self->y.value = position_default;
+	self->z.value = position_default;
+	self->points_at_x.value = position_default;
+	self->points_at_y.value = position_default;
+	self->points_at_z.value = position_default;
+	self->specular_exponent.value = specular_exponent_default;
+	self->limiting_cone_angle.value = limiting_cone_angle_default;
+}
+
+static void
+lsm_svg_filter_spot_light_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterSpotLight class */
+
+static const LsmAttributeInfos lsm_svg_filter_spot_light_attribute_infos[] = {
+	{
+		.name = "x",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, x),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "y",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, y),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "z",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, z),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "pointsAtX",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, points_at_x),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "pointsAtY",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, points_at_y),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "pointsAtZ",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, points_at_z),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &position_default
+	},
+	{
+		.name = "specularExponent",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, specular_exponent),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &specular_exponent_default
+	},
+	{
+		.name = "limitingConeAngle",
+		.attribute_offset = offsetof (LsmSvgFilterSpotLight, limiting_cone_angle),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &limiting_cone_angle_default
+	}
+};
+
+static void
+lsm_svg_filter_spot_light_class_init (LsmSvgFilterSpotLightClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
+	LsmSvgFilterLightSourceClass *f_light_source_class = LSM_SVG_FILTER_LIGHT_SOURCE_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_spot_light_finalize;
+
+	d_node_class->get_node_name = lsm_svg_filter_spot_light_get_node_name;
+
+	s_element_class->attribute_manager = lsm_attribute_manager_duplicate (s_element_class->attribute_manager);
+
+	lsm_attribute_manager_add_attributes (s_element_class->attribute_manager,
+					      G_N_ELEMENTS (lsm_svg_filter_spot_light_attribute_infos),
+					      lsm_svg_filter_spot_light_attribute_infos);
+
+	f_light_source_class->get_light = lsm_svg_filter_spot_light_get_light;
+}
+
+G_DEFINE_TYPE (LsmSvgFilterSpotLight, lsm_svg_filter_spot_light, LSM_TYPE_SVG_FILTER_LIGHT_SOURCE)
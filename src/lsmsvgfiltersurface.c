@@ -30,9 +30,19 @@
 #include <lsmsvgfiltersurface.h>
 #include <lsmsvgenums.h>
 #include <lsmutils.h>
+#include <lsmdebug.h>
 #include <math.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LSM_SVG_FILTER_SURFACE_AVX2
+#include <immintrin.h>
+#endif
+
 static const int channelmap[4] = {2, 1, 0, 3};
 
 struct _LsmSvgFilterSurface {
@@ -149,6 +159,153 @@ lsm_svg_filter_surface_unref (LsmSvgFilterSurface *filter_surface)
 
 G_DEFINE_BOXED_TYPE (LsmSvgFilterSurface, lsm_svg_filter_surface, lsm_svg_filter_surface_ref, lsm_svg_filter_surface_unref)
 
+/* Filter kernels split their work in bands of rows or columns, processed in parallel by a shared thread
+ * pool. The calling thread processes the first band itself. */
+
+#define LSM_SVG_FILTER_SURFACE_MIN_PARALLEL_PIXELS	65536
+
+typedef void (*LsmSvgFilterBandFunc) (gpointer data, int start, int end);
+
+typedef struct {
+	LsmSvgFilterBandFunc func;
+	gpointer data;
+	int start;
+	int end;
+
+	GMutex *mutex;
+	GCond *cond;
+	int *n_pending;
+} LsmSvgFilterBand;
+
+static gboolean simd_enabled = TRUE;
+
+static void
+_band_thread_func (gpointer data, gpointer user_data)
+{
+	LsmSvgFilterBand *band = data;
+
+	band->func (band->data, band->start, band->end);
+
+	g_mutex_lock (band->mutex);
+	(*band->n_pending)--;
+	g_cond_signal (band->cond);
+	g_mutex_unlock (band->mutex);
+}
+
+/* The pool is created on first use. Dispatches hold thread_pool_users for reading until all their bands are
+ * done, so that lsm_svg_filter_surface_cleanup() can't free the pool under them, while concurrent renderings
+ * still share it. */
+
+static GRWLock thread_pool_users;
+G_LOCK_DEFINE_STATIC (thread_pool);
+static GThreadPool *thread_pool = NULL;
+
+static GThreadPool *
+_get_thread_pool (void)
+{
+	GThreadPool *pool;
+
+	G_LOCK (thread_pool);
+
+	if (thread_pool == NULL)
+		thread_pool = g_thread_pool_new (_band_thread_func, NULL,
+						 MAX (1, (int) g_get_num_processors () - 1), FALSE, NULL);
+	pool = thread_pool;
+
+	G_UNLOCK (thread_pool);
+
+	return pool;
+}
+
+static void
+_process_bands (LsmSvgFilterBandFunc func, gpointer data, int n_items, int n_pixels)
+{
+	LsmSvgFilterBand *bands;
+	GMutex mutex;
+	GCond cond;
+	GThreadPool *pool;
+	int n_bands;
+	int n_pending;
+	int i;
+
+	n_bands = MIN ((int) g_get_num_processors (), n_items);
+	if (n_pixels < LSM_SVG_FILTER_SURFACE_MIN_PARALLEL_PIXELS || n_bands < 2) {
+		func (data, 0, n_items);
+		return;
+	}
+
+	g_rw_lock_reader_lock (&thread_pool_users);
+
+	pool = _get_thread_pool ();
+	if (pool == NULL) {
+		g_rw_lock_reader_unlock (&thread_pool_users);
+		func (data, 0, n_items);
+		return;
+	}
+
+	g_mutex_init (&mutex);
+	g_cond_init (&cond);
+	n_pending = n_bands - 1;
+
+	bands = g_new (LsmSvgFilterBand, n_bands);
+	for (i = 0; i < n_bands; i++) {
+		bands[i].func = func;
+		bands[i].data = data;
+		bands[i].start = (gint64) n_items * i / n_bands;
+		bands[i].end = (gint64) n_items * (i + 1) / n_bands;
+		bands[i].mutex = &mutex;
+		bands[i].cond = &cond;
+		bands[i].n_pending = &n_pending;
+	}
+
+	for (i = 1; i < n_bands; i++)
+		g_thread_pool_push (pool, &bands[i], NULL);
+
+	func (data, bands[0].start, bands[0].end);
+
+	g_mutex_lock (&mutex);
+	while (n_pending > 0)
+		g_cond_wait (&cond, &mutex);
+	g_mutex_unlock (&mutex);
+
+	g_rw_lock_reader_unlock (&thread_pool_users);
+
+	g_free (bands);
+	g_mutex_clear (&mutex);
+	g_cond_clear (&cond);
+}
+
+/**
+ * lsm_svg_filter_surface_set_simd_enabled:
+ * @enable: whether filter kernels may use SIMD instructions
+ *
+ * Enables or disables the vectorized filter kernels. The vectorized and scalar kernels give the exact same
+ * results, this is mostly useful for testing and benchmarking. SIMD is enabled by default, when the CPU
+ * supports it.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_filter_surface_set_simd_enabled (gboolean enable)
+{
+	simd_enabled = enable;
+}
+
+/**
+ * lsm_svg_filter_surface_get_simd_enabled:
+ *
+ * Returns: %TRUE if filter kernels may use SIMD instructions.
+ *
+ * Since: 0.6
+ */
+
+gboolean
+lsm_svg_filter_surface_get_simd_enabled (void)
+{
+	return simd_enabled;
+}
+
 /*
  * The stack blur algorithm was invented by Mario Klingemann <mario@quasimondo.com>
  * http://incubator.quasimondo.com/processing/fast_blur_deluxe.php
@@ -156,257 +313,314 @@ G_DEFINE_BOXED_TYPE (LsmSvgFilterSurface, lsm_svg_filter_surface, lsm_svg_filter
  * Compared to Mario's original source code, the lookup table is removed as the benefit
  * doesn't worth the memory usage in case of large radiuses. Also, the following code adds
  * alpha channel support and different radius for vertical and horizontal directions.
+ *
+ * Each output pixel is the sum of the pixels of the line weighted by a triangle of half width radius + 1,
+ * with clamped borders, divided by (radius + 1)². Instead of keeping the pixels of the sliding window in
+ * a stack, they are read again from a copy of the line, so a line can be written back in place. The
+ * horizontal pass writes to the output surface, the vertical pass blurs the columns of the output
+ * surface in place. The kernels blur n_lines interleaved lines: pixel i of line c is lines[i * n_lines + c],
+ * and is written to output[c * line_step + i * pixel_step].
  */
 
+typedef void (*LsmSvgStackBlurFunc) (const guint32 *lines, int n, int radius,
+				     guint32 *output, int line_step, int pixel_step);
+
 static void
-stack_blur (cairo_surface_t *input, cairo_surface_t *output, int rx, int ry)
+_stack_blur_lines_scalar (const guint32 *line, int n, int radius, guint32 *output, int line_step, int pixel_step)
 {
-	guint32 *input_pixels;
-	guint32 *output_pixels;
-	int w, h, wm, hm, wh, div;
-	int *r, *g, *b, *a;
-
-	int rsum,gsum,bsum,asum,x,y,i,p,yp,yi,yw;
-	int *vmin;
-	int divsum;
-
-	yw=yi=0;
-
-	int *stack;
-	int stackpointer;
-	int stackstart;
-	int *sir;
-	int rbs;
-	int r1;
-	int routsum,goutsum,boutsum, aoutsum;
-	int rinsum,ginsum,binsum, ainsum;
-	int rowstride;
+	int sum[4] = {0, 0, 0, 0};
+	int in_sum[4] = {0, 0, 0, 0};
+	int out_sum[4] = {0, 0, 0, 0};
+	int divisor;
+	int last;
+	int i, c;
+
+	divisor = (radius + 1) * (radius + 1);
+	last = n - 1;
+
+	for (i = -radius; i <= radius; i++) {
+		guint32 p = line[CLAMP (i, 0, last)];
+		int weight = radius + 1 - ABS (i);
+
+		for (c = 0; c < 4; c++) {
+			int value = (p >> (8 * c)) & 0xff;
+
+			sum[c] += value * weight;
+			if (i > 0)
+				in_sum[c] += value;
+			else
+				out_sum[c] += value;
+		}
+	}
 
-	g_return_if_fail (rx > 0 || ry > 0);
+	for (i = 0; i < n; i++) {
+		guint32 p_out = line[MAX (i - radius, 0)];
+		guint32 p_in = line[MIN (i + radius + 1, last)];
+		guint32 p_next = line[MIN (i + 1, last)];
+
+		output[i * pixel_step] =
+			((guint32) (sum[3] / divisor) << 24) |
+			((guint32) (sum[2] / divisor) << 16) |
+			((guint32) (sum[1] / divisor) << 8) |
+			(guint32) (sum[0] / divisor);
+
+		for (c = 0; c < 4; c++) {
+			sum[c] -= out_sum[c];
+			out_sum[c] -= (p_out >> (8 * c)) & 0xff;
+			in_sum[c] += (p_in >> (8 * c)) & 0xff;
+			sum[c] += in_sum[c];
+			out_sum[c] += (p_next >> (8 * c)) & 0xff;
+			in_sum[c] -= (p_next >> (8 * c)) & 0xff;
+		}
+	}
+}
 
-	input_pixels = (guint32 *) cairo_image_surface_get_data (input);
-	output_pixels = (guint32 *) cairo_image_surface_get_data (output);
-	rowstride = cairo_image_surface_get_stride (input);
-	w = cairo_image_surface_get_width (input);
-	h = cairo_image_surface_get_height (input);
+/* The vectorized kernels divide the channel sums in double precision, by a multiplication with the
+ * rounded reciprocal of the divisor. Sums are below 2^31, the quotient is below 256, so the error of the
+ * product is below 2^-44. Adding 2^-40 before truncation gives the exact integer quotient, as a non
+ * integer quotient is at least 1 / divisor > 2^-31 away from the next integer. Initial sums are
+ * accumulated without multiplication, SSE2 lacks a 32 bit one. */
 
-	g_return_if_fail (cairo_image_surface_get_width (output) == w);
-	g_return_if_fail (cairo_image_surface_get_height (output) == h);
-	g_return_if_fail (cairo_image_surface_get_stride (output) == rowstride);
+#define LSM_SVG_STACK_BLUR_BIAS	0x1p-40
 
-	wm = w - 1;
-	hm = h - 1;
-	wh = w * h;
-	
-	r = g_new (int, wh);
-	g = g_new (int, wh);
-	b = g_new (int, wh);
-	a = g_new (int, wh);
-
-	div = 2 * rx + 1;
-	divsum = (div + 1) >> 1; 
-	divsum *= divsum;
-	stack = g_new (int, div * 4);
-	r1 = rx + 1;
-
-	vmin = g_new (int, w);
-	for (y =0; y < h; y++) {
-		rinsum=ginsum=binsum=ainsum=routsum=goutsum=boutsum=aoutsum=rsum=gsum=bsum=asum=0;
-		yi = y * rowstride / 4;
-
-		for (i = -rx; i <= rx; i++) {
-			p = input_pixels [yi + MIN (wm, MAX (i, 0))];
-			sir = &stack [4 * (i + rx)];
-			sir[0]=(p & 0x00ff0000)>>16;
-			sir[1]=(p & 0x0000ff00)>>8;
-			sir[2]=(p & 0x000000ff);
-			sir[3]=(p & 0xff0000ff)>>24;
-			rbs= r1 - ABS (i);
-			rsum+=sir[0]*rbs;
-			gsum+=sir[1]*rbs;
-			bsum+=sir[2]*rbs;
-			asum+=sir[3]*rbs;
-			if (i>0){
-				rinsum+=sir[0];
-				ginsum+=sir[1];
-				binsum+=sir[2];
-				ainsum+=sir[3];
-			} else {
-				routsum+=sir[0];
-				goutsum+=sir[1];
-				boutsum+=sir[2];
-				aoutsum+=sir[3];
-			}
-		}
-		stackpointer=rx;
+#ifdef __SSE2__
 
-		for (x=0;x<w;x++){
+static inline __m128i
+_stack_blur_unpack_sse2 (guint32 pixel)
+{
+	const __m128i zero = _mm_setzero_si128 ();
 
-			r[yi] = rsum / divsum;
-			g[yi] = gsum / divsum;
-			b[yi] = bsum / divsum;
-			a[yi] = asum / divsum;
-			rsum-=routsum;
-			gsum-=goutsum;
-			bsum-=boutsum;
-			asum-=aoutsum;
+	return _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (pixel), zero), zero);
+}
 
-			stackstart=stackpointer-rx+div;
-			sir = &stack [4 * (stackstart % div)];
+static inline guint32
+_stack_blur_pack_sse2 (__m128i sum, __m128d reciprocal)
+{
+	const __m128d bias = _mm_set1_pd (LSM_SVG_STACK_BLUR_BIAS);
+	__m128i low, high, result;
 
-			routsum-=sir[0];
-			goutsum-=sir[1];
-			boutsum-=sir[2];
-			aoutsum-=sir[3];
+	low = _mm_cvttpd_epi32 (_mm_add_pd (_mm_mul_pd (_mm_cvtepi32_pd (sum), reciprocal), bias));
+	high = _mm_cvttpd_epi32 (_mm_add_pd (_mm_mul_pd (_mm_cvtepi32_pd (_mm_shuffle_epi32 (sum, _MM_SHUFFLE (1, 0, 3, 2))),
+							 reciprocal), bias));
+	result = _mm_unpacklo_epi64 (low, high);
+	result = _mm_packs_epi32 (result, result);
 
-			if(y==0){
-				vmin[x]=MIN (x + rx + 1, wm);
-			}
-			p = input_pixels [yw + vmin[x]];
+	return _mm_cvtsi128_si32 (_mm_packus_epi16 (result, result));
+}
+
+static void
+_stack_blur_lines_sse2 (const guint32 *line, int n, int radius, guint32 *output, int line_step, int pixel_step)
+{
+	__m128i sum = _mm_setzero_si128 ();
+	__m128i in_sum = _mm_setzero_si128 ();
+	__m128i out_sum = _mm_setzero_si128 ();
+	__m128d reciprocal;
+	int last;
+	int i;
+
+	reciprocal = _mm_set1_pd (1.0 / ((double) (radius + 1) * (radius + 1)));
+	last = n - 1;
+
+	for (i = 0; i >= -radius; i--) {
+		out_sum = _mm_add_epi32 (out_sum, _stack_blur_unpack_sse2 (line[MIN (MAX (i, 0), last)]));
+		sum = _mm_add_epi32 (sum, out_sum);
+	}
+	for (i = 1; i <= radius; i++) {
+		in_sum = _mm_add_epi32 (in_sum, _stack_blur_unpack_sse2 (line[MIN (i, last)]));
+		sum = _mm_add_epi32 (sum, in_sum);
+	}
+
+	for (i = 0; i < n; i++) {
+		__m128i p_next = _stack_blur_unpack_sse2 (line[MIN (i + 1, last)]);
+
+		output[i * pixel_step] = _stack_blur_pack_sse2 (sum, reciprocal);
 
-			sir[0]=(p & 0x00ff0000)>>16;
-			sir[1]=(p & 0x0000ff00)>>8;
-			sir[2]=(p & 0x000000ff);
-			sir[3]=(p & 0xff000000)>>24;
+		sum = _mm_sub_epi32 (sum, out_sum);
+		out_sum = _mm_sub_epi32 (out_sum, _stack_blur_unpack_sse2 (line[MAX (i - radius, 0)]));
+		in_sum = _mm_add_epi32 (in_sum, _stack_blur_unpack_sse2 (line[MIN (i + radius + 1, last)]));
+		sum = _mm_add_epi32 (sum, in_sum);
+		out_sum = _mm_add_epi32 (out_sum, p_next);
+		in_sum = _mm_sub_epi32 (in_sum, p_next);
+	}
+}
 
-			rinsum+=sir[0];
-			ginsum+=sir[1];
-			binsum+=sir[2];
-			ainsum+=sir[3];
+#endif
 
-			rsum+=rinsum;
-			gsum+=ginsum;
-			bsum+=binsum;
-			asum+=ainsum;
+#ifdef LSM_SVG_FILTER_SURFACE_AVX2
 
-			stackpointer = (stackpointer + 1) % div;
-			sir = &stack [4 * ((stackpointer) % div)];
+/* Two interleaved lines, one pixel of each per vector */
 
-			routsum+=sir[0];
-			goutsum+=sir[1];
-			boutsum+=sir[2];
-			aoutsum+=sir[3];
+__attribute__ ((target ("avx2"))) static inline __m256i
+_stack_blur_unpack_avx2 (const guint32 *pixels)
+{
+	return _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) pixels));
+}
 
-			rinsum-=sir[0];
-			ginsum-=sir[1];
-			binsum-=sir[2];
-			ainsum-=sir[3];
+__attribute__ ((target ("avx2"))) static inline __m128i
+_stack_blur_divide_avx2 (__m128i sum, __m256d reciprocal)
+{
+	const __m256d bias = _mm256_set1_pd (LSM_SVG_STACK_BLUR_BIAS);
 
-			yi++;
-		}
-		yw+=w;
+	return _mm256_cvttpd_epi32 (_mm256_add_pd (_mm256_mul_pd (_mm256_cvtepi32_pd (sum), reciprocal), bias));
+}
+
+__attribute__ ((target ("avx2"))) static void
+_stack_blur_lines_avx2 (const guint32 *lines, int n, int radius, guint32 *output, int line_step, int pixel_step)
+{
+	__m256i sum = _mm256_setzero_si256 ();
+	__m256i in_sum = _mm256_setzero_si256 ();
+	__m256i out_sum = _mm256_setzero_si256 ();
+	__m256d reciprocal;
+	int last;
+	int i;
+
+	reciprocal = _mm256_set1_pd (1.0 / ((double) (radius + 1) * (radius + 1)));
+	last = n - 1;
+
+	for (i = 0; i >= -radius; i--) {
+		out_sum = _mm256_add_epi32 (out_sum, _stack_blur_unpack_avx2 (&lines[2 * MIN (MAX (i, 0), last)]));
+		sum = _mm256_add_epi32 (sum, out_sum);
+	}
+	for (i = 1; i <= radius; i++) {
+		in_sum = _mm256_add_epi32 (in_sum, _stack_blur_unpack_avx2 (&lines[2 * MIN (i, last)]));
+		sum = _mm256_add_epi32 (sum, in_sum);
 	}
-	g_free (vmin);
-	g_free (stack);
-
-	div = 2 * ry + 1;
-	divsum = (div + 1) >> 1; 
-	divsum *= divsum;
-
-	stack = g_new0 (int, div * 4);
-	r1 = ry + 1;
-
-	vmin = g_new0 (int, h);
-	for (x=0;x<w;x++){
-		rinsum=ginsum=binsum=ainsum=routsum=goutsum=boutsum=aoutsum=rsum=gsum=bsum=asum=0;
-		yp=-ry*w;
-		for(i=-ry;i<=ry;i++){
-			yi= MAX(0,yp)+x;
-
-			sir = &stack [4 * (i + ry)];
-
-			sir[0]=r[yi];
-			sir[1]=g[yi];
-			sir[2]=b[yi];
-			sir[3]=a[yi];
-
-			rbs=r1 - ABS(i);
-
-			rsum+=r[yi]*rbs;
-			gsum+=g[yi]*rbs;
-			bsum+=b[yi]*rbs;
-			asum+=a[yi]*rbs;
-
-			if (i>0){
-				rinsum+=sir[0];
-				ginsum+=sir[1];
-				binsum+=sir[2];
-				ainsum+=sir[3];
-			} else {
-				routsum+=sir[0];
-				goutsum+=sir[1];
-				boutsum+=sir[2];
-				aoutsum+=sir[3];
-			}
 
-			if(i<hm){
-				yp+=w;
-			}
+	for (i = 0; i < n; i++) {
+		__m256i p_next = _stack_blur_unpack_avx2 (&lines[2 * MIN (i + 1, last)]);
+		__m128i low, high;
+
+		low = _stack_blur_divide_avx2 (_mm256_castsi256_si128 (sum), reciprocal);
+		high = _stack_blur_divide_avx2 (_mm256_extracti128_si256 (sum, 1), reciprocal);
+		low = _mm_packs_epi32 (low, high);
+		low = _mm_packus_epi16 (low, low);
+		output[i * pixel_step] = _mm_cvtsi128_si32 (low);
+		output[line_step + i * pixel_step] = _mm_cvtsi128_si32 (_mm_srli_si128 (low, 4));
+
+		sum = _mm256_sub_epi32 (sum, out_sum);
+		out_sum = _mm256_sub_epi32 (out_sum, _stack_blur_unpack_avx2 (&lines[2 * MAX (i - radius, 0)]));
+		in_sum = _mm256_add_epi32 (in_sum, _stack_blur_unpack_avx2 (&lines[2 * MIN (i + radius + 1, last)]));
+		sum = _mm256_add_epi32 (sum, in_sum);
+		out_sum = _mm256_add_epi32 (out_sum, p_next);
+		in_sum = _mm256_sub_epi32 (in_sum, p_next);
+	}
+}
+
+#endif
+
+typedef struct {
+	const guint32 *input_pixels;
+	guint32 *output_pixels;
+	int width;
+	int height;
+	int stride;
+	int rx;
+	int ry;
+
+	LsmSvgStackBlurFunc blur_lines;
+	int n_lines;
+	LsmSvgStackBlurFunc blur_line;
+} LsmSvgStackBlur;
+
+static void
+_stack_blur_rows (gpointer data, int start, int end)
+{
+	LsmSvgStackBlur *blur = data;
+	guint32 *lines;
+	int y, x, c;
+
+	lines = g_new (guint32, blur->width * blur->n_lines);
+
+	for (y = start; y + blur->n_lines <= end; y += blur->n_lines) {
+		for (c = 0; c < blur->n_lines; c++) {
+			const guint32 *row = blur->input_pixels + (y + c) * blur->stride;
+
+			for (x = 0; x < blur->width; x++)
+				lines[x * blur->n_lines + c] = row[x];
 		}
-		yi=x;
-		stackpointer=ry;
-		for (y=0;y<h;y++){
-			output_pixels [yi] = 
-				((asum / divsum) << 24) |
-				((rsum / divsum) << 16) |
-				((gsum / divsum) << 8) |
-				(bsum / divsum);
-			rsum-=routsum;
-			gsum-=goutsum;
-			bsum-=boutsum;
-			asum-=aoutsum;
-
-			stackstart=stackpointer-ry+div;
-			sir = &stack [4 * (stackstart % div)];
-
-			routsum-=sir[0];
-			goutsum-=sir[1];
-			boutsum-=sir[2];
-			aoutsum-=sir[3];
-
-			if(x==0) {
-				vmin[y] = MIN(y+r1,hm)*w;
-			}
-			p=x+vmin[y];
+		blur->blur_lines (lines, blur->width, blur->rx,
+				  blur->output_pixels + y * blur->stride, blur->stride, 1);
+	}
+
+	for (; y < end; y++) {
+		memcpy (lines, blur->input_pixels + y * blur->stride, blur->width * sizeof (guint32));
+		blur->blur_line (lines, blur->width, blur->rx,
+				 blur->output_pixels + y * blur->stride, blur->stride, 1);
+	}
 
-			sir[0]=r[p];
-			sir[1]=g[p];
-			sir[2]=b[p];
-			sir[3]=a[p];
+	g_free (lines);
+}
+
+static void
+_stack_blur_columns (gpointer data, int start, int end)
+{
+	LsmSvgStackBlur *blur = data;
+	guint32 *lines;
+	int x, y, c;
+
+	lines = g_new (guint32, blur->height * blur->n_lines);
+
+	for (x = start; x + blur->n_lines <= end; x += blur->n_lines) {
+		for (y = 0; y < blur->height; y++)
+			for (c = 0; c < blur->n_lines; c++)
+				lines[y * blur->n_lines + c] = blur->output_pixels[y * blur->stride + x + c];
+		blur->blur_lines (lines, blur->height, blur->ry,
+				  blur->output_pixels + x, 1, blur->stride);
+	}
+
+	for (; x < end; x++) {
+		for (y = 0; y < blur->height; y++)
+			lines[y] = blur->output_pixels[y * blur->stride + x];
+		blur->blur_line (lines, blur->height, blur->ry,
+				 blur->output_pixels + x, 1, blur->stride);
+	}
 
-			rinsum+=sir[0];
-			ginsum+=sir[1];
-			binsum+=sir[2];
-			ainsum+=sir[3];
+	g_free (lines);
+}
 
-			rsum+=rinsum;
-			gsum+=ginsum;
-			bsum+=binsum;
-			asum+=ainsum;
+static void
+stack_blur (cairo_surface_t *input, cairo_surface_t *output, int rx, int ry)
+{
+	LsmSvgStackBlur blur;
+	int rowstride;
 
-			stackpointer=(stackpointer+1)%div;
-			sir = &stack[4 * stackpointer];
+	g_return_if_fail (rx > 0 || ry > 0);
 
-			routsum+=sir[0];
-			goutsum+=sir[1];
-			boutsum+=sir[2];
-			aoutsum+=sir[3];
+	rowstride = cairo_image_surface_get_stride (input);
 
-			rinsum-=sir[0];
-			ginsum-=sir[1];
-			binsum-=sir[2];
-			ainsum-=sir[3];
+	g_return_if_fail (cairo_image_surface_get_width (output) == cairo_image_surface_get_width (input));
+	g_return_if_fail (cairo_image_surface_get_height (output) == cairo_image_surface_get_height (input));
+	g_return_if_fail (cairo_image_surface_get_stride (output) == rowstride);
 
-			yi+= rowstride / 4;
+	blur.input_pixels = (const guint32 *) cairo_image_surface_get_data (input);
+	blur.output_pixels = (guint32 *) cairo_image_surface_get_data (output);
+	blur.width = cairo_image_surface_get_width (input);
+	blur.height = cairo_image_surface_get_height (input);
+	blur.stride = rowstride / 4;
+	blur.rx = rx;
+	blur.ry = ry;
+
+	blur.blur_lines = _stack_blur_lines_scalar;
+	blur.blur_line = _stack_blur_lines_scalar;
+	blur.n_lines = 1;
+
+	if (simd_enabled) {
+#ifdef __SSE2__
+		blur.blur_lines = _stack_blur_lines_sse2;
+		blur.blur_line = _stack_blur_lines_sse2;
+#endif
+#ifdef LSM_SVG_FILTER_SURFACE_AVX2
+		if (__builtin_cpu_supports ("avx2")) {
+			blur.blur_lines = _stack_blur_lines_avx2;
+			blur.n_lines = 2;
 		}
+#endif
 	}
-	g_free (vmin);
-	g_free (stack);
 
-	g_free (r);
-	g_free (g);
-	g_free (b);
-	g_free (a);
+	_process_bands (_stack_blur_rows, &blur, blur.height, blur.width * blur.height);
+
+	if (ry > 0)
+		_process_bands (_stack_blur_columns, &blur, blur.width, blur.width * blur.height);
 }
 
 void
@@ -788,32 +1002,159 @@ lsm_svg_filter_surface_color_matrix (LsmSvgFilterSurface *input, LsmSvgFilterSur
 	cairo_destroy (cairo);
 }
 
+/* Component transfer. Pixels are unpremultiplied, mapped through the lookup table of each channel, and
+ * premultiplied again, a row at a time. Unpremultiplication is done in single precision, as
+ * c * 255 / a rounded to the nearest integer, premultiplication uses the exact rounded division by 255.
+ * Both are vectorized, the lookups are scalar. */
+
+typedef struct {
+	const guint32 *input;
+	int input_stride;
+	guint32 *output;
+	int output_stride;
+	int x1, y1;
+	int width;
+
+	const guint8 *red;
+	const guint8 *green;
+	const guint8 *blue;
+	const guint8 *alpha;
+	gboolean use_simd;
+} LsmSvgComponentTransfer;
+
+static inline guint32
+_unpremultiply_channel (guint32 pixel, int shift, float alpha)
+{
+	float value = (float) ((pixel >> shift) & 0xff) * 255.0f / alpha + 0.5f;
+
+	return (guint32) MIN (value, 255.0f) << shift;
+}
+
+static inline guint32
+_premultiply_channel (guint32 pixel, int shift, guint32 alpha)
+{
+	guint32 t = ((pixel >> shift) & 0xff) * alpha + 128;
+
+	return ((t + (t >> 8)) >> 8) << shift;
+}
+
+static void
+_component_transfer_row (const LsmSvgComponentTransfer *transfer, const guint32 *input, guint32 *output)
+{
+	int x = 0;
+
+#ifdef __SSE2__
+	if (transfer->use_simd) {
+		const __m128i mask = _mm_set1_epi32 (0xff);
+		const __m128 scale = _mm_set1_ps (255.0f);
+		const __m128 half = _mm_set1_ps (0.5f);
+		const __m128 one = _mm_set1_ps (1.0f);
+
+		for (; x + 4 <= transfer->width; x += 4) {
+			__m128i pixels = _mm_loadu_si128 ((const __m128i *) (input + x));
+			__m128i alpha = _mm_srli_epi32 (pixels, 24);
+			__m128 divisor = _mm_max_ps (_mm_cvtepi32_ps (alpha), one);
+			__m128i result = _mm_slli_epi32 (alpha, 24);
+			int shift;
+
+			for (shift = 0; shift < 24; shift += 8) {
+				__m128 value = _mm_cvtepi32_ps (_mm_and_si128 (_mm_srli_epi32 (pixels, shift), mask));
+
+				value = _mm_add_ps (_mm_div_ps (_mm_mul_ps (value, scale), divisor), half);
+				value = _mm_min_ps (value, scale);
+				result = _mm_or_si128 (result, _mm_slli_epi32 (_mm_cvttps_epi32 (value), shift));
+			}
+
+			_mm_storeu_si128 ((__m128i *) (output + x), result);
+		}
+	}
+#endif
+
+	for (; x < transfer->width; x++) {
+		guint32 pixel = input[x];
+		float divisor = MAX (pixel >> 24, 1);
+
+		output[x] = (pixel & 0xff000000) |
+			_unpremultiply_channel (pixel, 16, divisor) |
+			_unpremultiply_channel (pixel, 8, divisor) |
+			_unpremultiply_channel (pixel, 0, divisor);
+	}
+
+	for (x = 0; x < transfer->width; x++) {
+		guint32 pixel = output[x];
+
+		output[x] = ((guint32) transfer->alpha[pixel >> 24] << 24) |
+			((guint32) transfer->red[(pixel >> 16) & 0xff] << 16) |
+			((guint32) transfer->green[(pixel >> 8) & 0xff] << 8) |
+			(guint32) transfer->blue[pixel & 0xff];
+	}
+
+	x = 0;
+
+#ifdef __SSE2__
+	if (transfer->use_simd) {
+		const __m128i zero = _mm_setzero_si128 ();
+		const __m128i bias = _mm_set1_epi16 (128);
+		const __m128i alpha_mask = _mm_set1_epi32 (0xff000000);
+
+		for (; x + 4 <= transfer->width; x += 4) {
+			__m128i pixels = _mm_loadu_si128 ((const __m128i *) (output + x));
+			__m128i low = _mm_unpacklo_epi8 (pixels, zero);
+			__m128i high = _mm_unpackhi_epi8 (pixels, zero);
+			__m128i low_alpha, high_alpha;
+
+			low_alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (low, _MM_SHUFFLE (3, 3, 3, 3)),
+							 _MM_SHUFFLE (3, 3, 3, 3));
+			high_alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (high, _MM_SHUFFLE (3, 3, 3, 3)),
+							  _MM_SHUFFLE (3, 3, 3, 3));
+
+			low = _mm_add_epi16 (_mm_mullo_epi16 (low, low_alpha), bias);
+			low = _mm_srli_epi16 (_mm_add_epi16 (low, _mm_srli_epi16 (low, 8)), 8);
+			high = _mm_add_epi16 (_mm_mullo_epi16 (high, high_alpha), bias);
+			high = _mm_srli_epi16 (_mm_add_epi16 (high, _mm_srli_epi16 (high, 8)), 8);
+
+			pixels = _mm_or_si128 (_mm_and_si128 (pixels, alpha_mask),
+					       _mm_andnot_si128 (alpha_mask, _mm_packus_epi16 (low, high)));
+			_mm_storeu_si128 ((__m128i *) (output + x), pixels);
+		}
+	}
+#endif
+
+	for (; x < transfer->width; x++) {
+		guint32 pixel = output[x];
+		guint32 alpha = pixel >> 24;
+
+		output[x] = (pixel & 0xff000000) |
+			_premultiply_channel (pixel, 16, alpha) |
+			_premultiply_channel (pixel, 8, alpha) |
+			_premultiply_channel (pixel, 0, alpha);
+	}
+}
+
+static void
+_component_transfer_rows (gpointer data, int start, int end)
+{
+	LsmSvgComponentTransfer *transfer = data;
+	int y;
+
+	for (y = start; y < end; y++)
+		_component_transfer_row (transfer,
+					 transfer->input + (transfer->y1 + y) * transfer->input_stride + transfer->x1,
+					 transfer->output + (transfer->y1 + y) * transfer->output_stride + transfer->x1);
+}
+
 void
-lsm_svg_filter_surface_convolve_matrix (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
-					 unsigned order_x, unsigned order_y, unsigned n_values, const double *values,
-					 double divisor, double bias, unsigned target_x, unsigned target_y,
-					 LsmSvgEdgeMode edge_mode, gboolean preserve_alpha)
+lsm_svg_filter_surface_component_transfer (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+					   const guint8 *red, const guint8 *green, const guint8 *blue,
+					   const guint8 *alpha)
 {
-	cairo_t *cairo;
-	int ch;
-	gint x, y, x1, x2, y1, y2;
-	gint width, height;
-	gint rowstride;
-	guchar *in_pixels;
-	guchar *output_pixels;
-	double kval, sum;
-	guchar sval;
-	int sx, sy, kx, ky;
-	double dx = 1.0, dy = 1.0;
-	int umch, i, j;
-	gint tempresult;
+	LsmSvgComponentTransfer transfer;
+	int width, height;
+	int x1, x2, y1, y2;
 
 	g_return_if_fail (input != NULL);
 	g_return_if_fail (output != NULL);
-	g_return_if_fail (values != NULL || n_values < 1);
-
-	if (divisor <= 0.0)
-		return;
+	g_return_if_fail (red != NULL && green != NULL && blue != NULL && alpha != NULL);
 
 	width = cairo_image_surface_get_width (input->surface);
 	height = cairo_image_surface_get_height (input->surface);
@@ -825,110 +1166,518 @@ lsm_svg_filter_surface_convolve_matrix (LsmSvgFilterSurface *input, LsmSvgFilter
 	if (height < 1 || width < 1)
 		return;
 
-	if (order_y * order_x != n_values)
-		return;
+	x1 = CLAMP (output->subregion.x, 0, width);
+	x2 = CLAMP (output->subregion.x + output->subregion.width, 0, width);
+	y1 = CLAMP (output->subregion.y, 0, height);
+	y2 = CLAMP (output->subregion.y + output->subregion.height, 0, height);
 
-	if (target_x > order_x || target_y > order_y)
+	if (x2 <= x1 || y2 <= y1)
 		return;
 
-	x1 = CLAMP (input->subregion.x, 0, width);
-	x2 = CLAMP (input->subregion.x + input->subregion.width, 0, width);
-	y1 = CLAMP (input->subregion.y, 0, height);
-	y2 = CLAMP (input->subregion.y + input->subregion.height, 0, height);
-
 	cairo_surface_flush (input->surface);
-	cairo = cairo_create (output->surface);
+	cairo_surface_flush (output->surface);
+
+	transfer.input = (const guint32 *) cairo_image_surface_get_data (input->surface);
+	transfer.input_stride = cairo_image_surface_get_stride (input->surface) / 4;
+	transfer.output = (guint32 *) cairo_image_surface_get_data (output->surface);
+	transfer.output_stride = cairo_image_surface_get_stride (output->surface) / 4;
+	transfer.x1 = x1;
+	transfer.y1 = y1;
+	transfer.width = x2 - x1;
+	transfer.red = red;
+	transfer.green = green;
+	transfer.blue = blue;
+	transfer.alpha = alpha;
+	transfer.use_simd = simd_enabled;
+
+	_process_bands (_component_transfer_rows, &transfer, y2 - y1, (x2 - x1) * (y2 - y1));
 
-	in_pixels = cairo_image_surface_get_data (input->surface);
-	output_pixels = cairo_image_surface_get_data (output->surface);
-	rowstride = cairo_image_surface_get_stride (input->surface);
+	cairo_surface_mark_dirty (output->surface);
+}
 
-	for (y = y1; y < y2; y++)
-		for (x = x1; x < x2; x++) {
-			for (umch = 0; umch < 3 + !preserve_alpha; umch++) {
-				ch = channelmap[umch];
-				sum = 0;
-				for (i = 0; i < order_y; i++)
-					for (j = 0; j < order_x; j++) {
-						int alpha;
-						sx = x - target_x + j * dx;
-						sy = y - target_y + i * dy;
-						if (edge_mode == LSM_SVG_EDGE_MODE_DUPLICATE) {
-							if (sx < x1)
-								sx = x1;
-							if (sx >= x2)
-								sx = x2 - 1;
-							if (sy < y1)
-								sy = y1;
-							if (sy >= y2)
-								sy = y2 - 1;
-						} else if (edge_mode == LSM_SVG_EDGE_MODE_WRAP) {
-							if (sx < x1 || (sx >= x2))
-								sx = x1 + (sx - x1) % (x2 - x1);
-							if (sy < y1 || (sy >= y2))
-								sy = y1 + (sy - y1) % (y2 - y1);
-						} else if (edge_mode == LSM_SVG_EDGE_MODE_NONE)
-							if (sx < x1 || (sx >= x2) ||
-							    sy < y1 || (sy >= y2))
-								continue;
-
-						kx = order_x - j - 1;
-						ky = order_y - i - 1;
-						alpha = in_pixels[4 * sx + sy * rowstride + 3];
-						if (ch == 3)
-							sval = alpha;
-						else if (alpha)
-							sval = in_pixels[4 * sx + sy * rowstride + ch] * 255 / alpha;
-						else
-							sval = 0;
-						kval = values[kx + ky * order_x];
-						sum += (double) sval *kval;
-					}
-				tempresult = sum / divisor + bias;
+/* The convolution first copies the input subregion to an unpremultiplied buffer, extended by the
+ * kernel size with the edge mode applied. The kernel then runs on this buffer without any border test.
+ * Rank one kernels are run as a horizontal and a vertical pass over chunks of rows. Sums are
+ * accumulated in single precision, one vector of four channels per pixel for the SSE2 kernels. */
+
+#define LSM_SVG_CONVOLUTION_CHUNK_ROWS	16
+
+typedef struct {
+	guint32 *pixels;
+	int padded_width;
+	int padded_height;
+
+	const guint32 *input_pixels;
+	guint32 *output_pixels;
+	int stride;
+	int x1, y1;
+	int width, height;
+	int target_x, target_y;
+	LsmSvgEdgeMode edge_mode;
+
+	int order_x, order_y;
+	float *kernel;
+	float *row_kernel;
+	float *column_kernel;
+	float divisor;
+	float bias;
+	gboolean preserve_alpha;
+	gboolean use_simd;
+} LsmSvgConvolution;
+
+static int
+_convolution_source (int position, int size, LsmSvgEdgeMode edge_mode)
+{
+	if (position >= 0 && position < size)
+		return position;
+
+	switch (edge_mode) {
+		case LSM_SVG_EDGE_MODE_DUPLICATE:
+			return CLAMP (position, 0, size - 1);
+		case LSM_SVG_EDGE_MODE_WRAP:
+			return ((position % size) + size) % size;
+		default:
+			return -1;
+	}
+}
+
+static void
+_convolution_pad_rows (gpointer data, int start, int end)
+{
+	LsmSvgConvolution *convolution = data;
+	int x, y;
 
-				if (tempresult > 255)
-					tempresult = 255;
-				if (tempresult < 0)
-					tempresult = 0;
+	for (y = start; y < end; y++) {
+		guint32 *row = convolution->pixels + y * convolution->padded_width;
+		int sy;
 
-				output_pixels[4 * x + y * rowstride + ch] = tempresult;
+		sy = _convolution_source (y - convolution->target_y, convolution->height, convolution->edge_mode);
+
+		for (x = 0; x < convolution->padded_width; x++) {
+			guint32 pixel;
+			guint32 alpha;
+			int sx;
+			int c;
+
+			sx = _convolution_source (x - convolution->target_x, convolution->width, convolution->edge_mode);
+
+			if (sx < 0 || sy < 0) {
+				row[x] = 0;
+				continue;
 			}
-			if (preserve_alpha)
-				output_pixels[4 * x + y * rowstride + channelmap[3]] =
-					in_pixels[4 * x + y * rowstride + channelmap[3]];
-			for (umch = 0; umch < 3; umch++) {
-				ch = channelmap[umch];
-				output_pixels[4 * x + y * rowstride + ch] =
-					output_pixels[4 * x + y * rowstride + ch] *
-					output_pixels[4 * x + y * rowstride + channelmap[3]] / 255;
+
+			pixel = convolution->input_pixels[(convolution->y1 + sy) * convolution->stride + convolution->x1 + sx];
+			alpha = pixel >> 24;
+
+			if (alpha == 0)
+				pixel = 0;
+			else if (alpha < 255) {
+				guint32 unpremultiplied = alpha << 24;
+
+				for (c = 0; c < 24; c += 8)
+					unpremultiplied |= MIN (((pixel >> c) & 0xff) * 255 / alpha, 255) << c;
+				pixel = unpremultiplied;
 			}
+
+			row[x] = pixel;
 		}
+	}
+}
 
-	cairo_surface_mark_dirty (output->surface);
+static inline void
+_convolution_store (LsmSvgConvolution *convolution, int x, int y, guint32 pixel)
+{
+	guint32 alpha;
+	guint32 result;
+	int offset;
+	int c;
 
-	cairo_destroy (cairo);
+	offset = (convolution->y1 + y) * convolution->stride + convolution->x1 + x;
+
+	alpha = convolution->preserve_alpha ? convolution->input_pixels[offset] >> 24 : pixel >> 24;
+	result = alpha << 24;
+
+	for (c = 0; c < 24; c += 8)
+		result |= (((pixel >> c) & 0xff) * alpha / 255) << c;
+
+	convolution->output_pixels[offset] = result;
 }
 
-static guchar
-_get_interp_pixel (guchar * src, gdouble ox, gdouble oy, guchar ch,
-		   gint x1, gint x2, gint y1, gint y2,
-		   guint rowstride)
+static inline guint32
+_convolution_pack_scalar (LsmSvgConvolution *convolution, const float *sum)
 {
-	double xmod, ymod;
-	double dist1, dist2, dist3, dist4;
-	double c, c1, c2, c3, c4;
-	double fox, foy, cox, coy;
+	guint32 pixel = 0;
+	int c;
 
-	xmod = fmod (ox, 1.0);
-	ymod = fmod (oy, 1.0);
+	for (c = 0; c < 4; c++) {
+		int value = sum[c] / convolution->divisor + convolution->bias;
 
-	dist1 = (1 - xmod) * (1 - ymod);
-	dist2 = (xmod) * (1 - ymod);
-	dist3 = (xmod) * (ymod);
-	dist4 = (1 - xmod) * (ymod);
+		pixel |= (guint32) CLAMP (value, 0, 255) << (8 * c);
+	}
 
-	fox = floor (ox);
-	foy = floor (oy);
+	return pixel;
+}
+
+static void
+_convolution_rows_scalar (LsmSvgConvolution *convolution, int start, int end)
+{
+	int x, y, i, j, c;
+
+	for (y = start; y < end; y++)
+		for (x = 0; x < convolution->width; x++) {
+			float sum[4] = {0.0, 0.0, 0.0, 0.0};
+
+			for (i = 0; i < convolution->order_y; i++) {
+				const guint32 *row = convolution->pixels + (y + i) * convolution->padded_width + x;
+				const float *kernel = convolution->kernel + i * convolution->order_x;
+
+				for (j = 0; j < convolution->order_x; j++)
+					for (c = 0; c < 4; c++)
+						sum[c] += kernel[j] * ((row[j] >> (8 * c)) & 0xff);
+			}
+
+			_convolution_store (convolution, x, y, _convolution_pack_scalar (convolution, sum));
+		}
+}
+
+static void
+_convolution_separable_rows_scalar (LsmSvgConvolution *convolution, int start, int end)
+{
+	float *rows;
+	int n_rows;
+	int chunk;
+	int x, y, i, j, c;
+
+	n_rows = LSM_SVG_CONVOLUTION_CHUNK_ROWS + convolution->order_y - 1;
+	rows = g_new (float, n_rows * convolution->width * 4);
+
+	for (chunk = start; chunk < end; chunk += LSM_SVG_CONVOLUTION_CHUNK_ROWS) {
+		int chunk_end = MIN (chunk + LSM_SVG_CONVOLUTION_CHUNK_ROWS, end);
+
+		for (y = 0; y < chunk_end - chunk + convolution->order_y - 1; y++) {
+			const guint32 *row = convolution->pixels + (chunk + y) * convolution->padded_width;
+
+			for (x = 0; x < convolution->width; x++) {
+				float *sum = rows + 4 * (y * convolution->width + x);
+
+				for (c = 0; c < 4; c++)
+					sum[c] = 0.0;
+
+				for (j = 0; j < convolution->order_x; j++)
+					for (c = 0; c < 4; c++)
+						sum[c] += convolution->row_kernel[j] * ((row[x + j] >> (8 * c)) & 0xff);
+			}
+		}
+
+		for (y = chunk; y < chunk_end; y++)
+			for (x = 0; x < convolution->width; x++) {
+				float sum[4] = {0.0, 0.0, 0.0, 0.0};
+
+				for (i = 0; i < convolution->order_y; i++) {
+					const float *row_sum = rows + 4 * ((y - chunk + i) * convolution->width + x);
+
+					for (c = 0; c < 4; c++)
+						sum[c] += convolution->column_kernel[i] * row_sum[c];
+				}
+
+				_convolution_store (convolution, x, y, _convolution_pack_scalar (convolution, sum));
+			}
+	}
+
+	g_free (rows);
+}
+
+#ifdef __SSE2__
+
+static inline __m128
+_convolution_unpack_sse2 (guint32 pixel)
+{
+	const __m128i zero = _mm_setzero_si128 ();
+
+	return _mm_cvtepi32_ps (_mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (pixel), zero), zero));
+}
+
+static inline guint32
+_convolution_pack_sse2 (__m128 sum, __m128 divisor, __m128 bias)
+{
+	__m128i result;
+
+	result = _mm_cvttps_epi32 (_mm_add_ps (_mm_div_ps (sum, divisor), bias));
+	result = _mm_packs_epi32 (result, result);
+
+	return _mm_cvtsi128_si32 (_mm_packus_epi16 (result, result));
+}
+
+static __m128 *
+_convolution_broadcast_sse2 (const float *values, int n_values)
+{
+	__m128 *broadcast;
+	int i;
+
+	broadcast = g_new (__m128, n_values);
+	for (i = 0; i < n_values; i++)
+		broadcast[i] = _mm_set1_ps (values[i]);
+
+	return broadcast;
+}
+
+static void
+_convolution_rows_sse2 (LsmSvgConvolution *convolution, int start, int end)
+{
+	__m128 divisor = _mm_set1_ps (convolution->divisor);
+	__m128 bias = _mm_set1_ps (convolution->bias);
+	__m128 *kernel;
+	int x, y, i, j;
+
+	kernel = _convolution_broadcast_sse2 (convolution->kernel, convolution->order_x * convolution->order_y);
+
+	for (y = start; y < end; y++)
+		for (x = 0; x < convolution->width; x++) {
+			__m128 sum = _mm_setzero_ps ();
+
+			for (i = 0; i < convolution->order_y; i++) {
+				const guint32 *row = convolution->pixels + (y + i) * convolution->padded_width + x;
+				const __m128 *row_kernel = kernel + i * convolution->order_x;
+
+				for (j = 0; j < convolution->order_x; j++)
+					sum = _mm_add_ps (sum, _mm_mul_ps (row_kernel[j], _convolution_unpack_sse2 (row[j])));
+			}
+
+			_convolution_store (convolution, x, y, _convolution_pack_sse2 (sum, divisor, bias));
+		}
+
+	g_free (kernel);
+}
+
+static void
+_convolution_separable_rows_sse2 (LsmSvgConvolution *convolution, int start, int end)
+{
+	__m128 divisor = _mm_set1_ps (convolution->divisor);
+	__m128 bias = _mm_set1_ps (convolution->bias);
+	__m128 *row_kernel;
+	__m128 *column_kernel;
+	__m128 *rows;
+	int n_rows;
+	int chunk;
+	int x, y, i, j;
+
+	row_kernel = _convolution_broadcast_sse2 (convolution->row_kernel, convolution->order_x);
+	column_kernel = _convolution_broadcast_sse2 (convolution->column_kernel, convolution->order_y);
+
+	n_rows = LSM_SVG_CONVOLUTION_CHUNK_ROWS + convolution->order_y - 1;
+	rows = g_new (__m128, n_rows * convolution->width);
+
+	for (chunk = start; chunk < end; chunk += LSM_SVG_CONVOLUTION_CHUNK_ROWS) {
+		int chunk_end = MIN (chunk + LSM_SVG_CONVOLUTION_CHUNK_ROWS, end);
+
+		for (y = 0; y < chunk_end - chunk + convolution->order_y - 1; y++) {
+			const guint32 *row = convolution->pixels + (chunk + y) * convolution->padded_width;
+
+			for (x = 0; x < convolution->width; x++) {
+				__m128 sum = _mm_setzero_ps ();
+
+				for (j = 0; j < convolution->order_x; j++)
+					sum = _mm_add_ps (sum, _mm_mul_ps (row_kernel[j], _convolution_unpack_sse2 (row[x + j])));
+
+				rows[y * convolution->width + x] = sum;
+			}
+		}
+
+		for (y = chunk; y < chunk_end; y++)
+			for (x = 0; x < convolution->width; x++) {
+				__m128 sum = _mm_setzero_ps ();
+
+				for (i = 0; i < convolution->order_y; i++)
+					sum = _mm_add_ps (sum, _mm_mul_ps (column_kernel[i],
+									   rows[(y - chunk + i) * convolution->width + x]));
+
+				_convolution_store (convolution, x, y, _convolution_pack_sse2 (sum, divisor, bias));
+			}
+	}
+
+	g_free (rows);
+	g_free (row_kernel);
+	g_free (column_kernel);
+}
+
+#endif
+
+static void
+_convolution_rows (gpointer data, int start, int end)
+{
+	LsmSvgConvolution *convolution = data;
+
+#ifdef __SSE2__
+	if (convolution->use_simd) {
+		if (convolution->row_kernel != NULL)
+			_convolution_separable_rows_sse2 (convolution, start, end);
+		else
+			_convolution_rows_sse2 (convolution, start, end);
+		return;
+	}
+#endif
+
+	if (convolution->row_kernel != NULL)
+		_convolution_separable_rows_scalar (convolution, start, end);
+	else
+		_convolution_rows_scalar (convolution, start, end);
+}
+
+/* A kernel is separable if it is the outer product of a column and a row vector, which are read from the
+ * row and column of its largest coefficient. */
+
+static gboolean
+_convolution_split_kernel (LsmSvgConvolution *convolution)
+{
+	double max = 0.0;
+	int pivot_x = 0, pivot_y = 0;
+	int i, j;
+
+	if (convolution->order_x < 2 || convolution->order_y < 2)
+		return FALSE;
+
+	for (i = 0; i < convolution->order_y; i++)
+		for (j = 0; j < convolution->order_x; j++)
+			if (fabs (convolution->kernel[i * convolution->order_x + j]) > max) {
+				max = fabs (convolution->kernel[i * convolution->order_x + j]);
+				pivot_x = j;
+				pivot_y = i;
+			}
+
+	if (max == 0.0)
+		return FALSE;
+
+	convolution->row_kernel = g_new (float, convolution->order_x);
+	convolution->column_kernel = g_new (float, convolution->order_y);
+
+	for (j = 0; j < convolution->order_x; j++)
+		convolution->row_kernel[j] = (double) convolution->kernel[pivot_y * convolution->order_x + j] /
+			convolution->kernel[pivot_y * convolution->order_x + pivot_x];
+	for (i = 0; i < convolution->order_y; i++)
+		convolution->column_kernel[i] = convolution->kernel[i * convolution->order_x + pivot_x];
+
+	for (i = 0; i < convolution->order_y; i++)
+		for (j = 0; j < convolution->order_x; j++)
+			if (fabs ((double) convolution->column_kernel[i] * convolution->row_kernel[j] -
+				  convolution->kernel[i * convolution->order_x + j]) > max * 1e-6) {
+				g_clear_pointer (&convolution->row_kernel, g_free);
+				g_clear_pointer (&convolution->column_kernel, g_free);
+				return FALSE;
+			}
+
+	return TRUE;
+}
+
+void
+lsm_svg_filter_surface_convolve_matrix (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+					 unsigned order_x, unsigned order_y, unsigned n_values, const double *values,
+					 double divisor, double bias, unsigned target_x, unsigned target_y,
+					 LsmSvgEdgeMode edge_mode, gboolean preserve_alpha)
+{
+	LsmSvgConvolution convolution;
+	gint x1, x2, y1, y2;
+	gint width, height;
+	unsigned int i, j;
+
+	g_return_if_fail (input != NULL);
+	g_return_if_fail (output != NULL);
+	g_return_if_fail (values != NULL || n_values < 1);
+
+	if (divisor <= 0.0)
+		return;
+
+	width = cairo_image_surface_get_width (input->surface);
+	height = cairo_image_surface_get_height (input->surface);
+
+	if (width != cairo_image_surface_get_width (output->surface) ||
+	    height != cairo_image_surface_get_height (output->surface))
+		return;
+
+	if (height < 1 || width < 1)
+		return;
+
+	if (order_y * order_x != n_values || n_values < 1)
+		return;
+
+	if (target_x > order_x || target_y > order_y)
+		return;
+
+	x1 = CLAMP (input->subregion.x, 0, width);
+	x2 = CLAMP (input->subregion.x + input->subregion.width, 0, width);
+	y1 = CLAMP (input->subregion.y, 0, height);
+	y2 = CLAMP (input->subregion.y + input->subregion.height, 0, height);
+
+	if (x2 <= x1 || y2 <= y1)
+		return;
+
+	cairo_surface_flush (input->surface);
+	cairo_surface_flush (output->surface);
+
+	convolution.input_pixels = (const guint32 *) cairo_image_surface_get_data (input->surface);
+	convolution.output_pixels = (guint32 *) cairo_image_surface_get_data (output->surface);
+	convolution.stride = cairo_image_surface_get_stride (input->surface) / 4;
+	convolution.x1 = x1;
+	convolution.y1 = y1;
+	convolution.width = x2 - x1;
+	convolution.height = y2 - y1;
+	convolution.target_x = target_x;
+	convolution.target_y = target_y;
+	convolution.edge_mode = edge_mode;
+	convolution.order_x = order_x;
+	convolution.order_y = order_y;
+	convolution.divisor = divisor;
+	convolution.bias = bias;
+	convolution.preserve_alpha = preserve_alpha;
+	convolution.use_simd = simd_enabled;
+	convolution.row_kernel = NULL;
+	convolution.column_kernel = NULL;
+
+	/* Kernel values are given in reverse order of the pixels they apply to */
+	convolution.kernel = g_new (float, n_values);
+	for (i = 0; i < order_y; i++)
+		for (j = 0; j < order_x; j++)
+			convolution.kernel[i * order_x + j] = values[(order_x - j - 1) + (order_y - i - 1) * order_x];
+
+	if (_convolution_split_kernel (&convolution))
+		lsm_debug_render ("[LsmSvgFilterSurface::convolve_matrix] Separable %ux%u kernel", order_x, order_y);
+
+	convolution.padded_width = convolution.width + order_x - 1;
+	convolution.padded_height = convolution.height + order_y - 1;
+	convolution.pixels = g_new (guint32, convolution.padded_width * convolution.padded_height);
+
+	_process_bands (_convolution_pad_rows, &convolution, convolution.padded_height,
+			convolution.padded_width * convolution.padded_height);
+	_process_bands (_convolution_rows, &convolution, convolution.height,
+			convolution.width * convolution.height * n_values);
+
+	g_free (convolution.pixels);
+	g_free (convolution.kernel);
+	g_free (convolution.row_kernel);
+	g_free (convolution.column_kernel);
+
+	cairo_surface_mark_dirty (output->surface);
+}
+
+static guchar
+_get_interp_pixel (guchar * src, gdouble ox, gdouble oy, guchar ch,
+		   gint x1, gint x2, gint y1, gint y2,
+		   guint rowstride)
+{
+	double xmod, ymod;
+	double dist1, dist2, dist3, dist4;
+	double c, c1, c2, c3, c4;
+	double fox, foy, cox, coy;
+
+	xmod = fmod (ox, 1.0);
+	ymod = fmod (oy, 1.0);
+
+	dist1 = (1 - xmod) * (1 - ymod);
+	dist2 = (xmod) * (1 - ymod);
+	dist3 = (xmod) * (ymod);
+	dist4 = (1 - xmod) * (ymod);
+
+	fox = floor (ox);
+	foy = floor (oy);
 	cox = ceil (ox);
 	coy = ceil (oy);
 
@@ -1072,94 +1821,709 @@ lsm_svg_filter_surface_displacement_map (LsmSvgFilterSurface *input_1,
 	cairo_destroy (cairo);
 }
 
+/* Diffuse and specular lighting. Surface normals are computed from the alpha channel with the Sobel kernels
+ * of the specification, a row at a time. The full kernels of interior pixels are vectorized, pixels on the
+ * border of the subregion use the reduced kernels. The light source is in pixels, the surface scale is the
+ * height of an opaque pixel in pixels. As in the specification, normals are measured per kernel unit, whose
+ * length dx, dy is given in user units. The specular exponent is clamped to [1, 128] and applied with a lookup
+ * table. The spot light exponent is only clamped to positive values, and uses a table as well up to 128. */
+
+#define LSM_SVG_LIGHTING_POW_TABLE_SIZE	4096
+#define LSM_SVG_LIGHTING_POW_TABLE_MAX_EXPONENT	128.0
+
+typedef struct {
+	const guint32 *input;
+	int input_stride;
+	guint32 *output;
+	int output_stride;
+	int x1, y1;
+	int width, height;
+
+	LsmSvgFilterLightType light_type;
+	double light_x, light_y, light_z;
+	double light_vector[3];
+	double spot_direction[3];
+	double cos_cone;
+	gboolean is_cone_limited;
+	double spot_exponent;
+	float *spot_table;
+
+	gboolean is_specular;
+	float *specular_table;
+	double surface_scale;
+	float normal_scale_x;
+	float normal_scale_y;
+	double constant;
+	double red, green, blue;
+	gboolean use_simd;
+} LsmSvgLighting;
+
+static float *
+_lighting_pow_table (double exponent)
+{
+	float *table;
+	int i;
+
+	table = g_new (float, LSM_SVG_LIGHTING_POW_TABLE_SIZE + 2);
+	for (i = 0; i <= LSM_SVG_LIGHTING_POW_TABLE_SIZE; i++)
+		table[i] = pow ((double) i / LSM_SVG_LIGHTING_POW_TABLE_SIZE, exponent);
+	table[LSM_SVG_LIGHTING_POW_TABLE_SIZE + 1] = table[LSM_SVG_LIGHTING_POW_TABLE_SIZE];
+
+	return table;
+}
+
+static inline double
+_lighting_pow (const float *table, double value)
+{
+	double position;
+	int index;
+
+	if (value <= 0.0)
+		return 0.0;
+	if (value >= 1.0)
+		return table[LSM_SVG_LIGHTING_POW_TABLE_SIZE];
+
+	position = value * LSM_SVG_LIGHTING_POW_TABLE_SIZE;
+	index = (int) position;
+
+	return table[index] + (position - index) * (table[index + 1] - table[index]);
+}
+
+static void
+_lighting_alpha_row (const guint32 *pixels, int width, gint16 *alpha, gboolean use_simd)
+{
+	int x = 0;
+
+#ifdef __SSE2__
+	if (use_simd)
+		for (; x + 8 <= width; x += 8) {
+			__m128i a = _mm_srli_epi32 (_mm_loadu_si128 ((const __m128i *) (pixels + x)), 24);
+			__m128i b = _mm_srli_epi32 (_mm_loadu_si128 ((const __m128i *) (pixels + x + 4)), 24);
+
+			_mm_storeu_si128 ((__m128i *) (alpha + x), _mm_packs_epi32 (a, b));
+		}
+#endif
+
+	for (; x < width; x++)
+		alpha[x] = pixels[x] >> 24;
+}
+
+#ifdef __SSE2__
+static inline void
+_lighting_store_sse2 (__m128i gradient, __m128 scale, float *normals)
+{
+	__m128i low = _mm_srai_epi32 (_mm_unpacklo_epi16 (gradient, gradient), 16);
+	__m128i high = _mm_srai_epi32 (_mm_unpackhi_epi16 (gradient, gradient), 16);
+
+	_mm_storeu_ps (normals, _mm_mul_ps (_mm_cvtepi32_ps (low), scale));
+	_mm_storeu_ps (normals + 4, _mm_mul_ps (_mm_cvtepi32_ps (high), scale));
+}
+#endif
+
+/* Full Sobel kernels, for the pixels 1 to width - 2 of an interior row. The scales include the 1/4 factor
+ * of the specification. Gradients are at most 4 * 255, which fits in 16 bits. */
+
+static void
+_lighting_sobel_row (const gint16 *top, const gint16 *middle, const gint16 *bottom, int width,
+		     float scale_x, float scale_y, float *nx, float *ny, gboolean use_simd)
+{
+	int x = 1;
+
+#ifdef __SSE2__
+	if (use_simd) {
+		__m128 sx = _mm_set1_ps (scale_x);
+		__m128 sy = _mm_set1_ps (scale_y);
+
+		for (; x + 9 <= width; x += 8) {
+			__m128i tl = _mm_loadu_si128 ((const __m128i *) (top + x - 1));
+			__m128i tc = _mm_loadu_si128 ((const __m128i *) (top + x));
+			__m128i tr = _mm_loadu_si128 ((const __m128i *) (top + x + 1));
+			__m128i ml = _mm_loadu_si128 ((const __m128i *) (middle + x - 1));
+			__m128i mr = _mm_loadu_si128 ((const __m128i *) (middle + x + 1));
+			__m128i bl = _mm_loadu_si128 ((const __m128i *) (bottom + x - 1));
+			__m128i bc = _mm_loadu_si128 ((const __m128i *) (bottom + x));
+			__m128i br = _mm_loadu_si128 ((const __m128i *) (bottom + x + 1));
+			__m128i gx, gy;
+
+			gx = _mm_sub_epi16 (_mm_add_epi16 (_mm_add_epi16 (tr, br), _mm_add_epi16 (mr, mr)),
+					    _mm_add_epi16 (_mm_add_epi16 (tl, bl), _mm_add_epi16 (ml, ml)));
+			gy = _mm_sub_epi16 (_mm_add_epi16 (_mm_add_epi16 (bl, br), _mm_add_epi16 (bc, bc)),
+					    _mm_add_epi16 (_mm_add_epi16 (tl, tr), _mm_add_epi16 (tc, tc)));
+
+			_lighting_store_sse2 (gx, sx, nx + x);
+			_lighting_store_sse2 (gy, sy, ny + x);
+		}
+	}
+#endif
+
+	for (; x < width - 1; x++) {
+		int gx, gy;
+
+		gx = (top[x + 1] + 2 * middle[x + 1] + bottom[x + 1]) -
+			(top[x - 1] + 2 * middle[x - 1] + bottom[x - 1]);
+		gy = (bottom[x - 1] + 2 * bottom[x] + bottom[x + 1]) -
+			(top[x - 1] + 2 * top[x] + top[x + 1]);
+
+		nx[x] = (float) gx * scale_x;
+		ny[x] = (float) gy * scale_y;
+	}
+}
+
+static inline int
+_lighting_alpha (const LsmSvgLighting *lighting, int x, int y)
+{
+	return lighting->input[(lighting->y1 + y) * lighting->input_stride + lighting->x1 + x] >> 24;
+}
+
+/* Reduced kernels of the specification, for the pixels on the border of the subregion. A missing
+ * neighbour row or column is replaced by the center one, with a weight of zero for the smoothing
+ * part of the kernel, and a factor of 2 / (distance * sum of weights). */
+
+static void
+_lighting_border_normal (const LsmSvgLighting *lighting, int x, int y, float *nx, float *ny)
+{
+	int left = x > 0 ? x - 1 : x;
+	int right = x < lighting->width - 1 ? x + 1 : x;
+	int top = y > 0 ? y - 1 : y;
+	int bottom = y < lighting->height - 1 ? y + 1 : y;
+	int row_weights = 2 + (top != y) + (bottom != y);
+	int column_weights = 2 + (left != x) + (right != x);
+	int gx, gy;
+
+	gx = 2 * (_lighting_alpha (lighting, right, y) - _lighting_alpha (lighting, left, y));
+	if (top != y)
+		gx += _lighting_alpha (lighting, right, top) - _lighting_alpha (lighting, left, top);
+	if (bottom != y)
+		gx += _lighting_alpha (lighting, right, bottom) - _lighting_alpha (lighting, left, bottom);
+
+	gy = 2 * (_lighting_alpha (lighting, x, bottom) - _lighting_alpha (lighting, x, top));
+	if (left != x)
+		gy += _lighting_alpha (lighting, left, bottom) - _lighting_alpha (lighting, left, top);
+	if (right != x)
+		gy += _lighting_alpha (lighting, right, bottom) - _lighting_alpha (lighting, right, top);
+
+	*nx = right != left ? (float) gx * lighting->normal_scale_x * 8.0f / ((right - left) * row_weights) : 0.0f;
+	*ny = bottom != top ? (float) gy * lighting->normal_scale_y * 8.0f / ((bottom - top) * column_weights) : 0.0f;
+}
+
+static inline guint32
+_lighting_pixel (const LsmSvgLighting *lighting, int x, int y, double nx, double ny, int alpha)
+{
+	double lx, ly, lz;
+	double norm;
+	double factor;
+	double red, green, blue, opacity;
+
+	if (lighting->light_type == LSM_SVG_FILTER_LIGHT_TYPE_DISTANT) {
+		lx = lighting->light_vector[0];
+		ly = lighting->light_vector[1];
+		lz = lighting->light_vector[2];
+	} else {
+		lx = lighting->light_x - (lighting->x1 + x + 0.5);
+		ly = lighting->light_y - (lighting->y1 + y + 0.5);
+		lz = lighting->light_z - lighting->surface_scale * alpha / 255.0;
+
+		norm = sqrt (lx * lx + ly * ly + lz * lz);
+		if (norm > 0.0) {
+			lx /= norm;
+			ly /= norm;
+			lz /= norm;
+		}
+	}
+
+	norm = sqrt (nx * nx + ny * ny + 1.0);
+
+	if (lighting->is_specular) {
+		double hz = lz + 1.0;
+		double h_norm = sqrt (lx * lx + ly * ly + hz * hz);
+
+		if (h_norm > 0.0)
+			factor = lighting->constant *
+				_lighting_pow (lighting->specular_table, (nx * lx + ny * ly + hz) / (norm * h_norm));
+		else
+			factor = 0.0;
+	} else
+		factor = lighting->constant * (nx * lx + ny * ly + lz) / norm;
+
+	if (lighting->light_type == LSM_SVG_FILTER_LIGHT_TYPE_SPOT) {
+		double minus_l_dot_s = -(lx * lighting->spot_direction[0] +
+					 ly * lighting->spot_direction[1] +
+					 lz * lighting->spot_direction[2]);
+
+		if (lighting->is_cone_limited && minus_l_dot_s < lighting->cos_cone)
+			factor = 0.0;
+		else if (minus_l_dot_s <= 0.0)
+			factor = 0.0;
+		else if (lighting->spot_table != NULL)
+			factor *= _lighting_pow (lighting->spot_table, minus_l_dot_s);
+		else
+			factor *= pow (minus_l_dot_s, lighting->spot_exponent);
+	}
+
+	red = CLAMP (factor * lighting->red, 0.0, 255.0);
+	green = CLAMP (factor * lighting->green, 0.0, 255.0);
+	blue = CLAMP (factor * lighting->blue, 0.0, 255.0);
+
+	if (lighting->is_specular) {
+		opacity = MAX (red, MAX (green, blue));
+		red = red * opacity / 255.0;
+		green = green * opacity / 255.0;
+		blue = blue * opacity / 255.0;
+	} else
+		opacity = 255.0;
+
+	return ((guint32) (opacity + 0.5) << 24) |
+		((guint32) (red + 0.5) << 16) |
+		((guint32) (green + 0.5) << 8) |
+		(guint32) (blue + 0.5);
+}
+
+static void
+_lighting_rows (gpointer data, int start, int end)
+{
+	LsmSvgLighting *lighting = data;
+	const guint32 *input;
+	guint32 *output;
+	gint16 *alpha, *top, *middle, *bottom, *tmp;
+	float *nx, *ny;
+	int width = lighting->width;
+	int next_y = -1;
+	int x, y;
+
+	alpha = g_new (gint16, 3 * width);
+	top = alpha;
+	middle = alpha + width;
+	bottom = alpha + 2 * width;
+	nx = g_new (float, 2 * width);
+	ny = nx + width;
+
+	for (y = start; y < end; y++) {
+		input = lighting->input + (lighting->y1 + y) * lighting->input_stride + lighting->x1;
+		output = lighting->output + (lighting->y1 + y) * lighting->output_stride + lighting->x1;
+
+		if (y > 0 && y < lighting->height - 1) {
+			if (y != next_y) {
+				_lighting_alpha_row (input - lighting->input_stride, width, top, lighting->use_simd);
+				_lighting_alpha_row (input, width, middle, lighting->use_simd);
+			} else {
+				tmp = top;
+				top = middle;
+				middle = bottom;
+				bottom = tmp;
+			}
+			_lighting_alpha_row (input + lighting->input_stride, width, bottom, lighting->use_simd);
+			next_y = y + 1;
+
+			_lighting_sobel_row (top, middle, bottom, width,
+					     lighting->normal_scale_x, lighting->normal_scale_y,
+					     nx, ny, lighting->use_simd);
+			_lighting_border_normal (lighting, 0, y, &nx[0], &ny[0]);
+			_lighting_border_normal (lighting, width - 1, y, &nx[width - 1], &ny[width - 1]);
+		} else
+			for (x = 0; x < width; x++)
+				_lighting_border_normal (lighting, x, y, &nx[x], &ny[x]);
+
+		for (x = 0; x < width; x++)
+			output[x] = _lighting_pixel (lighting, x, y, nx[x], ny[x], input[x] >> 24);
+	}
+
+	g_free (nx);
+	g_free (alpha);
+}
+
+static void
+_lighting (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output, const LsmSvgFilterLight *light,
+	   gboolean is_specular, double surface_scale, double constant, double specular_exponent,
+	   double dx, double dy, double red, double green, double blue)
+{
+	LsmSvgLighting lighting;
+	int width, height;
+	int x1, x2, y1, y2;
+
+	width = cairo_image_surface_get_width (input->surface);
+	height = cairo_image_surface_get_height (input->surface);
+
+	if (width != cairo_image_surface_get_width (output->surface) ||
+	    height != cairo_image_surface_get_height (output->surface))
+		return;
+
+	if (height < 1 || width < 1)
+		return;
+
+	x1 = CLAMP (output->subregion.x, 0, width);
+	x2 = CLAMP (output->subregion.x + output->subregion.width, 0, width);
+	y1 = CLAMP (output->subregion.y, 0, height);
+	y2 = CLAMP (output->subregion.y + output->subregion.height, 0, height);
+
+	if (x2 <= x1 || y2 <= y1)
+		return;
+
+	cairo_surface_flush (input->surface);
+	cairo_surface_flush (output->surface);
+
+	lighting.input = (const guint32 *) cairo_image_surface_get_data (input->surface);
+	lighting.input_stride = cairo_image_surface_get_stride (input->surface) / 4;
+	lighting.output = (guint32 *) cairo_image_surface_get_data (output->surface);
+	lighting.output_stride = cairo_image_surface_get_stride (output->surface) / 4;
+	lighting.x1 = x1;
+	lighting.y1 = y1;
+	lighting.width = x2 - x1;
+	lighting.height = y2 - y1;
+	lighting.use_simd = simd_enabled;
+
+	lighting.light_type = light->type;
+	lighting.light_x = light->x;
+	lighting.light_y = light->y;
+	lighting.light_z = light->z;
+	lighting.spot_exponent = 1.0;
+	lighting.spot_table = NULL;
+	lighting.is_cone_limited = FALSE;
+	lighting.cos_cone = -1.0;
+
+	if (light->type == LSM_SVG_FILTER_LIGHT_TYPE_DISTANT) {
+		double azimuth = light->azimuth * M_PI / 180.0;
+		double elevation = light->elevation * M_PI / 180.0;
+
+		lighting.light_vector[0] = cos (azimuth) * cos (elevation);
+		lighting.light_vector[1] = sin (azimuth) * cos (elevation);
+		lighting.light_vector[2] = sin (elevation);
+	} else if (light->type == LSM_SVG_FILTER_LIGHT_TYPE_SPOT) {
+		double sx = light->points_at_x - light->x;
+		double sy = light->points_at_y - light->y;
+		double sz = light->points_at_z - light->z;
+		double norm = sqrt (sx * sx + sy * sy + sz * sz);
+
+		if (norm > 0.0) {
+			sx /= norm;
+			sy /= norm;
+			sz /= norm;
+		}
+
+		lighting.spot_direction[0] = sx;
+		lighting.spot_direction[1] = sy;
+		lighting.spot_direction[2] = sz;
+		lighting.is_cone_limited = light->is_cone_limited;
+		if (light->is_cone_limited)
+			lighting.cos_cone = cos (fabs (light->limiting_cone_angle) * M_PI / 180.0);
+		lighting.spot_exponent = MAX (light->specular_exponent, 0.0);
+		if (lighting.spot_exponent <= LSM_SVG_LIGHTING_POW_TABLE_MAX_EXPONENT)
+			lighting.spot_table = _lighting_pow_table (lighting.spot_exponent);
+	}
+
+	lighting.is_specular = is_specular;
+	lighting.specular_table = is_specular ? _lighting_pow_table (CLAMP (specular_exponent, 1.0,
+											       LSM_SVG_LIGHTING_POW_TABLE_MAX_EXPONENT)) : NULL;
+	lighting.surface_scale = surface_scale;
+	lighting.normal_scale_x = -surface_scale * dx / (4.0 * 255.0);
+	lighting.normal_scale_y = -surface_scale * dy / (4.0 * 255.0);
+	lighting.constant = constant;
+	lighting.red = red * 255.0;
+	lighting.green = green * 255.0;
+	lighting.blue = blue * 255.0;
+
+	_process_bands (_lighting_rows, &lighting, lighting.height, lighting.width * lighting.height);
+
+	g_free (lighting.specular_table);
+	g_free (lighting.spot_table);
+
+	cairo_surface_mark_dirty (output->surface);
+}
+
 void
-lsm_svg_filter_surface_specular_lighting (LsmSvgFilterSurface *output,
+lsm_svg_filter_surface_diffuse_lighting (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+					 const LsmSvgFilterLight *light,
+					 double surface_scale, double diffuse_constant,
+					 double dx, double dy,
+					 double red, double green, double blue)
+{
+	g_return_if_fail (input != NULL);
+	g_return_if_fail (output != NULL);
+	g_return_if_fail (light != NULL);
+
+	_lighting (input, output, light, FALSE, surface_scale, diffuse_constant, 1.0, dx, dy, red, green, blue);
+}
+
+void
+lsm_svg_filter_surface_specular_lighting (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+					  const LsmSvgFilterLight *light,
 					  double surface_scale, double specular_constant, double specular_exponent,
-					  double dx, double dy)
+					  double dx, double dy,
+					  double red, double green, double blue)
+{
+	g_return_if_fail (input != NULL);
+	g_return_if_fail (output != NULL);
+	g_return_if_fail (light != NULL);
+
+	_lighting (input, output, light, TRUE, surface_scale, specular_constant, specular_exponent,
+		   dx, dy, red, green, blue);
+}
+
+void
+lsm_svg_filter_surface_image (LsmSvgFilterSurface *output, GdkPixbuf *pixbuf,
+			      LsmSvgPreserveAspectRatio preserve_aspect_ratio)
 {
 	cairo_t *cairo;
 	int width, height;
-#if 0
-	guchar *output_pixels;
-	gint rowstride;
-	gint x1, x2, y1, y2;
+	double zoom_x, zoom_y;
+
+	g_return_if_fail (output != NULL);
+	g_return_if_fail (GDK_IS_PIXBUF (pixbuf));
+	
+	if (output->subregion.width < 1 ||
+	    output->subregion.height < 1)
+		return;
+
+	/* TODO Implement preserve_aspect_ratio support */
+
+	width = gdk_pixbuf_get_height (pixbuf);
+	height = gdk_pixbuf_get_width (pixbuf);
+
+	if (height < 1 || width < 1)
+		return;
+
+	zoom_x = (double) output->subregion.width / (double) width;
+	zoom_y = (double) output->subregion.height / (double) height;
+
+	cairo = cairo_create (output->surface);
+	
+	cairo_translate (cairo, output->subregion.x, output->subregion.y);
+	cairo_scale (cairo, zoom_x, zoom_y);
+	lsm_cairo_set_source_pixbuf (cairo, pixbuf, 0, 0);
+	cairo_paint (cairo);
+
+	cairo_destroy (cairo);
+}
+
+/* Separable van Herk/Gil-Werman min/max filter. The line is cut in blocks of the window size, starting
+ * radius pixels before the first output pixel. g holds the extremum from the start of the block of each
+ * pixel, h the extremum up to the end of its block. The window of an output pixel spans at most two
+ * blocks, its extremum is the one of h at its first pixel and g at its last, whatever the radius. Pixels
+ * outside of the line are ignored, by giving them the identity value of the operator. A line element is
+ * one pixel for the scalar kernel and 4 pixels of interleaved lines for the SSE2 kernel, the line
+ * and output steps are in pixels. */
+
+static inline guint32
+_morphology_op (guint32 a, guint32 b, gboolean dilate)
+{
+	guint32 result = 0;
+	int c;
+
+	for (c = 0; c < 32; c += 8) {
+		guint32 value_a = (a >> c) & 0xff;
+		guint32 value_b = (b >> c) & 0xff;
+
+		result |= (dilate ? MAX (value_a, value_b) : MIN (value_a, value_b)) << c;
+	}
+
+	return result;
+}
+
+static void
+_morphology_line_scalar (const guint32 *line, int line_step, int n, int start, int end, int radius, gboolean dilate,
+			 guint32 *g, guint32 *h, guint32 *output, int output_step)
+{
+	guint32 identity = dilate ? 0x00000000 : 0xffffffff;
+	int origin = start - radius;
+	int length = end - start + 2 * radius;
+	int size = 2 * radius + 1;
+	int i, j, block;
+
+	for (i = 0, j = origin, block = 0; i < length; i++, j++, block++) {
+		guint32 p = j >= 0 && j < n ? line[j * line_step] : identity;
+
+		if (block == size)
+			block = 0;
+		g[i] = block == 0 ? p : _morphology_op (g[i - 1], p, dilate);
+	}
+
+	block = (length - 1) % size;
+	for (i = length - 1, j = origin + length - 1; i >= 0; i--, j--, block--) {
+		guint32 p = j >= 0 && j < n ? line[j * line_step] : identity;
+
+		if (block < 0)
+			block = size - 1;
+		h[i] = i == length - 1 || block == size - 1 ? p : _morphology_op (h[i + 1], p, dilate);
+	}
+
+	for (i = 0; i < end - start; i++)
+		output[i * output_step] = _morphology_op (h[i], g[i + 2 * radius], dilate);
+}
+
+#ifdef __SSE2__
+
+static inline __m128i
+_morphology_op_sse2 (__m128i a, __m128i b, gboolean dilate)
+{
+	return dilate ? _mm_max_epu8 (a, b) : _mm_min_epu8 (a, b);
+}
+
+static void
+_morphology_line_sse2 (const guint32 *line, int line_step, int n, int start, int end, int radius, gboolean dilate,
+		       __m128i *g, __m128i *h, guint32 *output, int output_step)
+{
+	__m128i identity = dilate ? _mm_setzero_si128 () : _mm_set1_epi32 (-1);
+	int origin = start - radius;
+	int length = end - start + 2 * radius;
+	int size = 2 * radius + 1;
+	int i, j, block;
+
+	for (i = 0, j = origin, block = 0; i < length; i++, j++, block++) {
+		__m128i p = j >= 0 && j < n ? _mm_loadu_si128 ((const __m128i *) (line + j * line_step)) : identity;
+
+		if (block == size)
+			block = 0;
+		g[i] = block == 0 ? p : _morphology_op_sse2 (g[i - 1], p, dilate);
+	}
+
+	block = (length - 1) % size;
+	for (i = length - 1, j = origin + length - 1; i >= 0; i--, j--, block--) {
+		__m128i p = j >= 0 && j < n ? _mm_loadu_si128 ((const __m128i *) (line + j * line_step)) : identity;
+
+		if (block < 0)
+			block = size - 1;
+		h[i] = i == length - 1 || block == size - 1 ? p : _morphology_op_sse2 (h[i + 1], p, dilate);
+	}
+
+	for (i = 0; i < end - start; i++)
+		_mm_storeu_si128 ((__m128i *) (output + i * output_step),
+				  _morphology_op_sse2 (h[i], g[i + 2 * radius], dilate));
+}
+
 #endif
 
-	g_return_if_fail (output != NULL);
+/* The horizontal pass writes the rows of the input subregion, extended by the vertical radius, to an
+ * intermediate buffer. The vertical pass writes the input subregion of the output surface. */
 
-	width = cairo_image_surface_get_width (output->surface);
-	height = cairo_image_surface_get_height (output->surface);
+typedef struct {
+	const guint32 *input_pixels;
+	guint32 *output_pixels;
+	guint32 *pixels;
+	int width;
+	int height;
+	int stride;
+	int x1, x2;
+	int y1, y2;
+	int ya, yb;
+	int kx, ky;
+	gboolean dilate;
+	gboolean use_simd;
+} LsmSvgMorphology;
 
-	if (height < 1 || width < 1)
-		return;
+static void
+_morphology_rows (gpointer data, int start, int end)
+{
+	LsmSvgMorphology *morphology = data;
+	int n_columns = morphology->x2 - morphology->x1;
+	int length = n_columns + 2 * morphology->kx;
+	int y = start;
+
+#ifdef __SSE2__
+	if (morphology->use_simd && end - start >= 4) {
+		guint32 *lines;
+		guint32 *results;
+		__m128i *g, *h;
+		int x, c;
+
+		lines = g_new (guint32, morphology->width * 4);
+		results = g_new (guint32, n_columns * 4);
+		g = g_new (__m128i, length);
+		h = g_new (__m128i, length);
+
+		for (; y + 4 <= end; y += 4) {
+			for (c = 0; c < 4; c++) {
+				const guint32 *row = morphology->input_pixels + (morphology->ya + y + c) * morphology->stride;
+
+				for (x = 0; x < morphology->width; x++)
+					lines[x * 4 + c] = row[x];
+			}
 
-	cairo = cairo_create (output->surface);
+			_morphology_line_sse2 (lines, 4, morphology->width, morphology->x1, morphology->x2,
+					       morphology->kx, morphology->dilate, g, h, results, 4);
 
-#if 0
-	output_pixels = cairo_image_surface_get_data (output->surface);
-	rowstride = cairo_image_surface_get_stride (output->surface);
+			for (c = 0; c < 4; c++) {
+				guint32 *row = morphology->pixels + (y + c) * n_columns;
 
-	x1 = CLAMP (output->subregion.x, 0, width);
-	x2 = CLAMP (output->subregion.x + output->subregion.width, 0, width);
-	y1 = CLAMP (output->subregion.y, 0, height);
-	y2 = CLAMP (output->subregion.y + output->subregion.height, 0, height);
-#endif
+				for (x = 0; x < n_columns; x++)
+					row[x] = results[x * 4 + c];
+			}
+		}
 
-	cairo_surface_mark_dirty (output->surface);
+		g_free (lines);
+		g_free (results);
+		g_free (g);
+		g_free (h);
+	}
+#endif
 
-	cairo_destroy (cairo);
-}
+	if (y < end) {
+		guint32 *g, *h;
 
-void
-lsm_svg_filter_surface_image (LsmSvgFilterSurface *output, GdkPixbuf *pixbuf,
-			      LsmSvgPreserveAspectRatio preserve_aspect_ratio)
-{
-	cairo_t *cairo;
-	int width, height;
-	double zoom_x, zoom_y;
+		g = g_new (guint32, length);
+		h = g_new (guint32, length);
 
-	g_return_if_fail (output != NULL);
-	g_return_if_fail (GDK_IS_PIXBUF (pixbuf));
-	
-	if (output->subregion.width < 1 ||
-	    output->subregion.height < 1)
-		return;
+		for (; y < end; y++)
+			_morphology_line_scalar (morphology->input_pixels + (morphology->ya + y) * morphology->stride, 1,
+						 morphology->width, morphology->x1, morphology->x2,
+						 morphology->kx, morphology->dilate, g, h,
+						 morphology->pixels + y * n_columns, 1);
 
-	/* TODO Implement preserve_aspect_ratio support */
+		g_free (g);
+		g_free (h);
+	}
+}
 
-	width = gdk_pixbuf_get_height (pixbuf);
-	height = gdk_pixbuf_get_width (pixbuf);
+static void
+_morphology_columns (gpointer data, int start, int end)
+{
+	LsmSvgMorphology *morphology = data;
+	int n_columns = morphology->x2 - morphology->x1;
+	int n_rows = morphology->yb - morphology->ya;
+	int length = morphology->y2 - morphology->y1 + 2 * morphology->ky;
+	guint32 *output = morphology->output_pixels + morphology->y1 * morphology->stride + morphology->x1;
+	int x = start;
+
+#ifdef __SSE2__
+	if (morphology->use_simd && end - start >= 4) {
+		__m128i *g, *h;
+
+		g = g_new (__m128i, length);
+		h = g_new (__m128i, length);
+
+		for (; x + 4 <= end; x += 4)
+			_morphology_line_sse2 (morphology->pixels + x, n_columns, n_rows,
+					       morphology->y1 - morphology->ya, morphology->y2 - morphology->ya,
+					       morphology->ky, morphology->dilate, g, h,
+					       output + x, morphology->stride);
+
+		g_free (g);
+		g_free (h);
+	}
+#endif
 
-	if (height < 1 || width < 1)
-		return;
+	if (x < end) {
+		guint32 *g, *h;
 
-	zoom_x = (double) output->subregion.width / (double) width;
-	zoom_y = (double) output->subregion.height / (double) height;
+		g = g_new (guint32, length);
+		h = g_new (guint32, length);
 
-	cairo = cairo_create (output->surface);
-	
-	cairo_translate (cairo, output->subregion.x, output->subregion.y);
-	cairo_scale (cairo, zoom_x, zoom_y);
-	lsm_cairo_set_source_pixbuf (cairo, pixbuf, 0, 0);
-	cairo_paint (cairo);
+		for (; x < end; x++)
+			_morphology_line_scalar (morphology->pixels + x, n_columns, n_rows,
+						 morphology->y1 - morphology->ya, morphology->y2 - morphology->ya,
+						 morphology->ky, morphology->dilate, g, h,
+						 output + x, morphology->stride);
 
-	cairo_destroy (cairo);
+		g_free (g);
+		g_free (h);
+	}
 }
 
 void
 lsm_svg_filter_surface_morphology (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
 				   LsmSvgMorphologyOperator op, double rx, double ry)
 {
-	cairo_t *cairo;
-	int i, j;
-	int ch, extreme;
-	gint x, y, x1, x2, y1, y2;
+	LsmSvgMorphology morphology;
 	gint width, height;
-	gint rowstride;
-	guchar *in_pixels;
-	guchar *output_pixels;
 	gint kx, ky;
-	guchar val;
 
 	g_return_if_fail (input != NULL);
 	g_return_if_fail (output != NULL);
@@ -1181,47 +2545,38 @@ lsm_svg_filter_surface_morphology (LsmSvgFilterSurface *input, LsmSvgFilterSurfa
 		return;
 
 	cairo_surface_flush (input->surface);
-	cairo = cairo_create (output->surface);
-
-	in_pixels = cairo_image_surface_get_data (input->surface);
-	output_pixels = cairo_image_surface_get_data (output->surface);
-	rowstride = cairo_image_surface_get_stride (input->surface);
-
-	x1 = CLAMP (input->subregion.x, 0, width);
-	x2 = CLAMP (input->subregion.x + input->subregion.width, 0, width);
-	y1 = CLAMP (input->subregion.y, 0, height);
-	y2 = CLAMP (input->subregion.y + input->subregion.height, 0, height);
-
-	for (y = y1; y < y2; y++)
-		for (x = x1; x < x2; x++)
-			for (ch = 0; ch < 4; ch++) {
-				if (op == LSM_SVG_MORPHOLOGY_OPERATOR_ERODE)
-					extreme = 255;
-				else
-					extreme = 0;
-				for (i = -ky; i < ky + 1; i++)
-					for (j = -kx; j < kx + 1; j++) {
-						if (y + i >= height || y + i < 0 || x + j >= width || x + j < 0)
-							continue;
-
-						val = in_pixels[(y + i) * rowstride + (x + j) * 4 + ch];
+	cairo_surface_flush (output->surface);
+
+	morphology.input_pixels = (const guint32 *) cairo_image_surface_get_data (input->surface);
+	morphology.output_pixels = (guint32 *) cairo_image_surface_get_data (output->surface);
+	morphology.width = width;
+	morphology.height = height;
+	morphology.stride = cairo_image_surface_get_stride (input->surface) / 4;
+	morphology.kx = MAX (kx, 0);
+	morphology.ky = MAX (ky, 0);
+	morphology.dilate = op != LSM_SVG_MORPHOLOGY_OPERATOR_ERODE;
+	morphology.use_simd = simd_enabled;
+
+	morphology.x1 = CLAMP (input->subregion.x, 0, width);
+	morphology.x2 = CLAMP (input->subregion.x + input->subregion.width, 0, width);
+	morphology.y1 = CLAMP (input->subregion.y, 0, height);
+	morphology.y2 = CLAMP (input->subregion.y + input->subregion.height, 0, height);
+	morphology.ya = MAX (morphology.y1 - morphology.ky, 0);
+	morphology.yb = MIN (morphology.y2 + morphology.ky, height);
+
+	if (morphology.x2 <= morphology.x1 || morphology.y2 <= morphology.y1)
+		return;
 
+	morphology.pixels = g_new (guint32, (morphology.x2 - morphology.x1) * (morphology.yb - morphology.ya));
 
-						if (op == LSM_SVG_MORPHOLOGY_OPERATOR_ERODE) {
-							if (extreme > val)
-								extreme = val;
-						} else {
-							if (extreme < val)
-								extreme = val;
-						}
+	_process_bands (_morphology_rows, &morphology, morphology.yb - morphology.ya,
+			(morphology.x2 - morphology.x1) * (morphology.yb - morphology.ya));
+	_process_bands (_morphology_columns, &morphology, morphology.x2 - morphology.x1,
+			(morphology.x2 - morphology.x1) * (morphology.y2 - morphology.y1));
 
-					}
-				output_pixels[y * rowstride + x * 4 + ch] = extreme;
-			}
+	g_free (morphology.pixels);
 
 	cairo_surface_mark_dirty (output->surface);
-
-	cairo_destroy (cairo);
 }
 
 /* Produces results in the range [1, 2**31 - 2].
@@ -1242,17 +2597,18 @@ lsm_svg_filter_surface_morphology (LsmSvgFilterSurface *input, LsmSvgFilterSurfa
 #define LSM_SVG_TURBULENCE_NP 		12      /* 2^PerlinN */
 #define LSM_SVG_TURBULENCE_NM 		0xfff
 
-typedef struct {
-	double base_frequency_x;
-	double base_frequency_y;
-	int n_octaves;
-	double seed;
-	LsmSvgStitchTiles stitch_tiles;
-	LsmSvgTurbulenceType type;
+#define LSM_SVG_TURBULENCE_LATTICE_CACHE_SIZE	8
 
+/* The lattice only depends on the seed. Gradients of the four color channels are stored side by side, so
+ * a noise evaluation reads them with the same lattice indices. */
+
+typedef struct {
+	double fGradient[LSM_SVG_TURBULENCE_BSize + LSM_SVG_TURBULENCE_BSize + 2][2][4];
 	int uLatticeSelector[LSM_SVG_TURBULENCE_BSize + LSM_SVG_TURBULENCE_BSize + 2];
-	double fGradient[4][LSM_SVG_TURBULENCE_BSize + LSM_SVG_TURBULENCE_BSize + 2][2];
-} LsmSvgTurbulence;
+
+	int seed;
+	gint ref_count;
+} LsmSvgTurbulenceLattice;
 
 typedef struct  {
 	int nWidth;                 /* How much to subtract to wrap for stitching. */
@@ -1261,6 +2617,27 @@ typedef struct  {
 	int nWrapY;
 } LsmSvgTurbulenceStitchInfo;
 
+typedef struct {
+	LsmSvgTurbulenceLattice *lattice;
+
+	double base_frequency_x;
+	double base_frequency_y;
+	int n_octaves;
+	LsmSvgTurbulenceType type;
+	LsmSvgTurbulenceStitchInfo *stitch_info;
+	LsmSvgTurbulenceStitchInfo stitch;
+
+	cairo_matrix_t affine;
+	guint32 *pixels;
+	int stride;
+	int x1, y1;
+	int width;
+	gboolean use_simd;
+} LsmSvgTurbulence;
+
+G_LOCK_DEFINE_STATIC (lattice_cache);
+static GQueue lattice_cache = G_QUEUE_INIT;
+
 static long
 _turbulence_setup_seed (int lSeed)
 {
@@ -1285,64 +2662,168 @@ _turbulence_random (int lSeed)
 }
 
 static void
-_turbulence_init (LsmSvgTurbulence *turbulence)
+_turbulence_init (LsmSvgTurbulenceLattice *lattice, int seed)
 {
 	double s;
 	int i, j, k, lSeed;
 
-	lSeed = _turbulence_setup_seed (turbulence->seed);
+	lSeed = _turbulence_setup_seed (seed);
 	for (k = 0; k < 4; k++) {
 		for (i = 0; i < LSM_SVG_TURBULENCE_BSize; i++) {
-			turbulence->uLatticeSelector[i] = i;
+			lattice->uLatticeSelector[i] = i;
 			for (j = 0; j < 2; j++)
-				turbulence->fGradient[k][i][j] =
+				lattice->fGradient[i][j][k] =
 					(double) (((lSeed =
 						    _turbulence_random (lSeed)) % (LSM_SVG_TURBULENCE_BSize +
 										   LSM_SVG_TURBULENCE_BSize)) -
 						  LSM_SVG_TURBULENCE_BSize) / LSM_SVG_TURBULENCE_BSize;
-			s = (double) (sqrt (turbulence->fGradient[k][i][0] * turbulence->fGradient[k][i][0] +
-					    turbulence->fGradient[k][i][1] * turbulence->fGradient[k][i][1]));
-			turbulence->fGradient[k][i][0] /= s;
-			turbulence->fGradient[k][i][1] /= s;
+			s = (double) (sqrt (lattice->fGradient[i][0][k] * lattice->fGradient[i][0][k] +
+					    lattice->fGradient[i][1][k] * lattice->fGradient[i][1][k]));
+			lattice->fGradient[i][0][k] /= s;
+			lattice->fGradient[i][1][k] /= s;
 		}
 	}
 
 	while (--i) {
-		k = turbulence->uLatticeSelector[i];
-		turbulence->uLatticeSelector[i] = turbulence->uLatticeSelector[j =
+		k = lattice->uLatticeSelector[i];
+		lattice->uLatticeSelector[i] = lattice->uLatticeSelector[j =
 			(lSeed = _turbulence_random (lSeed)) % LSM_SVG_TURBULENCE_BSize];
-		turbulence->uLatticeSelector[j] = k;
+		lattice->uLatticeSelector[j] = k;
 	}
 
 	for (i = 0; i < LSM_SVG_TURBULENCE_BSize + 2; i++) {
-		turbulence->uLatticeSelector[LSM_SVG_TURBULENCE_BSize + i] = turbulence->uLatticeSelector[i];
-		for (k = 0; k < 4; k++)
-			for (j = 0; j < 2; j++)
-				turbulence->fGradient[k][LSM_SVG_TURBULENCE_BSize + i][j] = turbulence->fGradient[k][i][j];
+		lattice->uLatticeSelector[LSM_SVG_TURBULENCE_BSize + i] = lattice->uLatticeSelector[i];
+		memcpy (lattice->fGradient[LSM_SVG_TURBULENCE_BSize + i], lattice->fGradient[i],
+			sizeof (lattice->fGradient[i]));
+	}
+}
+
+static void
+_turbulence_lattice_unref (LsmSvgTurbulenceLattice *lattice)
+{
+	if (g_atomic_int_dec_and_test (&lattice->ref_count))
+		g_free (lattice);
+}
+
+/* Must be called with the lattice cache lock held. Returns a new reference, or NULL. */
+
+static LsmSvgTurbulenceLattice *
+_turbulence_lattice_lookup (int seed)
+{
+	LsmSvgTurbulenceLattice *lattice;
+	GList *iter;
+
+	for (iter = lattice_cache.head; iter != NULL; iter = iter->next) {
+		lattice = iter->data;
+
+		if (lattice->seed == seed) {
+			g_queue_unlink (&lattice_cache, iter);
+			g_queue_push_head_link (&lattice_cache, iter);
+			g_atomic_int_inc (&lattice->ref_count);
+
+			return lattice;
+		}
+	}
+
+	return NULL;
+}
+
+static LsmSvgTurbulenceLattice *
+_turbulence_lattice_get (int seed)
+{
+	LsmSvgTurbulenceLattice *lattice;
+	LsmSvgTurbulenceLattice *cached;
+
+	G_LOCK (lattice_cache);
+	lattice = _turbulence_lattice_lookup (seed);
+	G_UNLOCK (lattice_cache);
+
+	if (lattice != NULL)
+		return lattice;
+
+	lattice = g_new (LsmSvgTurbulenceLattice, 1);
+	lattice->seed = seed;
+	lattice->ref_count = 2;
+	_turbulence_init (lattice, seed);
+
+	G_LOCK (lattice_cache);
+
+	/* Another thread may have built the same lattice meanwhile */
+	cached = _turbulence_lattice_lookup (seed);
+	if (cached != NULL) {
+		G_UNLOCK (lattice_cache);
+
+		g_free (lattice);
+
+		return cached;
 	}
+
+	g_queue_push_head (&lattice_cache, lattice);
+	while (lattice_cache.length > LSM_SVG_TURBULENCE_LATTICE_CACHE_SIZE)
+		_turbulence_lattice_unref (g_queue_pop_tail (&lattice_cache));
+
+	G_UNLOCK (lattice_cache);
+
+	return lattice;
+}
+
+void
+lsm_svg_filter_surface_cleanup (void)
+{
+	LsmSvgTurbulenceLattice *lattice;
+	GThreadPool *pool;
+
+	G_LOCK (lattice_cache);
+
+	while ((lattice = g_queue_pop_head (&lattice_cache)) != NULL)
+		_turbulence_lattice_unref (lattice);
+
+	G_UNLOCK (lattice_cache);
+
+	/* Wait for the running dispatches */
+	g_rw_lock_writer_lock (&thread_pool_users);
+
+	pool = thread_pool;
+	thread_pool = NULL;
+
+	g_rw_lock_writer_unlock (&thread_pool_users);
+
+	if (pool != NULL)
+		g_thread_pool_free (pool, FALSE, TRUE);
 }
 
 #define _turbulence_s_curve(t) 		( t * t * (3. - 2. * t) )
 #define _turbulence_lerp(t, a, b) 	( a + t * (b - a) )
 
-static double
-_turbulence_noise2 (LsmSvgTurbulence * turbulence,
-		    int nColorChannel, double vec[2], LsmSvgTurbulenceStitchInfo *pStitchInfo)
+/* Lattice indices and interpolation factors of a noise evaluation, common to the four channels */
+
+typedef struct {
+	const double (*q00)[4];
+	const double (*q10)[4];
+	const double (*q01)[4];
+	const double (*q11)[4];
+	double rx0, rx1, ry0, ry1;
+	double sx, sy;
+} LsmSvgTurbulenceCell;
+
+static void
+_turbulence_cell (const LsmSvgTurbulenceLattice *lattice, const double vec[2],
+		  const LsmSvgTurbulenceStitchInfo *pStitchInfo, LsmSvgTurbulenceCell *cell)
 {
 	int bx0, bx1, by0, by1, b00, b10, b01, b11;
-	double rx0, rx1, ry0, ry1, *q, sx, sy, a, b, t, u, v;
+	double t;
 	register int i, j;
 
 	t = vec[0] + LSM_SVG_TURBULENCE_PerlinN;
 	bx0 = (int) t;
 	bx1 = bx0 + 1;
-	rx0 = t - (int) t;
-	rx1 = rx0 - 1.0f;
+	cell->rx0 = t - (int) t;
+	cell->rx1 = cell->rx0 - 1.0f;
 	t = vec[1] + LSM_SVG_TURBULENCE_PerlinN;
 	by0 = (int) t;
 	by1 = by0 + 1;
-	ry0 = t - (int) t;
-	ry1 = ry0 - 1.0f;
+	cell->ry0 = t - (int) t;
+	cell->ry1 = cell->ry0 - 1.0f;
 
 	/* If stitching, adjust lattice points accordingly. */
 	if (pStitchInfo != NULL) {
@@ -1360,96 +2841,208 @@ _turbulence_noise2 (LsmSvgTurbulence * turbulence,
 	bx1 &= LSM_SVG_TURBULENCE_BM;
 	by0 &= LSM_SVG_TURBULENCE_BM;
 	by1 &= LSM_SVG_TURBULENCE_BM;
-	i = turbulence->uLatticeSelector[bx0];
-	j = turbulence->uLatticeSelector[bx1];
-	b00 = turbulence->uLatticeSelector[i + by0];
-	b10 = turbulence->uLatticeSelector[j + by0];
-	b01 = turbulence->uLatticeSelector[i + by1];
-	b11 = turbulence->uLatticeSelector[j + by1];
-	sx = (double) (_turbulence_s_curve (rx0));
-	sy = (double) (_turbulence_s_curve (ry0));
-	q = turbulence->fGradient[nColorChannel][b00];
-	u = rx0 * q[0] + ry0 * q[1];
-	q = turbulence->fGradient[nColorChannel][b10];
-	v = rx1 * q[0] + ry0 * q[1];
-	a = _turbulence_lerp (sx, u, v);
-	q = turbulence->fGradient[nColorChannel][b01];
-	u = rx0 * q[0] + ry1 * q[1];
-	q = turbulence->fGradient[nColorChannel][b11];
-	v = rx1 * q[0] + ry1 * q[1];
-	b = _turbulence_lerp (sx, u, v);
-
-	return _turbulence_lerp (sy, a, b);
+	i = lattice->uLatticeSelector[bx0];
+	j = lattice->uLatticeSelector[bx1];
+	b00 = lattice->uLatticeSelector[i + by0];
+	b10 = lattice->uLatticeSelector[j + by0];
+	b01 = lattice->uLatticeSelector[i + by1];
+	b11 = lattice->uLatticeSelector[j + by1];
+	cell->sx = (double) (_turbulence_s_curve (cell->rx0));
+	cell->sy = (double) (_turbulence_s_curve (cell->ry0));
+	cell->q00 = lattice->fGradient[b00];
+	cell->q10 = lattice->fGradient[b10];
+	cell->q01 = lattice->fGradient[b01];
+	cell->q11 = lattice->fGradient[b11];
 }
 
-static double
-_turbulence (LsmSvgTurbulence * turbulence,
-	     int nColorChannel, double *point,
-	     double fTileX, double fTileY, double fTileWidth, double fTileHeight)
+static void
+_turbulence_stitch_next_octave (LsmSvgTurbulenceStitchInfo *stitch)
 {
-	LsmSvgTurbulenceStitchInfo stitch;
-	LsmSvgTurbulenceStitchInfo *pStitchInfo = NULL; /* Not stitching when NULL. */
+	/* Update stitch values. Subtracting PerlinN before the multiplication and
+	   adding it afterward simplifies to subtracting it once. */
+	stitch->nWidth *= 2;
+	stitch->nWrapX = 2 * stitch->nWrapX - LSM_SVG_TURBULENCE_PerlinN;
+	stitch->nHeight *= 2;
+	stitch->nWrapY = 2 * stitch->nWrapY - LSM_SVG_TURBULENCE_PerlinN;
+}
 
-	double fSum = 0.0f, vec[2], ratio = 1.;
+static void
+_turbulence_scalar (const LsmSvgTurbulence *turbulence, const double point[2], double fSum[4])
+{
+	LsmSvgTurbulenceStitchInfo stitch = turbulence->stitch;
+	LsmSvgTurbulenceCell cell;
+	double vec[2], ratio = 1.;
 	int nOctave;
+	int k;
 
-	/* Adjust the base frequencies if necessary for stitching. */
-	if (turbulence->stitch_tiles == LSM_SVG_STITCH_TILES_STITCH) {
-		/* When stitching tiled turbulence, the frequencies must be adjusted
-		   so that the tile borders will be continuous. */
-		if (turbulence->base_frequency_x != 0.0) {
-			double fLoFreq = (double) (floor (fTileWidth * turbulence->base_frequency_x)) / fTileWidth;
-			double fHiFreq = (double) (ceil (fTileWidth * turbulence->base_frequency_x)) / fTileWidth;
-			if (turbulence->base_frequency_x / fLoFreq < fHiFreq / turbulence->base_frequency_x)
-				turbulence->base_frequency_x = fLoFreq;
-			else
-				turbulence->base_frequency_x = fHiFreq;
-		}
+	for (k = 0; k < 4; k++)
+		fSum[k] = 0.0;
+
+	vec[0] = point[0] * turbulence->base_frequency_x;
+	vec[1] = point[1] * turbulence->base_frequency_y;
+
+	for (nOctave = 0; nOctave < turbulence->n_octaves; nOctave++) {
+		_turbulence_cell (turbulence->lattice, vec, turbulence->stitch_info != NULL ? &stitch : NULL, &cell);
+
+		for (k = 0; k < 4; k++) {
+			double a, b, u, v, noise;
 
-		if (turbulence->base_frequency_y != 0.0) {
-			double fLoFreq = (double) (floor (fTileHeight * turbulence->base_frequency_y)) / fTileHeight;
-			double fHiFreq = (double) (ceil (fTileHeight * turbulence->base_frequency_y)) / fTileHeight;
-			if (turbulence->base_frequency_y / fLoFreq < fHiFreq / turbulence->base_frequency_y)
-				turbulence->base_frequency_y = fLoFreq;
+			u = cell.rx0 * cell.q00[0][k] + cell.ry0 * cell.q00[1][k];
+			v = cell.rx1 * cell.q10[0][k] + cell.ry0 * cell.q10[1][k];
+			a = _turbulence_lerp (cell.sx, u, v);
+			u = cell.rx0 * cell.q01[0][k] + cell.ry1 * cell.q01[1][k];
+			v = cell.rx1 * cell.q11[0][k] + cell.ry1 * cell.q11[1][k];
+			b = _turbulence_lerp (cell.sx, u, v);
+			noise = _turbulence_lerp (cell.sy, a, b);
+
+			if (turbulence->type == LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
+				fSum[k] += noise / ratio;
 			else
-				turbulence->base_frequency_y = fHiFreq;
+				fSum[k] += fabs (noise) / ratio;
 		}
 
-		/* Set up initial stitch values. */
-		pStitchInfo = &stitch;
-		stitch.nWidth = (int) (fTileWidth * turbulence->base_frequency_x + 0.5f);
-		stitch.nWrapX = fTileX * turbulence->base_frequency_x + LSM_SVG_TURBULENCE_PerlinN + stitch.nWidth;
-		stitch.nHeight = (int) (fTileHeight * turbulence->base_frequency_y + 0.5f);
-		stitch.nWrapY = fTileY * turbulence->base_frequency_y + LSM_SVG_TURBULENCE_PerlinN + stitch.nHeight;
+		vec[0] *= 2;
+		vec[1] *= 2;
+		ratio *= 2;
+
+		if (turbulence->stitch_info != NULL)
+			_turbulence_stitch_next_octave (&stitch);
 	}
+}
+
+#ifdef __SSE2__
+
+/* Same operations as the scalar version, with the four channels in two vectors of two doubles */
+
+static void
+_turbulence_sse2 (const LsmSvgTurbulence *turbulence, const double point[2], double fSum[4])
+{
+	LsmSvgTurbulenceStitchInfo stitch = turbulence->stitch;
+	LsmSvgTurbulenceCell cell;
+	const __m128d sign = _mm_set1_pd (-0.0);
+	__m128d sum[2];
+	double vec[2], ratio = 1.;
+	int nOctave;
+	int k;
+
+	sum[0] = sum[1] = _mm_setzero_pd ();
 
 	vec[0] = point[0] * turbulence->base_frequency_x;
 	vec[1] = point[1] * turbulence->base_frequency_y;
 
 	for (nOctave = 0; nOctave < turbulence->n_octaves; nOctave++) {
-		if (turbulence->type == LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
-			fSum +=
-				(double) (_turbulence_noise2 (turbulence, nColorChannel, vec, pStitchInfo) / ratio);
-		else
-			fSum +=
-				(double) (fabs (_turbulence_noise2 (turbulence, nColorChannel, vec, pStitchInfo)) /
-					  ratio);
+		__m128d rx0, rx1, ry0, ry1, sx, sy, r;
+
+		_turbulence_cell (turbulence->lattice, vec, turbulence->stitch_info != NULL ? &stitch : NULL, &cell);
+
+		rx0 = _mm_set1_pd (cell.rx0);
+		rx1 = _mm_set1_pd (cell.rx1);
+		ry0 = _mm_set1_pd (cell.ry0);
+		ry1 = _mm_set1_pd (cell.ry1);
+		sx = _mm_set1_pd (cell.sx);
+		sy = _mm_set1_pd (cell.sy);
+		r = _mm_set1_pd (ratio);
+
+		for (k = 0; k < 2; k++) {
+			__m128d a, b, u, v, noise;
+
+			u = _mm_add_pd (_mm_mul_pd (rx0, _mm_loadu_pd (&cell.q00[0][2 * k])),
+					_mm_mul_pd (ry0, _mm_loadu_pd (&cell.q00[1][2 * k])));
+			v = _mm_add_pd (_mm_mul_pd (rx1, _mm_loadu_pd (&cell.q10[0][2 * k])),
+					_mm_mul_pd (ry0, _mm_loadu_pd (&cell.q10[1][2 * k])));
+			a = _mm_add_pd (u, _mm_mul_pd (sx, _mm_sub_pd (v, u)));
+			u = _mm_add_pd (_mm_mul_pd (rx0, _mm_loadu_pd (&cell.q01[0][2 * k])),
+					_mm_mul_pd (ry1, _mm_loadu_pd (&cell.q01[1][2 * k])));
+			v = _mm_add_pd (_mm_mul_pd (rx1, _mm_loadu_pd (&cell.q11[0][2 * k])),
+					_mm_mul_pd (ry1, _mm_loadu_pd (&cell.q11[1][2 * k])));
+			b = _mm_add_pd (u, _mm_mul_pd (sx, _mm_sub_pd (v, u)));
+			noise = _mm_add_pd (a, _mm_mul_pd (sy, _mm_sub_pd (b, a)));
+
+			if (turbulence->type != LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
+				noise = _mm_andnot_pd (sign, noise);
+
+			sum[k] = _mm_add_pd (sum[k], _mm_div_pd (noise, r));
+		}
 
 		vec[0] *= 2;
 		vec[1] *= 2;
 		ratio *= 2;
 
-		if (pStitchInfo != NULL) {
-			/* Update stitch values. Subtracting PerlinN before the multiplication and
-			   adding it afterward simplifies to subtracting it once. */
-			stitch.nWidth *= 2;
-			stitch.nWrapX = 2 * stitch.nWrapX - LSM_SVG_TURBULENCE_PerlinN;
-			stitch.nHeight *= 2;
-			stitch.nWrapY = 2 * stitch.nWrapY - LSM_SVG_TURBULENCE_PerlinN;
+		if (turbulence->stitch_info != NULL)
+			_turbulence_stitch_next_octave (&stitch);
+	}
+
+	_mm_storeu_pd (&fSum[0], sum[0]);
+	_mm_storeu_pd (&fSum[2], sum[1]);
+}
+
+#endif
+
+static void
+_turbulence_rows (gpointer data, int start, int end)
+{
+	LsmSvgTurbulence *turbulence = data;
+	const cairo_matrix_t *affine = &turbulence->affine;
+	int x, y, i;
+
+	for (y = start; y < end; y++) {
+		guint32 *row = turbulence->pixels + (y + turbulence->y1) * turbulence->stride + turbulence->x1;
+
+		for (x = 0; x < turbulence->width; x++) {
+			double point[2];
+			double sum[4];
+			guint32 channels[4];
+			guint32 pixel;
+
+			point[0] = affine->xx * (x + turbulence->x1) + affine->xy * (y + turbulence->y1) + affine->x0;
+			point[1] = affine->yx * (x + turbulence->x1) + affine->yy * (y + turbulence->y1) + affine->y0;
+
+#ifdef __SSE2__
+			if (turbulence->use_simd)
+				_turbulence_sse2 (turbulence, point, sum);
+			else
+#endif
+				_turbulence_scalar (turbulence, point, sum);
+
+			for (i = 0; i < 4; i++) {
+				double cr = sum[i];
+
+				if (turbulence->type == LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
+					cr = ((cr * 255.) + 255.) / 2.;
+				else
+					cr = (cr * 255.);
+
+				channels[i] = CLAMP (cr, 0., 255.);
+			}
+
+			/* Premultiplied ARGB, channels are in RGBA order */
+			pixel = channels[3] << 24;
+			for (i = 0; i < 3; i++)
+				pixel |= (channels[i] * channels[3] / 255) << (16 - 8 * i);
+
+			row[x] = pixel;
 		}
 	}
+}
+
+/* When stitching tiled turbulence, the frequencies must be adjusted so that the tile borders will be
+ * continuous. */
 
-	return fSum;
+static double
+_turbulence_stitch_frequency (double frequency, double tile_size)
+{
+	double fLoFreq, fHiFreq;
+
+	if (frequency == 0.0)
+		return frequency;
+
+	fLoFreq = (double) (floor (tile_size * frequency)) / tile_size;
+	fHiFreq = (double) (ceil (tile_size * frequency)) / tile_size;
+
+	if (frequency / fLoFreq < fHiFreq / frequency)
+		return fLoFreq;
+
+	return fHiFreq;
 }
 
 void
@@ -1460,18 +3053,14 @@ lsm_svg_filter_surface_turbulence (LsmSvgFilterSurface *output,
 				   const cairo_matrix_t *transform)
 {
 	LsmSvgTurbulence turbulence;
-	cairo_t *cairo;
-	gint x, y, x1, x2, y1, y2;
+	gint x1, x2, y1, y2;
 	gint width, height, tileWidth, tileHeight;
-	gint rowstride;
-	guchar *output_pixels;
-	cairo_matrix_t affine;
 
 	g_return_if_fail (output != NULL);
 	g_return_if_fail (transform != NULL);
 
-	affine = *transform;
-	if (cairo_matrix_invert (&affine) != CAIRO_STATUS_SUCCESS)
+	turbulence.affine = *transform;
+	if (cairo_matrix_invert (&turbulence.affine) != CAIRO_STATUS_SUCCESS)
 		return;
 
 	width = cairo_image_surface_get_width (output->surface);
@@ -1480,61 +3069,50 @@ lsm_svg_filter_surface_turbulence (LsmSvgFilterSurface *output,
 	if (height < 1 || width < 1)
 		return;
 
-	cairo = cairo_create (output->surface);
-
-	output_pixels = cairo_image_surface_get_data (output->surface);
-	rowstride = cairo_image_surface_get_stride (output->surface);
-
 	x1 = CLAMP (output->subregion.x, 0, width);
 	x2 = CLAMP (output->subregion.x + output->subregion.width, 0, width);
 	y1 = CLAMP (output->subregion.y, 0, height);
 	y2 = CLAMP (output->subregion.y + output->subregion.height, 0, height);
 
-	turbulence.base_frequency_x = base_frequency_x;
-	turbulence.base_frequency_y = base_frequency_y;
-	turbulence.n_octaves = n_octaves;
-	turbulence.seed = seed;
-	turbulence.stitch_tiles = stitch_tiles;
-	turbulence.type = type;
-
-	_turbulence_init (&turbulence);
-
 	tileWidth = x2 - x1;
 	tileHeight = y2 - y1;
 
-	for (y = 0; y < tileHeight; y++) {
-		for (x = 0; x < tileWidth; x++) {
-			gint i;
-			double point[2];
-			guchar *pixel;
-			point[0] = affine.xx * (x + x1) + affine.xy * (y + y1) + affine.x0;
-			point[1] = affine.yx * (x + x1) + affine.yy * (y + y1) + affine.y0;
+	if (tileWidth < 1 || tileHeight < 1)
+		return;
 
-			pixel = output_pixels + 4 * (x + x1) + (y + y1) * rowstride;
+	cairo_surface_flush (output->surface);
 
-			for (i = 0; i < 4; i++) {
-				double cr;
+	turbulence.pixels = (guint32 *) cairo_image_surface_get_data (output->surface);
+	turbulence.stride = cairo_image_surface_get_stride (output->surface) / 4;
+	turbulence.x1 = x1;
+	turbulence.y1 = y1;
+	turbulence.width = tileWidth;
+	turbulence.n_octaves = n_octaves;
+	turbulence.type = type;
+	turbulence.use_simd = simd_enabled;
+	turbulence.base_frequency_x = base_frequency_x;
+	turbulence.base_frequency_y = base_frequency_y;
+	turbulence.stitch_info = NULL;
 
-				cr = _turbulence (&turbulence, i, point, (double) x, (double) y,
-						  (double) tileWidth, (double) tileHeight);
+	if (stitch_tiles == LSM_SVG_STITCH_TILES_STITCH) {
+		turbulence.base_frequency_x = _turbulence_stitch_frequency (base_frequency_x, tileWidth);
+		turbulence.base_frequency_y = _turbulence_stitch_frequency (base_frequency_y, tileHeight);
 
-				if (type == LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
-					cr = ((cr * 255.) + 255.) / 2.;
-				else
-					cr = (cr * 255.);
+		/* Set up initial stitch values. */
+		turbulence.stitch_info = &turbulence.stitch;
+		turbulence.stitch.nWidth = (int) (tileWidth * turbulence.base_frequency_x + 0.5f);
+		turbulence.stitch.nWrapX = x1 * turbulence.base_frequency_x + LSM_SVG_TURBULENCE_PerlinN +
+			turbulence.stitch.nWidth;
+		turbulence.stitch.nHeight = (int) (tileHeight * turbulence.base_frequency_y + 0.5f);
+		turbulence.stitch.nWrapY = y1 * turbulence.base_frequency_y + LSM_SVG_TURBULENCE_PerlinN +
+			turbulence.stitch.nHeight;
+	}
 
-				cr = CLAMP (cr, 0., 255.);
+	turbulence.lattice = _turbulence_lattice_get (seed);
 
-				pixel[channelmap[i]] = (guchar) cr;
-			}
-			for (i = 0; i < 3; i++)
-				pixel[channelmap[i]] =
-					pixel[channelmap[i]] * pixel[channelmap[3]] / 255;
+	_process_bands (_turbulence_rows, &turbulence, tileHeight, tileWidth * tileHeight * MAX (n_octaves, 1));
 
-		}
-	}
+	_turbulence_lattice_unref (turbulence.lattice);
 
 	cairo_surface_mark_dirty (output->surface);
-
-	cairo_destroy (cairo);
 }
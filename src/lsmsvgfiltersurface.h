@@ -33,6 +33,29 @@ G_BEGIN_DECLS
 
 typedef struct _LsmSvgFilterSurface LsmSvgFilterSurface;
 
+typedef enum {
+	LSM_SVG_FILTER_LIGHT_TYPE_DISTANT,
+	LSM_SVG_FILTER_LIGHT_TYPE_POINT,
+	LSM_SVG_FILTER_LIGHT_TYPE_SPOT
+} LsmSvgFilterLightType;
+
+typedef struct {
+	LsmSvgFilterLightType type;
+
+	double azimuth;
+	double elevation;
+
+	double x;
+	double y;
+	double z;
+	double points_at_x;
+	double points_at_y;
+	double points_at_z;
+	double specular_exponent;
+	double limiting_cone_angle;
+	gboolean is_cone_limited;
+} LsmSvgFilterLight;
+
 #define LSM_TYPE_FILTER_SURFACE (lsm_svg_filter_surface_get_type())
 
 GType lsm_svg_filter_surface_get_type (void);
@@ -48,6 +71,10 @@ const LsmBox *		lsm_svg_filter_surface_get_subregion 	(LsmSvgFilterSurface *surf
 void 			lsm_svg_filter_surface_unref 		(LsmSvgFilterSurface *filter_surface);
 LsmSvgFilterSurface *	lsm_svg_filter_surface_ref 		(LsmSvgFilterSurface *filter_surface);
 
+void			lsm_svg_filter_surface_set_simd_enabled	(gboolean enable);
+gboolean		lsm_svg_filter_surface_get_simd_enabled	(void);
+void			lsm_svg_filter_surface_cleanup 		(void);
+
 void 			lsm_svg_filter_surface_alpha 		(LsmSvgFilterSurface *input, LsmSvgFilterSurface *output);
 void 			lsm_svg_filter_surface_blend 		(LsmSvgFilterSurface *input_1,
 								 LsmSvgFilterSurface *input_2,
@@ -63,6 +90,9 @@ void 			lsm_svg_filter_surface_merge 		(LsmSvgFilterSurface *input, LsmSvgFilter
 void 			lsm_svg_filter_surface_tile 		(LsmSvgFilterSurface *input, LsmSvgFilterSurface *output);
 void 			lsm_svg_filter_surface_color_matrix 	(LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
 								 LsmSvgColorFilterType type, unsigned n_values, const double *values);
+void 			lsm_svg_filter_surface_component_transfer (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+								 const guint8 *red, const guint8 *green, const guint8 *blue,
+								 const guint8 *alpha);
 void 			lsm_svg_filter_surface_convolve_matrix 	(LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
 								 unsigned x_order, unsigned y_order,
 								 unsigned n_values, const double *values,
@@ -78,9 +108,16 @@ void			lsm_svg_filter_surface_image 		(LsmSvgFilterSurface *output, GdkPixbuf *p
 								 LsmSvgPreserveAspectRatio preserve_aspect_ratio);
 void 			lsm_svg_filter_surface_morphology 	(LsmSvgFilterSurface *input_surface, LsmSvgFilterSurface *output_surface,
 								 LsmSvgMorphologyOperator op, double rx, double ry);
-void 			lsm_svg_filter_surface_specular_lighting(LsmSvgFilterSurface *output_surface,
+void 			lsm_svg_filter_surface_diffuse_lighting	(LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+								 const LsmSvgFilterLight *light,
+								 double surface_scale, double diffuse_constant,
+								 double dx, double dy,
+								 double red, double green, double blue);
+void 			lsm_svg_filter_surface_specular_lighting(LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+								 const LsmSvgFilterLight *light,
 								 double surface_scale, double specular_constant, double specular_exponent,
-								 double dx, double dy);
+								 double dx, double dy,
+								 double red, double green, double blue);
 void			lsm_svg_filter_surface_turbulence 	(LsmSvgFilterSurface *output_surface,
 								 double base_frequency_x, double base_frequency_y,
 								 int n_octaves, double seed,
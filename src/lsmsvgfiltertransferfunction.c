@@ -0,0 +1,210 @@
+/* Lasem
+ * 
+ * Copyright © 2012 Emmanuel Pacaud
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Author:
+ * 	Emmanuel Pacaud <emmanuel@gnome.org>
+ */
+
+#include <lsmsvgfiltertransferfunction.h>
+#include <math.h>
+
+static GObjectClass *parent_class;
+
+/* GdomNode implementation */
+
+static const char *
+lsm_svg_filter_transfer_function_get_node_name (LsmDomNode *node)
+{
+	switch (LSM_SVG_FILTER_TRANSFER_FUNCTION (node)->channel) {
+		case LSM_SVG_CHANNEL_SELECTOR_RED:
+			return "feFuncR";
+		case LSM_SVG_CHANNEL_SELECTOR_GREEN:
+			return "feFuncG";
+		case LSM_SVG_CHANNEL_SELECTOR_BLUE:
+			return "feFuncB";
+		default:
+			return "feFuncA";
+	}
+}
+
+static gboolean
+lsm_svg_filter_transfer_function_can_append_child (LsmDomNode *self, LsmDomNode *child)
+{
+	return FALSE;
+}
+
+/* LsmSvgFilterTransferFunction implementation */
+
+static double
+_transfer_function_value (LsmSvgFilterTransferFunction *self, double value)
+{
+	const LsmSvgVector *table_values = &self->table_values.value;
+	unsigned int n = table_values->n_values;
+	unsigned int k;
+
+	switch (self->type.value) {
+		case LSM_SVG_TRANSFER_FUNCTION_TYPE_TABLE:
+			if (n < 1)
+				return value;
+			if (n == 1 || value >= 1.0)
+				return table_values->values[n - 1];
+			k = value * (n - 1);
+			return table_values->values[k] +
+				(value * (n - 1) - k) * (table_values->values[k + 1] - table_values->values[k]);
+		case LSM_SVG_TRANSFER_FUNCTION_TYPE_DISCRETE:
+			if (n < 1)
+				return value;
+			k = MIN (value * n, n - 1);
+			return table_values->values[k];
+		case LSM_SVG_TRANSFER_FUNCTION_TYPE_LINEAR:
+			return self->slope.value * value + self->intercept.value;
+		case LSM_SVG_TRANSFER_FUNCTION_TYPE_GAMMA:
+			return self->amplitude.value * pow (value, self->exponent.value) + self->offset.value;
+		default:
+			return value;
+	}
+}
+
+/* Evaluates the function for the 256 values of an unpremultiplied channel. Results out of [0, 1], or not
+ * a number, are clamped. */
+
+void
+lsm_svg_filter_transfer_function_get_table (LsmSvgFilterTransferFunction *self, guint8 *table)
+{
+	double value;
+	unsigned int i;
+
+	g_return_if_fail (LSM_IS_SVG_FILTER_TRANSFER_FUNCTION (self));
+	g_return_if_fail (table != NULL);
+
+	for (i = 0; i < 256; i++) {
+		value = _transfer_function_value (self, i / 255.0);
+		table[i] = value > 0.0 ? MIN (value, 1.0) * 255.0 + 0.5 : 0;
+	}
+}
+
+static const LsmSvgTransferFunctionType type_default = LSM_SVG_TRANSFER_FUNCTION_TYPE_IDENTITY;
+static const LsmSvgVector table_values_default = { .n_values = 0, .values = NULL};
+static const double slope_default = 1.0;
+static const double intercept_default = 0.0;
+static const double amplitude_default = 1.0;
+static const double exponent_default = 1.0;
+static const double offset_default = 0.0;
+
+LsmDomNode *
+lsm_svg_filter_transfer_function_new (LsmSvgChannelSelector channel)
+{
+	LsmSvgFilterTransferFunction *transfer_function;
+
+	transfer_function = g_object_new (LSM_TYPE_SVG_FILTER_TRANSFER_FUNCTION, NULL);
+	transfer_function->channel = channel;
+
+	return LSM_DOM_NODE (transfer_function);
+}
+
+static void
+lsm_svg_filter_transfer_function_init (LsmSvgFilterTransferFunction *self)
+{
+	self->channel = LSM_SVG_CHANNEL_SELECTOR_ALPHA;
+	self->type.value = type_default;
+	self->table_values.value = table_values_default;
+	self->slope.value = slope_default;
+	self->intercept.value = intercept_default;
+	self->amplitude.value = amplitude_default;
+	self->exponent.value = exponent_default;
+	self->offset.value = offset_default;
+}
+
+static void
+lsm_svg_filter_transfer_function_finalize (GObject *object)
+{
+	parent_class->finalize (object);
+}
+
+/* LsmSvgFilterTransferFunction class */
+
+static const LsmAttributeInfos lsm_svg_filter_transfer_function_attribute_infos[] = {
+	{
+		.name = "type",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, type),
+		.trait_class = &lsm_svg_transfer_function_type_trait_class,
+		.trait_default = &type_default
+	},
+	{
+		.name = "tableValues",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, table_values),
+		.trait_class = &lsm_svg_vector_trait_class,
+		.trait_default = &table_values_default
+	},
+	{
+		.name = "slope",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, slope),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &slope_default
+	},
+	{
+		.name = "intercept",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, intercept),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &intercept_default
+	},
+	{
+		.name = "amplitude",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, amplitude),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &amplitude_default
+	},
+	{
+		.name = "exponent",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, exponent),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &exponent_default
+	},
+	{
+		.name = "offset",
+		.attribute_offset = offsetof (LsmSvgFilterTransferFunction, offset),
+		.trait_class = &lsm_double_trait_class,
+		.trait_default = &offset_default
+	}
+};
+
+static void
+lsm_svg_filter_transfer_function_class_init (LsmSvgFilterTransferFunctionClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
+	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+
+	object_class->finalize = lsm_svg_filter_transfer_function_finalize;
+
+	d_node_class->get_node_name = lsm_svg_filter_transfer_function_get_node_name;
+	d_node_class->can_append_child = lsm_svg_filter_transfer_function_can_append_child;
+
+	s_element_class->category = LSM_SVG_ELEMENT_CATEGORY_NONE;
+	s_element_class->render = NULL;
+	s_element_class->attribute_manager = lsm_attribute_manager_duplicate (s_element_class->attribute_manager);
+
+	lsm_attribute_manager_add_attributes (s_element_class->attribute_manager,
+					      G_N_ELEMENTS (lsm_svg_filter_transfer_function_attribute_infos),
+					      lsm_svg_filter_transfer_function_attribute_infos);
+}
+
+G_DEFINE_TYPE (LsmSvgFilterTransferFunction, lsm_svg_filter_transfer_function, LSM_TYPE_SVG_ELEMENT)
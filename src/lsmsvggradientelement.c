@@ -27,6 +27,7 @@
 #include <lsmdomdocument.h>
 #include <lsmdebug.h>
 #include <stdio.h>
+#include <string.h>
 
 static const LsmSvgGradientElementAttributes default_attributes = {
 	.transform = {1.0, 0.0, 0.0, 1.0, 0.0, 0.0, LSM_SVG_MATRIX_FLAGS_IDENTITY},
@@ -46,12 +47,59 @@ lsm_svg_gradient_element_can_append_child (LsmDomNode *parent, LsmDomNode *child
 
 /* LsmSvgElement implementation */
 
+/* Everything the resolved gradient geometry and stop colors depend on, besides the document itself */
+
+static void
+_get_pattern_key (LsmSvgGradientElement *gradient, LsmSvgView *view, LsmSvgGradientPatternKey *key)
+{
+	const LsmSvgStyle *style = view->style;
+
+	memset (key, 0, sizeof (LsmSvgGradientPatternKey));
+
+	key->document_generation = lsm_dom_node_get_owner_document (LSM_DOM_NODE (gradient))->generation;
+	key->color = style->color;
+	key->stop_color = style->stop_color;
+	key->stop_opacity = style->stop_opacity;
+	key->visibility = style->visibility;
+	key->font_size_px = style->font_size_px;
+	key->viewbox = *((LsmSvgViewbox *) view->viewbox_stack->data);
+	key->opacity = lsm_svg_view_get_pattern_opacity (view);
+}
+
+static gboolean
+_is_pattern_key_equal (const LsmSvgGradientPatternKey *a, const LsmSvgGradientPatternKey *b)
+{
+	return (a->document_generation == b->document_generation &&
+		a->color == b->color &&
+		a->stop_color == b->stop_color &&
+		a->stop_opacity == b->stop_opacity &&
+		a->visibility == b->visibility &&
+		a->font_size_px == b->font_size_px &&
+		a->viewbox.resolution_ppi == b->viewbox.resolution_ppi &&
+		a->viewbox.viewbox.x == b->viewbox.viewbox.x &&
+		a->viewbox.viewbox.y == b->viewbox.viewbox.y &&
+		a->viewbox.viewbox.width == b->viewbox.viewbox.width &&
+		a->viewbox.viewbox.height == b->viewbox.viewbox.height &&
+		a->opacity == b->opacity);
+}
+
+static void
+_clear_pattern (LsmSvgGradientElement *gradient)
+{
+	if (gradient->pattern == NULL)
+		return;
+
+	cairo_pattern_destroy (gradient->pattern);
+	gradient->pattern = NULL;
+}
+
 static void
 lsm_svg_gradient_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
 	LsmSvgGradientElement *gradient = LSM_SVG_GRADIENT_ELEMENT (self);
 	LsmSvgGradientElement *referenced_gradient;
 	LsmSvgGradientElementClass *gradient_class = LSM_SVG_GRADIENT_ELEMENT_GET_CLASS (self);
+	LsmSvgGradientPatternKey key;
 	LsmDomNode *node;
 
 	if (!gradient->enable_rendering)
@@ -59,6 +107,25 @@ lsm_svg_gradient_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	gradient->enable_rendering = FALSE;
 
+	_get_pattern_key (gradient, view, &key);
+
+	if (gradient->pattern != NULL && _is_pattern_key_equal (&key, &gradient->pattern_key)) {
+		lsm_debug_render ("[LsmSvgGradientElement::render] Use cached pattern");
+
+		/* The attributes inherited through href were resolved when the pattern was created. Only the
+		 * pattern matrix depends on the painted object. */
+		lsm_svg_view_set_gradient_pattern (view, gradient->pattern);
+		if (!lsm_svg_view_set_gradient_properties (view,
+							   gradient->spread_method.value,
+							   gradient->units.value,
+							   &gradient->transform.matrix))
+			lsm_svg_view_set_gradient_pattern (view, NULL);
+
+		return;
+	}
+
+	_clear_pattern (gradient);
+
 	referenced_gradient = gradient_class->create_gradient (self, view);
 
 	if (referenced_gradient == NULL)
@@ -79,6 +146,12 @@ lsm_svg_gradient_element_render (LsmSvgElement *self, LsmSvgView *view)
 		for (node = LSM_DOM_NODE (referenced_gradient)->first_child; node != NULL; node = node->next_sibling)
 			if (LSM_IS_SVG_ELEMENT (node))
 				lsm_svg_element_render (LSM_SVG_ELEMENT (node), view);
+
+		gradient->pattern = lsm_svg_view_get_gradient_pattern (view);
+		if (gradient->pattern != NULL) {
+			cairo_pattern_reference (gradient->pattern);
+			gradient->pattern_key = key;
+		}
 	}
 }
 
@@ -95,12 +168,21 @@ static void
 lsm_svg_gradient_element_init (LsmSvgGradientElement *self)
 {
 	self->enable_rendering = FALSE;
+	self->pattern = NULL;
 
 	self->units.value = default_attributes.units;
 	self->spread_method.value = default_attributes.spread_method;
 	self->transform.matrix = default_attributes.transform;
 }
 
+static void
+lsm_svg_gradient_element_finalize (GObject *object)
+{
+	_clear_pattern (LSM_SVG_GRADIENT_ELEMENT (object));
+
+	parent_class->finalize (object);
+}
+
 /* LsmSvgGradientElement class */
 
 static const LsmAttributeInfos lsm_svg_gradient_element_attribute_infos[] = {
@@ -132,11 +214,14 @@ static const LsmAttributeInfos lsm_svg_gradient_element_attribute_infos[] = {
 static void
 lsm_svg_gradient_element_class_init (LsmSvgGradientElementClass *klass)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
 	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (klass);
 	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (klass);
 
 	parent_class = g_type_class_peek_parent (klass);
 
+	object_class->finalize = lsm_svg_gradient_element_finalize;
+
 	d_node_class->can_append_child = lsm_svg_gradient_element_can_append_child;
 
 	s_element_class->render = lsm_svg_gradient_element_render;
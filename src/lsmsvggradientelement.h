@@ -44,6 +44,17 @@ typedef struct {
 
 typedef struct _LsmSvgGradientElementClass LsmSvgGradientElementClass;
 
+typedef struct {
+	unsigned int document_generation;
+	const void *color;
+	const void *stop_color;
+	const void *stop_opacity;
+	const void *visibility;
+	double font_size_px;
+	LsmSvgViewbox viewbox;
+	double opacity;
+} LsmSvgGradientPatternKey;
+
 struct _LsmSvgGradientElement {
 	LsmSvgElement element;
 
@@ -53,6 +64,9 @@ struct _LsmSvgGradientElement {
 	LsmAttribute href;
 
 	gboolean enable_rendering;
+
+	cairo_pattern_t *pattern;
+	LsmSvgGradientPatternKey pattern_key;
 };
 
 struct _LsmSvgGradientElementClass {
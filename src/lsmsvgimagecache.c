@@ -0,0 +1,338 @@
+/* Lasem
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#include <lsmsvgimagecache.h>
+#include <lsmcairo.h>
+#include <lsmdebug.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <string.h>
+
+/* Decoded images are shared between all the documents of the process. Entries
+ * are keyed on the resolved URI, or on a digest of the URI for data: URIs,
+ * and evicted in least recently used order once the total size of the cached
+ * surfaces, including their mip levels, exceeds the cache limit. */
+
+typedef struct {
+	char *key;
+	cairo_surface_t *surface;
+	gsize image_size;
+	gsize size;
+	GList *link;
+} LsmSvgImageCacheEntry;
+
+static GHashTable *image_cache = NULL;
+static GHashTable *image_cache_surfaces = NULL;
+static GQueue image_cache_lru = G_QUEUE_INIT;
+static gsize image_cache_size = 0;
+static gsize image_cache_max_size = LSM_SVG_IMAGE_CACHE_DEFAULT_MAX_SIZE;
+G_LOCK_DEFINE_STATIC (image_cache);
+
+static void
+_entry_free (LsmSvgImageCacheEntry *entry)
+{
+	cairo_surface_destroy (entry->surface);
+	g_free (entry->key);
+	g_free (entry);
+}
+
+static void
+_trim (gsize max_size)
+{
+	LsmSvgImageCacheEntry *entry;
+
+	while (image_cache_size > max_size &&
+	       (entry = g_queue_pop_tail (&image_cache_lru)) != NULL) {
+		image_cache_size -= entry->size;
+		g_hash_table_remove (image_cache_surfaces, entry->surface);
+		g_hash_table_remove (image_cache, entry->key);
+	}
+}
+
+static char *
+_get_key (LsmDomDocument *document, const char *href)
+{
+	if (strncmp (href, "data:", 5) == 0) {
+		char *checksum;
+		char *key;
+
+		checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, href, -1);
+		key = g_strconcat ("data:sha1,", checksum, NULL);
+		g_free (checksum);
+
+		return key;
+	}
+
+	return lsm_dom_document_resolve_href (document, href);
+}
+
+static cairo_surface_t *
+_decode (LsmDomDocument *document, const char *href)
+{
+	GdkPixbufLoader *loader;
+	GdkPixbuf *pixbuf;
+	cairo_surface_t *surface = NULL;
+	char *data;
+	gsize size;
+
+	data = lsm_dom_document_get_href_data (document, href, &size);
+	if (data == NULL)
+		return NULL;
+
+	loader = gdk_pixbuf_loader_new ();
+
+	gdk_pixbuf_loader_write (loader, (guchar *) data, size, NULL);
+	gdk_pixbuf_loader_close (loader, NULL);
+
+	g_free (data);
+
+	pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+	if (pixbuf != NULL)
+		surface = lsm_cairo_surface_new_from_pixbuf (pixbuf);
+
+	g_object_unref (loader);
+
+	return surface;
+}
+
+/**
+ * lsm_svg_image_cache_get_surface:
+ * @document: the document referencing the image
+ * @href: image href, relative to the document url
+ *
+ * Returns the decoded image referenced by @href, as a premultiplied image
+ * surface. The surface is shared with the other users of the same image and
+ * must not be modified.
+ *
+ * Returns: (transfer full): an image surface, or %NULL if the image can't be loaded.
+ *
+ * Since: 0.6
+ */
+
+cairo_surface_t *
+lsm_svg_image_cache_get_surface (LsmDomDocument *document, const char *href)
+{
+	LsmSvgImageCacheEntry *entry;
+	cairo_surface_t *surface;
+	char *key;
+	gsize size;
+
+	g_return_val_if_fail (LSM_IS_DOM_DOCUMENT (document), NULL);
+	g_return_val_if_fail (href != NULL, NULL);
+
+	key = _get_key (document, href);
+
+	G_LOCK (image_cache);
+
+	if (image_cache != NULL) {
+		entry = g_hash_table_lookup (image_cache, key);
+		if (entry != NULL) {
+			g_queue_unlink (&image_cache_lru, entry->link);
+			g_queue_push_head_link (&image_cache_lru, entry->link);
+			surface = cairo_surface_reference (entry->surface);
+
+			G_UNLOCK (image_cache);
+
+			g_free (key);
+			return surface;
+		}
+	}
+
+	G_UNLOCK (image_cache);
+
+	/* Decoding is done without holding the lock, so an other thread may
+	 * have inserted the same image in the meantime. */
+
+	surface = _decode (document, strncmp (href, "data:", 5) == 0 ? href : key);
+	if (surface == NULL) {
+		lsm_debug_render ("[SvgImageCache::get_surface] Failed to load image '%s'", href);
+		g_free (key);
+		return NULL;
+	}
+
+	size = (gsize) cairo_image_surface_get_stride (surface) *
+		cairo_image_surface_get_height (surface);
+
+	G_LOCK (image_cache);
+
+	if (image_cache == NULL) {
+		image_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+						     (GDestroyNotify) _entry_free);
+		image_cache_surfaces = g_hash_table_new (g_direct_hash, g_direct_equal);
+	}
+
+	entry = g_hash_table_lookup (image_cache, key);
+	if (entry != NULL) {
+		cairo_surface_destroy (surface);
+		surface = cairo_surface_reference (entry->surface);
+		g_free (key);
+	} else if (size <= image_cache_max_size) {
+		entry = g_new (LsmSvgImageCacheEntry, 1);
+		entry->key = key;
+		entry->surface = cairo_surface_reference (surface);
+		entry->image_size = size;
+		entry->size = size;
+
+		g_queue_push_head (&image_cache_lru, entry);
+		entry->link = image_cache_lru.head;
+		g_hash_table_insert (image_cache, entry->key, entry);
+		g_hash_table_insert (image_cache_surfaces, entry->surface, entry);
+		image_cache_size += size;
+
+		_trim (image_cache_max_size);
+	} else
+		g_free (key);
+
+	G_UNLOCK (image_cache);
+
+	return surface;
+}
+
+/**
+ * lsm_svg_image_cache_get_mipmap:
+ * @surface: an image surface
+ * @scale: number of device pixels per pixel of @surface
+ *
+ * Same as lsm_cairo_image_surface_get_mipmap(). When @surface belongs to the
+ * cache, the mip levels built for it are counted against the cache budget.
+ *
+ * Returns: (transfer full): @surface or one of its downscaled copies.
+ *
+ * Since: 0.6
+ */
+
+cairo_surface_t *
+lsm_svg_image_cache_get_mipmap (cairo_surface_t *surface, double scale)
+{
+	LsmSvgImageCacheEntry *entry;
+	cairo_surface_t *level;
+	gsize size;
+
+	g_return_val_if_fail (surface != NULL, NULL);
+
+	level = lsm_cairo_image_surface_get_mipmap (surface, scale);
+	if (level == surface)
+		return level;
+
+	G_LOCK (image_cache);
+
+	/* Levels may be added concurrently by other renderings. The size is read under the cache lock, so
+	 * that the last accounting made for this surface includes all its levels. */
+	size = lsm_cairo_image_surface_get_mipmap_size (surface);
+
+	entry = image_cache_surfaces != NULL ? g_hash_table_lookup (image_cache_surfaces, surface) : NULL;
+	if (entry != NULL && entry->size != entry->image_size + size) {
+		image_cache_size = image_cache_size - entry->size + entry->image_size + size;
+		entry->size = entry->image_size + size;
+
+		_trim (image_cache_max_size);
+	}
+
+	G_UNLOCK (image_cache);
+
+	return level;
+}
+
+/**
+ * lsm_svg_image_cache_set_max_size:
+ * @max_size: maximum size of the cached image data, in bytes
+ *
+ * Sets the memory budget of the decoded image cache. Least recently used
+ * images are released until the cache fits into the new budget. A size of 0
+ * disables the cache.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_image_cache_set_max_size (gsize max_size)
+{
+	G_LOCK (image_cache);
+
+	image_cache_max_size = max_size;
+	if (image_cache != NULL)
+		_trim (max_size);
+
+	G_UNLOCK (image_cache);
+}
+
+/**
+ * lsm_svg_image_cache_get_max_size:
+ *
+ * Returns: the memory budget of the decoded image cache, in bytes.
+ *
+ * Since: 0.6
+ */
+
+gsize
+lsm_svg_image_cache_get_max_size (void)
+{
+	gsize max_size;
+
+	G_LOCK (image_cache);
+	max_size = image_cache_max_size;
+	G_UNLOCK (image_cache);
+
+	return max_size;
+}
+
+/**
+ * lsm_svg_image_cache_get_size:
+ *
+ * Returns: the size of the image data currently held by the decoded image
+ * cache, in bytes.
+ *
+ * Since: 0.6
+ */
+
+gsize
+lsm_svg_image_cache_get_size (void)
+{
+	gsize size;
+
+	G_LOCK (image_cache);
+	size = image_cache_size;
+	G_UNLOCK (image_cache);
+
+	return size;
+}
+
+/**
+ * lsm_svg_image_cache_cleanup:
+ *
+ * Releases all the images of the decoded image cache. Surfaces still
+ * referenced by their users stay valid. Called by lsm_shutdown().
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_image_cache_cleanup (void)
+{
+	G_LOCK (image_cache);
+
+	if (image_cache != NULL) {
+		g_queue_clear (&image_cache_lru);
+		g_hash_table_unref (image_cache_surfaces);
+		g_hash_table_unref (image_cache);
+		image_cache_surfaces = NULL;
+		image_cache = NULL;
+		image_cache_size = 0;
+	}
+
+	G_UNLOCK (image_cache);
+}
@@ -0,0 +1,39 @@
+/* Lasem
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifndef LSM_SVG_IMAGE_CACHE_H
+#define LSM_SVG_IMAGE_CACHE_H
+
+#include <lsmsvgtypes.h>
+#include <lsmdomdocument.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+#define LSM_SVG_IMAGE_CACHE_DEFAULT_MAX_SIZE	(64 * 1024 * 1024)
+
+cairo_surface_t *	lsm_svg_image_cache_get_surface 	(LsmDomDocument *document, const char *href);
+cairo_surface_t *	lsm_svg_image_cache_get_mipmap		(cairo_surface_t *surface, double scale);
+void			lsm_svg_image_cache_set_max_size	(gsize max_size);
+gsize			lsm_svg_image_cache_get_max_size	(void);
+gsize			lsm_svg_image_cache_get_size		(void);
+void			lsm_svg_image_cache_cleanup		(void);
+
+G_END_DECLS
+
+#endif
@@ -23,6 +23,7 @@
 
 #include <lsmsvgimageelement.h>
 #include <lsmsvgview.h>
+#include <lsmsvgimagecache.h>
 #include <lsmdebug.h>
 #include <lsmdomdocument.h>
 #include <stdio.h>
@@ -45,9 +46,9 @@ lsm_svg_image_element_set_attribute (LsmDomElement *self, const char *name, cons
 
 	LSM_DOM_ELEMENT_CLASS (parent_class)->set_attribute (self, name, value);
 
-	if (g_strcmp0 (name, "xlink:href") == 0 && image_element->pixbuf != NULL) {
-		g_object_unref (image_element->pixbuf);
-		image_element->pixbuf = NULL;
+	if (g_strcmp0 (name, "xlink:href") == 0 && image_element->surface != NULL) {
+		cairo_surface_destroy (image_element->surface);
+		image_element->surface = NULL;
 	}
 }
 
@@ -70,39 +71,18 @@ lsm_svg_image_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	image = LSM_SVG_IMAGE_ELEMENT (self);
 
-	if (image->pixbuf == NULL) {
+	if (image->surface == NULL) {
 		LsmDomDocument *document;
-		char *data;
-		gsize size;
 
 		document = lsm_dom_node_get_owner_document (LSM_DOM_NODE (self));
 
-		if (image->href.value != NULL) {
-			data = lsm_dom_document_get_href_data (document, image->href.value, &size);
-			if (data != NULL) {
-				GdkPixbufLoader *loader;
-
-				loader = gdk_pixbuf_loader_new ();
-
-				gdk_pixbuf_loader_write (loader, (guchar *) data, size, NULL);
-
-				g_free (data);
-
-				gdk_pixbuf_loader_close (loader, NULL);
-
-				image->pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
-				g_object_ref (image->pixbuf);
-
-				g_object_unref (loader);
-			} else
-				lsm_debug_render ("[SvgImageElement::render] Failed to load image '%s'",
-						  image->href.value);
-		} else
+		if (image->href.value != NULL)
+			image->surface = lsm_svg_image_cache_get_surface (document, image->href.value);
+		else
 			lsm_debug_render ("[SvgImageElement::render] Missing xlink:href attribute");
-
 	}
 
-	if (image->pixbuf == NULL)
+	if (image->surface == NULL)
 		return;
 
 	viewport.x      = lsm_svg_view_normalize_length (view, &image->x.length,
@@ -119,14 +99,14 @@ lsm_svg_image_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	viewbox.x = 0;
 	viewbox.y = 0;
-	viewbox.width = gdk_pixbuf_get_width (image->pixbuf);
-	viewbox.height = gdk_pixbuf_get_height (image->pixbuf);
+	viewbox.width = cairo_image_surface_get_width (image->surface);
+	viewbox.height = cairo_image_surface_get_height (image->surface);
 
 	lsm_svg_view_push_viewport (view, &viewport, &viewbox, &image->preserve_aspect_ratio.value, LSM_SVG_OVERFLOW_HIDDEN);
 
 	lsm_svg_view_show_viewport (view, &viewbox);
 
-	lsm_svg_view_show_pixbuf (view, image->pixbuf);
+	lsm_svg_view_show_surface (view, image->surface);
 
 	lsm_svg_view_pop_viewport (view);
 }
@@ -169,7 +149,7 @@ static const LsmSvgPreserveAspectRatio preserve_aspect_ratio_default = {
 static void
 lsm_svg_image_element_init (LsmSvgImageElement *self)
 {
-	self->pixbuf = NULL;
+	self->surface = NULL;
 	self->x.length = length_default;
 	self->y.length = length_default;
 	self->width.length = length_default;
@@ -182,8 +162,8 @@ lsm_svg_image_element_finalize (GObject *gobject)
 {
 	LsmSvgImageElement *image = LSM_SVG_IMAGE_ELEMENT (gobject);
 
-	if (image->pixbuf != NULL)
-		g_object_unref (image->pixbuf);
+	if (image->surface != NULL)
+		cairo_surface_destroy (image->surface);
 
 	parent_class->finalize (gobject);
 }
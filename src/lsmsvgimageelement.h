@@ -26,7 +26,7 @@
 
 #include <lsmsvgtypes.h>
 #include <lsmsvgtransformable.h>
-#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 
 G_BEGIN_DECLS
 
@@ -51,7 +51,7 @@ struct _LsmSvgImageElement {
 
 	LsmSvgPreserveAspectRatioAttribute	preserve_aspect_ratio;
 
-	GdkPixbuf *pixbuf;
+	cairo_surface_t *surface;
 };
 
 struct _LsmSvgImageElementClass {
@@ -38,6 +38,38 @@ _mask_element_get_node_name (LsmDomNode *node)
 
 /* LsmSvgElement implementation */
 
+static void
+_get_region (LsmSvgMaskElement *mask, LsmSvgView *view, const LsmBox *object_extents, LsmBox *region)
+{
+	gboolean is_object_bounding_box;
+
+	is_object_bounding_box = (mask->units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX);
+
+	if (is_object_bounding_box) {
+		LsmBox viewbox = {.x = 0.0, .y = .0, .width = 1.0, .height = 1.0};
+
+		lsm_svg_view_push_viewbox (view, &viewbox);
+	}
+
+	region->x      = lsm_svg_view_normalize_length (view, &mask->x.length,
+							LSM_SVG_LENGTH_DIRECTION_HORIZONTAL);
+	region->y      = lsm_svg_view_normalize_length (view, &mask->y.length,
+							LSM_SVG_LENGTH_DIRECTION_VERTICAL);
+	region->width  = lsm_svg_view_normalize_length (view, &mask->width.length,
+							LSM_SVG_LENGTH_DIRECTION_HORIZONTAL);
+	region->height = lsm_svg_view_normalize_length (view, &mask->height.length,
+							LSM_SVG_LENGTH_DIRECTION_VERTICAL);
+
+	if (is_object_bounding_box) {
+		lsm_svg_view_pop_viewbox (view);
+
+		region->x = region->x * object_extents->width + object_extents->x;
+		region->y = region->y * object_extents->height + object_extents->y;
+		region->width *= object_extents->width;
+		region->height *= object_extents->height;
+	}
+}
+
 static void
 lsm_svg_mask_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
@@ -61,31 +93,7 @@ lsm_svg_mask_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	mask_extents = lsm_svg_view_get_pattern_extents (view);
 
-	is_object_bounding_box = (mask->units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX);
-
-	if (is_object_bounding_box) {
-		LsmBox viewbox = {.x = 0.0, .y = .0, .width = 1.0, .height = 1.0};
-
-		lsm_svg_view_push_viewbox (view, &viewbox);
-	}
-
-	viewport.x      = lsm_svg_view_normalize_length (view, &mask->x.length,
-							 LSM_SVG_LENGTH_DIRECTION_HORIZONTAL);
-	viewport.y      = lsm_svg_view_normalize_length (view, &mask->y.length,
-							 LSM_SVG_LENGTH_DIRECTION_VERTICAL);
-	viewport.width  = lsm_svg_view_normalize_length (view, &mask->width.length,
-							 LSM_SVG_LENGTH_DIRECTION_HORIZONTAL);
-	viewport.height = lsm_svg_view_normalize_length (view, &mask->height.length,
-							 LSM_SVG_LENGTH_DIRECTION_VERTICAL);
-
-	if (is_object_bounding_box) {
-		lsm_svg_view_pop_viewbox (view);
-
-		viewport.x = viewport.x * mask_extents->width + mask_extents->x;
-		viewport.y = viewport.y * mask_extents->height + mask_extents->y;
-		viewport.width *= mask_extents->width;
-		viewport.height *= mask_extents->height;
-	}
+	_get_region (mask, view, mask_extents, &viewport);
 
 	if (viewport.width <= 0.0 || viewport.height <= 0.0) {
 		lsm_debug_render ("[LsmSvgMaskElement::render] Invalid viewport w = %g, h = %g",
@@ -95,6 +103,14 @@ lsm_svg_mask_element_render (LsmSvgElement *self, LsmSvgView *view)
 		return;
 	}
 
+	/* Parts of the mask outside of the clip area will never be used */
+	if (!lsm_svg_view_intersect_pattern_clip (view, &viewport)) {
+		lsm_debug_render ("[LsmSvgMaskElement::render] Mask outside of clip area");
+		lsm_svg_view_pop_composition (view);
+		lsm_svg_style_unref (style);
+		return;
+	}
+
 	if (!lsm_svg_view_create_surface_pattern (view, &viewport,
 						  NULL,
 						  LSM_SVG_VIEW_SURFACE_TYPE_IMAGE)) {
@@ -144,6 +160,43 @@ lsm_svg_mask_element_enable_rendering (LsmSvgElement *element)
 
 /* LsmSvgMaskElement implementation */
 
+/**
+ * lsm_svg_mask_element_get_region:
+ * @mask: a #LsmSvgMaskElement
+ * @view: a #LsmSvgView
+ * @object_extents: extents of the masked element, in user space
+ * @region: (out): mask region, in user space
+ *
+ * Computes the area outside of which the mask is fully transparent, using the current user space of @view.
+ *
+ * Returns: %TRUE if the region is not empty.
+ *
+ * Since: 0.6
+ */
+
+gboolean
+lsm_svg_mask_element_get_region (LsmSvgMaskElement *mask, LsmSvgView *view,
+				 const LsmBox *object_extents, LsmBox *region)
+{
+	LsmSvgStyle *style;
+
+	g_return_val_if_fail (LSM_IS_SVG_MASK_ELEMENT (mask), FALSE);
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), FALSE);
+	g_return_val_if_fail (object_extents != NULL, FALSE);
+	g_return_val_if_fail (region != NULL, FALSE);
+
+	/* Same style context as in lsm_svg_mask_element_render, for font relative lengths */
+	style = lsm_svg_style_new_inherited (NULL, &LSM_SVG_ELEMENT (mask)->property_bag);
+	lsm_svg_view_push_style (view, style);
+
+	_get_region (mask, view, object_extents, region);
+
+	lsm_svg_view_pop_style (view);
+	lsm_svg_style_unref (style);
+
+	return region->width > 0.0 && region->height > 0.0;
+}
+
 LsmDomNode *
 lsm_svg_mask_element_new (void)
 {
@@ -59,6 +59,9 @@ GType lsm_svg_mask_element_get_type (void);
 
 LsmDomNode * 	lsm_svg_mask_element_new 	(void);
 
+gboolean	lsm_svg_mask_element_get_region	(LsmSvgMaskElement *mask, LsmSvgView *view,
+						 const LsmBox *object_extents, LsmBox *region);
+
 G_END_DECLS
 
 #endif
@@ -35,8 +35,30 @@ lsm_svg_path_element_get_node_name (LsmDomNode *node)
 	return "path";
 }
 
+static void
+lsm_svg_path_element_set_attribute (LsmDomElement *self, const char *name, const char *value)
+{
+	LsmSvgPathElement *path = LSM_SVG_PATH_ELEMENT (self);
+
+	LSM_DOM_ELEMENT_CLASS (parent_class)->set_attribute (self, name, value);
+
+	if (g_strcmp0 (name, "d") == 0 && path->cairo_path != NULL) {
+		lsm_cairo_path_free (path->cairo_path);
+		path->cairo_path = NULL;
+	}
+}
+
 /* LsmSvgGraphic implementation */
 
+static const LsmCairoPath *
+_get_cairo_path (LsmSvgPathElement *path)
+{
+	if (path->cairo_path == NULL)
+		path->cairo_path = lsm_cairo_path_new_from_svg_path (path->d.value);
+
+	return path->cairo_path;
+}
+
 static void
 lsm_svg_path_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
@@ -44,7 +66,7 @@ lsm_svg_path_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	lsm_debug_render ("[LsmSvgPathElement::render]");
 
-	lsm_svg_view_show_path (view, path->d.value);
+	lsm_svg_view_show_cairo_path (view, _get_cairo_path (path));
 }
 
 static void
@@ -52,7 +74,7 @@ lsm_svg_path_element_get_extents (LsmSvgElement *self, LsmSvgView *view, LsmExte
 {
 	LsmSvgPathElement *path = LSM_SVG_PATH_ELEMENT (self);
 
-	lsm_svg_view_path_extents (view, path->d.value, extents);
+	lsm_svg_view_cairo_path_extents (view, _get_cairo_path (path), extents);
 }
 
 /* LsmSvgPathElement implementation */
@@ -66,11 +88,16 @@ lsm_svg_path_element_new (void)
 static void
 lsm_svg_path_element_init (LsmSvgPathElement *self)
 {
+	self->cairo_path = NULL;
 }
 
 static void
 lsm_svg_path_element_finalize (GObject *object)
 {
+	LsmSvgPathElement *path = LSM_SVG_PATH_ELEMENT (object);
+
+	lsm_cairo_path_free (path->cairo_path);
+
 	parent_class->finalize (object);
 }
 
@@ -89,6 +116,7 @@ lsm_svg_path_element_class_init (LsmSvgPathElementClass *s_rect_class)
 {
 	GObjectClass *object_class = G_OBJECT_CLASS (s_rect_class);
 	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (s_rect_class);
+	LsmDomElementClass *d_element_class = LSM_DOM_ELEMENT_CLASS (s_rect_class);
 	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (s_rect_class);
 
 	parent_class = g_type_class_peek_parent (s_rect_class);
@@ -97,6 +125,8 @@ lsm_svg_path_element_class_init (LsmSvgPathElementClass *s_rect_class)
 
 	d_node_class->get_node_name = lsm_svg_path_element_get_node_name;
 
+	d_element_class->set_attribute = lsm_svg_path_element_set_attribute;
+
 	s_element_class->category =
 		LSM_SVG_ELEMENT_CATEGORY_GRAPHICS |
 		LSM_SVG_ELEMENT_CATEGORY_SHAPE;
@@ -26,6 +26,7 @@
 
 #include <lsmsvgtypes.h>
 #include <lsmsvgtransformable.h>
+#include <lsmcairo.h>
 
 G_BEGIN_DECLS
 
@@ -43,6 +44,8 @@ struct _LsmSvgPathElement {
 
 	LsmAttribute 		d;
 	LsmSvgDoubleAttribute 	path_length;
+
+	LsmCairoPath		*cairo_path;
 };
 
 struct _LsmSvgPathElementClass {
@@ -148,6 +148,7 @@ lsm_svg_pattern_element_render (LsmSvgElement *self, LsmSvgView *view)
 	LsmBox viewport;
 	LsmBox image_box;
 	const LsmBox *pattern_extents;
+	const LsmBox *cache_extents;
 	LsmSvgStyle *style;
 	gboolean is_matrix_invertible = TRUE;
 
@@ -228,6 +229,20 @@ lsm_svg_pattern_element_render (LsmSvgElement *self, LsmSvgView *view)
 		return;
 	}
 
+	/* The pattern content only depends on the bounding box of the painted object when one of the
+	 * pattern units is objectBoundingBox */
+	if (pattern->units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX ||
+	    pattern->content_units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX)
+		cache_extents = pattern_extents;
+	else
+		cache_extents = NULL;
+
+	if (lsm_svg_view_set_cached_surface_pattern (view, self, cache_extents)) {
+		lsm_svg_view_pop_composition (view);
+		lsm_svg_style_unref (style);
+		return;
+	}
+
 	lsm_debug_render ("[LsmSvgPatternElement::render] Create pattern x = %g, y = %g, w = %g, h = %g",
 		   viewport.x, viewport.y, viewport.width, viewport.height);
 
@@ -278,6 +293,9 @@ lsm_svg_pattern_element_render (LsmSvgElement *self, LsmSvgView *view)
 		lsm_svg_view_pop_viewbox (view);
 	}
 
+	if (is_matrix_invertible)
+		lsm_svg_view_cache_surface_pattern (view, self, cache_extents);
+
 	lsm_svg_view_pop_composition (view);
 	lsm_svg_style_unref (style);
 }
@@ -23,6 +23,7 @@
 
 #include <lsmsvgpolygonelement.h>
 #include <lsmsvgview.h>
+#include <lsmstr.h>
 
 static GObjectClass *parent_class;
 
@@ -34,16 +35,43 @@ lsm_svg_polygon_element_get_node_name (LsmDomNode *node)
 	return "polygon";
 }
 
+static void
+lsm_svg_polygon_element_set_attribute (LsmDomElement *self, const char *name, const char *value)
+{
+	LsmSvgPolygonElement *polygon = LSM_SVG_POLYGON_ELEMENT (self);
+
+	LSM_DOM_ELEMENT_CLASS (parent_class)->set_attribute (self, name, value);
+
+	if (g_strcmp0 (name, "points") == 0 && polygon->is_point_data_valid) {
+		g_free (polygon->point_data);
+		polygon->point_data = NULL;
+		polygon->n_points = 0;
+		polygon->is_point_data_valid = FALSE;
+	}
+}
+
 /* LsmSvgElement implementation */
 
 /* LsmSvgGraphic implementation */
 
+static void
+_update_point_data (LsmSvgPolygonElement *polygon)
+{
+	if (polygon->is_point_data_valid)
+		return;
+
+	polygon->point_data = lsm_str_parse_point_list (polygon->points.value, &polygon->n_points, &polygon->point_extents);
+	polygon->is_point_data_valid = TRUE;
+}
+
 static void
 lsm_svg_polygon_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
 	LsmSvgPolygonElement *polygon = LSM_SVG_POLYGON_ELEMENT (self);
 
-	lsm_svg_view_show_polygon (view, polygon->points.value);
+	_update_point_data (polygon);
+
+	lsm_svg_view_show_polygon_points (view, polygon->n_points, polygon->point_data);
 }
 
 static void
@@ -51,7 +79,9 @@ lsm_svg_polygon_element_get_extents (LsmSvgElement *self, LsmSvgView *view, LsmE
 {
 	LsmSvgPolygonElement *polygon = LSM_SVG_POLYGON_ELEMENT (self);
 
-	lsm_str_point_list_exents (polygon->points.value, extents);
+	_update_point_data (polygon);
+
+	*extents = polygon->point_extents;
 }
 
 /* LsmSvgPolygonElement implementation */
@@ -65,6 +95,19 @@ lsm_svg_polygon_element_new (void)
 static void
 lsm_svg_polygon_element_init (LsmSvgPolygonElement *self)
 {
+	self->point_data = NULL;
+	self->n_points = 0;
+	self->is_point_data_valid = FALSE;
+}
+
+static void
+lsm_svg_polygon_element_finalize (GObject *object)
+{
+	LsmSvgPolygonElement *polygon = LSM_SVG_POLYGON_ELEMENT (object);
+
+	g_free (polygon->point_data);
+
+	parent_class->finalize (object);
 }
 
 /* LsmSvgPolygonElement class */
@@ -80,13 +123,19 @@ static const LsmAttributeInfos lsm_svg_polygon_element_attribute_infos[] = {
 static void
 lsm_svg_polygon_element_class_init (LsmSvgPolygonElementClass *s_rect_class)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS (s_rect_class);
 	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (s_rect_class);
+	LsmDomElementClass *d_element_class = LSM_DOM_ELEMENT_CLASS (s_rect_class);
 	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (s_rect_class);
 
 	parent_class = g_type_class_peek_parent (s_rect_class);
 
+	object_class->finalize = lsm_svg_polygon_element_finalize;
+
 	d_node_class->get_node_name = lsm_svg_polygon_element_get_node_name;
 
+	d_element_class->set_attribute = lsm_svg_polygon_element_set_attribute;
+
 	s_element_class->category =
 		LSM_SVG_ELEMENT_CATEGORY_GRAPHICS |
 		LSM_SVG_ELEMENT_CATEGORY_SHAPE |
@@ -42,6 +42,11 @@ struct _LsmSvgPolygonElement {
 	LsmSvgTransformable base;
 
 	LsmAttribute	points;
+
+	double		*point_data;
+	unsigned int	n_points;
+	LsmExtents	point_extents;
+	gboolean	is_point_data_valid;
 };
 
 struct _LsmSvgPolygonElementClass {
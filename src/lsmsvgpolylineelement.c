@@ -23,6 +23,7 @@
 
 #include <lsmsvgpolylineelement.h>
 #include <lsmsvgview.h>
+#include <lsmstr.h>
 
 static GObjectClass *parent_class;
 
@@ -34,16 +35,43 @@ lsm_svg_polyline_element_get_node_name (LsmDomNode *node)
 	return "polyline";
 }
 
+static void
+lsm_svg_polyline_element_set_attribute (LsmDomElement *self, const char *name, const char *value)
+{
+	LsmSvgPolylineElement *polyline = LSM_SVG_POLYLINE_ELEMENT (self);
+
+	LSM_DOM_ELEMENT_CLASS (parent_class)->set_attribute (self, name, value);
+
+	if (g_strcmp0 (name, "points") == 0 && polyline->is_point_data_valid) {
+		g_free (polyline->point_data);
+		polyline->point_data = NULL;
+		polyline->n_points = 0;
+		polyline->is_point_data_valid = FALSE;
+	}
+}
+
 /* LsmSvgElement implementation */
 
 /* LsmSvgGraphic implementation */
 
+static void
+_update_point_data (LsmSvgPolylineElement *polyline)
+{
+	if (polyline->is_point_data_valid)
+		return;
+
+	polyline->point_data = lsm_str_parse_point_list (polyline->points.value, &polyline->n_points, &polyline->point_extents);
+	polyline->is_point_data_valid = TRUE;
+}
+
 static void
 lsm_svg_polyline_element_render (LsmSvgElement *self, LsmSvgView *view)
 {
 	LsmSvgPolylineElement *polyline = LSM_SVG_POLYLINE_ELEMENT (self);
 
-	lsm_svg_view_show_polyline (view, polyline->points.value);
+	_update_point_data (polyline);
+
+	lsm_svg_view_show_polyline_points (view, polyline->n_points, polyline->point_data);
 }
 
 static void
@@ -51,7 +79,9 @@ lsm_svg_polyline_element_get_extents (LsmSvgElement *self, LsmSvgView *view, Lsm
 {
 	LsmSvgPolylineElement *polyline = LSM_SVG_POLYLINE_ELEMENT (self);
 
-	lsm_str_point_list_exents (polyline->points.value, extents);
+	_update_point_data (polyline);
+
+	*extents = polyline->point_extents;
 }
 
 /* LsmSvgPolylineElement implementation */
@@ -65,6 +95,19 @@ lsm_svg_polyline_element_new (void)
 static void
 lsm_svg_polyline_element_init (LsmSvgPolylineElement *self)
 {
+	self->point_data = NULL;
+	self->n_points = 0;
+	self->is_point_data_valid = FALSE;
+}
+
+static void
+lsm_svg_polyline_element_finalize (GObject *object)
+{
+	LsmSvgPolylineElement *polyline = LSM_SVG_POLYLINE_ELEMENT (object);
+
+	g_free (polyline->point_data);
+
+	parent_class->finalize (object);
 }
 
 /* LsmSvgPolylineElement class */
@@ -80,13 +123,19 @@ static const LsmAttributeInfos lsm_svg_polyline_element_attribute_infos[] = {
 static void
 lsm_svg_polyline_element_class_init (LsmSvgPolylineElementClass *s_rect_class)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS (s_rect_class);
 	LsmDomNodeClass *d_node_class = LSM_DOM_NODE_CLASS (s_rect_class);
+	LsmDomElementClass *d_element_class = LSM_DOM_ELEMENT_CLASS (s_rect_class);
 	LsmSvgElementClass *s_element_class = LSM_SVG_ELEMENT_CLASS (s_rect_class);
 
 	parent_class = g_type_class_peek_parent (s_rect_class);
 
+	object_class->finalize = lsm_svg_polyline_element_finalize;
+
 	d_node_class->get_node_name = lsm_svg_polyline_element_get_node_name;
 
+	d_element_class->set_attribute = lsm_svg_polyline_element_set_attribute;
+
 	s_element_class->category =
 		LSM_SVG_ELEMENT_CATEGORY_GRAPHICS |
 		LSM_SVG_ELEMENT_CATEGORY_SHAPE |
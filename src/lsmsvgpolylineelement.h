@@ -42,6 +42,11 @@ struct _LsmSvgPolylineElement {
 	LsmSvgTransformable base;
 
 	LsmAttribute	points;
+
+	double		*point_data;
+	unsigned int	n_points;
+	LsmExtents	point_extents;
+	gboolean	is_point_data_valid;
 };
 
 struct _LsmSvgPolylineElementClass {
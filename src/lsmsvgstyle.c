@@ -421,10 +421,9 @@ lsm_svg_get_property_manager (void)
 {
 	static LsmPropertyManager *manager = NULL;
 
-	if (G_LIKELY (manager != NULL))
-		return manager;
-
-	manager = lsm_property_manager_new (G_N_ELEMENTS (lsm_svg_property_infos), lsm_svg_property_infos);
+	if (g_once_init_enter (&manager))
+		g_once_init_leave (&manager, lsm_property_manager_new (G_N_ELEMENTS (lsm_svg_property_infos),
+								       lsm_svg_property_infos));
 
 	return manager;
 }
@@ -471,15 +470,18 @@ static const LsmSvgStyle *
 lsm_svg_get_default_style (void)
 {
 	static LsmSvgStyle *style = NULL;
-	LsmPropertyManager *property_manager = lsm_svg_get_property_manager ();
 
-	if (style != NULL)
-		return style;
+	if (g_once_init_enter (&style)) {
+		LsmPropertyManager *property_manager = lsm_svg_get_property_manager ();
+		LsmSvgStyle *default_style;
 
-	style = lsm_svg_style_new ();
-	style->font_size_px = 0.0;
+		default_style = lsm_svg_style_new ();
+		default_style->font_size_px = 0.0;
 
-	lsm_property_manager_init_default_style (property_manager, style);
+		lsm_property_manager_init_default_style (property_manager, default_style);
+
+		g_once_init_leave (&style, default_style);
+	}
 
 	return style;
 }
@@ -1488,3 +1488,27 @@ const LsmTraitClass lsm_svg_channel_selector_trait_class = {
 	.from_string = lsm_svg_channel_selector_trait_from_string,
 	.to_string = lsm_svg_channel_selector_trait_to_string
 };
+
+static gboolean
+lsm_svg_transfer_function_type_trait_from_string (LsmTrait *abstract_trait, char *string)
+{
+	LsmSvgTransferFunctionType *trait = (LsmSvgTransferFunctionType *) abstract_trait;
+
+	*trait = lsm_svg_transfer_function_type_from_string (string);
+
+	return *trait >= 0;
+}
+
+static char *
+lsm_svg_transfer_function_type_trait_to_string (LsmTrait *abstract_trait)
+{
+	LsmSvgTransferFunctionType *trait = (LsmSvgTransferFunctionType *) abstract_trait;
+
+	return g_strdup (lsm_svg_transfer_function_type_to_string (*trait));
+}
+
+const LsmTraitClass lsm_svg_transfer_function_type_trait_class = {
+	.size = sizeof (LsmSvgTransferFunctionType),
+	.from_string = lsm_svg_transfer_function_type_trait_from_string,
+	.to_string = lsm_svg_transfer_function_type_trait_to_string
+};
@@ -45,22 +45,30 @@ typedef struct _LsmSvgRectElement LsmSvgRectElement;
 typedef struct _LsmSvgCircleElement LsmSvgCircleElement;
 typedef struct _LsmSvgEllipseElement LsmSvgEllipseElement;
 typedef struct _LsmSvgFilterElement LsmSvgFilterElement;
+typedef struct _LsmSvgFilterGraph LsmSvgFilterGraph;
 typedef struct _LsmSvgFilterPrimitive LsmSvgFilterPrimitive;
 typedef struct _LsmSvgFilterBlend LsmSvgFilterBlend;
 typedef struct _LsmSvgFilterColorMatrix LsmSvgFilterColorMatrix;
+typedef struct _LsmSvgFilterComponentTransfer LsmSvgFilterComponentTransfer;
 typedef struct _LsmSvgFilterComposite LsmSvgFilterComposite;
 typedef struct _LsmSvgFilterConvolveMatrix LsmSvgFilterConvolveMatrix;
+typedef struct _LsmSvgFilterDiffuseLighting LsmSvgFilterDiffuseLighting;
 typedef struct _LsmSvgFilterDisplacementMap LsmSvgFilterDisplacementMap;
+typedef struct _LsmSvgFilterDistantLight LsmSvgFilterDistantLight;
 typedef struct _LsmSvgFilterFlood LsmSvgFilterFlood;
 typedef struct _LsmSvgFilterGaussianBlur LsmSvgFilterGaussianBlur;
 typedef struct _LsmSvgFilterImage LsmSvgFilterImage;
+typedef struct _LsmSvgFilterLightSource LsmSvgFilterLightSource;
 typedef struct _LsmSvgFilterMerge LsmSvgFilterMerge;
 typedef struct _LsmSvgFilterMergeNode LsmSvgFilterMergeNode;
 typedef struct _LsmSvgFilterMorphology LsmSvgFilterMorphology;
 typedef struct _LsmSvgFilterOffset LsmSvgFilterOffset;
+typedef struct _LsmSvgFilterPointLight LsmSvgFilterPointLight;
 typedef struct _LsmSvgFilterSpecularLighting LsmSvgFilterSpecularLighting;
+typedef struct _LsmSvgFilterSpotLight LsmSvgFilterSpotLight;
 typedef struct _LsmSvgFilterTurbulence LsmSvgFilterTurbulence;
 typedef struct _LsmSvgFilterTile LsmSvgFilterTile;
+typedef struct _LsmSvgFilterTransferFunction LsmSvgFilterTransferFunction;
 typedef struct _LsmSvgLineElement LsmSvgLineElement;
 typedef struct _LsmSvgPolylineElement LsmSvgPolylineElement;
 typedef struct _LsmSvgPolygonElement LsmSvgPolygonElement;
@@ -22,6 +22,8 @@
  */
 
 #include <lsmsvguseelement.h>
+#include <lsmsvgsymbolelement.h>
+#include <lsmsvggelement.h>
 #include <lsmsvgview.h>
 #include <lsmdebug.h>
 #include <lsmsvgdocument.h>
@@ -102,8 +104,28 @@ lsm_svg_use_element_render (LsmSvgElement *self, LsmSvgView *view)
 
 	lsm_svg_matrix_init_translate (&matrix, x, y);
 
-	if (lsm_svg_view_push_matrix (view, &matrix))
-		lsm_svg_element_render (LSM_SVG_ELEMENT (element), view);
+	if (lsm_svg_view_push_matrix (view, &matrix)) {
+		gboolean is_instanced = FALSE;
+
+		/* Containers referenced many times, like icons or sprites, are recorded once and
+		 * replayed. Symbol rendering depends on the use size. */
+		if (LSM_IS_SVG_SYMBOL_ELEMENT (element) || LSM_IS_SVG_G_ELEMENT (element)) {
+			double width = 0.0, height = 0.0;
+
+			if (LSM_IS_SVG_SYMBOL_ELEMENT (element)) {
+				width = lsm_svg_view_normalize_length (view, &use_element->width.length,
+								       LSM_SVG_LENGTH_DIRECTION_HORIZONTAL);
+				height = lsm_svg_view_normalize_length (view, &use_element->height.length,
+									LSM_SVG_LENGTH_DIRECTION_VERTICAL);
+			}
+
+			is_instanced = lsm_svg_view_render_instance (view, LSM_SVG_ELEMENT (element),
+								     width, height);
+		}
+
+		if (!is_instanced)
+			lsm_svg_element_render (LSM_SVG_ELEMENT (element), view);
+	}
 
 	lsm_svg_view_pop_matrix (view);
 
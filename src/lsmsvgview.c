@@ -22,18 +22,25 @@
  */
 
 #include <lsmdebug.h>
-#include <lsmsvgview.h>
+#include <lsmsvgviewprivate.h>
 #include <lsmsvgdocument.h>
 #include <lsmsvgelement.h>
 #include <lsmsvgsvgelement.h>
 #include <lsmsvgradialgradientelement.h>
-#include <lsmsvgfilterelement.h>
+#include <lsmsvgfilterelementprivate.h>
+#include <lsmsvgfilterprimitive.h>
 #include <lsmsvglineargradientelement.h>
 #include <lsmsvgpatternelement.h>
 #include <lsmsvgmarkerelement.h>
 #include <lsmsvgclippathelement.h>
 #include <lsmsvgmaskelement.h>
+#include <lsmsvgtextelement.h>
+#include <lsmsvggelement.h>
+#include <lsmsvgdefselement.h>
+#include <lsmsvggradientelement.h>
+#include <lsmsvgtransformable.h>
 #include <lsmsvgfiltersurface.h>
+#include <lsmsvgimagecache.h>
 #include <lsmcairo.h>
 #include <lsmstr.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -42,6 +49,10 @@
 #include <math.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 static gboolean lsm_svg_view_circular_reference_check (LsmSvgView *view, LsmSvgElement *element);
 
 static GObjectClass *parent_class;
@@ -51,15 +62,23 @@ typedef struct {
 	gboolean is_extents_defined;
 	LsmExtents extents;
 	PangoLayout *pango_layout;
+	GArray *glyph_runs;
 } LsmSvgViewPathInfos;
 
 static LsmSvgViewPathInfos default_path_infos = {
 	.is_text_path = FALSE,
 	.is_extents_defined = FALSE,
 	.extents = {0.0, 0.0, 0.0, 0.0},
-	.pango_layout = NULL
+	.pango_layout = NULL,
+	.glyph_runs = NULL
 };
 
+typedef struct {
+	cairo_scaled_font_t *scaled_font;
+	cairo_glyph_t *glyphs;
+	int n_glyphs;
+} LsmSvgViewGlyphRun;
+
 struct _LsmSvgViewPatternData {
 	cairo_t *old_cairo;
 
@@ -77,6 +96,90 @@ typedef struct {
 	gboolean enable_background;
 } LsmSvgViewBackground;
 
+typedef struct {
+	const LsmSvgElement *element;
+	unsigned int document_generation;
+	double xx, yx, xy, yy;
+	LsmBox object_extents;
+	LsmSvgViewbox viewbox;
+	double font_size_px;
+} LsmSvgViewPatternKey;
+
+typedef struct {
+	LsmSvgViewPatternKey key;
+	cairo_pattern_t *pattern;
+	gsize size;
+	GList *link;
+} LsmSvgViewPatternEntry;
+
+struct _LsmSvgViewPatternCache {
+	LsmDomDocument *document;
+	GHashTable *entries;
+	GQueue lru;
+	gsize size;
+	gsize max_size;
+};
+
+/* Header of the text layout keys, followed by the string and the font family */
+
+typedef struct {
+	double font_size_px;
+	int font_weight;
+	int font_stretch;
+	int font_style;
+	unsigned int n_string;
+	unsigned int n_family;
+} LsmSvgViewTextKey;
+
+typedef struct {
+	GBytes *key;
+	PangoLayout *layout;
+	PangoRectangle extents;
+	PangoRectangle line_extents;
+	int baseline;
+	GList *link;
+} LsmSvgViewTextLayout;
+
+struct _LsmSvgViewTextCache {
+	PangoContext *context;
+	cairo_matrix_t matrix;
+	cairo_font_options_t *font_options;
+	GHashTable *layouts;
+	GQueue lru;
+	unsigned int max_size;
+};
+
+typedef struct {
+	const LsmSvgElement *marker;
+	LsmSvgStyle *marker_style;
+	double stroke_width;
+	double font_size_px;
+	LsmSvgViewbox viewbox;
+} LsmSvgViewMarkerKey;
+
+typedef struct {
+	LsmSvgViewMarkerKey key;
+	cairo_pattern_t *pattern;
+	gboolean is_empty;
+	gboolean is_oriented;
+} LsmSvgViewMarkerInstance;
+
+typedef struct {
+	const LsmSvgElement *element;
+	LsmSvgStyle style;
+	LsmSvgViewbox viewbox;
+	double width;
+	double height;
+} LsmSvgViewUseKey;
+
+typedef struct {
+	LsmSvgViewUseKey key;
+	cairo_pattern_t *pattern;
+	gboolean is_empty;
+} LsmSvgViewUseInstance;
+
+typedef void (*LsmSvgViewInstanceRenderFunc) (LsmSvgView *view, LsmSvgElement *element, gpointer data);
+
 cairo_operator_t cairo_operators[] = {
 	CAIRO_OPERATOR_CLEAR,
 	CAIRO_OPERATOR_SOURCE,
@@ -192,6 +295,101 @@ _set_pattern (LsmSvgView *view, cairo_pattern_t *pattern)
 	view->last_stop_offset = 0.0;
 }
 
+double
+lsm_svg_view_get_pattern_opacity (LsmSvgView *view)
+{
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), 1.0);
+	g_return_val_if_fail (view->pattern_data != NULL, 1.0);
+
+	return view->pattern_data->opacity;
+}
+
+/**
+ * lsm_svg_view_intersect_pattern_clip:
+ * @view: a #LsmSvgView
+ * @box: (inout): a box in the user space of the pattern destination
+ *
+ * Restricts @box to the clip extents of the context the current pattern will
+ * be drawn on. Only valid for patterns painted without repetition.
+ *
+ * Returns: %FALSE if the resulting box is empty.
+ *
+ * Since: 0.6
+ */
+
+gboolean
+lsm_svg_view_intersect_pattern_clip (LsmSvgView *view, LsmBox *box)
+{
+	double x1, y1, x2, y2;
+
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), FALSE);
+	g_return_val_if_fail (view->pattern_data != NULL, FALSE);
+	g_return_val_if_fail (box != NULL, FALSE);
+
+	if (view->pattern_data->old_cairo == NULL ||
+	    view->debug_mask_unbounded)
+		return box->width > 0.0 && box->height > 0.0;
+
+	cairo_clip_extents (view->pattern_data->old_cairo, &x1, &y1, &x2, &y2);
+
+	x1 = MAX (x1, box->x);
+	y1 = MAX (y1, box->y);
+	x2 = MIN (x2, box->x + box->width);
+	y2 = MIN (y2, box->y + box->height);
+
+	if (x2 <= x1 || y2 <= y1)
+		return FALSE;
+
+	box->x = x1;
+	box->y = y1;
+	box->width = x2 - x1;
+	box->height = y2 - y1;
+
+	return TRUE;
+}
+
+/**
+ * lsm_svg_view_get_gradient_pattern:
+ * @view: a #LsmSvgView
+ *
+ * Returns: (transfer none): the gradient pattern being built, or %NULL.
+ *
+ * Since: 0.6
+ */
+
+cairo_pattern_t *
+lsm_svg_view_get_gradient_pattern (LsmSvgView *view)
+{
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), NULL);
+	g_return_val_if_fail (view->pattern_data != NULL, NULL);
+
+	return view->pattern_data->pattern;
+}
+
+/**
+ * lsm_svg_view_set_gradient_pattern:
+ * @view: a #LsmSvgView
+ * @pattern: (allow-none): a gradient pattern, or %NULL
+ *
+ * Replace the gradient pattern being built by a previously built one, which already holds its color
+ * stops. Only the pattern properties have to be set using lsm_svg_view_set_gradient_properties().
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_set_gradient_pattern (LsmSvgView *view, cairo_pattern_t *pattern)
+{
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+	g_return_if_fail (view->pattern_data != NULL);
+
+	if (view->pattern_data->pattern != NULL)
+		cairo_pattern_destroy (view->pattern_data->pattern);
+
+	view->pattern_data->pattern = pattern != NULL ? cairo_pattern_reference (pattern) : NULL;
+	view->last_stop_offset = 0.0;
+}
+
 void
 lsm_svg_view_create_radial_gradient (LsmSvgView *view,
 				     double cx, double cy,
@@ -311,6 +509,354 @@ lsm_svg_view_set_gradient_properties (LsmSvgView *view,
 	return TRUE;
 }
 
+static guint
+_hash_bytes (gconstpointer data, gsize size)
+{
+	const unsigned char *bytes = data;
+	guint hash = 5381;
+	gsize i;
+
+	for (i = 0; i < size; i++)
+		hash = hash * 33 + bytes[i];
+
+	return hash;
+}
+
+static guint
+_pattern_key_hash (gconstpointer data)
+{
+	return _hash_bytes (data, sizeof (LsmSvgViewPatternKey));
+}
+
+static gboolean
+_pattern_key_equal (gconstpointer a, gconstpointer b)
+{
+	return memcmp (a, b, sizeof (LsmSvgViewPatternKey)) == 0;
+}
+
+static void
+_pattern_entry_free (gpointer data)
+{
+	LsmSvgViewPatternEntry *entry = data;
+
+	cairo_pattern_destroy (entry->pattern);
+	g_free (entry);
+}
+
+static LsmSvgViewPatternCache *
+_pattern_cache_new (gsize max_size)
+{
+	LsmSvgViewPatternCache *cache;
+
+	cache = g_new0 (LsmSvgViewPatternCache, 1);
+	cache->entries = g_hash_table_new_full (_pattern_key_hash, _pattern_key_equal, NULL, _pattern_entry_free);
+	g_queue_init (&cache->lru);
+	cache->max_size = max_size;
+
+	return cache;
+}
+
+static void
+_pattern_cache_evict (LsmSvgViewPatternCache *cache, gsize max_size)
+{
+	LsmSvgViewPatternEntry *entry;
+
+	while (cache->size > max_size) {
+		entry = g_queue_pop_tail (&cache->lru);
+		if (entry == NULL)
+			break;
+
+		cache->size -= entry->size;
+		g_hash_table_remove (cache->entries, &entry->key);
+	}
+}
+
+static void
+_pattern_cache_set_document (LsmSvgViewPatternCache *cache, LsmDomDocument *document)
+{
+	if (cache->document == document)
+		return;
+
+	_pattern_cache_evict (cache, 0);
+
+	/* Keep the document alive, so element pointers used as keys can't be reused by another document */
+	if (cache->document != NULL)
+		g_object_unref (cache->document);
+	cache->document = document != NULL ? g_object_ref (document) : NULL;
+}
+
+static void
+_pattern_cache_free (LsmSvgViewPatternCache *cache)
+{
+	_pattern_cache_set_document (cache, NULL);
+	g_hash_table_unref (cache->entries);
+	g_free (cache);
+}
+
+static void
+_text_layout_free (gpointer data)
+{
+	LsmSvgViewTextLayout *text_layout = data;
+
+	g_bytes_unref (text_layout->key);
+	g_object_unref (text_layout->layout);
+	g_free (text_layout);
+}
+
+static LsmSvgViewTextCache *
+_text_cache_new (unsigned int max_size)
+{
+	LsmSvgViewTextCache *cache;
+
+	cache = g_new0 (LsmSvgViewTextCache, 1);
+	cache->layouts = g_hash_table_new_full (g_bytes_hash, g_bytes_equal, NULL, _text_layout_free);
+	g_queue_init (&cache->lru);
+	cache->max_size = max_size;
+
+	return cache;
+}
+
+static void
+_text_cache_evict (LsmSvgViewTextCache *cache, unsigned int max_size)
+{
+	LsmSvgViewTextLayout *text_layout;
+
+	while (g_queue_get_length (&cache->lru) > max_size) {
+		text_layout = g_queue_pop_tail (&cache->lru);
+		g_hash_table_remove (cache->layouts, text_layout->key);
+	}
+}
+
+/* Layouts are shaped in the pango context of the first rendering. They stay valid for the following
+ * renderings as long as the font options and the linear part of the initial transform are unchanged. */
+
+static void
+_text_cache_update_context (LsmSvgViewTextCache *cache, cairo_t *cairo, PangoLayout *pango_layout)
+{
+	cairo_font_options_t *font_options;
+	cairo_matrix_t matrix;
+
+	cairo_get_matrix (cairo, &matrix);
+	matrix.x0 = 0.0;
+	matrix.y0 = 0.0;
+
+	font_options = cairo_font_options_create ();
+	cairo_surface_get_font_options (cairo_get_target (cairo), font_options);
+
+	if (cache->context != NULL &&
+	    memcmp (&matrix, &cache->matrix, sizeof (cairo_matrix_t)) == 0 &&
+	    cairo_font_options_equal (font_options, cache->font_options)) {
+		cairo_font_options_destroy (font_options);
+		return;
+	}
+
+	lsm_debug_render ("[LsmSvgView::_text_cache_update_context] New pango context");
+
+	_text_cache_evict (cache, 0);
+
+	if (cache->font_options != NULL)
+		cairo_font_options_destroy (cache->font_options);
+	if (cache->context != NULL)
+		g_object_unref (cache->context);
+
+	cache->font_options = font_options;
+	cache->matrix = matrix;
+	cache->context = g_object_ref (pango_layout_get_context (pango_layout));
+}
+
+static void
+_text_cache_free (LsmSvgViewTextCache *cache)
+{
+	_text_cache_evict (cache, 0);
+	g_hash_table_unref (cache->layouts);
+	if (cache->font_options != NULL)
+		cairo_font_options_destroy (cache->font_options);
+	if (cache->context != NULL)
+		g_object_unref (cache->context);
+	g_free (cache);
+}
+
+static void
+_get_pattern_key (LsmSvgView *view, const LsmSvgElement *element, const LsmBox *object_extents,
+		  LsmSvgViewPatternKey *key)
+{
+	cairo_matrix_t matrix;
+
+	/* Zero the padding bytes, the key is hashed and compared as a byte array */
+	memset (key, 0, sizeof (LsmSvgViewPatternKey));
+
+	cairo_get_matrix (view->pattern_data->old_cairo, &matrix);
+
+	key->element = element;
+	key->document_generation = view->dom_view.document->generation;
+	key->xx = matrix.xx;
+	key->yx = matrix.yx;
+	key->xy = matrix.xy;
+	key->yy = matrix.yy;
+	if (object_extents != NULL)
+		key->object_extents = *object_extents;
+	key->viewbox = *((LsmSvgViewbox *) view->viewbox_stack->data);
+	key->font_size_px = view->style->font_size_px;
+}
+
+/**
+ * lsm_svg_view_set_cached_surface_pattern:
+ * @view: a #LsmSvgView
+ * @element: the element the pattern is rendered for
+ * @object_extents: (allow-none): bounding box of the painted object, or %NULL if the pattern doesn't
+ * depend on it
+ *
+ * Look for a surface pattern previously rendered for @element in the same context, and use it as the
+ * current pattern. The key includes the scale and rotation of the target context, but not its
+ * translation.
+ *
+ * Returns: %TRUE if a cached pattern was found.
+ *
+ * Since: 0.6
+ */
+
+gboolean
+lsm_svg_view_set_cached_surface_pattern (LsmSvgView *view, const LsmSvgElement *element,
+					 const LsmBox *object_extents)
+{
+	LsmSvgViewPatternCache *cache;
+	LsmSvgViewPatternEntry *entry;
+	LsmSvgViewPatternKey key;
+
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), FALSE);
+	g_return_val_if_fail (LSM_IS_SVG_ELEMENT (element), FALSE);
+	g_return_val_if_fail (view->pattern_data != NULL, FALSE);
+	g_return_val_if_fail (view->dom_view.cairo == NULL, FALSE);
+
+	cache = view->pattern_cache;
+	if (cache->max_size == 0)
+		return FALSE;
+
+	_pattern_cache_set_document (cache, view->dom_view.document);
+
+	_get_pattern_key (view, element, object_extents, &key);
+
+	entry = g_hash_table_lookup (cache->entries, &key);
+	if (entry == NULL)
+		return FALSE;
+
+	g_queue_unlink (&cache->lru, entry->link);
+	g_queue_push_head_link (&cache->lru, entry->link);
+
+	_set_pattern (view, cairo_pattern_reference (entry->pattern));
+
+	view->dom_view.is_resolution_dependent = TRUE;
+	view->n_pattern_cache_hits++;
+
+	lsm_debug_render ("[LsmSvgView::set_cached_surface_pattern] Use cached pattern");
+
+	return TRUE;
+}
+
+/**
+ * lsm_svg_view_cache_surface_pattern:
+ * @view: a #LsmSvgView
+ * @element: the element the pattern was rendered for
+ * @object_extents: (allow-none): bounding box of the painted object, or %NULL if the pattern doesn't
+ * depend on it
+ *
+ * Store the current surface pattern in the pattern cache, once its content is rendered. Only image
+ * surfaces are cached. The least recently used patterns are dropped when the cache size exceeds the
+ * limit set by lsm_svg_view_set_pattern_cache_size().
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_cache_surface_pattern (LsmSvgView *view, const LsmSvgElement *element,
+				    const LsmBox *object_extents)
+{
+	LsmSvgViewPatternCache *cache;
+	LsmSvgViewPatternEntry *entry;
+	cairo_surface_t *surface;
+	gsize size;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+	g_return_if_fail (LSM_IS_SVG_ELEMENT (element));
+	g_return_if_fail (view->pattern_data != NULL);
+
+	cache = view->pattern_cache;
+
+	if (view->pattern_data->pattern == NULL ||
+	    cairo_pattern_get_surface (view->pattern_data->pattern, &surface) != CAIRO_STATUS_SUCCESS ||
+	    cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_IMAGE)
+		return;
+
+	if (view->dom_view.cairo != NULL)
+		cairo_surface_flush (surface);
+
+	size = (gsize) cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface);
+	if (size > cache->max_size)
+		return;
+
+	_pattern_cache_set_document (cache, view->dom_view.document);
+
+	entry = g_new0 (LsmSvgViewPatternEntry, 1);
+	_get_pattern_key (view, element, object_extents, &entry->key);
+
+	if (g_hash_table_lookup (cache->entries, &entry->key) != NULL) {
+		g_free (entry);
+		return;
+	}
+
+	entry->pattern = cairo_pattern_reference (view->pattern_data->pattern);
+	entry->size = size;
+
+	g_hash_table_insert (cache->entries, &entry->key, entry);
+	g_queue_push_head (&cache->lru, entry);
+	entry->link = g_queue_peek_head_link (&cache->lru);
+	cache->size += size;
+
+	_pattern_cache_evict (cache, cache->max_size);
+
+	lsm_debug_render ("[LsmSvgView::cache_surface_pattern] Cache size = %" G_GSIZE_FORMAT " bytes", cache->size);
+}
+
+/**
+ * lsm_svg_view_set_text_cache_size:
+ * @view: a #LsmSvgView
+ * @max_size: maximum number of shaped text layouts
+ *
+ * Set the number of shaped text layouts kept between text renderings and extents queries. A zero size
+ * disables the cache. The default is %LSM_SVG_VIEW_DEFAULT_TEXT_CACHE_SIZE.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_set_text_cache_size (LsmSvgView *view, unsigned int max_size)
+{
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+
+	view->text_cache->max_size = max_size;
+	_text_cache_evict (view->text_cache, max_size);
+}
+
+/**
+ * lsm_svg_view_set_pattern_cache_size:
+ * @view: a #LsmSvgView
+ * @max_size: maximum memory used by cached pattern surfaces, in bytes
+ *
+ * Set the memory limit of the rendered pattern tile cache. A zero size disables the cache. The default is
+ * %LSM_SVG_VIEW_DEFAULT_PATTERN_CACHE_SIZE.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_set_pattern_cache_size (LsmSvgView *view, gsize max_size)
+{
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+
+	view->pattern_cache->max_size = max_size;
+	_pattern_cache_evict (view->pattern_cache, max_size);
+}
+
 gboolean
 lsm_svg_view_create_surface_pattern (LsmSvgView *view,
 				     const LsmBox *viewport,
@@ -384,6 +930,9 @@ lsm_svg_view_create_surface_pattern (LsmSvgView *view,
 			break;
 	}
 
+	if (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE)
+		view->dom_view.is_resolution_dependent = TRUE;
+
 	pattern = cairo_pattern_create_for_surface (surface);
 	view->dom_view.cairo = cairo_create (surface);
 	cairo_surface_destroy (surface);
@@ -530,6 +1079,235 @@ _set_color (LsmSvgView *view,
 	return TRUE;
 }
 
+static guint
+_marker_key_hash (gconstpointer data)
+{
+	return _hash_bytes (data, sizeof (LsmSvgViewMarkerKey));
+}
+
+static gboolean
+_marker_key_equal (gconstpointer a, gconstpointer b)
+{
+	return memcmp (a, b, sizeof (LsmSvgViewMarkerKey)) == 0;
+}
+
+static void
+_marker_instance_free (gpointer data)
+{
+	LsmSvgViewMarkerInstance *instance = data;
+
+	if (instance->pattern != NULL)
+		cairo_pattern_destroy (instance->pattern);
+	if (instance->key.marker_style != NULL)
+		lsm_svg_style_unref (instance->key.marker_style);
+	g_free (instance);
+}
+
+/* Renders an element once into a recording surface, in the current user space without the current
+ * transform, so that it can be replayed under any transform. Returns NULL if the rendering needs
+ * intermediate raster surfaces, which depend on the final resolution, or if it composites with the
+ * backdrop. */
+
+static cairo_pattern_t *
+_record_instance (LsmSvgView *view, LsmSvgElement *element,
+		  LsmSvgViewInstanceRenderFunc render, gpointer data,
+		  gboolean *is_empty)
+{
+	cairo_pattern_t *pattern = NULL;
+	cairo_surface_t *recording;
+	cairo_rectangle_t extents;
+	cairo_t *old_cairo;
+	gboolean is_resolution_dependent;
+	gboolean is_backdrop_dependent;
+
+	*is_empty = FALSE;
+
+	is_resolution_dependent = view->dom_view.is_resolution_dependent;
+	is_backdrop_dependent = view->is_backdrop_dependent;
+	view->dom_view.is_resolution_dependent = FALSE;
+	view->is_backdrop_dependent = FALSE;
+
+	old_cairo = view->dom_view.cairo;
+	recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+	view->dom_view.cairo = cairo_create (recording);
+
+	render (view, element, data);
+
+	cairo_destroy (view->dom_view.cairo);
+	view->dom_view.cairo = old_cairo;
+
+	cairo_recording_surface_ink_extents (recording, &extents.x, &extents.y, &extents.width, &extents.height);
+
+	if (view->dom_view.is_resolution_dependent || view->is_backdrop_dependent) {
+		lsm_debug_render ("[LsmSvgView::record_instance] Resolution or backdrop dependent, no instancing");
+	} else if (extents.width <= 0.0 || extents.height <= 0.0) {
+		*is_empty = TRUE;
+	} else if (extents.width < 1e6 && extents.height < 1e6) {
+		cairo_surface_t *surface;
+		cairo_t *cairo;
+
+		/* Replay into a bounded surface, so that stamps only touch the instance area */
+		extents.x -= 1.0;
+		extents.y -= 1.0;
+		extents.width += 2.0;
+		extents.height += 2.0;
+
+		surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, &extents);
+		cairo = cairo_create (surface);
+		cairo_set_source_surface (cairo, recording, 0.0, 0.0);
+		cairo_paint (cairo);
+		cairo_destroy (cairo);
+
+		pattern = cairo_pattern_create_for_surface (surface);
+		cairo_surface_destroy (surface);
+
+		lsm_debug_render ("[LsmSvgView::record_instance] New instance %g, %g, %g, %g",
+				  extents.x, extents.y, extents.width, extents.height);
+	}
+
+	cairo_surface_destroy (recording);
+
+	view->dom_view.is_resolution_dependent = is_resolution_dependent;
+	view->is_backdrop_dependent = is_backdrop_dependent;
+
+	return pattern;
+}
+
+static void
+_render_marker_instance (LsmSvgView *view, LsmSvgElement *element, gpointer data)
+{
+	lsm_svg_marker_element_render (LSM_SVG_MARKER_ELEMENT (element), view, *((double *) data), 0.0);
+}
+
+/* Markers are rendered once per stroke width and length resolution context, without the vertex
+ * orientation, and then stamped at each vertex. */
+
+static LsmSvgViewMarkerInstance *
+_get_marker_instance (LsmSvgView *view, LsmSvgMarkerElement *marker, double stroke_width)
+{
+	LsmSvgViewMarkerInstance *instance;
+	LsmSvgViewMarkerKey key;
+
+	memset (&key, 0, sizeof (LsmSvgViewMarkerKey));
+	key.marker = LSM_SVG_ELEMENT (marker);
+	key.marker_style = marker->style;
+	key.stroke_width = stroke_width;
+	key.font_size_px = view->style->font_size_px;
+	key.viewbox = *((LsmSvgViewbox *) view->viewbox_stack->data);
+
+	instance = g_hash_table_lookup (view->marker_instances, &key);
+	if (instance != NULL)
+		return instance;
+
+	/* The marker style is compared by address, keep it alive so that its address is not reused by
+	 * another style while the instance exists */
+	instance = g_new0 (LsmSvgViewMarkerInstance, 1);
+	instance->key = key;
+	if (instance->key.marker_style != NULL)
+		lsm_svg_style_ref (instance->key.marker_style);
+	instance->is_oriented = marker->orientation.value.type != LSM_SVG_ANGLE_TYPE_FIXED;
+	g_hash_table_insert (view->marker_instances, &instance->key, instance);
+
+	instance->pattern = _record_instance (view, LSM_SVG_ELEMENT (marker),
+					      _render_marker_instance, &stroke_width,
+					      &instance->is_empty);
+
+	return instance;
+}
+
+static guint
+_use_key_hash (gconstpointer data)
+{
+	return _hash_bytes (data, sizeof (LsmSvgViewUseKey));
+}
+
+static gboolean
+_use_key_equal (gconstpointer a, gconstpointer b)
+{
+	return memcmp (a, b, sizeof (LsmSvgViewUseKey)) == 0;
+}
+
+static void
+_use_instance_free (gpointer data)
+{
+	LsmSvgViewUseInstance *instance = data;
+
+	if (instance->pattern != NULL)
+		cairo_pattern_destroy (instance->pattern);
+	g_free (instance);
+}
+
+static void
+_render_use_instance (LsmSvgView *view, LsmSvgElement *element, gpointer data)
+{
+	lsm_svg_element_render (element, view);
+}
+
+/**
+ * lsm_svg_view_render_instance:
+ * @view: a #LsmSvgView
+ * @element: an element referenced by a use element
+ * @width: width of the referencing use element
+ * @height: height of the referencing use element
+ *
+ * Renders @element through a recording shared by all the references made during the current
+ * rendering with the same inherited style, length resolution context and use size. The recording is
+ * replayed under the current transform.
+ *
+ * Returns: %FALSE if @element can not be instanced and must be rendered directly.
+ *
+ * Since: 0.6
+ */
+
+gboolean
+lsm_svg_view_render_instance (LsmSvgView *view, LsmSvgElement *element, double width, double height)
+{
+	LsmSvgViewUseInstance *instance;
+	LsmSvgViewUseKey key;
+	cairo_t *cairo;
+
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), FALSE);
+	g_return_val_if_fail (LSM_IS_SVG_ELEMENT (element), FALSE);
+
+	cairo = view->dom_view.cairo;
+
+	/* Clip geometry is built as a path, not painted */
+	if (cairo == NULL || view->is_clipping)
+		return FALSE;
+
+	/* The style is copied up to the group opacity flag, as the referenced element may explicitly
+	 * inherit non inherited properties. Property pointers stay valid for the whole rendering. */
+	memset (&key, 0, sizeof (LsmSvgViewUseKey));
+	key.element = element;
+	memcpy (&key.style, view->style, offsetof (LsmSvgStyle, ignore_group_opacity));
+	key.viewbox = *((LsmSvgViewbox *) view->viewbox_stack->data);
+	key.width = width;
+	key.height = height;
+
+	instance = g_hash_table_lookup (view->use_instances, &key);
+	if (instance == NULL) {
+		instance = g_new0 (LsmSvgViewUseInstance, 1);
+		instance->key = key;
+		g_hash_table_insert (view->use_instances, &instance->key, instance);
+
+		instance->pattern = _record_instance (view, element, _render_use_instance, NULL,
+						      &instance->is_empty);
+	}
+
+	if (instance->is_empty)
+		return TRUE;
+
+	if (instance->pattern == NULL)
+		return FALSE;
+
+	cairo_save (cairo);
+	cairo_set_source (cairo, instance->pattern);
+	cairo_paint (cairo);
+	cairo_restore (cairo);
+
+	return TRUE;
+}
+
 static void
 paint_markers (LsmSvgView *view)
 {
@@ -549,6 +1327,8 @@ paint_markers (LsmSvgView *view)
 	double next_x, next_y;
 	cairo_path_data_type_t type;
 	cairo_path_data_type_t next_type;
+	LsmSvgViewMarkerInstance *current_instance = NULL;
+	gboolean use_instances;
 	double angle;
 	int i;
 
@@ -589,6 +1369,9 @@ paint_markers (LsmSvgView *view)
 	if (marker_end == NULL)
 		marker_end = marker;
 
+	/* Stamps are painted with the current operator */
+	use_instances = style->comp_op->value == LSM_SVG_COMP_OP_SRC_OVER;
+
 	path = cairo_copy_path (cairo);
 	cairo_new_path (cairo);
 
@@ -702,15 +1485,69 @@ paint_markers (LsmSvgView *view)
 			}
 
 			if (marker != NULL) {
-				cairo_save (cairo);
-				cairo_translate (cairo, x, y);
-				lsm_svg_marker_element_render (LSM_SVG_MARKER_ELEMENT (marker), view,
-							       stroke_width, angle);
-				cairo_restore (cairo);
+				LsmSvgViewMarkerInstance *instance = NULL;
+
+				if (use_instances)
+					instance = _get_marker_instance (view, LSM_SVG_MARKER_ELEMENT (marker),
+									 stroke_width);
+
+				if (instance != NULL && instance->pattern != NULL) {
+					cairo_matrix_t matrix;
+
+					/* Consecutive stamps of the same instance share the source */
+					if (instance != current_instance) {
+						if (current_instance == NULL)
+							cairo_save (cairo);
+						cairo_set_source (cairo, instance->pattern);
+						current_instance = instance;
+					}
+
+					cairo_matrix_init_translate (&matrix, x, y);
+					if (instance->is_oriented)
+						cairo_matrix_rotate (&matrix, angle);
+					cairo_matrix_invert (&matrix);
+					cairo_pattern_set_matrix (instance->pattern, &matrix);
+
+					cairo_paint (cairo);
+				} else if (instance == NULL || !instance->is_empty) {
+					cairo_save (cairo);
+					cairo_translate (cairo, x, y);
+					lsm_svg_marker_element_render (LSM_SVG_MARKER_ELEMENT (marker), view,
+								       stroke_width, angle);
+					cairo_restore (cairo);
+				}
 			}
 		}
 
-		cairo_path_destroy (path);
+		if (current_instance != NULL)
+			cairo_restore (cairo);
+	}
+
+	cairo_path_destroy (path);
+}
+
+static void
+_glyph_run_clear (gpointer data)
+{
+	LsmSvgViewGlyphRun *run = data;
+
+	cairo_scaled_font_destroy (run->scaled_font);
+	g_free (run->glyphs);
+}
+
+static void
+_emit_glyph_runs (cairo_t *cairo, GArray *runs, gboolean as_path)
+{
+	unsigned int i;
+
+	for (i = 0; i < runs->len; i++) {
+		LsmSvgViewGlyphRun *run = &g_array_index (runs, LsmSvgViewGlyphRun, i);
+
+		cairo_set_scaled_font (cairo, run->scaled_font);
+		if (as_path)
+			cairo_glyph_path (cairo, run->glyphs, run->n_glyphs);
+		else
+			cairo_show_glyphs (cairo, run->glyphs, run->n_glyphs);
 	}
 }
 
@@ -760,7 +1597,9 @@ paint (LsmSvgView *view, LsmSvgViewPathInfos *path_infos)
 			&style->fill->paint,
 			style->fill_opacity->value * (use_group ? 1.0 : group_opacity))) {
 
-		if (path_infos->is_text_path) {
+		if (path_infos->glyph_runs != NULL) {
+			_emit_glyph_runs (cairo, path_infos->glyph_runs, FALSE);
+		} else if (path_infos->is_text_path) {
 			pango_cairo_show_layout (cairo, path_infos->pango_layout);
 		} else {
 			cairo_set_fill_rule (cairo, style->fill_rule->value == LSM_SVG_FILL_RULE_EVEN_ODD ?
@@ -776,7 +1615,9 @@ paint (LsmSvgView *view, LsmSvgViewPathInfos *path_infos)
 			style->stroke_opacity->value * (use_group ? 1.0 : group_opacity))) {
 		double line_width;
 
-		if (path_infos->is_text_path) {
+		if (path_infos->glyph_runs != NULL) {
+			_emit_glyph_runs (cairo, path_infos->glyph_runs, TRUE);
+		} else if (path_infos->is_text_path) {
 			pango_cairo_layout_path (cairo, path_infos->pango_layout);
 		}
 
@@ -850,7 +1691,9 @@ process_path (LsmSvgView *view, LsmSvgViewPathInfos *path_infos)
 	g_return_if_fail (view->style != NULL);
 
 	if (view->is_clipping) {
-		if (path_infos->is_text_path)
+		if (path_infos->glyph_runs != NULL)
+			_emit_glyph_runs (view->dom_view.cairo, path_infos->glyph_runs, TRUE);
+		else if (path_infos->is_text_path)
 			pango_cairo_layout_path (view->dom_view.cairo, path_infos->pango_layout);
 		cairo_set_fill_rule (view->dom_view.cairo, view->style->clip_rule->value);
 	} else
@@ -988,10 +1831,38 @@ lsm_svg_view_show_path (LsmSvgView *view,
 	process_path (view, &path_infos);
 }
 
+void
+lsm_svg_view_show_cairo_path (LsmSvgView *view,
+			      const LsmCairoPath *path)
+{
+	LsmSvgViewPathInfos path_infos = default_path_infos;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+
+	lsm_cairo_emit_path (view->dom_view.cairo, path);
+
+	process_path (view, &path_infos);
+}
+
 void
 lsm_svg_view_path_extents (LsmSvgView *view,
 			   const char *path,
 			   LsmExtents *extents)
+{
+	LsmCairoPath *cairo_path;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+	g_return_if_fail (extents != NULL);
+
+	cairo_path = lsm_cairo_path_new_from_svg_path (path);
+	lsm_svg_view_cairo_path_extents (view, cairo_path, extents);
+	lsm_cairo_path_free (cairo_path);
+}
+
+void
+lsm_svg_view_cairo_path_extents (LsmSvgView *view,
+				 const LsmCairoPath *path,
+				 LsmExtents *extents)
 {
 	double x1, y1, x2, y2;
 
@@ -999,7 +1870,7 @@ lsm_svg_view_path_extents (LsmSvgView *view,
 	g_return_if_fail (extents != NULL);
 
 	cairo_new_path (view->dom_view.cairo);
-	lsm_cairo_emit_svg_path (view->dom_view.cairo, path);
+	lsm_cairo_emit_path (view->dom_view.cairo, path);
 	cairo_path_extents (view->dom_view.cairo, &x1, &y1, &x2, &y2);
 	cairo_new_path (view->dom_view.cairo);
 
@@ -1023,34 +1894,19 @@ lsm_svg_view_show_line (LsmSvgView *view, double x1, double y1, double x2, doubl
 }
 
 static void
-_show_points (LsmSvgView *view, const char *points, gboolean close_path)
+_show_points (LsmSvgView *view, unsigned int n_points, const double *points, gboolean close_path)
 {
 	LsmSvgViewPathInfos path_infos = default_path_infos;
-	char *str;
-	double values[2];
-	unsigned int n_values;
-	unsigned int count = 0;
-
-	if (points == NULL)
-		return;
+	unsigned int i;
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
-	str = (char *) points;
+	if (n_points == 0 || points == NULL)
+		return;
 
-	do {
-		n_values = lsm_str_parse_double_list (&str, 2, values);
-		if (n_values == 2) {
-			if (count == 0)
-				cairo_move_to (view->dom_view.cairo, values[0], values[1]);
-			else
-				cairo_line_to (view->dom_view.cairo, values[0], values[1]);
-		} else if (n_values != 0) {
-			cairo_new_path (view->dom_view.cairo);
-			return;
-		}
-		count++;
-	} while (n_values == 2);
+	cairo_move_to (view->dom_view.cairo, points[0], points[1]);
+	for (i = 1; i < n_points; i++)
+		cairo_line_to (view->dom_view.cairo, points[2 * i], points[2 * i + 1]);
 
 	if (close_path)
 		cairo_close_path (view->dom_view.cairo);
@@ -1058,40 +1914,79 @@ _show_points (LsmSvgView *view, const char *points, gboolean close_path)
 	process_path (view, &path_infos);
 }
 
+static void
+_show_point_list (LsmSvgView *view, const char *point_list, gboolean close_path)
+{
+	double *points;
+	unsigned int n_points;
+
+	points = lsm_str_parse_point_list (point_list, &n_points, NULL);
+	_show_points (view, n_points, points, close_path);
+	g_free (points);
+}
+
 void
 lsm_svg_view_show_polyline (LsmSvgView *view, const char *points)
 {
-	_show_points (view, points, FALSE);
+	_show_point_list (view, points, FALSE);
 }
 
 void
 lsm_svg_view_show_polygon (LsmSvgView *view, const char *points)
 {
-	_show_points (view, points, TRUE);
+	_show_point_list (view, points, TRUE);
 }
 
-static void
-_update_pango_layout (LsmSvgView *view, unsigned int n, char const *string, double x, double y,
-		      unsigned int n_dx, const double *dx,
-		      unsigned int n_dy, const double *dy,
-		      LsmSvgViewPathInfos *path_infos)
+void
+lsm_svg_view_show_polyline_points (LsmSvgView *view, unsigned int n_points, const double *points)
+{
+	_show_points (view, n_points, points, FALSE);
+}
+
+void
+lsm_svg_view_show_polygon_points (LsmSvgView *view, unsigned int n_points, const double *points)
+{
+	_show_points (view, n_points, points, TRUE);
+}
+
+static GBytes *
+_get_text_key (const LsmSvgStyle *style, unsigned int n, char const *string)
+{
+	LsmSvgViewTextKey key;
+	GByteArray *array;
+
+	/* Zero the padding bytes, the key is hashed and compared as a byte array */
+	memset (&key, 0, sizeof (LsmSvgViewTextKey));
+
+	key.font_size_px = style->font_size_px;
+	key.font_weight = style->font_weight->value;
+	key.font_stretch = style->font_stretch->value;
+	key.font_style = style->font_style->value;
+	key.n_string = n;
+	key.n_family = style->font_family->value != NULL ? strlen (style->font_family->value) : 0;
+
+	array = g_byte_array_sized_new (sizeof (LsmSvgViewTextKey) + key.n_string + key.n_family);
+	g_byte_array_append (array, (const guint8 *) &key, sizeof (LsmSvgViewTextKey));
+	g_byte_array_append (array, (const guint8 *) string, key.n_string);
+	g_byte_array_append (array, (const guint8 *) style->font_family->value, key.n_family);
+
+	return g_byte_array_free_to_bytes (array);
+}
+
+static LsmSvgViewTextLayout *
+_create_text_layout (LsmSvgView *view, GBytes *key, unsigned int n, char const *string)
 {
 	const LsmSvgStyle *style;
+	LsmSvgViewTextLayout *text_layout;
 	PangoLayout *pango_layout;
 	PangoFontDescription *font_description;
 	PangoStretch font_stretch;
 	PangoStyle font_style;
 	PangoLayoutIter *iter;
-	PangoRectangle rectangle;
-	PangoAttrList *attrs;
-	PangoAttribute *attr;
-	int baseline;
-	int i;
-	double x1, y1;
 
 	style = view->style;
 
-	pango_layout = view->pango_layout;
+	pango_layout = pango_layout_new (view->text_cache->context);
 	font_description = view->dom_view.font_description;
 
 	pango_font_description_set_family (font_description, style->font_family->value);
@@ -1145,51 +2040,78 @@ _update_pango_layout (LsmSvgView *view, unsigned int n, char const *string, doub
 	pango_font_description_set_style (font_description, font_style);
 
 	pango_layout_set_text (pango_layout, string, n);
+	pango_layout_set_font_description (pango_layout, font_description);
 
-	attrs = pango_attr_list_new ();
-#if 0
-	for (i = 0; i < n_dx; i++) {
+	text_layout = g_new0 (LsmSvgViewTextLayout, 1);
+	text_layout->key = g_bytes_ref (key);
+	text_layout->layout = pango_layout;
 
-		attr = pango_attr_letter_spacing_new (pango_units_from_double (dx[i]));
-		attr->start_index = i;
-		if (i < n_dx - 1)
-			attr->end_index = i + 1;
-		else
-			attr->end_index = PANGO_ATTR_INDEX_TO_TEXT_END;
+	pango_layout_get_extents (pango_layout, &text_layout->extents, NULL);
 
-		pango_attr_list_insert (attrs, attr);
-	}
-#endif
-	for (i = 0; i < n_dy; i++) {
+	iter = pango_layout_get_iter (pango_layout);
+	pango_layout_iter_get_line_extents (iter, NULL, &text_layout->line_extents);
+	text_layout->baseline = pango_layout_iter_get_baseline (iter);
+	pango_layout_iter_free (iter);
 
-		attr = pango_attr_rise_new (-pango_units_from_double (dy[i]));
-		attr->start_index = i;
-		if (i < n_dy - 1)
-			attr->end_index = i + 1;
-		else
-			attr->end_index = PANGO_ATTR_INDEX_TO_TEXT_END;
+	return text_layout;
+}
+
+/* The returned layout stays in the cache until the next call to _text_cache_evict () */
+
+static LsmSvgViewTextLayout *
+_get_text_layout (LsmSvgView *view, unsigned int n, char const *string)
+{
+	LsmSvgViewTextCache *cache;
+	LsmSvgViewTextLayout *text_layout;
+	GBytes *key;
 
-		pango_attr_list_insert (attrs, attr);
+	cache = view->text_cache;
+
+	key = _get_text_key (view->style, n, string);
+
+	text_layout = g_hash_table_lookup (cache->layouts, key);
+	if (text_layout != NULL) {
+		g_queue_unlink (&cache->lru, text_layout->link);
+		g_queue_push_head_link (&cache->lru, text_layout->link);
+	} else {
+		text_layout = _create_text_layout (view, key, n, string);
+		view->n_text_cache_misses++;
+
+		g_hash_table_insert (cache->layouts, text_layout->key, text_layout);
+		g_queue_push_head (&cache->lru, text_layout);
+		text_layout->link = g_queue_peek_head_link (&cache->lru);
 	}
-	pango_layout_set_attributes (pango_layout, attrs);
-	pango_attr_list_unref (attrs);
 
-	pango_layout_set_font_description (pango_layout, font_description);
-	pango_layout_get_extents (pango_layout, &rectangle, NULL);
+	g_bytes_unref (key);
+
+	return text_layout;
+}
+
+/* On return, path_infos holds a reference to the layout, as it may be evicted from the cache by the
+ * rendering of a text based paint server. */
+
+static void
+_update_pango_layout (LsmSvgView *view, unsigned int n, char const *string, double x, double y,
+		      LsmSvgViewPathInfos *path_infos,
+		      PangoRectangle *line_extents, double *baseline)
+{
+	LsmSvgViewTextLayout *text_layout;
+	const LsmSvgStyle *style;
+	double x1, y1;
+
+	style = view->style;
 
-	iter = pango_layout_get_iter (pango_layout);
-	baseline = pango_layout_iter_get_baseline (iter);
-	pango_layout_iter_free (iter);
+	text_layout = _get_text_layout (view, n, string);
 
-	x1 = x - pango_units_to_double (rectangle.x);
-	y1 = y - pango_units_to_double (baseline);
+	x1 = x - pango_units_to_double (text_layout->extents.x);
+	y1 = y - pango_units_to_double (text_layout->baseline);
 
 	switch (style->text_anchor->value) {
 		case LSM_SVG_TEXT_ANCHOR_END:
-			x1 -= pango_units_to_double (rectangle.width);
+			x1 -= pango_units_to_double (text_layout->extents.width);
 			break;
 		case LSM_SVG_TEXT_ANCHOR_MIDDLE:
-			x1 -= pango_units_to_double (rectangle.width) / 2.0;
+			x1 -= pango_units_to_double (text_layout->extents.width) / 2.0;
 			break;
 		case LSM_SVG_TEXT_ANCHOR_START:
 		default:
@@ -1200,64 +2122,309 @@ _update_pango_layout (LsmSvgView *view, unsigned int n, char const *string, doub
 	path_infos->is_extents_defined = TRUE;
 	path_infos->extents.x1 = x1;
 	path_infos->extents.y1 = y1;
-	path_infos->extents.x2 = x1 + pango_units_to_double (rectangle.width);
-	path_infos->extents.y2 = y1 + pango_units_to_double (rectangle.height);
-	path_infos->pango_layout = pango_layout;
+	path_infos->extents.x2 = x1 + pango_units_to_double (text_layout->extents.width);
+	path_infos->extents.y2 = y1 + pango_units_to_double (text_layout->extents.height);
+	path_infos->pango_layout = g_object_ref (text_layout->layout);
+
+	if (line_extents != NULL)
+		*line_extents = text_layout->line_extents;
+	if (baseline != NULL)
+		*baseline = pango_units_to_double (text_layout->baseline);
+
+	_text_cache_evict (view->text_cache, view->text_cache->max_size);
 }
 
-static gboolean
-_lock_pango_layout (LsmSvgView *view)
+/* Resolve the x, y, dx and dy lists of a text into absolute glyph positions. The string is shaped once, over
+ * all its lines and in visual order, which gives the natural position of each character. Characters are then
+ * walked in logical order: dx and dy accumulate into a shift applied to the following characters, and an
+ * absolute x or y resets the shift so the origin of the character lands on it. The origin of a character is
+ * its left edge in left to right runs, and its right edge in right to left runs, where the text progresses
+ * leftwards. Each absolute x or y starts a new text chunk, which is aligned according to text-anchor,
+ * mirrored for chunks starting with a right to left character. The result contains one run per glyph
+ * item. */
+
+static GArray *
+_create_glyph_runs (LsmSvgView *view, char const *string, double x, double y,
+		    unsigned int n_x, const double *xs, unsigned int n_y, const double *ys,
+		    unsigned int n_dx, const double *dx, unsigned int n_dy, const double *dy,
+		    LsmExtents *extents, double *x_end, double *y_end)
 {
-	/* A text may be painted with a text based pattern. In this case,
-	 * we take care to create a new pango layout if the current one is in use. */
-	if (view->is_pango_layout_in_use) {
-		PangoContext *pango_context;
+	LsmSvgViewTextLayout *text_layout;
+	PangoLayoutIter *iter;
+	PangoLayoutLine *line;
+	PangoRectangle line_extents;
+	GArray *runs;
+	unsigned int n_bytes, n_chars, i, c;
+	unsigned int chunk_start;
+	int *char_indices;
+	gboolean *is_rtl;
+	double *lefts;
+	double *advances;
+	double *lines;
+	double *shifts;
+	double shift_x, shift_y;
+	double first_baseline;
+	double ascent, descent;
+	double anchor;
+	double line_end;
+
+	n_bytes = strlen (string);
+	n_chars = g_utf8_strlen (string, n_bytes);
+
+	text_layout = _get_text_layout (view, n_bytes, string);
+
+	char_indices = g_new (int, n_bytes + 1);
+	is_rtl = g_new0 (gboolean, n_chars);
+	lefts = g_new (double, n_chars);
+	advances = g_new0 (double, n_chars);
+	lines = g_new0 (double, n_chars);
+	shifts = g_new (double, 2 * n_chars);
+
+	for (i = 0, c = 0; i < n_bytes; c++) {
+		unsigned int next = g_utf8_next_char (string + i) - string;
+
+		for (; i < next && i < n_bytes; i++)
+			char_indices[i] = c;
+	}
+	char_indices[n_bytes] = n_chars;
 
-		pango_context = pango_layout_get_context (view->pango_layout);
-		view->pango_layout_stack = g_slist_prepend (view->pango_layout_stack, view->pango_layout);
-		view->pango_layout = pango_layout_new (pango_context);
+	for (c = 0; c < n_chars; c++)
+		lefts[c] = G_MAXDOUBLE;
 
-		lsm_debug_render ("[LsmSvgView::_lock_pango_layout] Create a new pango layout");
+	first_baseline = pango_units_to_double (text_layout->baseline);
 
-		return TRUE;
+	/* Natural position of the characters. Cluster advances are accumulated on the first character of the
+	 * cluster, the baseline offset of the line of each character is kept in lines. */
+	iter = pango_layout_get_iter (text_layout->layout);
+	do {
+		PangoGlyphItem *glyph_item = pango_layout_iter_get_run_readonly (iter);
+		PangoRectangle run_extents;
+		double glyph_x;
+		double line_y;
+		int j;
+
+		if (glyph_item == NULL)
+			continue;
+
+		pango_layout_iter_get_run_extents (iter, NULL, &run_extents);
+		glyph_x = pango_units_to_double (run_extents.x);
+		line_y = pango_units_to_double (pango_layout_iter_get_baseline (iter)) - first_baseline;
+
+		for (j = 0; j < glyph_item->glyphs->num_glyphs; j++) {
+			double width = pango_units_to_double (glyph_item->glyphs->glyphs[j].geometry.width);
+
+			c = char_indices[glyph_item->item->offset + glyph_item->glyphs->log_clusters[j]];
+			if (c < n_chars) {
+				lefts[c] = MIN (lefts[c], glyph_x);
+				advances[c] += width;
+				lines[c] = line_y;
+				is_rtl[c] = (glyph_item->item->analysis.level % 2) != 0;
+			}
+
+			glyph_x += width;
+		}
+	} while (pango_layout_iter_next_run (iter));
+	pango_layout_iter_free (iter);
+
+	/* Characters without glyph, like line separators, sit at the end of the previous one */
+	for (c = 0; c < n_chars; c++)
+		if (lefts[c] == G_MAXDOUBLE) {
+			if (c == 0)
+				lefts[c] = 0.0;
+			else {
+				lefts[c] = is_rtl[c - 1] ? lefts[c - 1] : lefts[c - 1] + advances[c - 1];
+				lines[c] = lines[c - 1];
+				is_rtl[c] = is_rtl[c - 1];
+			}
+		}
+
+	anchor = view->style->text_anchor->value == LSM_SVG_TEXT_ANCHOR_END ? 1.0 :
+		view->style->text_anchor->value == LSM_SVG_TEXT_ANCHOR_MIDDLE ? 0.5 : 0.0;
+
+	/* The current text position acts as an absolute position for the first character */
+	shift_x = 0.0;
+	shift_y = 0.0;
+	chunk_start = 0;
+	for (c = 0; c <= n_chars; c++) {
+		gboolean is_chunk_start = c == 0 || c < n_x || c < n_y;
+
+		if (c > chunk_start && (c == n_chars || is_chunk_start) && anchor != 0.0) {
+			double x1 = G_MAXDOUBLE, x2 = -G_MAXDOUBLE;
+			double shift;
+
+			for (i = chunk_start; i < c; i++) {
+				x1 = MIN (x1, lefts[i] + shifts[2 * i]);
+				x2 = MAX (x2, lefts[i] + advances[i] + shifts[2 * i]);
+			}
+
+			shift = anchor * (x2 - x1);
+			if (is_rtl[chunk_start])
+				shift = -shift;
+
+			for (i = chunk_start; i < c; i++)
+				shifts[2 * i] -= shift;
+			shift_x -= shift;
+		}
+
+		if (c == n_chars)
+			break;
+
+		if (is_chunk_start)
+			chunk_start = c;
+
+		if (c < n_x || c == 0)
+			shift_x = (c < n_x ? xs[c] : x) - (is_rtl[c] ? lefts[c] + advances[c] : lefts[c]);
+		if (c < n_y || c == 0)
+			shift_y = (c < n_y ? ys[c] : y) - lines[c];
+		if (c < n_dx)
+			shift_x += dx[c];
+		if (c < n_dy)
+			shift_y += dy[c];
+
+		shifts[2 * c] = shift_x;
+		shifts[2 * c + 1] = shift_y;
 	}
 
-	view->is_pango_layout_in_use = TRUE;
+	/* The end position follows the last line in its base direction, with the shift of the last
+	 * character */
+	line = pango_layout_get_line_readonly (text_layout->layout,
+					       pango_layout_get_line_count (text_layout->layout) - 1);
+	if (line != NULL) {
+		pango_layout_line_get_extents (line, NULL, &line_extents);
+		line_end = pango_units_to_double (line->resolved_dir == PANGO_DIRECTION_RTL ?
+						  line_extents.x : line_extents.x + line_extents.width);
+	} else
+		line_end = 0.0;
 
-	return FALSE;
+	if (n_chars > 0) {
+		*x_end = line_end + shifts[2 * (n_chars - 1)];
+		*y_end = lines[n_chars - 1] + shifts[2 * (n_chars - 1) + 1];
+	} else {
+		*x_end = x;
+		*y_end = y;
+	}
+
+	ascent = first_baseline;
+	descent = pango_units_to_double (text_layout->line_extents.height) - ascent;
+
+	extents->x1 = extents->y1 = G_MAXDOUBLE;
+	extents->x2 = extents->y2 = -G_MAXDOUBLE;
+	for (c = 0; c < n_chars; c++) {
+		extents->x1 = MIN (extents->x1, lefts[c] + shifts[2 * c]);
+		extents->x2 = MAX (extents->x2, lefts[c] + advances[c] + shifts[2 * c]);
+		extents->y1 = MIN (extents->y1, lines[c] + shifts[2 * c + 1] - ascent);
+		extents->y2 = MAX (extents->y2, lines[c] + shifts[2 * c + 1] + descent);
+	}
+
+	runs = g_array_new (FALSE, FALSE, sizeof (LsmSvgViewGlyphRun));
+	g_array_set_clear_func (runs, _glyph_run_clear);
+
+	iter = pango_layout_get_iter (text_layout->layout);
+	do {
+		PangoGlyphItem *glyph_item = pango_layout_iter_get_run_readonly (iter);
+		PangoGlyphString *glyphs;
+		PangoRectangle run_extents;
+		LsmSvgViewGlyphRun run;
+		double glyph_x;
+		int j;
+
+		if (glyph_item == NULL || glyph_item->glyphs->num_glyphs < 1)
+			continue;
+
+		glyphs = glyph_item->glyphs;
+
+		pango_layout_iter_get_run_extents (iter, NULL, &run_extents);
+		glyph_x = pango_units_to_double (run_extents.x);
+
+		run.scaled_font = cairo_scaled_font_reference
+			(pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (glyph_item->item->analysis.font)));
+		run.glyphs = g_new (cairo_glyph_t, glyphs->num_glyphs);
+		run.n_glyphs = 0;
+
+		for (j = 0; j < glyphs->num_glyphs; j++) {
+			PangoGlyphInfo *info = &glyphs->glyphs[j];
+
+			c = char_indices[glyph_item->item->offset + glyphs->log_clusters[j]];
+			if (c < n_chars && info->glyph != PANGO_GLYPH_EMPTY &&
+			    (info->glyph & PANGO_GLYPH_UNKNOWN_FLAG) == 0) {
+				run.glyphs[run.n_glyphs].index = info->glyph;
+				run.glyphs[run.n_glyphs].x = glyph_x + shifts[2 * c] +
+					pango_units_to_double (info->geometry.x_offset);
+				run.glyphs[run.n_glyphs].y = lines[c] + shifts[2 * c + 1] +
+					pango_units_to_double (info->geometry.y_offset);
+				run.n_glyphs++;
+			}
+
+			glyph_x += pango_units_to_double (info->geometry.width);
+		}
+
+		if (run.n_glyphs > 0)
+			g_array_append_val (runs, run);
+		else
+			_glyph_run_clear (&run);
+	} while (pango_layout_iter_next_run (iter));
+	pango_layout_iter_free (iter);
+
+	g_free (char_indices);
+	g_free (is_rtl);
+	g_free (lefts);
+	g_free (advances);
+	g_free (lines);
+	g_free (shifts);
+
+	_text_cache_evict (view->text_cache, view->text_cache->max_size);
+
+	return runs;
 }
 
 static void
-_unlock_pango_layout (LsmSvgView *view, gboolean need_pop)
+_show_positioned_text (LsmSvgView *view, char const *string,
+		       unsigned int n_x, double *x, unsigned int n_y, double *y,
+		       unsigned int n_dx, double *dx, unsigned int n_dy, double *dy)
 {
+	LsmSvgViewPathInfos path_infos = default_path_infos;
+	gboolean is_vertical;
+	double x_text, y_text;
+	double x_end, y_end;
+	cairo_t *cairo;
 
-	if (need_pop) {
-		lsm_debug_render ("[LsmSvgView::_unlock_pango_layout] Free the child pango layout");
+	cairo = view->dom_view.cairo;
 
-		if (view->pango_layout != NULL) {
-			g_object_unref (view->pango_layout);
+	lsm_debug_render ("[LsmSvgView::show_positioned_text] Show '%s' (%u x, %u y, %u dx, %u dy)",
+			  string, n_x, n_y, n_dx, n_dy);
 
-			view->pango_layout = view->pango_layout_stack->data;
-			view->pango_layout_stack = g_slist_delete_link (view->pango_layout_stack,
-									view->pango_layout_stack);
-		} else
-			g_warning ("[LsmSvgView::_unlock_pango_layout] Pango layout stack empty");
+	cairo_get_current_point (cairo, &x_text, &y_text);
+
+	path_infos.is_text_path = TRUE;
+	path_infos.is_extents_defined = TRUE;
+	path_infos.glyph_runs = _create_glyph_runs (view, string, x_text, y_text,
+						    n_x, x, n_y, y, n_dx, dx, n_dy, dy,
+						    &path_infos.extents, &x_end, &y_end);
+
+	is_vertical = view->style->writing_mode->value == LSM_SVG_WRITING_MODE_TB ||
+		view->style->writing_mode->value == LSM_SVG_WRITING_MODE_TB_RL;
+
+	if (is_vertical) {
+		cairo_save (cairo);
+		cairo_rotate (cairo, M_PI / 2.0);
 	}
 
-	view->is_pango_layout_in_use = FALSE;
+	process_path (view, &path_infos);
+
+	if (is_vertical)
+		cairo_restore (cairo);
+
+	g_array_unref (path_infos.glyph_runs);
+
+	cairo_move_to (cairo, x_end, y_end);
 }
 
 static void
-_show_text (LsmSvgView *view,
-	    unsigned int n, char const *string, 
-	    unsigned int n_x, double *x, unsigned int n_y, double *y,
-	    unsigned int n_dx, double *dx, unsigned int n_dy, double *dy)
+_show_text (LsmSvgView *view, unsigned int n, char const *string, double *x, double *y)
 {
 	LsmSvgViewPathInfos path_infos = default_path_infos;
 	PangoRectangle extents;
-	PangoLayoutIter *layout_iter;
 	const LsmSvgStyle *style;
-	gboolean need_pop;
 	double x_text;
 	double y_text;
 	double x_end, y_end;
@@ -1272,16 +2439,13 @@ _show_text (LsmSvgView *view,
 	lsm_debug_render ("[LsmSvgView::show_text] Show '%s' at %g,%g (%g px)", string,
 			 x != NULL ? *x : 0, y != NULL ? *y : 0, style->font_size_px);
 
-	need_pop = _lock_pango_layout (view);
-
 	cairo_get_current_point (cairo, &x_text, &y_text);
 	if (x != NULL)
 		x_text = x[0];
 	if (y != NULL)
 		y_text = y[0];
 
-
-	_update_pango_layout (view, n, string, x_text, y_text, n_dx, dx, n_dy, dy, &path_infos);
+	_update_pango_layout (view, n, string, x_text, y_text, &path_infos, &extents, &baseline);
 
 	if (style->writing_mode->value == LSM_SVG_WRITING_MODE_TB ||
 	    style->writing_mode->value == LSM_SVG_WRITING_MODE_TB_RL) {
@@ -1298,11 +2462,6 @@ _show_text (LsmSvgView *view,
 		process_path (view, &path_infos);
 	}
 
-	layout_iter = pango_layout_get_iter (view->pango_layout);
-	pango_layout_iter_get_line_extents (layout_iter, NULL, &extents);
-	baseline = pango_units_to_double (pango_layout_iter_get_baseline (layout_iter));
-	pango_layout_iter_free (layout_iter);
-
 	x_end = pango_units_to_double (extents.x + extents.width) + path_infos.extents.x1;
 	y_end = pango_units_to_double (extents.y) + baseline + path_infos.extents.y1;
 
@@ -1336,7 +2495,7 @@ _show_text (LsmSvgView *view,
 
 	cairo_move_to (cairo, x_end, y_end);
 
-	_unlock_pango_layout (view, need_pop);
+	g_object_unref (path_infos.pango_layout);
 }
 
 void
@@ -1360,9 +2519,6 @@ lsm_svg_view_show_text (LsmSvgView *view, char const *string,
 			unsigned int n_x, double *x, unsigned int n_y, double *y,
 			unsigned int n_dx, double *dx, unsigned int n_dy, double *dy)
 {
-	unsigned int n, i;
-	char *iter = (char *) string;
-
 	if (string == NULL || string[0] == '\0')
 		return;
 
@@ -1372,38 +2528,10 @@ lsm_svg_view_show_text (LsmSvgView *view, char const *string,
 	g_return_if_fail (n_dx > 0 || dx == NULL);
 	g_return_if_fail (n_dy > 0 || dy == NULL);
 
-	n = MAX (n_x, n_y);
-	if (n <= 1) {
-		_show_text (view, strlen (string), string, n_x, x, n_y, y, n_dx, dx, n_dy, dy);
-		return;
-	}
-
-	for (i = 0; (i < n - 1) && iter[0] != '\0'; i++) {
-		char *next_char;
-
-		next_char = g_utf8_next_char (iter);
-		_show_text (view, next_char - iter, iter,
-			    i < n_x ? n_x - i : 0,
-			    i < n_x ? &x[i] : NULL,
-			    i < n_y ? n_y - i : 0,
-			    i < n_y ? &y[i] : NULL,
-			    i < n_dx ? n_dx - i : 0,
-			    i < n_dx ? &dx[i] : NULL,
-			    i < n_dy ? n_dy - i : 0,
-			    i < n_dy ? &dy[i] : NULL);
-		iter = next_char;
-	}
-
-	if (iter[0] != '\0')
-		_show_text (view, strlen (iter), iter,
-			    i < n_x ? n_x - i : 0,
-			    i < n_x ? &x[i] : NULL,
-			    i < n_y ? n_y - i : 0,
-			    i < n_y ? &y[i] : NULL,
-			    i < n_dx ? n_dx - i : 0,
-			    i < n_dx ? &dx[i] : NULL,
-			    i < n_dy ? n_dy - i : 0,
-			    i < n_dy ? &dy[i] : NULL);
+	if (n_x > 1 || n_y > 1 || n_dx > 0 || n_dy > 0)
+		_show_positioned_text (view, string, n_x, x, n_y, y, n_dx, dx, n_dy, dy);
+	else
+		_show_text (view, strlen (string), string, x, y);
 }
 
 void
@@ -1413,7 +2541,6 @@ lsm_svg_view_text_extents (LsmSvgView *view, char const *string,
 			   LsmExtents *extents)
 {
 	LsmSvgViewPathInfos path_infos = default_path_infos;
-	gboolean need_pop;
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 	g_return_if_fail (extents != NULL);
@@ -1424,13 +2551,20 @@ lsm_svg_view_text_extents (LsmSvgView *view, char const *string,
 		extents->y1 = 0;
 		extents->y1 = 0;
 		extents->y2 = 0;
+		return;
 	}
 
-	need_pop = _lock_pango_layout (view);
+	if (n_dx > 0 || n_dy > 0) {
+		double x_end, y_end;
 
-	_update_pango_layout (view, strlen (string), string, x, y, n_dx, dx, n_dy, dy, &path_infos);
+		g_array_unref (_create_glyph_runs (view, string, x, y, 0, NULL, 0, NULL, n_dx, dx, n_dy, dy,
+						   extents, &x_end, &y_end));
+		return;
+	}
 
-	_unlock_pango_layout (view, need_pop);
+	_update_pango_layout (view, strlen (string), string, x, y, &path_infos, NULL, NULL);
+
+	g_object_unref (path_infos.pango_layout);
 
 	*extents = path_infos.extents;
 }
@@ -1445,6 +2579,68 @@ lsm_svg_view_show_pixbuf (LsmSvgView *view, GdkPixbuf *pixbuf)
 	cairo_paint (view->dom_view.cairo);
 }
 
+/**
+ * lsm_svg_view_show_surface:
+ * @view: a #LsmSvgView
+ * @surface: an image surface
+ *
+ * Paints @surface at the origin of the current user space, one surface pixel
+ * per user unit. Downscaled image surfaces are painted from the matching level
+ * of their mip pyramid.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_show_surface (LsmSvgView *view, cairo_surface_t *surface)
+{
+	cairo_t *cairo;
+	cairo_surface_t *level;
+	double x_dx = 1.0, x_dy = 0.0;
+	double y_dx = 0.0, y_dy = 1.0;
+	double scale;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+	g_return_if_fail (surface != NULL);
+
+	cairo = view->dom_view.cairo;
+
+	cairo_user_to_device_distance (cairo, &x_dx, &x_dy);
+	cairo_user_to_device_distance (cairo, &y_dx, &y_dy);
+	scale = MAX (sqrt (x_dx * x_dx + x_dy * x_dy), sqrt (y_dx * y_dx + y_dy * y_dy));
+
+	level = lsm_svg_image_cache_get_mipmap (surface, scale);
+
+	if (level != surface) {
+		cairo_pattern_t *pattern;
+		cairo_matrix_t matrix;
+
+		lsm_debug_render ("[LsmSvgView::show_surface] Use %dx%d mipmap of %dx%d image",
+				  cairo_image_surface_get_width (level),
+				  cairo_image_surface_get_height (level),
+				  cairo_image_surface_get_width (surface),
+				  cairo_image_surface_get_height (surface));
+
+		cairo_matrix_init_scale (&matrix,
+					 (double) cairo_image_surface_get_width (level) /
+					 cairo_image_surface_get_width (surface),
+					 (double) cairo_image_surface_get_height (level) /
+					 cairo_image_surface_get_height (surface));
+
+		pattern = cairo_pattern_create_for_surface (level);
+		cairo_pattern_set_matrix (pattern, &matrix);
+		cairo_set_source (cairo, pattern);
+		cairo_pattern_destroy (pattern);
+
+		view->dom_view.is_resolution_dependent = TRUE;
+	} else
+		cairo_set_source_surface (cairo, surface, 0, 0);
+
+	cairo_paint (cairo);
+
+	cairo_surface_destroy (level);
+}
+
 void
 lsm_svg_view_push_viewbox (LsmSvgView *view, const LsmBox *viewbox)
 {
@@ -1686,38 +2882,199 @@ lsm_svg_view_pop_matrix (LsmSvgView *view)
 	}
 }
 
+/**
+ * lsm_svg_view_copy_clip_path:
+ * @view: a #LsmSvgView
+ * @fill_rule: (out): placeholder for the clip fill rule
+ *
+ * Retrieves the geometry accumulated during the rendering of a clip path element, in the current
+ * user space, and clears the current path.
+ *
+ * Returns: (transfer full): a new path, to be freed using cairo_path_destroy(), or %NULL on error.
+ *
+ * Since: 0.6
+ */
+
+cairo_path_t *
+lsm_svg_view_copy_clip_path (LsmSvgView *view, cairo_fill_rule_t *fill_rule)
+{
+	cairo_path_t *path;
+
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), NULL);
+	g_return_val_if_fail (view->is_clipping, NULL);
+	g_return_val_if_fail (fill_rule != NULL, NULL);
+
+	if (view->dom_view.cairo == NULL)
+		return NULL;
+
+	path = cairo_copy_path (view->dom_view.cairo);
+	if (path->status != CAIRO_STATUS_SUCCESS) {
+		cairo_path_destroy (path);
+		return NULL;
+	}
+
+	*fill_rule = cairo_get_fill_rule (view->dom_view.cairo);
+	cairo_new_path (view->dom_view.cairo);
+
+	return path;
+}
+
+/* Matches the path produced by cairo_rectangle, or any closed path made of four axis aligned
+ * segments, once transformed to device space. */
+
+static gboolean
+_get_device_rectangle (cairo_t *cairo, const cairo_path_t *path, double *x1, double *y1, double *x2, double *y2)
+{
+	double x[4], y[4];
+	unsigned int n_points = 0;
+	unsigned int i;
+	int j;
+
+	for (i = 0; i < path->num_data; i += path->data[i].header.length) {
+		const cairo_path_data_t *data = &path->data[i];
+
+		switch (data->header.type) {
+			case CAIRO_PATH_MOVE_TO:
+				/* Implicit move to after close path */
+				if (n_points == 5)
+					break;
+				if (n_points != 0)
+					return FALSE;
+				/* Fall through */
+			case CAIRO_PATH_LINE_TO:
+				if (n_points >= 4)
+					return FALSE;
+				x[n_points] = data[1].point.x;
+				y[n_points] = data[1].point.y;
+				cairo_user_to_device (cairo, &x[n_points], &y[n_points]);
+				n_points++;
+				break;
+			case CAIRO_PATH_CLOSE_PATH:
+				if (n_points != 4)
+					return FALSE;
+				n_points = 5;
+				break;
+			default:
+				return FALSE;
+		}
+	}
+
+	if (n_points != 5)
+		return FALSE;
+
+	/* Non null edges, alternatively horizontal and vertical */
+	for (j = 0; j < 4; j++) {
+		int k = (j + 1) % 4;
+		int l = (j + 2) % 4;
+		gboolean is_horizontal = fabs (y[j] - y[k]) <= 1e-6;
+		gboolean is_vertical = fabs (x[j] - x[k]) <= 1e-6;
+
+		if (is_horizontal == is_vertical ||
+		    is_horizontal == (fabs (y[k] - y[l]) <= 1e-6))
+			return FALSE;
+	}
+
+	*x1 = MIN (x[0], x[2]);
+	*y1 = MIN (y[0], y[2]);
+	*x2 = MAX (x[0], x[2]);
+	*y2 = MAX (y[0], y[2]);
+
+	return TRUE;
+}
+
+static double
+_snap_to_pixel (double value)
+{
+	double rounded = floor (value + 0.5);
+
+	return fabs (value - rounded) < 1e-3 ? rounded : value;
+}
+
+/**
+ * lsm_svg_view_append_clip_path:
+ * @view: a #LsmSvgView
+ * @path: a clip geometry returned by lsm_svg_view_copy_clip_path()
+ * @fill_rule: the clip fill rule
+ *
+ * Appends @path to the current clip geometry, in the current user space. Axis aligned rectangles are
+ * appended in device space, with their edges snapped to the pixel grid when they lie within rounding
+ * error of it, so that cairo can use its rectangular clip fast path.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_append_clip_path (LsmSvgView *view, const cairo_path_t *path, cairo_fill_rule_t fill_rule)
+{
+	cairo_t *cairo;
+	double x1, y1, x2, y2;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+	g_return_if_fail (view->is_clipping);
+	g_return_if_fail (path != NULL);
+
+	cairo = view->dom_view.cairo;
+	if (cairo == NULL)
+		return;
+
+	cairo_set_fill_rule (cairo, fill_rule);
+
+	if (_get_device_rectangle (cairo, path, &x1, &y1, &x2, &y2)) {
+		cairo_matrix_t matrix;
+
+		x1 = _snap_to_pixel (x1);
+		y1 = _snap_to_pixel (y1);
+		x2 = _snap_to_pixel (x2);
+		y2 = _snap_to_pixel (y2);
+
+		lsm_debug_render ("[LsmSvgView::append_clip_path] Rectangle %g, %g, %g, %g", x1, y1, x2, y2);
+
+		cairo_get_matrix (cairo, &matrix);
+		cairo_identity_matrix (cairo);
+		cairo_rectangle (cairo, x1, y1, x2 - x1, y2 - y1);
+		cairo_set_matrix (cairo, &matrix);
+	} else
+		cairo_append_path (cairo, path);
+}
+
 static void
 lsm_svg_view_push_clip (LsmSvgView *view)
 {
 	LsmSvgElement *element;
-	LsmExtents extents;
 	char *url;
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 	g_return_if_fail (!view->is_clipping);
 
-	lsm_svg_element_get_extents (view->element_stack->data, view, &extents);
-
 	url = view->style->clip_path->value;
 
 	lsm_debug_render ("[LsmSvgView::push_clip] Using '%s'", url);
 
 	cairo_save (view->dom_view.cairo);
 
-	view->clip_extents.x = extents.x1;
-	view->clip_extents.y = extents.y1;
-	view->clip_extents.width  = extents.x2 - extents.x1;
-	view->clip_extents.height = extents.y2 - extents.y1;
-
-	lsm_debug_render ("[LsmSvgView::push_clip] x=%g y=%g w=%g h=%g",
-			  view->clip_extents.x,
-			  view->clip_extents.y,
-			  view->clip_extents.width,
-			  view->clip_extents.height);
-
 	element = lsm_svg_document_get_element_by_url (LSM_SVG_DOCUMENT (view->dom_view.document), url);
 	if (LSM_IS_SVG_CLIP_PATH_ELEMENT (element) &&
 	    !lsm_svg_view_circular_reference_check (view, element)) {
+		/* The clipped element extents are only needed for objectBoundingBox units */
+		if (LSM_SVG_CLIP_PATH_ELEMENT (element)->units.value == LSM_SVG_PATTERN_UNITS_OBJECT_BOUNDING_BOX) {
+			LsmExtents extents;
+
+			lsm_svg_element_get_extents (view->element_stack->data, view, &extents);
+
+			view->clip_extents.x = extents.x1;
+			view->clip_extents.y = extents.y1;
+			view->clip_extents.width  = extents.x2 - extents.x1;
+			view->clip_extents.height = extents.y2 - extents.y1;
+
+			lsm_debug_render ("[LsmSvgView::push_clip] x=%g y=%g w=%g h=%g",
+					  view->clip_extents.x,
+					  view->clip_extents.y,
+					  view->clip_extents.width,
+					  view->clip_extents.height);
+		}
+
+		cairo_new_path (view->dom_view.cairo);
+
 		view->is_clipping = TRUE;
 		lsm_svg_element_force_render (LSM_SVG_ELEMENT (element), view);
 		cairo_clip (view->dom_view.cairo);
@@ -1737,9 +3094,98 @@ lsm_svg_view_pop_clip (LsmSvgView *view)
 static void
 lsm_svg_view_push_mask (LsmSvgView *view)
 {
+	LsmSvgElement *mask_element;
+	cairo_t *cairo;
+
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
-	cairo_push_group (view->dom_view.cairo);
+	cairo = view->dom_view.cairo;
+
+	cairo_save (cairo);
+
+	/* Nothing is drawn outside of the mask region, bound the group to it, in
+	 * order to avoid the allocation of a surface of the size of the whole
+	 * target. cairo_push_group already limits the group to the clip extents. */
+
+	mask_element = lsm_svg_document_get_element_by_url (LSM_SVG_DOCUMENT (view->dom_view.document),
+							    view->style->mask->value);
+
+	if (!view->debug_mask_unbounded &&
+	    LSM_IS_SVG_MASK_ELEMENT (mask_element) &&
+	    !lsm_svg_view_circular_reference_check (view, mask_element)) {
+		LsmExtents extents;
+		LsmBox object_extents;
+		LsmBox region;
+
+		lsm_svg_element_get_extents (view->element_stack->data, view, &extents);
+
+		object_extents.x = extents.x1;
+		object_extents.y = extents.y1;
+		object_extents.width = extents.x2 - extents.x1;
+		object_extents.height = extents.y2 - extents.y1;
+
+		if (lsm_svg_mask_element_get_region (LSM_SVG_MASK_ELEMENT (mask_element), view,
+						     &object_extents, &region)) {
+			lsm_debug_render ("[LsmSvgView::push_mask] Bound group to %g, %g, %g, %g",
+					  region.x, region.y, region.width, region.height);
+
+			cairo_new_path (cairo);
+			cairo_rectangle (cairo, region.x, region.y, region.width, region.height);
+			cairo_clip (cairo);
+		}
+	}
+
+	cairo_push_group (cairo);
+}
+
+/* Luminance to alpha conversion of a mask surface. Only the alpha byte of the
+ * result is relevant, the SSE2 version gives the exact same result than the
+ * scalar one. */
+
+static void
+_luminance_to_alpha (guint32 *pixels, int n_pixels, gboolean use_simd)
+{
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128i mask = _mm_set1_epi32 (0xff);
+	const __m128i r_coef = _mm_set1_epi32 (13817);
+	const __m128i g_coef = _mm_set1_epi32 (46518);
+	const __m128i b_coef = _mm_set1_epi32 (4688);
+
+	for (; use_simd && i + 4 <= n_pixels; i += 4) {
+		__m128i pixel, r, g, b, sum;
+
+		pixel = _mm_loadu_si128 ((const __m128i *) (pixels + i));
+
+		r = _mm_and_si128 (_mm_srli_epi32 (pixel, 16), mask);
+		g = _mm_and_si128 (_mm_srli_epi32 (pixel, 8), mask);
+		b = _mm_and_si128 (pixel, mask);
+
+		/* Channels and coefficients fit in the low 16 bits of each
+		 * lane, the 32 bit products are rebuilt from their low and high
+		 * halves. */
+		sum = _mm_or_si128 (_mm_mullo_epi16 (r, r_coef),
+				    _mm_slli_epi32 (_mm_mulhi_epu16 (r, r_coef), 16));
+		sum = _mm_add_epi32 (sum, _mm_or_si128 (_mm_mullo_epi16 (g, g_coef),
+							_mm_slli_epi32 (_mm_mulhi_epu16 (g, g_coef), 16)));
+		sum = _mm_add_epi32 (sum, _mm_or_si128 (_mm_mullo_epi16 (b, b_coef),
+							_mm_slli_epi32 (_mm_mulhi_epu16 (b, b_coef), 16)));
+
+		/* sum * 0xff */
+		sum = _mm_sub_epi32 (_mm_slli_epi32 (sum, 8), sum);
+
+		_mm_storeu_si128 ((__m128i *) (pixels + i), sum);
+	}
+#endif
+
+	for (; i < n_pixels; i++) {
+		guint32 pixel = pixels[i];
+
+		pixels[i] = ((((pixel & 0x00ff0000) >> 16) * 13817 +
+			      ((pixel & 0x0000ff00) >> 8) * 46518 +
+			      ((pixel & 0x000000ff)) * 4688) * 0xff);
+	}
 }
 
 static void
@@ -1752,7 +3198,8 @@ lsm_svg_view_pop_mask (LsmSvgView *view)
 	mask_element = lsm_svg_document_get_element_by_url (LSM_SVG_DOCUMENT (view->dom_view.document),
 							    view->style->mask->value);
 
-	if (LSM_IS_SVG_MASK_ELEMENT (mask_element) &&
+	if (!view->debug_mask_unbounded &&
+	    LSM_IS_SVG_MASK_ELEMENT (mask_element) &&
 	    !lsm_svg_view_circular_reference_check (view, mask_element)) {
 		LsmExtents extents;
 		LsmBox mask_extents;
@@ -1776,24 +3223,21 @@ lsm_svg_view_pop_mask (LsmSvgView *view)
 			cairo_surface_t *surface;
 
 			if (cairo_pattern_get_surface (view->pattern_data->pattern, &surface) == CAIRO_STATUS_SUCCESS) {
-				int width, height, row, i, stride;
+				int width, height, row, stride;
 				unsigned char *pixels;
 
+				cairo_surface_flush (surface);
+
 				pixels = cairo_image_surface_get_data (surface);
 				height = cairo_image_surface_get_height (surface);
 				width = cairo_image_surface_get_width (surface);
 				stride = cairo_image_surface_get_stride (surface);
 
-				for (row = 0; row < height; row++) {
-					guint8 *row_data = (pixels + (row * stride));
-					for (i = 0; i < width; i++) {
-						guint32 *pixel = (guint32 *) row_data + i;
-						*pixel = ((((*pixel & 0x00ff0000) >> 16) * 13817 +
-							   ((*pixel & 0x0000ff00) >> 8) * 46518 +
-							   ((*pixel & 0x000000ff)) * 4688) * 0xff
-							  /* * opacity */);
-					}
-				}
+				for (row = 0; row < height; row++)
+					_luminance_to_alpha ((guint32 *) (pixels + (row * stride)), width,
+							     !view->debug_mask_scalar);
+
+				cairo_surface_mark_dirty (surface);
 			}
 
 			cairo_pattern_set_extend (view->pattern_data->pattern, CAIRO_EXTEND_NONE);
@@ -1818,6 +3262,8 @@ lsm_svg_view_pop_mask (LsmSvgView *view)
 		cairo_pop_group_to_source (view->dom_view.cairo);
 		cairo_paint (view->dom_view.cairo);
 	}
+
+	cairo_restore (view->dom_view.cairo);
 }
 
 static void
@@ -1868,13 +3314,63 @@ lsm_svg_view_push_filter (LsmSvgView *view)
 		lsm_warning_render ("LsmSvgView::push_filter] Failed to create subsurface");
 }
 
+static void
+_dump_filter_surface (LsmSvgView *view, LsmSvgFilterSurface *surface)
+{
+	static int count = 0;
+	char *filename;
+
+	filename = g_strdup_printf ("filter-%04d-%s-%s.png", count++,
+				    view->style->filter->value,
+				    lsm_svg_filter_surface_get_name (surface));
+	cairo_surface_write_to_png (lsm_svg_filter_surface_get_cairo_surface (surface), filename);
+	g_free (filename);
+}
+
+static gsize
+_get_filter_surface_size (LsmSvgFilterSurface *surface)
+{
+	cairo_surface_t *cairo_surface;
+
+	cairo_surface = lsm_svg_filter_surface_get_cairo_surface (surface);
+
+	return (gsize) cairo_image_surface_get_stride (cairo_surface) * cairo_image_surface_get_height (cairo_surface);
+}
+
+static void
+_release_filter_surface (LsmSvgView *view, unsigned int slot)
+{
+	LsmSvgFilterSurface *surface = view->filter_surfaces[slot];
+
+	if (surface == NULL)
+		return;
+
+	if (view->debug_filter)
+		_dump_filter_surface (view, surface);
+
+	view->filter_size -= _get_filter_surface_size (surface);
+	lsm_svg_filter_surface_unref (surface);
+	view->filter_surfaces[slot] = NULL;
+}
+
+static LsmSvgFilterSurface *
+_store_filter_surface (LsmSvgView *view, unsigned int slot, LsmSvgFilterSurface *surface)
+{
+	_release_filter_surface (view, slot);
+
+	view->filter_surfaces[slot] = surface;
+	view->filter_size += _get_filter_surface_size (surface);
+	view->filter_peak_size = MAX (view->filter_peak_size, view->filter_size);
+
+	return surface;
+}
+
 static void
 lsm_svg_view_pop_filter (LsmSvgView *view)
 {
 	LsmSvgElement *filter_element;
 	LsmSvgFilterSurface *filter_surface;
 	cairo_surface_t *surface;
-	GSList *iter;
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
@@ -1884,10 +3380,21 @@ lsm_svg_view_pop_filter (LsmSvgView *view)
 	if (LSM_IS_SVG_FILTER_ELEMENT (filter_element) &&
 	    view->pattern_data->pattern != NULL) {
 		if (cairo_pattern_get_surface (view->pattern_data->pattern, &surface) == CAIRO_STATUS_SUCCESS) {
+			const LsmSvgFilterGraph *old_graph = view->filter_graph;
+			LsmSvgFilterSurface **old_surfaces = view->filter_surfaces;
+			unsigned int old_node = view->filter_node;
+			const LsmSvgFilterGraph *graph;
 			cairo_matrix_t matrix;
 			LsmBox subregion;
+			unsigned int i;
 
-			view->filter_surfaces = NULL;
+			graph = lsm_svg_filter_element_get_graph (LSM_SVG_FILTER_ELEMENT (filter_element));
+
+			view->filter_graph = graph;
+			view->filter_surfaces = g_new0 (LsmSvgFilterSurface *, graph->n_slots);
+			view->filter_node = 0;
+			if (old_graph == NULL)
+				view->filter_size = 0;
 
 			subregion.x = 0;
 			subregion.y = 0;
@@ -1897,32 +3404,17 @@ lsm_svg_view_pop_filter (LsmSvgView *view)
 			filter_surface = lsm_svg_filter_surface_new_with_content ("SourceGraphic", surface, &subregion);
 			cairo_pattern_get_matrix (view->pattern_data->pattern, &matrix);
 
-			view->filter_surfaces = g_slist_prepend (view->filter_surfaces, filter_surface);
+			_store_filter_surface (view, LSM_SVG_FILTER_INPUT_SOURCE_GRAPHIC, filter_surface);
 
 			lsm_svg_element_force_render (filter_element, view);
 
-			if (view->debug_filter) {
-				GSList *iter;
-				char *filename;
-				static int count = 0;
-
-				for (iter = view->filter_surfaces; iter != NULL; iter = iter->next) {
-					LsmSvgFilterSurface *surface = iter->data;
-
-					filename = g_strdup_printf ("filter-%04d-%s-%s.png", count++,
-							view->style->filter->value,
-							lsm_svg_filter_surface_get_name (surface));
-					cairo_surface_write_to_png (lsm_svg_filter_surface_get_cairo_surface (surface), filename);
-					g_free (filename);
-				}
-			}
+			filter_surface = graph->n_nodes > 0 ?
+				view->filter_surfaces[LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS + graph->n_nodes - 1] : NULL;
 
-			if (view->filter_surfaces->next != NULL) {
+			if (filter_surface != NULL) {
 				cairo_pattern_t *pattern;
-				cairo_surface_t *surface;
 
-				surface = lsm_svg_filter_surface_get_cairo_surface (view->filter_surfaces->data);
-				pattern = cairo_pattern_create_for_surface (surface);
+				pattern = cairo_pattern_create_for_surface (lsm_svg_filter_surface_get_cairo_surface (filter_surface));
 				cairo_pattern_set_extend (pattern, CAIRO_EXTEND_NONE);
 				cairo_pattern_set_matrix (pattern, &matrix);
 				cairo_set_source (view->pattern_data->old_cairo, pattern);
@@ -1930,44 +3422,109 @@ lsm_svg_view_pop_filter (LsmSvgView *view)
 				cairo_paint_with_alpha (view->pattern_data->old_cairo, view->style->opacity->value);
 			}
 
-			for (iter = view->filter_surfaces; iter != NULL; iter = iter->next)
-				lsm_svg_filter_surface_unref (iter->data);
-			g_slist_free (view->filter_surfaces);
-			view->filter_surfaces = NULL;
+			for (i = 0; i < graph->n_slots; i++)
+				_release_filter_surface (view, i);
+			g_free (view->filter_surfaces);
+
+			if (old_graph == NULL)
+				lsm_debug_render ("[LsmSvgView::pop_filter] Peak memory %" G_GSIZE_FORMAT " bytes after '%s'",
+						  view->filter_peak_size, view->style->filter->value);
+
+			view->filter_graph = old_graph;
+			view->filter_surfaces = old_surfaces;
+			view->filter_node = old_node;
 		}
 	}
 
 	_end_pattern (view);
 }
 
+/**
+ * lsm_svg_view_apply_filter_node:
+ * @view: a #LsmSvgView
+ * @graph: the compiled graph of the filter being rendered
+ * @index: index of the primitive to apply
+ *
+ * Applies the primitive at @index in @graph, then releases the surfaces no later primitive reads.
+ *
+ * Since: 0.6
+ */
+
+void
+lsm_svg_view_apply_filter_node (LsmSvgView *view, const LsmSvgFilterGraph *graph, unsigned int index)
+{
+	unsigned int i;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+	g_return_if_fail (graph != NULL);
+	g_return_if_fail (index < graph->n_nodes);
+
+	if (view->filter_graph != graph || view->filter_surfaces == NULL) {
+		lsm_debug_render ("[LsmSvgView::apply_filter_node] Filter graph not pushed");
+		return;
+	}
+
+	view->filter_node = index;
+
+	lsm_svg_filter_primitive_apply (graph->nodes[index].primitive, view);
+
+	for (i = 0; i < graph->n_slots; i++)
+		if (graph->last_uses[i] <= (int) index)
+			_release_filter_surface (view, i);
+}
+
 static LsmSvgFilterSurface *
 _get_filter_surface (LsmSvgView *view, const char *input)
 {
-	GSList *iter;
-	LsmSvgFilterSurface *source_surface = NULL;
+	const LsmSvgFilterGraph *graph = view->filter_graph;
+	const LsmSvgFilterNode *node;
+	LsmSvgFilterSurface *surface;
+	int slot = -1;
+	unsigned int i;
 
-	if (input == NULL)
-		return view->filter_surfaces->data;
+	if (graph == NULL || view->filter_surfaces == NULL)
+		return NULL;
+
+	if (view->filter_node < graph->n_nodes) {
+		node = &graph->nodes[view->filter_node];
 
-	for (iter = view->filter_surfaces; iter != NULL; iter = iter->next) {
-		LsmSvgFilterSurface *surface = iter->data;
+		for (i = 0; i < node->n_inputs; i++)
+			if (g_strcmp0 (input, node->inputs[i].name) == 0) {
+				slot = node->inputs[i].slot;
+				break;
+			}
 
-		if (g_strcmp0 (input, lsm_svg_filter_surface_get_name (surface)) == 0)
-			return surface;
+		/* The current primitive output, for merge nodes accumulating into it */
+		if (slot < 0 && input != NULL) {
+			surface = view->filter_surfaces[LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS + view->filter_node];
+			if (surface != NULL && g_strcmp0 (input, lsm_svg_filter_surface_get_name (surface)) == 0)
+				return surface;
+		}
+	}
 
-		source_surface = surface;
+	if (slot < 0) {
+		if (input == NULL)
+			return NULL;
+		slot = lsm_svg_filter_input_from_string (input);
+		if (slot < 0)
+			return NULL;
 	}
 
-	if (g_strcmp0 (input, "SourceAlpha") == 0 && source_surface != NULL) {
-		LsmSvgFilterSurface *surface;
+	if (view->filter_surfaces[slot] != NULL)
+		return view->filter_surfaces[slot];
+
+	if (slot == LSM_SVG_FILTER_INPUT_SOURCE_ALPHA) {
+		LsmSvgFilterSurface *source_surface;
+
+		source_surface = view->filter_surfaces[LSM_SVG_FILTER_INPUT_SOURCE_GRAPHIC];
+		if (source_surface == NULL)
+			return NULL;
 
 		surface = lsm_svg_filter_surface_new_similar ("SourceAlpha", source_surface, NULL);
 		lsm_svg_filter_surface_alpha (source_surface, surface);
-		view->filter_surfaces = g_slist_prepend (view->filter_surfaces, surface);	
 
-		return surface;
-	} else if (g_strcmp0 (input, "BackgroundImage") == 0) {
-		LsmSvgFilterSurface *surface;
+		return _store_filter_surface (view, slot, surface);
+	} else if (slot == LSM_SVG_FILTER_INPUT_BACKGROUND_IMAGE) {
 		LsmSvgViewBackground *background;
 		gboolean background_processing = FALSE;
 		cairo_matrix_t matrix;
@@ -1989,8 +3546,10 @@ _get_filter_surface (LsmSvgView *view, const char *input)
 			return NULL;
 		}
 
-		surface = lsm_svg_filter_surface_new_similar ("BackgroundImage", source_surface, NULL);
-		view->filter_surfaces = g_slist_prepend (view->filter_surfaces, surface);	
+		surface = lsm_svg_filter_surface_new_similar ("BackgroundImage",
+							      view->filter_surfaces[LSM_SVG_FILTER_INPUT_SOURCE_GRAPHIC],
+							      NULL);
+		_store_filter_surface (view, slot, surface);
 
 		cairo_get_matrix (view->pattern_data->old_cairo, &matrix);
 		cairo_pattern_get_matrix (view->pattern_data->pattern, &pattern_matrix);
@@ -2015,20 +3574,20 @@ _get_filter_surface (LsmSvgView *view, const char *input)
 		cairo_destroy (cairo);
 		
 		return surface;
-	} else if (g_strcmp0 (input, "BackgroundAlpha") == 0) {
-		LsmSvgFilterSurface *surface;
+	} else if (slot == LSM_SVG_FILTER_INPUT_BACKGROUND_ALPHA) {
 		LsmSvgFilterSurface *background_surface;
 
 		if (view->background_stack == NULL)
 			return NULL;
 
 		background_surface = _get_filter_surface (view, "BackgroundImage");
+		if (background_surface == NULL)
+			return NULL;
 
 		surface = lsm_svg_filter_surface_new_similar ("BackgroundAlpha", background_surface, NULL);
 		lsm_svg_filter_surface_alpha (background_surface, surface);
-		view->filter_surfaces = g_slist_prepend (view->filter_surfaces, surface);	
 
-		return surface;
+		return _store_filter_surface (view, slot, surface);
 	}
 
 	return NULL;
@@ -2041,9 +3600,7 @@ _create_filter_surface (LsmSvgView *view, const char *output, LsmSvgFilterSurfac
 
 	surface = lsm_svg_filter_surface_new_similar (output, input_surface, subregion);
 
-	view->filter_surfaces = g_slist_prepend (view->filter_surfaces, surface); 
-
-	return surface;
+	return _store_filter_surface (view, LSM_SVG_FILTER_GRAPH_N_STANDARD_INPUTS + view->filter_node, surface);
 }
 
 LsmBox
@@ -2100,7 +3657,7 @@ lsm_svg_view_apply_flood (LsmSvgView *view, const char *output, const LsmBox *su
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
-	input_surface = _get_filter_surface (view, NULL);
+	input_surface = _get_filter_surface (view, "SourceGraphic");
 
 	lsm_cairo_box_user_to_device (view->dom_view.cairo, &subregion_px, subregion);
 	output_surface = _create_filter_surface (view, output, input_surface, &subregion_px);
@@ -2126,7 +3683,7 @@ lsm_svg_view_apply_image (LsmSvgView *view, const char *output, const LsmBox *su
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
-	input_surface = _get_filter_surface (view, NULL);
+	input_surface = _get_filter_surface (view, "SourceGraphic");
 
 	lsm_cairo_box_user_to_device (view->dom_view.cairo, &subregion_px, subregion);
 	output_surface = _create_filter_surface (view, output, input_surface, &subregion_px);
@@ -2222,6 +3779,30 @@ lsm_svg_view_apply_color_matrix (LsmSvgView *view, const char *input, const char
 	lsm_svg_filter_surface_color_matrix (input_surface, output_surface, type, n_values, values);
 }
 
+void
+lsm_svg_view_apply_component_transfer (LsmSvgView *view, const char *input, const char *output,
+				       const LsmBox *subregion,
+				       const guint8 *red, const guint8 *green, const guint8 *blue, const guint8 *alpha)
+{
+	LsmSvgFilterSurface *input_surface;
+	LsmSvgFilterSurface *output_surface;
+	LsmBox subregion_px;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+
+	input_surface = _get_filter_surface (view, input);
+
+	if (input_surface == NULL) {
+		lsm_debug_render ("[SvgView::apply_component_transfer] Input '%s' not found", input);
+		return;
+	}
+
+	lsm_cairo_box_user_to_device (view->dom_view.cairo, &subregion_px, subregion);
+	output_surface = _create_filter_surface (view, output, input_surface, &subregion_px);
+
+	lsm_svg_filter_surface_component_transfer (input_surface, output_surface, red, green, blue, alpha);
+}
+
 void
 lsm_svg_view_apply_displacement_map (LsmSvgView *view, const char *input_1, const char *input_2, const char *output,
 				     const LsmBox *subregion,
@@ -2310,18 +3891,119 @@ lsm_svg_view_apply_convolve_matrix (LsmSvgView *view, const char *input, const c
 						divisor, bias, target_x, target_y, edge_mode, preserve_alpha);
 }
 
-void 
-lsm_svg_view_apply_specular_lighting (LsmSvgView *view, const char *output, const LsmBox *subregion,
+/* Light sources are converted to pixels, with distances along the z axis scaled by the mean scale of the
+ * current transform. The returned scale is also used for the surface height.
+ *
+ * With primitiveUnits="objectBoundingBox", the filter element has already mapped the unit square onto the
+ * bounding box, which takes care of x and y. The z coordinates are fractions of the normalized diagonal of
+ * the bounding box, while the surface height stays in the units of the filtered element. */
+
+static double
+_light_user_to_device (LsmSvgView *view, const LsmSvgFilterLight *light, LsmSvgFilterLight *device_light)
+{
+	cairo_matrix_t matrix;
+	double scale;
+	double z_scale;
+
+	cairo_get_matrix (view->dom_view.cairo, &matrix);
+	scale = sqrt (fabs (matrix.xx * matrix.yy - matrix.xy * matrix.yx));
+	z_scale = scale;
+
+	if (view->filter_graph != NULL && view->filter_graph->is_object_bounding_box) {
+		const LsmBox *object_extents = lsm_svg_view_get_object_extents (view);
+		double area = object_extents->width * object_extents->height;
+
+		if (area > 0.0) {
+			scale /= sqrt (area);
+			z_scale = scale * sqrt ((object_extents->width * object_extents->width +
+						 object_extents->height * object_extents->height) * 0.5);
+		}
+	}
+
+	*device_light = *light;
+
+	if (light->type == LSM_SVG_FILTER_LIGHT_TYPE_DISTANT) {
+		double azimuth = light->azimuth * M_PI / 180.0;
+		double elevation = light->elevation * M_PI / 180.0;
+		double x = cos (azimuth) * cos (elevation);
+		double y = sin (azimuth) * cos (elevation);
+
+		cairo_user_to_device_distance (view->dom_view.cairo, &x, &y);
+
+		device_light->azimuth = atan2 (y, x) * 180.0 / M_PI;
+		device_light->elevation = atan2 (sin (elevation) * z_scale, sqrt (x * x + y * y)) * 180.0 / M_PI;
+	} else {
+		cairo_user_to_device (view->dom_view.cairo, &device_light->x, &device_light->y);
+		device_light->z = light->z * z_scale;
+		cairo_user_to_device (view->dom_view.cairo, &device_light->points_at_x, &device_light->points_at_y);
+		device_light->points_at_z = light->points_at_z * z_scale;
+	}
+
+	return scale;
+}
+
+void
+lsm_svg_view_apply_diffuse_lighting (LsmSvgView *view, const char *input, const char *output, const LsmBox *subregion,
+				     const LsmSvgFilterLight *light,
+				     double surface_scale, double diffuse_constant,
+				     double dx, double dy)
+{
+	LsmSvgFilterSurface *output_surface;
+	LsmSvgFilterSurface *input_surface;
+	LsmSvgFilterLight device_light;
+	LsmBox subregion_px;
+	double scale;
+
+	g_return_if_fail (LSM_IS_SVG_VIEW (view));
+
+	input_surface = _get_filter_surface (view, input);
+
+	if (input_surface == NULL) {
+		lsm_debug_render ("[SvgView::apply_diffuse_lighting] Input '%s' not found", input);
+		return;
+	}
+
+	lsm_cairo_box_user_to_device (view->dom_view.cairo, &subregion_px, subregion);
+	output_surface = _create_filter_surface (view, output, input_surface, &subregion_px);
+
+	lsm_log_render ("[SvgView::apply_diffuse_lighting] subregion %gx%g px at %g,%g px",
+			subregion_px.width, subregion_px.height,
+			subregion_px.x, subregion_px.y);
+
+	if (light == NULL) {
+		lsm_debug_render ("[SvgView::apply_diffuse_lighting] Missing light source");
+		return;
+	}
+
+	scale = _light_user_to_device (view, light, &device_light);
+
+	lsm_svg_filter_surface_diffuse_lighting (input_surface, output_surface, &device_light,
+						 surface_scale * scale, diffuse_constant, dx, dy,
+						 view->style->lighting_color->value.red,
+						 view->style->lighting_color->value.green,
+						 view->style->lighting_color->value.blue);
+}
+
+void
+lsm_svg_view_apply_specular_lighting (LsmSvgView *view, const char *input, const char *output, const LsmBox *subregion,
+				      const LsmSvgFilterLight *light,
 				      double surface_scale, double specular_constant, double specular_exponent,
 				      double dx, double dy)
 {
 	LsmSvgFilterSurface *output_surface;
 	LsmSvgFilterSurface *input_surface;
+	LsmSvgFilterLight device_light;
 	LsmBox subregion_px;
+	double scale;
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
-	input_surface = _get_filter_surface (view, NULL);
+	input_surface = _get_filter_surface (view, input);
+
+	if (input_surface == NULL) {
+		lsm_debug_render ("[SvgView::apply_specular_lighting] Input '%s' not found", input);
+		return;
+	}
 
 	lsm_cairo_box_user_to_device (view->dom_view.cairo, &subregion_px, subregion);
 	output_surface = _create_filter_surface (view, output, input_surface, &subregion_px);
@@ -2330,9 +4012,18 @@ lsm_svg_view_apply_specular_lighting (LsmSvgView *view, const char *output, cons
 			subregion_px.width, subregion_px.height,
 			subregion_px.x, subregion_px.y);
 
-	cairo_user_to_device_distance (view->dom_view.cairo, &dx, &dy);
+	if (light == NULL) {
+		lsm_debug_render ("[SvgView::apply_specular_lighting] Missing light source");
+		return;
+	}
+
+	scale = _light_user_to_device (view, light, &device_light);
 
-	lsm_svg_filter_surface_specular_lighting (output_surface, surface_scale, specular_constant, specular_exponent, dx, dy);
+	lsm_svg_filter_surface_specular_lighting (input_surface, output_surface, &device_light,
+						  surface_scale * scale, specular_constant, specular_exponent, dx, dy,
+						  view->style->lighting_color->value.red,
+						  view->style->lighting_color->value.green,
+						  view->style->lighting_color->value.blue);
 }
 
 void
@@ -2349,7 +4040,7 @@ lsm_svg_view_apply_turbulence (LsmSvgView *view, const char *output, const LsmBo
 
 	g_return_if_fail (LSM_IS_SVG_VIEW (view));
 
-	input_surface = _get_filter_surface (view, NULL);
+	input_surface = _get_filter_surface (view, "SourceGraphic");
 
 	lsm_cairo_box_user_to_device (view->dom_view.cairo, &subregion_px, subregion);
 	output_surface = _create_filter_surface (view, output, input_surface, &subregion_px);
@@ -2439,6 +4130,345 @@ lsm_svg_view_get_referencing_element (LsmSvgView *view)
 	return view->element_stack->next->data;
 }
 
+static gboolean
+_is_marker_set (const LsmProperty *property)
+{
+	return property->value != NULL && strcmp (property->value, "none") != 0;
+}
+
+static gboolean _get_painted_extents (LsmSvgView *view, LsmSvgElement *element, LsmSvgStyle *style,
+				      LsmExtents *extents);
+
+static gboolean
+_is_non_painting_element (LsmSvgElement *element)
+{
+	return LSM_SVG_ELEMENT_GET_CLASS (element)->render == NULL ||
+		LSM_IS_SVG_DEFS_ELEMENT (element) ||
+		LSM_IS_SVG_GRADIENT_ELEMENT (element) ||
+		LSM_IS_SVG_PATTERN_ELEMENT (element) ||
+		LSM_IS_SVG_MARKER_ELEMENT (element) ||
+		LSM_IS_SVG_CLIP_PATH_ELEMENT (element) ||
+		LSM_IS_SVG_MASK_ELEMENT (element) ||
+		LSM_IS_SVG_FILTER_ELEMENT (element);
+}
+
+/* Union of the painted extents of the children of a group, in the group user space. Returns FALSE if one of
+ * the children has an unbounded painted area, or if nothing is painted at all, as a filter may still paint
+ * the region of an empty group. */
+
+static gboolean
+_get_children_painted_extents (LsmSvgView *view, LsmSvgElement *element, LsmSvgStyle *style,
+			       LsmExtents *extents)
+{
+	LsmDomNode *node;
+	gboolean is_empty = TRUE;
+
+	for (node = LSM_DOM_NODE (element)->first_child; node != NULL; node = node->next_sibling) {
+		LsmSvgElement *child;
+		LsmSvgStyle *child_style;
+		LsmExtents child_extents;
+
+		if (!LSM_IS_SVG_ELEMENT (node))
+			continue;
+
+		child = LSM_SVG_ELEMENT (node);
+		if (_is_non_painting_element (child))
+			continue;
+
+		child_style = lsm_svg_element_get_computed_style (child, style);
+		if (child_style->visibility->value != LSM_SVG_VISIBILITY_VISIBLE ||
+		    child_style->display->value == LSM_SVG_DISPLAY_NONE)
+			continue;
+
+		if (!_get_painted_extents (view, child, child_style, &child_extents))
+			return FALSE;
+
+		if (LSM_IS_SVG_TRANSFORMABLE (child)) {
+			LsmSvgMatrix *matrix = &LSM_SVG_TRANSFORMABLE (child)->transform.matrix;
+
+			if (!lsm_svg_matrix_is_identity (matrix))
+				lsm_svg_matrix_transform_bounding_box (matrix,
+								       &child_extents.x1, &child_extents.y1,
+								       &child_extents.x2, &child_extents.y2);
+		}
+
+		if (is_empty) {
+			*extents = child_extents;
+			is_empty = FALSE;
+		} else {
+			extents->x1 = MIN (extents->x1, child_extents.x1);
+			extents->y1 = MIN (extents->y1, child_extents.y1);
+			extents->x2 = MAX (extents->x2, child_extents.x2);
+			extents->y2 = MAX (extents->y2, child_extents.y2);
+		}
+	}
+
+	return !is_empty;
+}
+
+static gboolean
+_compute_painted_extents (LsmSvgView *view, LsmSvgElement *element, LsmSvgStyle *style, LsmExtents *extents)
+{
+	gboolean is_bounded;
+
+	/* Text extents don't account for position attributes and tspan children, and marker geometry lives
+	 * outside of the shape extents: don't try to cull those. Unbounded compositing operators may also
+	 * touch pixels outside of the element. */
+	if (LSM_IS_SVG_TEXT_ELEMENT (element) ||
+	    style->comp_op->value != LSM_SVG_COMP_OP_SRC_OVER ||
+	    _is_marker_set (style->marker) ||
+	    _is_marker_set (style->marker_start) ||
+	    _is_marker_set (style->marker_mid) ||
+	    _is_marker_set (style->marker_end))
+		return FALSE;
+
+	lsm_svg_view_push_style (view, style);
+
+	if (LSM_IS_SVG_G_ELEMENT (element)) {
+		is_bounded = _get_children_painted_extents (view, element, style, extents);
+	} else if (LSM_SVG_ELEMENT_GET_CLASS (element)->is_shape_element) {
+		lsm_svg_element_get_extents (element, view, extents);
+
+		if (style->stroke->paint.type != LSM_SVG_PAINT_TYPE_NONE) {
+			double half_width;
+
+			half_width = 0.5 * lsm_svg_view_normalize_length (view, &style->stroke_width->length,
+									  LSM_SVG_LENGTH_DIRECTION_DIAGONAL);
+			if (style->stroke_line_join->value == LSM_SVG_LINE_JOIN_MITER)
+				half_width *= MAX (style->stroke_miter_limit->value, M_SQRT2);
+			else
+				half_width *= M_SQRT2;
+
+			extents->x1 -= half_width;
+			extents->y1 -= half_width;
+			extents->x2 += half_width;
+			extents->y2 += half_width;
+		}
+
+		is_bounded = TRUE;
+	} else
+		is_bounded = FALSE;
+
+	if (is_bounded && g_strcmp0 (style->filter->value, "none") != 0) {
+		LsmSvgElement *filter;
+		LsmBox box;
+
+		filter = lsm_svg_document_get_element_by_url (LSM_SVG_DOCUMENT (view->dom_view.document),
+							      style->filter->value);
+		if (LSM_IS_SVG_FILTER_ELEMENT (filter)) {
+			box.x = extents->x1;
+			box.y = extents->y1;
+			box.width = extents->x2 - extents->x1;
+			box.height = extents->y2 - extents->y1;
+
+			box = lsm_svg_filter_element_get_effect_viewport (LSM_SVG_FILTER_ELEMENT (filter), &box, view);
+
+			extents->x1 = box.x;
+			extents->y1 = box.y;
+			extents->x2 = box.x + box.width;
+			extents->y2 = box.y + box.height;
+		} else
+			is_bounded = FALSE;
+	}
+
+	lsm_svg_view_pop_style (view);
+
+	return is_bounded;
+}
+
+static gboolean
+_is_same_viewbox (const LsmSvgViewbox *a, const LsmSvgViewbox *b)
+{
+	return (a->resolution_ppi == b->resolution_ppi &&
+		a->viewbox.x == b->viewbox.x &&
+		a->viewbox.y == b->viewbox.y &&
+		a->viewbox.width == b->viewbox.width &&
+		a->viewbox.height == b->viewbox.height);
+}
+
+/* Painted extents of a shape element or of a group, in the element user space, including the stroke and the
+ * filter region. Returns FALSE when the painted area is not known to be bounded by these extents.
+ *
+ * Extents don't depend on the current transform. They are cached on the element for a given computed style,
+ * which is kept referenced, viewport and document generation, so that groups are measured once and their
+ * descendants reuse the extents computed for the group when they are tested in turn. */
+
+static gboolean
+_get_painted_extents (LsmSvgView *view, LsmSvgElement *element, LsmSvgStyle *style, LsmExtents *extents)
+{
+	const LsmSvgViewbox *viewbox = view->viewbox_stack->data;
+	unsigned int generation = view->dom_view.document->generation;
+
+	if (element->painted_extents_style == style &&
+	    element->painted_extents_generation == generation &&
+	    _is_same_viewbox (&element->painted_extents_viewbox, viewbox)) {
+		*extents = element->painted_extents;
+		return element->is_painted_extents_bounded;
+	}
+
+	element->is_painted_extents_bounded = _compute_painted_extents (view, element, style,
+									 &element->painted_extents);
+
+	if (element->painted_extents_style != NULL)
+		lsm_svg_style_unref (element->painted_extents_style);
+	element->painted_extents_style = lsm_svg_style_ref (style);
+	element->painted_extents_generation = generation;
+	element->painted_extents_viewbox = *viewbox;
+
+	*extents = element->painted_extents;
+
+	return element->is_painted_extents_bounded;
+}
+
+/**
+ * lsm_svg_view_is_element_culled:
+ * @view: a #LsmSvgView
+ * @element: a shape element or a group
+ * @style: the computed style of @element
+ *
+ * Tests whether the painted area of @element, including its stroke and filter region, lies completely
+ * outside of the current device clip. For a group, the painted area is the union of the painted areas of
+ * its descendants, so a group which is entirely off-screen is skipped without walking its subtree again. It
+ * is called after the element transform has been applied to the cairo context, and increments the culled
+ * element counter when it returns %TRUE. Other elements are never culled.
+ *
+ * Returns: %TRUE if rendering @element can be skipped.
+ *
+ * Since: 0.6
+ */
+
+gboolean
+lsm_svg_view_is_element_culled (LsmSvgView *view, LsmSvgElement *element, LsmSvgStyle *style)
+{
+	LsmExtents extents;
+	cairo_t *cairo;
+	double clip_x1, clip_y1, clip_x2, clip_y2;
+	double x[4], y[4];
+	double x1, y1, x2, y2;
+	unsigned int i;
+
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), FALSE);
+	g_return_val_if_fail (LSM_IS_SVG_ELEMENT (element), FALSE);
+	g_return_val_if_fail (style != NULL, FALSE);
+
+	cairo = view->dom_view.cairo;
+	if (cairo == NULL)
+		return FALSE;
+
+	/* Computing the extents resets the cairo path, which holds the clip geometry gathered so far while
+	 * clipping, and clip path geometry is cached and reused under other clips. */
+	if (view->is_clipping ||
+	    !(LSM_SVG_ELEMENT_GET_CLASS (element)->is_shape_element || LSM_IS_SVG_G_ELEMENT (element)))
+		return FALSE;
+
+	if (!_get_painted_extents (view, element, style, &extents))
+		return FALSE;
+
+	x[0] = extents.x1;	y[0] = extents.y1;
+	x[1] = extents.x2;	y[1] = extents.y1;
+	x[2] = extents.x2;	y[2] = extents.y2;
+	x[3] = extents.x1;	y[3] = extents.y2;
+
+	for (i = 0; i < 4; i++)
+		cairo_user_to_device (cairo, &x[i], &y[i]);
+
+	x1 = x2 = x[0];
+	y1 = y2 = y[0];
+	for (i = 1; i < 4; i++) {
+		x1 = MIN (x1, x[i]);
+		y1 = MIN (y1, y[i]);
+		x2 = MAX (x2, x[i]);
+		y2 = MAX (y2, y[i]);
+	}
+
+	cairo_save (cairo);
+	cairo_identity_matrix (cairo);
+	cairo_clip_extents (cairo, &clip_x1, &clip_y1, &clip_x2, &clip_y2);
+	cairo_restore (cairo);
+
+	/* One device pixel of slack for antialiasing */
+	if (x2 + 1.0 < clip_x1 || x1 - 1.0 > clip_x2 ||
+	    y2 + 1.0 < clip_y1 || y1 - 1.0 > clip_y2) {
+		lsm_debug_render ("[LsmSvgView::is_element_culled] Cull %s (%g,%g %g,%g)",
+				  lsm_dom_node_get_node_name (LSM_DOM_NODE (element)), x1, y1, x2, y2);
+		view->n_culled_elements++;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * lsm_svg_view_get_n_culled_elements:
+ * @view: a #LsmSvgView
+ *
+ * Returns: the number of shape elements and groups skipped during the last render because they were outside of the
+ * visible area.
+ *
+ * Since: 0.6
+ */
+
+unsigned int
+lsm_svg_view_get_n_culled_elements (LsmSvgView *view)
+{
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), 0);
+
+	return view->n_culled_elements;
+}
+
+/**
+ * lsm_svg_view_get_n_pattern_cache_hits:
+ * @view: a #LsmSvgView
+ *
+ * Returns: the number of pattern tiles reused from the pattern cache during the last render.
+ *
+ * Since: 0.6
+ */
+
+unsigned int
+lsm_svg_view_get_n_pattern_cache_hits (LsmSvgView *view)
+{
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), 0);
+
+	return view->n_pattern_cache_hits;
+}
+
+/**
+ * lsm_svg_view_get_n_text_cache_misses:
+ * @view: a #LsmSvgView
+ *
+ * Returns: the number of text layouts shaped during the last render because they were not found in the
+ * text cache.
+ *
+ * Since: 0.6
+ */
+
+unsigned int
+lsm_svg_view_get_n_text_cache_misses (LsmSvgView *view)
+{
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), 0);
+
+	return view->n_text_cache_misses;
+}
+
+/**
+ * lsm_svg_view_get_filter_peak_size:
+ * @view: a #LsmSvgView
+ *
+ * Returns: the largest amount of memory held at once by filter intermediate surfaces during the last render, in
+ * bytes.
+ *
+ * Since: 0.6
+ */
+
+gsize
+lsm_svg_view_get_filter_peak_size (LsmSvgView *view)
+{
+	g_return_val_if_fail (LSM_IS_SVG_VIEW (view), 0);
+
+	return view->filter_peak_size;
+}
+
 static gboolean
 lsm_svg_view_circular_reference_check (LsmSvgView *view, LsmSvgElement *element)
 {
@@ -2509,6 +4539,9 @@ lsm_svg_view_push_composition (LsmSvgView *view, LsmSvgStyle *style)
 
 	lsm_log_render ("[SvgView::push_composition]");
 
+	if (G_UNLIKELY (style->comp_op->value != LSM_SVG_COMP_OP_SRC_OVER))
+		view->is_backdrop_dependent = TRUE;
+
 	do_clip = (g_strcmp0 (style->clip_path->value, "none") != 0);
 	do_mask = (g_strcmp0 (style->mask->value, "none") != 0);
 	do_filter = (g_strcmp0 (style->filter->value, "none") != 0);
@@ -2686,29 +4719,28 @@ lsm_svg_view_render (LsmDomView *view)
 	svg_view->element_stack = NULL;
 	svg_view->viewbox_stack = NULL;
 	svg_view->matrix_stack = NULL;
-	svg_view->pango_layout_stack = NULL;
 	svg_view->background_stack = NULL;
 
 	svg_view->is_clipping = FALSE;
-	svg_view->is_pango_layout_in_use = FALSE;
-	svg_view->pango_layout = view->pango_layout;
+
+	_text_cache_update_context (svg_view->text_cache, view->cairo, view->pango_layout);
+
+	svg_view->n_culled_elements = 0;
+	svg_view->n_pattern_cache_hits = 0;
+	svg_view->n_text_cache_misses = 0;
+	svg_view->filter_peak_size = 0;
+
+	g_hash_table_remove_all (svg_view->marker_instances);
+	g_hash_table_remove_all (svg_view->use_instances);
+	svg_view->is_backdrop_dependent = FALSE;
 
 	svg_view->resolution_ppi = lsm_dom_view_get_resolution (view);
 
 	lsm_svg_svg_element_render  (svg_element, svg_view);
 
-	if (svg_view->is_pango_layout_in_use)
-		g_warning ("[LsmSvgView::render] Unfinished text redenring");
-
 	if (svg_view->is_clipping)
 		g_warning ("[LsmSvgView::render] Unfinished clipping");
 
-	if (svg_view->pango_layout_stack != NULL) {
-		g_warning ("[LsmSvgView::render] Dangling pango_layout in stack");
-		g_slist_free (svg_view->pango_layout_stack);
-		svg_view->pango_layout_stack = NULL;
-	}
-
 	if (svg_view->matrix_stack != NULL) {
 		g_warning ("[LsmSvgView::render] Dangling matrix in stack");
 		g_slist_free (svg_view->matrix_stack);
@@ -2751,6 +4783,10 @@ lsm_svg_view_set_debug (LsmDomView *view, const char *feature, gboolean enable)
 		svg_view->debug_group = enable;
 	else if (g_strcmp0 (feature, "text") == 0)
 		svg_view->debug_text = enable;
+	else if (g_strcmp0 (feature, "mask-unbounded") == 0)
+		svg_view->debug_mask_unbounded = enable;
+	else if (g_strcmp0 (feature, "mask-scalar") == 0)
+		svg_view->debug_mask_scalar = enable;
 }
 
 LsmSvgView *
@@ -2771,11 +4807,32 @@ lsm_svg_view_init (LsmSvgView *view)
 	view->debug_mask = FALSE;
 	view->debug_filter = FALSE;
 	view->debug_pattern = FALSE;
+	view->debug_mask_unbounded = FALSE;
+	view->debug_mask_scalar = FALSE;
+
+	view->n_culled_elements = 0;
+	view->n_pattern_cache_hits = 0;
+	view->n_text_cache_misses = 0;
+	view->filter_peak_size = 0;
+
+	view->pattern_cache = _pattern_cache_new (LSM_SVG_VIEW_DEFAULT_PATTERN_CACHE_SIZE);
+	view->text_cache = _text_cache_new (LSM_SVG_VIEW_DEFAULT_TEXT_CACHE_SIZE);
+	view->marker_instances = g_hash_table_new_full (_marker_key_hash, _marker_key_equal,
+							NULL, _marker_instance_free);
+	view->use_instances = g_hash_table_new_full (_use_key_hash, _use_key_equal,
+						     NULL, _use_instance_free);
 }
 
 static void
 lsm_svg_view_finalize (GObject *object)
 {
+	LsmSvgView *view = LSM_SVG_VIEW (object);
+
+	_pattern_cache_free (view->pattern_cache);
+	_text_cache_free (view->text_cache);
+	g_hash_table_unref (view->marker_instances);
+	g_hash_table_unref (view->use_instances);
+
 	parent_class->finalize (object);
 }
 
@@ -27,6 +27,8 @@
 #include <lsmdom.h>
 #include <lsmsvgtypes.h>
 #include <lsmsvgelement.h>
+#include <lsmcairo.h>
+#include <lsmsvgfiltersurface.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
 G_BEGIN_DECLS
@@ -47,6 +49,11 @@ typedef struct _LsmSvgViewClass LsmSvgViewClass;
 typedef struct _LsmSvgViewPrivate LsmSvgViewPrivate;
 
 typedef struct _LsmSvgViewPatternData LsmSvgViewPatternData;
+typedef struct _LsmSvgViewPatternCache LsmSvgViewPatternCache;
+typedef struct _LsmSvgViewTextCache LsmSvgViewTextCache;
+
+#define LSM_SVG_VIEW_DEFAULT_PATTERN_CACHE_SIZE	(16 * 1024 * 1024)
+#define LSM_SVG_VIEW_DEFAULT_TEXT_CACHE_SIZE	256
 
 struct _LsmSvgView {
 	LsmDomView dom_view;
@@ -59,28 +66,41 @@ struct _LsmSvgView {
 	GSList *element_stack;
 	GSList *viewbox_stack;
 	GSList *matrix_stack;
-	GSList *pango_layout_stack;
 	GList *background_stack;
 
-	gboolean is_pango_layout_in_use;
-
 	LsmSvgViewPatternData *pattern_data;
-	PangoLayout *pango_layout;
 
 	GSList *pattern_stack;
 
+	LsmSvgViewPatternCache *pattern_cache;
+	LsmSvgViewTextCache *text_cache;
+	GHashTable *marker_instances;
+	GHashTable *use_instances;
+
 	gboolean is_clipping;
 	LsmBox clip_extents;
 
 	double last_stop_offset;
 
-	GSList *filter_surfaces;
+	const LsmSvgFilterGraph *filter_graph;
+	LsmSvgFilterSurface **filter_surfaces;
+	unsigned int filter_node;
+	gsize filter_size;
+	gsize filter_peak_size;
+
+	unsigned int n_culled_elements;
+	unsigned int n_pattern_cache_hits;
+	unsigned int n_text_cache_misses;
+
+	gboolean is_backdrop_dependent;
 
 	gboolean debug_filter;
 	gboolean debug_mask;
 	gboolean debug_pattern;
 	gboolean debug_group;
 	gboolean debug_text;
+	gboolean debug_mask_unbounded;
+	gboolean debug_mask_scalar;
 };
 
 struct _LsmSvgViewClass {
@@ -99,20 +119,37 @@ double * 	lsm_svg_view_normalize_length_list 	(LsmSvgView *view, const LsmSvgLen
 const LsmBox *	lsm_svg_view_get_pattern_extents	(LsmSvgView *view);
 const LsmBox * 	lsm_svg_view_get_object_extents 	(LsmSvgView *view);
 const LsmBox *	lsm_svg_view_get_clip_extents		(LsmSvgView *view);
+gboolean	lsm_svg_view_intersect_pattern_clip	(LsmSvgView *view, LsmBox *box);
+
+cairo_path_t *	lsm_svg_view_copy_clip_path		(LsmSvgView *view, cairo_fill_rule_t *fill_rule);
+void		lsm_svg_view_append_clip_path		(LsmSvgView *view, const cairo_path_t *path,
+							 cairo_fill_rule_t fill_rule);
 
 void		lsm_svg_view_path_extents		(LsmSvgView *view, const char *path, LsmExtents *extents);
+void		lsm_svg_view_cairo_path_extents		(LsmSvgView *view, const LsmCairoPath *path, LsmExtents *extents);
 
 void 		lsm_svg_view_create_radial_gradient 	(LsmSvgView *view, double cx, double cy,
 							                   double r, double fx, double fy);
 void 		lsm_svg_view_create_linear_gradient 	(LsmSvgView *view, double x1, double y1,
 							                   double x2, double y2);
 void 		lsm_svg_view_add_gradient_color_stop	(LsmSvgView *view, double offset);
+double		lsm_svg_view_get_pattern_opacity	(LsmSvgView *view);
+cairo_pattern_t *
+		lsm_svg_view_get_gradient_pattern	(LsmSvgView *view);
+void		lsm_svg_view_set_gradient_pattern	(LsmSvgView *view, cairo_pattern_t *pattern);
 G_GNUC_WARN_UNUSED_RESULT gboolean 	
 		lsm_svg_view_set_gradient_properties	(LsmSvgView *view,
 							 LsmSvgSpreadMethod method,
 							 LsmSvgPatternUnits units,
 							 const LsmSvgMatrix *matrix);
 
+gboolean	lsm_svg_view_set_cached_surface_pattern	(LsmSvgView *view, const LsmSvgElement *element,
+							 const LsmBox *object_extents);
+void		lsm_svg_view_cache_surface_pattern	(LsmSvgView *view, const LsmSvgElement *element,
+							 const LsmBox *object_extents);
+void		lsm_svg_view_set_pattern_cache_size	(LsmSvgView *view, gsize max_size);
+void		lsm_svg_view_set_text_cache_size	(LsmSvgView *view, unsigned int max_size);
+
 G_GNUC_WARN_UNUSED_RESULT gboolean
 		lsm_svg_view_create_surface_pattern	(LsmSvgView *view, const LsmBox *viewport,
 							 const LsmSvgMatrix *matrix,
@@ -125,9 +162,12 @@ void 		lsm_svg_view_show_rectangle 	(LsmSvgView *view, double x, double y,
 void 		lsm_svg_view_show_circle	(LsmSvgView *view, double cx, double cy, double r);
 void 		lsm_svg_view_show_ellipse	(LsmSvgView *view, double cx, double cy, double rx, double ry);
 void		lsm_svg_view_show_path		(LsmSvgView *view, const char *d);
+void		lsm_svg_view_show_cairo_path	(LsmSvgView *view, const LsmCairoPath *path);
 void 		lsm_svg_view_show_line 		(LsmSvgView *view, double x1, double y1, double x2, double y2);
 void 		lsm_svg_view_show_polyline	(LsmSvgView *view, const char *points);
 void 		lsm_svg_view_show_polygon	(LsmSvgView *view, const char *points);
+void 		lsm_svg_view_show_polyline_points	(LsmSvgView *view, unsigned int n_points, const double *points);
+void 		lsm_svg_view_show_polygon_points	(LsmSvgView *view, unsigned int n_points, const double *points);
 void 		lsm_svg_view_start_text 	(LsmSvgView *view);
 void 		lsm_svg_view_end_text 		(LsmSvgView *view);
 void 		lsm_svg_view_show_text 		(LsmSvgView *view, char const *string, 
@@ -138,6 +178,7 @@ void 		lsm_svg_view_text_extents 	(LsmSvgView *view, char const *string,
 						 unsigned int n_dx, double *dx, unsigned int n_dy, double *dy,
 						 LsmExtents *extents);
 void		lsm_svg_view_show_pixbuf	(LsmSvgView *view, GdkPixbuf *pixbuf);
+void		lsm_svg_view_show_surface	(LsmSvgView *view, cairo_surface_t *surface);
 
 void 		lsm_svg_view_push_viewbox 		(LsmSvgView *view, const LsmBox *viewbox);
 void 		lsm_svg_view_pop_viewbox 		(LsmSvgView *view);
@@ -157,6 +198,15 @@ void		lsm_svg_view_push_element		(LsmSvgView *view, const LsmSvgElement *element
 void		lsm_svg_view_pop_element		(LsmSvgView *view);
 LsmSvgElement * lsm_svg_view_get_referencing_element 	(LsmSvgView *view);
 
+gboolean	lsm_svg_view_is_element_culled		(LsmSvgView *view, LsmSvgElement *element, LsmSvgStyle *style);
+unsigned int	lsm_svg_view_get_n_culled_elements	(LsmSvgView *view);
+unsigned int	lsm_svg_view_get_n_pattern_cache_hits	(LsmSvgView *view);
+unsigned int	lsm_svg_view_get_n_text_cache_misses	(LsmSvgView *view);
+gsize		lsm_svg_view_get_filter_peak_size	(LsmSvgView *view);
+
+gboolean	lsm_svg_view_render_instance		(LsmSvgView *view, LsmSvgElement *element,
+							 double width, double height);
+
 void		lsm_svg_view_push_style			(LsmSvgView *view, LsmSvgStyle *style);
 void		lsm_svg_view_pop_style			(LsmSvgView *view);
 LsmSvgStyle *	lsm_svg_view_get_current_style		(LsmSvgView *view);
@@ -175,6 +225,10 @@ void 		lsm_svg_view_apply_offset 		(LsmSvgView *view, const char *input, const c
 void 		lsm_svg_view_apply_color_matrix 	(LsmSvgView *view, const char *input, const char *output,
 							 const LsmBox *subregion, LsmSvgColorFilterType type,
 							 unsigned int n_values, const double *values);
+void 		lsm_svg_view_apply_component_transfer 	(LsmSvgView *view, const char *input, const char *output,
+							 const LsmBox *subregion,
+							 const guint8 *red, const guint8 *green, const guint8 *blue,
+							 const guint8 *alpha);
 void		lsm_svg_view_apply_displacement_map 	(LsmSvgView *view, const char *input_1, const char *input_2, const char *output,
 							 const LsmBox *subregion, double scale,
 							 LsmSvgChannelSelector x_channel_selector,
@@ -189,7 +243,12 @@ void 		lsm_svg_view_apply_convolve_matrix 	(LsmSvgView *view, const char *input,
 							 unsigned a, unsigned b, unsigned n_values, double *values,
 							 double divisor, double bias, int target_x, int target_y,
 							 LsmSvgEdgeMode edge_mode, gboolean preserve_alpha);
-void 		lsm_svg_view_apply_specular_lighting 	(LsmSvgView *view, const char *output, const LsmBox *subregion,
+void 		lsm_svg_view_apply_diffuse_lighting 	(LsmSvgView *view, const char *input, const char *output,
+							 const LsmBox *subregion, const LsmSvgFilterLight *light,
+							 double surface_scale, double diffuse_constant,
+							 double dx, double dy);
+void 		lsm_svg_view_apply_specular_lighting 	(LsmSvgView *view, const char *input, const char *output,
+							 const LsmBox *subregion, const LsmSvgFilterLight *light,
 							 double surface_scale, double specular_constant, double specular_exponent,
 							 double dx, double dy);
 void		lsm_svg_view_apply_turbulence 		(LsmSvgView *view, const char *output, const LsmBox *subregion,
@@ -243,6 +243,84 @@ insert_before_test (void)
 	g_object_unref (document);
 }
 
+#define PARSE_N_THREADS	8
+#define PARSE_N_DOCUMENTS	512
+
+static const char *parse_svg_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10\" height=\"10\">"
+"<rect x=\"1\" y=\"1\" width=\"8\" height=\"8\" style=\"fill:red\"/>"
+"<text x=\"1\" y=\"9\">Lasem</text>"
+"</svg>";
+
+static const char *parse_mathml_document =
+"<math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+"<mrow><mi>&alpha;</mi><mo>+</mo><mn>1</mn></mrow>"
+"</math>";
+
+static void
+_parse_document_cb (gpointer data, gpointer user_data)
+{
+	int *n_valid_documents = user_data;
+	LsmDomDocument *document;
+	LsmDomNode *root;
+	LsmDomView *view;
+	cairo_surface_t *surface;
+	cairo_t *cairo;
+	gboolean is_svg = GPOINTER_TO_INT (data) % 2 == 0;
+
+	document = lsm_dom_document_new_from_memory (is_svg ? parse_svg_document : parse_mathml_document, -1, NULL);
+	if (document == NULL)
+		return;
+
+	root = lsm_dom_node_get_first_child (LSM_DOM_NODE (document));
+
+	if (root != NULL &&
+	    g_strcmp0 (lsm_dom_node_get_node_name (root), is_svg ? "svg" : "math") == 0) {
+		LsmDomNode *node;
+
+		node = lsm_dom_node_get_first_child (root);
+		if (is_svg)
+			node = lsm_dom_node_get_next_sibling (node);
+		else
+			node = lsm_dom_node_get_first_child (node);
+
+		if (node != NULL &&
+		    g_strcmp0 (lsm_dom_node_get_node_name (node), is_svg ? "text" : "mi") == 0 &&
+		    g_strcmp0 (lsm_dom_node_get_node_value (lsm_dom_node_get_first_child (node)),
+			       is_svg ? "Lasem" : "\xce\xb1") == 0)
+			g_atomic_int_inc (n_valid_documents);
+	}
+
+	/* Rendering reaches the lazily built style and operator tables from all the threads */
+	view = lsm_dom_document_create_view (document);
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 16, 16);
+	cairo = cairo_create (surface);
+	lsm_dom_view_render (view, cairo, 0, 0);
+	cairo_destroy (cairo);
+	cairo_surface_destroy (surface);
+	g_object_unref (view);
+
+	g_object_unref (document);
+}
+
+static void
+concurrent_parse_test (void)
+{
+	GThreadPool *pool;
+	int n_valid_documents = 0;
+	int i;
+
+	pool = g_thread_pool_new (_parse_document_cb, &n_valid_documents, PARSE_N_THREADS, TRUE, NULL);
+	g_assert (pool != NULL);
+
+	for (i = 0; i < PARSE_N_DOCUMENTS; i++)
+		g_thread_pool_push (pool, GINT_TO_POINTER (i + 1), NULL);
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+
+	g_assert_cmpint (n_valid_documents, ==, PARSE_N_DOCUMENTS);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -257,6 +335,7 @@ main (int argc, char *argv[])
 	g_test_add_func ("/dom/add-remove-element", add_remove_element_test);
 	g_test_add_func ("/dom/node-list", node_list_test);
 	g_test_add_func ("/dom/insert-before", insert_before_test);
+	g_test_add_func ("/dom/concurrent-parse", concurrent_parse_test);
 
 	result = g_test_run();
 
@@ -1,5 +1,7 @@
 #include <glib.h>
 #include <lsmsvgfiltersurface.h>
+#include <string.h>
+#include <math.h>
 
 static void
 surface (void)
@@ -49,10 +51,16 @@ similar (void)
 static void
 operations (LsmSvgFilterSurface *input_1, LsmSvgFilterSurface *input_2, LsmSvgFilterSurface *output)
 {
+	LsmSvgFilterLight light = {.type = LSM_SVG_FILTER_LIGHT_TYPE_POINT, .x = 100.0, .y = 50.0, .z = 20.0};
 	cairo_matrix_t transform;
+	guint8 table[256];
+	unsigned int i;
 
 	cairo_matrix_init_identity (&transform);
 
+	for (i = 0; i < 256; i++)
+		table[i] = 255 - i;
+
 	lsm_svg_filter_surface_alpha (input_1, output);
 	lsm_svg_filter_surface_blend (input_1, input_2, output, LSM_SVG_BLENDING_MODE_XOR);
 	lsm_svg_filter_surface_blur (input_1, output, 0.0, 0.0);
@@ -60,7 +68,9 @@ operations (LsmSvgFilterSurface *input_1, LsmSvgFilterSurface *input_2, LsmSvgFi
 	lsm_svg_filter_surface_blur (input_1, output, 10.0, 10.0);
 	lsm_svg_filter_surface_blur (input_1, output, 1000.0, 1000.0);
 	lsm_svg_filter_surface_color_matrix (input_1, output, LSM_SVG_COLOR_FILTER_TYPE_HUE_ROTATE, 0, NULL);
+	lsm_svg_filter_surface_component_transfer (input_1, output, table, table, table, table);
 	lsm_svg_filter_surface_convolve_matrix (input_1, output, 0, 0, 0, NULL, 1.0, 0.0, 0, 0, LSM_SVG_EDGE_MODE_NONE, TRUE);
+	lsm_svg_filter_surface_diffuse_lighting (input_1, output, &light, 2.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0);
 	lsm_svg_filter_surface_displacement_map (input_1, input_2, output, 2.0, 2.0,
 						 LSM_SVG_CHANNEL_SELECTOR_RED, LSM_SVG_CHANNEL_SELECTOR_GREEN);
 	lsm_svg_filter_surface_displacement_map (input_1, input_2, output, 2.0, 3.0,
@@ -74,6 +84,7 @@ operations (LsmSvgFilterSurface *input_1, LsmSvgFilterSurface *input_2, LsmSvgFi
 	lsm_svg_filter_surface_offset (input_1, output, 10, 10);
 	lsm_svg_filter_surface_offset (input_1, output, -10, -10);
 	lsm_svg_filter_surface_offset (input_1, output, -1000, -1000);
+	lsm_svg_filter_surface_specular_lighting (input_1, output, &light, 2.0, 1.0, 20.0, 1.0, 1.0, 1.0, 1.0, 1.0);
 	lsm_svg_filter_surface_tile (input_1, output);
 	lsm_svg_filter_surface_turbulence (output, 10.0, 10.0, 2, 1.0, LSM_SVG_STITCH_TILES_STITCH, LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE,
 					   &transform);
@@ -123,15 +134,992 @@ processing_null (void)
 	if (!g_test_undefined())
 		return;
 
-	for (i = 0; i < 20; i++)
+	for (i = 0; i < 23; i++)
 		g_test_expect_message ("Lasem", G_LOG_LEVEL_CRITICAL, "*assertion*NULL*failed");
 
 	operations (NULL, NULL, NULL);
 
-	for (i = 0; i < 20; i++)
+	for (i = 0; i < 23; i++)
 		g_test_assert_expected_messages ();
 }
 
+static void
+_fill_random (LsmSvgFilterSurface *surface, guint32 seed)
+{
+	cairo_surface_t *cairo_surface;
+	guint32 *pixels;
+	int width, height, stride;
+	int x, y;
+
+	cairo_surface = lsm_svg_filter_surface_get_cairo_surface (surface);
+	pixels = (guint32 *) cairo_image_surface_get_data (cairo_surface);
+	width = cairo_image_surface_get_width (cairo_surface);
+	height = cairo_image_surface_get_height (cairo_surface);
+	stride = cairo_image_surface_get_stride (cairo_surface) / 4;
+
+	for (y = 0; y < height; y++)
+		for (x = 0; x < width; x++) {
+			seed = seed * 1103515245 + 12345;
+			pixels[y * stride + x] = seed ^ (seed >> 16);
+		}
+
+	cairo_surface_mark_dirty (cairo_surface);
+}
+
+static void
+_assert_same_pixels (LsmSvgFilterSurface *surface_a, LsmSvgFilterSurface *surface_b)
+{
+	cairo_surface_t *cairo_a = lsm_svg_filter_surface_get_cairo_surface (surface_a);
+	cairo_surface_t *cairo_b = lsm_svg_filter_surface_get_cairo_surface (surface_b);
+	int height;
+	int y;
+
+	cairo_surface_flush (cairo_a);
+	cairo_surface_flush (cairo_b);
+
+	height = cairo_image_surface_get_height (cairo_a);
+
+	g_assert_cmpint (cairo_image_surface_get_stride (cairo_a), ==, cairo_image_surface_get_stride (cairo_b));
+	g_assert_cmpint (height, ==, cairo_image_surface_get_height (cairo_b));
+
+	for (y = 0; y < height; y++) {
+		size_t offset = y * cairo_image_surface_get_stride (cairo_a);
+
+		g_assert (memcmp (cairo_image_surface_get_data (cairo_a) + offset,
+				  cairo_image_surface_get_data (cairo_b) + offset,
+				  cairo_image_surface_get_width (cairo_a) * 4) == 0);
+	}
+}
+
+static void
+blur_simd (void)
+{
+	static const int sizes[][2] = {{1, 1}, {13, 9}, {3, 200}, {400, 300}};
+	static const double deviations[][2] = {{1.0, 0.0}, {0.0, 2.0}, {2.0, 3.0}, {15.0, 1.0}, {60.0, 60.0}};
+	gboolean simd_enabled;
+	unsigned int i, j;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+		LsmSvgFilterSurface *input;
+		LsmSvgFilterSurface *scalar;
+		LsmSvgFilterSurface *simd;
+		LsmBox subregion = {0, 0, sizes[i][0], sizes[i][1]};
+
+		input = lsm_svg_filter_surface_new ("input", sizes[i][0], sizes[i][1], &subregion);
+		scalar = lsm_svg_filter_surface_new_similar ("scalar", input, NULL);
+		simd = lsm_svg_filter_surface_new_similar ("simd", input, NULL);
+
+		_fill_random (input, i + 1);
+
+		for (j = 0; j < G_N_ELEMENTS (deviations); j++) {
+			lsm_svg_filter_surface_set_simd_enabled (FALSE);
+			lsm_svg_filter_surface_blur (input, scalar, deviations[j][0], deviations[j][1]);
+			lsm_svg_filter_surface_set_simd_enabled (TRUE);
+			lsm_svg_filter_surface_blur (input, simd, deviations[j][0], deviations[j][1]);
+
+			_assert_same_pixels (scalar, simd);
+		}
+
+		lsm_svg_filter_surface_unref (input);
+		lsm_svg_filter_surface_unref (scalar);
+		lsm_svg_filter_surface_unref (simd);
+	}
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+static void
+cleanup (void)
+{
+	LsmSvgFilterSurface *input;
+	LsmSvgFilterSurface *before;
+	LsmSvgFilterSurface *after;
+	LsmBox subregion = {0, 0, 400, 300};
+
+	input = lsm_svg_filter_surface_new ("input", 400, 300, &subregion);
+	before = lsm_svg_filter_surface_new_similar ("before", input, NULL);
+	after = lsm_svg_filter_surface_new_similar ("after", input, NULL);
+
+	_fill_random (input, 1);
+
+	/* Large enough to be processed by the thread pool, which must be recreated after a cleanup */
+	lsm_svg_filter_surface_blur (input, before, 5.0, 5.0);
+	lsm_svg_filter_surface_cleanup ();
+	lsm_svg_filter_surface_blur (input, after, 5.0, 5.0);
+
+	_assert_same_pixels (before, after);
+
+	lsm_svg_filter_surface_unref (input);
+	lsm_svg_filter_surface_unref (before);
+	lsm_svg_filter_surface_unref (after);
+}
+
+/* Brute force reference for the morphology filter */
+
+static void
+_morphology_reference (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+		       LsmSvgMorphologyOperator op, int kx, int ky)
+{
+	cairo_surface_t *input_surface = lsm_svg_filter_surface_get_cairo_surface (input);
+	cairo_surface_t *output_surface = lsm_svg_filter_surface_get_cairo_surface (output);
+	const LsmBox *subregion = lsm_svg_filter_surface_get_subregion (input);
+	guchar *in_pixels;
+	guchar *output_pixels;
+	int width, height, rowstride;
+	int x, y, x1, x2, y1, y2;
+	int i, j, ch, extreme;
+
+	cairo_surface_flush (input_surface);
+	cairo_surface_flush (output_surface);
+
+	in_pixels = cairo_image_surface_get_data (input_surface);
+	output_pixels = cairo_image_surface_get_data (output_surface);
+	rowstride = cairo_image_surface_get_stride (input_surface);
+	width = cairo_image_surface_get_width (input_surface);
+	height = cairo_image_surface_get_height (input_surface);
+
+	x1 = CLAMP (subregion->x, 0, width);
+	x2 = CLAMP (subregion->x + subregion->width, 0, width);
+	y1 = CLAMP (subregion->y, 0, height);
+	y2 = CLAMP (subregion->y + subregion->height, 0, height);
+
+	for (y = y1; y < y2; y++)
+		for (x = x1; x < x2; x++)
+			for (ch = 0; ch < 4; ch++) {
+				extreme = op == LSM_SVG_MORPHOLOGY_OPERATOR_ERODE ? 255 : 0;
+
+				for (i = -ky; i < ky + 1; i++)
+					for (j = -kx; j < kx + 1; j++) {
+						int val;
+
+						if (y + i >= height || y + i < 0 || x + j >= width || x + j < 0)
+							continue;
+
+						val = in_pixels[(y + i) * rowstride + (x + j) * 4 + ch];
+
+						if (op == LSM_SVG_MORPHOLOGY_OPERATOR_ERODE)
+							extreme = MIN (extreme, val);
+						else
+							extreme = MAX (extreme, val);
+					}
+
+				output_pixels[y * rowstride + x * 4 + ch] = extreme;
+			}
+
+	cairo_surface_mark_dirty (output_surface);
+}
+
+static void
+morphology (void)
+{
+	static const int sizes[][2] = {{1, 1}, {17, 11}, {300, 250}};
+	static const int radii[][2] = {{1, 0}, {0, 2}, {2, 3}, {7, 1}, {20, 20}};
+	static const LsmBox subregions[] = {{0, 0, 1000, 1000}, {2, 1, 9, 7}, {-5, 3, 40, 30}};
+	gboolean simd_enabled;
+	unsigned int i, j, k, l;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+		for (j = 0; j < G_N_ELEMENTS (subregions); j++) {
+			LsmSvgFilterSurface *input;
+			LsmSvgFilterSurface *reference;
+			LsmSvgFilterSurface *output;
+
+			input = lsm_svg_filter_surface_new ("input", sizes[i][0], sizes[i][1], &subregions[j]);
+			reference = lsm_svg_filter_surface_new_similar ("reference", input, NULL);
+			output = lsm_svg_filter_surface_new_similar ("output", input, NULL);
+
+			_fill_random (input, i + 1);
+
+			for (k = 0; k < G_N_ELEMENTS (radii); k++)
+				for (l = 0; l < 2; l++) {
+					LsmSvgMorphologyOperator op = l == 0 ?
+						LSM_SVG_MORPHOLOGY_OPERATOR_ERODE :
+						LSM_SVG_MORPHOLOGY_OPERATOR_DILATE;
+
+					_morphology_reference (input, reference, op, radii[k][0], radii[k][1]);
+
+					lsm_svg_filter_surface_set_simd_enabled (FALSE);
+					lsm_svg_filter_surface_morphology (input, output, op, radii[k][0], radii[k][1]);
+					_assert_same_pixels (reference, output);
+
+					lsm_svg_filter_surface_set_simd_enabled (TRUE);
+					lsm_svg_filter_surface_morphology (input, output, op, radii[k][0], radii[k][1]);
+					_assert_same_pixels (reference, output);
+				}
+
+			lsm_svg_filter_surface_unref (input);
+			lsm_svg_filter_surface_unref (reference);
+			lsm_svg_filter_surface_unref (output);
+		}
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+/* Brute force reference for the convolve matrix filter, in double precision and straight from the
+ * specification formula, with the kernel values applied in reverse order. Colors are unpremultiplied before
+ * the convolution. */
+
+static void
+_convolve_matrix_reference (LsmSvgFilterSurface *input, LsmSvgFilterSurface *output,
+			    int order_x, int order_y, const double *values, double divisor, double bias,
+			    int target_x, int target_y, LsmSvgEdgeMode edge_mode, gboolean preserve_alpha)
+{
+	cairo_surface_t *input_surface = lsm_svg_filter_surface_get_cairo_surface (input);
+	cairo_surface_t *output_surface = lsm_svg_filter_surface_get_cairo_surface (output);
+	const LsmBox *subregion = lsm_svg_filter_surface_get_subregion (input);
+	const guint32 *in_pixels;
+	guint32 *output_pixels;
+	int width, height, stride;
+	int x, y, x1, x2, y1, y2;
+	int i, j, c;
+
+	cairo_surface_flush (input_surface);
+	cairo_surface_flush (output_surface);
+
+	in_pixels = (const guint32 *) cairo_image_surface_get_data (input_surface);
+	output_pixels = (guint32 *) cairo_image_surface_get_data (output_surface);
+	stride = cairo_image_surface_get_stride (input_surface) / 4;
+	width = cairo_image_surface_get_width (input_surface);
+	height = cairo_image_surface_get_height (input_surface);
+
+	x1 = CLAMP (subregion->x, 0, width);
+	x2 = CLAMP (subregion->x + subregion->width, 0, width);
+	y1 = CLAMP (subregion->y, 0, height);
+	y2 = CLAMP (subregion->y + subregion->height, 0, height);
+
+	for (y = 0; y < y2 - y1; y++)
+		for (x = 0; x < x2 - x1; x++) {
+			double sum[4] = {0.0, 0.0, 0.0, 0.0};
+			guint32 result;
+			int value[4];
+			int alpha;
+
+			for (i = 0; i < order_y; i++)
+				for (j = 0; j < order_x; j++) {
+					int sx = x - target_x + j;
+					int sy = y - target_y + i;
+					double kernel_value = values[(order_x - j - 1) + (order_y - i - 1) * order_x];
+					guint32 pixel;
+
+					if (sx < 0 || sx >= x2 - x1 || sy < 0 || sy >= y2 - y1) {
+						if (edge_mode == LSM_SVG_EDGE_MODE_NONE)
+							continue;
+						if (edge_mode == LSM_SVG_EDGE_MODE_DUPLICATE) {
+							sx = CLAMP (sx, 0, x2 - x1 - 1);
+							sy = CLAMP (sy, 0, y2 - y1 - 1);
+						} else {
+							sx = ((sx % (x2 - x1)) + (x2 - x1)) % (x2 - x1);
+							sy = ((sy % (y2 - y1)) + (y2 - y1)) % (y2 - y1);
+						}
+					}
+
+					pixel = in_pixels[(y1 + sy) * stride + x1 + sx];
+					alpha = pixel >> 24;
+
+					sum[3] += kernel_value * alpha;
+					if (alpha > 0)
+						for (c = 0; c < 3; c++)
+							sum[c] += kernel_value *
+								MIN (((pixel >> (8 * c)) & 0xff) * 255 / alpha, 255);
+				}
+
+			for (c = 0; c < 4; c++)
+				value[c] = CLAMP ((int) (sum[c] / divisor + bias), 0, 255);
+
+			alpha = preserve_alpha ? in_pixels[(y1 + y) * stride + x1 + x] >> 24 : value[3];
+
+			result = (guint32) alpha << 24;
+			for (c = 0; c < 3; c++)
+				result |= (guint32) (value[c] * alpha / 255) << (8 * c);
+
+			output_pixels[(y1 + y) * stride + x1 + x] = result;
+		}
+
+	cairo_surface_mark_dirty (output_surface);
+}
+
+static void
+convolve_matrix (void)
+{
+	static const double identity[] = {0, 0, 0, 0, 1, 0, 0, 0, 0};
+	static const double box[] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+	LsmSvgFilterSurface *input;
+	LsmSvgFilterSurface *output;
+	LsmBox subregion = {0, 0, 300, 250};
+	gboolean simd_enabled;
+	cairo_surface_t *surface;
+	guint32 *pixels;
+	unsigned int i;
+	int x, y, stride;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	input = lsm_svg_filter_surface_new ("input", subregion.width, subregion.height, &subregion);
+	output = lsm_svg_filter_surface_new_similar ("output", input, NULL);
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (input);
+	pixels = (guint32 *) cairo_image_surface_get_data (surface);
+	stride = cairo_image_surface_get_stride (surface) / 4;
+
+	for (i = 0; i < 2; i++) {
+		lsm_svg_filter_surface_set_simd_enabled (i == 1);
+
+		/* Opaque pixels go through the identity kernel unchanged */
+
+		_fill_random (input, i + 1);
+		for (y = 0; y < subregion.height; y++)
+			for (x = 0; x < subregion.width; x++)
+				pixels[y * stride + x] |= 0xff000000;
+		cairo_surface_mark_dirty (surface);
+
+		lsm_svg_filter_surface_convolve_matrix (input, output, 3, 3, 9, identity, 1.0, 0.0, 1, 1,
+							LSM_SVG_EDGE_MODE_DUPLICATE, FALSE);
+		_assert_same_pixels (input, output);
+
+		/* Separable kernel over a uniform surface */
+
+		for (y = 0; y < subregion.height; y++)
+			for (x = 0; x < subregion.width; x++)
+				pixels[y * stride + x] = 0xff204080;
+		cairo_surface_mark_dirty (surface);
+
+		lsm_svg_filter_surface_convolve_matrix (input, output, 3, 3, 9, box, 9.0, 0.0, 1, 1,
+							LSM_SVG_EDGE_MODE_WRAP, FALSE);
+		_assert_same_pixels (input, output);
+	}
+
+	lsm_svg_filter_surface_unref (input);
+	lsm_svg_filter_surface_unref (output);
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+/* Asymmetric, non separable kernels, which go through the general kernel path. Their coefficients, divisors
+ * and biases are exact in single precision, so the results match the double precision reference exactly. */
+
+static void
+convolve_matrix_reference (void)
+{
+	static const double emboss[] = {2, 0, 0, 0, -1, 0, 0, 0, -1};
+	static const double skewed[] = {1, 2, 0, -1, 0, 3, -2, 1, -1, 0, 1, 2};
+	static const struct {
+		int order_x, order_y;
+		const double *values;
+		double divisor;
+		double bias;
+		int target_x, target_y;
+	} kernels[] = {
+		{3, 3, emboss, 1.0, 128.0, 1, 1},
+		{3, 3, emboss, 2.0, 0.0, 0, 2},
+		{4, 3, skewed, 4.0, 32.0, 3, 0},
+		{4, 3, skewed, 8.0, 0.0, 1, 2}
+	};
+	static const LsmSvgEdgeMode edge_modes[] = {
+		LSM_SVG_EDGE_MODE_DUPLICATE,
+		LSM_SVG_EDGE_MODE_WRAP,
+		LSM_SVG_EDGE_MODE_NONE
+	};
+	static const int sizes[][2] = {{1, 1}, {17, 11}, {120, 90}};
+	static const LsmBox subregions[] = {{0, 0, 1000, 1000}, {2, 1, 9, 7}};
+	gboolean simd_enabled;
+	unsigned int i, j, k, l, m;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+		for (j = 0; j < G_N_ELEMENTS (subregions); j++) {
+			LsmSvgFilterSurface *input;
+			LsmSvgFilterSurface *reference;
+			LsmSvgFilterSurface *output;
+			cairo_surface_t *surface;
+			guint32 *pixels;
+			int x, y, stride;
+
+			input = lsm_svg_filter_surface_new ("input", sizes[i][0], sizes[i][1], &subregions[j]);
+			reference = lsm_svg_filter_surface_new_similar ("reference", input, NULL);
+			output = lsm_svg_filter_surface_new_similar ("output", input, NULL);
+
+			/* Random translucent pixels, with valid premultiplied colors */
+
+			_fill_random (input, i + 1);
+
+			surface = lsm_svg_filter_surface_get_cairo_surface (input);
+			pixels = (guint32 *) cairo_image_surface_get_data (surface);
+			stride = cairo_image_surface_get_stride (surface) / 4;
+
+			for (y = 0; y < sizes[i][1]; y++)
+				for (x = 0; x < sizes[i][0]; x++) {
+					guint32 pixel = pixels[y * stride + x];
+					guint32 alpha = pixel >> 24;
+					int c;
+
+					for (c = 0; c < 24; c += 8)
+						if (((pixel >> c) & 0xff) > alpha)
+							pixel = (pixel & ~(0xffu << c)) | (alpha << c);
+					pixels[y * stride + x] = pixel;
+				}
+			cairo_surface_mark_dirty (surface);
+
+			for (k = 0; k < G_N_ELEMENTS (kernels); k++)
+				for (l = 0; l < G_N_ELEMENTS (edge_modes); l++)
+					for (m = 0; m < 2; m++) {
+						_convolve_matrix_reference (input, reference,
+									    kernels[k].order_x, kernels[k].order_y,
+									    kernels[k].values,
+									    kernels[k].divisor, kernels[k].bias,
+									    kernels[k].target_x, kernels[k].target_y,
+									    edge_modes[l], m == 1);
+
+						lsm_svg_filter_surface_set_simd_enabled (FALSE);
+						lsm_svg_filter_surface_convolve_matrix (input, output,
+											kernels[k].order_x,
+											kernels[k].order_y,
+											kernels[k].order_x *
+											kernels[k].order_y,
+											kernels[k].values,
+											kernels[k].divisor,
+											kernels[k].bias,
+											kernels[k].target_x,
+											kernels[k].target_y,
+											edge_modes[l], m == 1);
+						_assert_same_pixels (reference, output);
+
+						lsm_svg_filter_surface_set_simd_enabled (TRUE);
+						lsm_svg_filter_surface_convolve_matrix (input, output,
+											kernels[k].order_x,
+											kernels[k].order_y,
+											kernels[k].order_x *
+											kernels[k].order_y,
+											kernels[k].values,
+											kernels[k].divisor,
+											kernels[k].bias,
+											kernels[k].target_x,
+											kernels[k].target_y,
+											edge_modes[l], m == 1);
+						_assert_same_pixels (reference, output);
+					}
+
+			lsm_svg_filter_surface_unref (input);
+			lsm_svg_filter_surface_unref (reference);
+			lsm_svg_filter_surface_unref (output);
+		}
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+static void
+turbulence (void)
+{
+	LsmSvgFilterSurface *scalar;
+	LsmSvgFilterSurface *simd;
+	LsmBox subregion = {10, 20, 250, 200};
+	cairo_matrix_t transform;
+	gboolean simd_enabled;
+	unsigned int i;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	cairo_matrix_init (&transform, 1.5, 0.2, -0.1, 0.8, 4.0, -2.0);
+
+	scalar = lsm_svg_filter_surface_new ("scalar", 300, 250, &subregion);
+	simd = lsm_svg_filter_surface_new_similar ("simd", scalar, NULL);
+
+	for (i = 0; i < 4; i++) {
+		LsmSvgStitchTiles stitch_tiles = i % 2 ? LSM_SVG_STITCH_TILES_STITCH : LSM_SVG_STITCH_TILES_NO_STITCH;
+		LsmSvgTurbulenceType type = i / 2 ? LSM_SVG_TURBULENCE_TYPE_TURBULENCE : LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE;
+
+		lsm_svg_filter_surface_set_simd_enabled (FALSE);
+		lsm_svg_filter_surface_turbulence (scalar, 0.05, 0.02, 4, i, stitch_tiles, type, &transform);
+		lsm_svg_filter_surface_set_simd_enabled (TRUE);
+		lsm_svg_filter_surface_turbulence (simd, 0.05, 0.02, 4, i, stitch_tiles, type, &transform);
+
+		_assert_same_pixels (scalar, simd);
+	}
+
+	lsm_svg_filter_surface_unref (scalar);
+	lsm_svg_filter_surface_unref (simd);
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+/* Turbulence as computed before the lattice was shared between channels and cached, without stitching */
+
+#define TURBULENCE_RAND_m 	2147483647
+#define TURBULENCE_RAND_a 	16807
+#define TURBULENCE_RAND_q 	127773
+#define TURBULENCE_RAND_r 	2836
+#define TURBULENCE_BSize 	0x100
+#define TURBULENCE_BM 		0xff
+#define TURBULENCE_PerlinN 	0x1000
+
+typedef struct {
+	int uLatticeSelector[TURBULENCE_BSize + TURBULENCE_BSize + 2];
+	double fGradient[4][TURBULENCE_BSize + TURBULENCE_BSize + 2][2];
+} TurbulenceReference;
+
+static long
+_turbulence_reference_random (int lSeed)
+{
+	long result;
+
+	result = TURBULENCE_RAND_a * (lSeed % TURBULENCE_RAND_q) - TURBULENCE_RAND_r * (lSeed / TURBULENCE_RAND_q);
+	if (result <= 0)
+		result += TURBULENCE_RAND_m;
+	return result;
+}
+
+static void
+_turbulence_reference_init (TurbulenceReference *turbulence, int lSeed)
+{
+	double s;
+	int i, j, k;
+
+	if (lSeed <= 0)
+		lSeed = -(lSeed % (TURBULENCE_RAND_m - 1)) + 1;
+	if (lSeed > TURBULENCE_RAND_m - 1)
+		lSeed = TURBULENCE_RAND_m - 1;
+
+	for (k = 0; k < 4; k++) {
+		for (i = 0; i < TURBULENCE_BSize; i++) {
+			turbulence->uLatticeSelector[i] = i;
+			for (j = 0; j < 2; j++)
+				turbulence->fGradient[k][i][j] =
+					(double) (((lSeed = _turbulence_reference_random (lSeed)) %
+						   (TURBULENCE_BSize + TURBULENCE_BSize)) - TURBULENCE_BSize) /
+					TURBULENCE_BSize;
+			s = (double) (sqrt (turbulence->fGradient[k][i][0] * turbulence->fGradient[k][i][0] +
+					    turbulence->fGradient[k][i][1] * turbulence->fGradient[k][i][1]));
+			turbulence->fGradient[k][i][0] /= s;
+			turbulence->fGradient[k][i][1] /= s;
+		}
+	}
+
+	while (--i) {
+		k = turbulence->uLatticeSelector[i];
+		turbulence->uLatticeSelector[i] = turbulence->uLatticeSelector[j =
+			(lSeed = _turbulence_reference_random (lSeed)) % TURBULENCE_BSize];
+		turbulence->uLatticeSelector[j] = k;
+	}
+
+	for (i = 0; i < TURBULENCE_BSize + 2; i++) {
+		turbulence->uLatticeSelector[TURBULENCE_BSize + i] = turbulence->uLatticeSelector[i];
+		for (k = 0; k < 4; k++)
+			for (j = 0; j < 2; j++)
+				turbulence->fGradient[k][TURBULENCE_BSize + i][j] = turbulence->fGradient[k][i][j];
+	}
+}
+
+static double
+_turbulence_reference_noise2 (TurbulenceReference *turbulence, int nColorChannel, double vec[2])
+{
+	int bx0, bx1, by0, by1, b00, b10, b01, b11;
+	double rx0, rx1, ry0, ry1, *q, sx, sy, a, b, t, u, v;
+	int i, j;
+
+	t = vec[0] + TURBULENCE_PerlinN;
+	bx0 = (int) t;
+	bx1 = bx0 + 1;
+	rx0 = t - (int) t;
+	rx1 = rx0 - 1.0f;
+	t = vec[1] + TURBULENCE_PerlinN;
+	by0 = (int) t;
+	by1 = by0 + 1;
+	ry0 = t - (int) t;
+	ry1 = ry0 - 1.0f;
+
+	bx0 &= TURBULENCE_BM;
+	bx1 &= TURBULENCE_BM;
+	by0 &= TURBULENCE_BM;
+	by1 &= TURBULENCE_BM;
+	i = turbulence->uLatticeSelector[bx0];
+	j = turbulence->uLatticeSelector[bx1];
+	b00 = turbulence->uLatticeSelector[i + by0];
+	b10 = turbulence->uLatticeSelector[j + by0];
+	b01 = turbulence->uLatticeSelector[i + by1];
+	b11 = turbulence->uLatticeSelector[j + by1];
+	sx = rx0 * rx0 * (3. - 2. * rx0);
+	sy = ry0 * ry0 * (3. - 2. * ry0);
+	q = turbulence->fGradient[nColorChannel][b00];
+	u = rx0 * q[0] + ry0 * q[1];
+	q = turbulence->fGradient[nColorChannel][b10];
+	v = rx1 * q[0] + ry0 * q[1];
+	a = u + sx * (v - u);
+	q = turbulence->fGradient[nColorChannel][b01];
+	u = rx0 * q[0] + ry1 * q[1];
+	q = turbulence->fGradient[nColorChannel][b11];
+	v = rx1 * q[0] + ry1 * q[1];
+	b = u + sx * (v - u);
+
+	return a + sy * (b - a);
+}
+
+static void
+_turbulence_reference (LsmSvgFilterSurface *output, double base_frequency_x, double base_frequency_y,
+		       int n_octaves, int seed, LsmSvgTurbulenceType type, const cairo_matrix_t *transform)
+{
+	static const int channelmap[4] = {2, 1, 0, 3};
+	cairo_surface_t *output_surface = lsm_svg_filter_surface_get_cairo_surface (output);
+	const LsmBox *subregion = lsm_svg_filter_surface_get_subregion (output);
+	TurbulenceReference turbulence;
+	cairo_matrix_t affine;
+	guchar *output_pixels;
+	int width, height, rowstride;
+	int x, y, x1, x2, y1, y2;
+	int i, nOctave;
+
+	affine = *transform;
+	g_assert (cairo_matrix_invert (&affine) == CAIRO_STATUS_SUCCESS);
+
+	cairo_surface_flush (output_surface);
+
+	output_pixels = cairo_image_surface_get_data (output_surface);
+	rowstride = cairo_image_surface_get_stride (output_surface);
+	width = cairo_image_surface_get_width (output_surface);
+	height = cairo_image_surface_get_height (output_surface);
+
+	x1 = CLAMP (subregion->x, 0, width);
+	x2 = CLAMP (subregion->x + subregion->width, 0, width);
+	y1 = CLAMP (subregion->y, 0, height);
+	y2 = CLAMP (subregion->y + subregion->height, 0, height);
+
+	_turbulence_reference_init (&turbulence, seed);
+
+	for (y = y1; y < y2; y++)
+		for (x = x1; x < x2; x++) {
+			guchar *pixel = output_pixels + 4 * x + y * rowstride;
+
+			for (i = 0; i < 4; i++) {
+				double vec[2], ratio = 1., fSum = 0.0, cr;
+
+				vec[0] = (affine.xx * x + affine.xy * y + affine.x0) * base_frequency_x;
+				vec[1] = (affine.yx * x + affine.yy * y + affine.y0) * base_frequency_y;
+
+				for (nOctave = 0; nOctave < n_octaves; nOctave++) {
+					if (type == LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
+						fSum += (double) (_turbulence_reference_noise2 (&turbulence, i, vec) /
+								  ratio);
+					else
+						fSum += (double) (fabs (_turbulence_reference_noise2 (&turbulence, i,
+												      vec)) / ratio);
+					vec[0] *= 2;
+					vec[1] *= 2;
+					ratio *= 2;
+				}
+
+				if (type == LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE)
+					cr = ((fSum * 255.) + 255.) / 2.;
+				else
+					cr = (fSum * 255.);
+
+				cr = CLAMP (cr, 0., 255.);
+
+				pixel[channelmap[i]] = (guchar) cr;
+			}
+			for (i = 0; i < 3; i++)
+				pixel[channelmap[i]] = pixel[channelmap[i]] * pixel[channelmap[3]] / 255;
+		}
+
+	cairo_surface_mark_dirty (output_surface);
+}
+
+static void
+turbulence_reference (void)
+{
+	LsmSvgFilterSurface *reference;
+	LsmSvgFilterSurface *output;
+	LsmBox subregion = {10, 20, 250, 200};
+	cairo_matrix_t transform;
+	gboolean simd_enabled;
+	unsigned int i, j;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	cairo_matrix_init (&transform, 1.5, 0.2, -0.1, 0.8, 4.0, -2.0);
+
+	reference = lsm_svg_filter_surface_new ("reference", 300, 250, &subregion);
+	output = lsm_svg_filter_surface_new_similar ("output", reference, NULL);
+
+	/* Same seed twice, the second time from the lattice cache */
+	for (i = 0; i < 6; i++) {
+		LsmSvgTurbulenceType type = i % 2 ? LSM_SVG_TURBULENCE_TYPE_TURBULENCE : LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE;
+		int seed = (int) (i / 2) - 1;
+
+		_turbulence_reference (reference, 0.05, 0.02, 4, seed, type, &transform);
+
+		for (j = 0; j < 2; j++) {
+			lsm_svg_filter_surface_set_simd_enabled (j == 1);
+			lsm_svg_filter_surface_turbulence (output, 0.05, 0.02, 4, seed,
+							   LSM_SVG_STITCH_TILES_NO_STITCH, type, &transform);
+			_assert_same_pixels (reference, output);
+		}
+	}
+
+	lsm_svg_filter_surface_unref (reference);
+	lsm_svg_filter_surface_unref (output);
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+static int
+_get_pixel_distance (guint32 a, guint32 b)
+{
+	int distance = 0;
+	int i;
+
+	for (i = 0; i < 32; i += 8)
+		distance = MAX (distance, ABS ((int) ((a >> i) & 0xff) - (int) ((b >> i) & 0xff)));
+
+	return distance;
+}
+
+static void
+turbulence_stitch (void)
+{
+	LsmSvgFilterSurface *output;
+	LsmBox subregion = {10, 20, 200, 160};
+	cairo_surface_t *surface;
+	cairo_matrix_t transform;
+	guint32 *pixels;
+	int stride;
+	int max_step = 0;
+	int x, y;
+
+	cairo_matrix_init_identity (&transform);
+
+	output = lsm_svg_filter_surface_new ("output", 230, 200, &subregion);
+	lsm_svg_filter_surface_turbulence (output, 0.047, 0.033, 3, 7, LSM_SVG_STITCH_TILES_STITCH,
+					   LSM_SVG_TURBULENCE_TYPE_FRACTAL_NOISE, &transform);
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (output);
+	cairo_surface_flush (surface);
+	pixels = (guint32 *) cairo_image_surface_get_data (surface);
+	stride = cairo_image_surface_get_stride (surface) / 4;
+
+#define TILE_PIXEL(x,y) (pixels[(20 + (y)) * stride + 10 + (x)])
+
+	for (y = 0; y < 160; y++)
+		for (x = 0; x < 200; x++) {
+			if (x > 0)
+				max_step = MAX (max_step, _get_pixel_distance (TILE_PIXEL (x - 1, y), TILE_PIXEL (x, y)));
+			if (y > 0)
+				max_step = MAX (max_step, _get_pixel_distance (TILE_PIXEL (x, y - 1), TILE_PIXEL (x, y)));
+		}
+
+	/* Tiles placed side by side must join like neighbouring pixels of a tile */
+	for (y = 0; y < 160; y++)
+		g_assert_cmpint (_get_pixel_distance (TILE_PIXEL (199, y), TILE_PIXEL (0, y)), <=, max_step);
+	for (x = 0; x < 200; x++)
+		g_assert_cmpint (_get_pixel_distance (TILE_PIXEL (x, 159), TILE_PIXEL (x, 0)), <=, max_step);
+
+#undef TILE_PIXEL
+
+	lsm_svg_filter_surface_unref (output);
+}
+
+static void
+lighting (void)
+{
+	static const LsmSvgFilterLight lights[] = {
+		{.type = LSM_SVG_FILTER_LIGHT_TYPE_DISTANT, .azimuth = 30.0, .elevation = 40.0},
+		{.type = LSM_SVG_FILTER_LIGHT_TYPE_POINT, .x = 50.0, .y = 60.0, .z = 40.0},
+		{.type = LSM_SVG_FILTER_LIGHT_TYPE_SPOT, .x = 50.0, .y = 60.0, .z = 40.0,
+			.points_at_x = 100.0, .points_at_y = 100.0, .specular_exponent = 4.0,
+			.limiting_cone_angle = 30.0, .is_cone_limited = TRUE}
+	};
+	LsmSvgFilterLight zenith = {.type = LSM_SVG_FILTER_LIGHT_TYPE_DISTANT, .elevation = 90.0};
+	LsmSvgFilterSurface *input;
+	LsmSvgFilterSurface *scalar;
+	LsmSvgFilterSurface *simd;
+	LsmBox subregion = {10, 20, 250, 200};
+	gboolean simd_enabled;
+	cairo_surface_t *surface;
+	guint32 *pixels;
+	unsigned int i;
+	int x, y, stride;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	input = lsm_svg_filter_surface_new ("input", 300, 250, &subregion);
+	scalar = lsm_svg_filter_surface_new_similar ("scalar", input, NULL);
+	simd = lsm_svg_filter_surface_new_similar ("simd", input, NULL);
+
+	_fill_random (input, 1);
+
+	for (i = 0; i < G_N_ELEMENTS (lights); i++) {
+		lsm_svg_filter_surface_set_simd_enabled (FALSE);
+		lsm_svg_filter_surface_diffuse_lighting (input, scalar, &lights[i], 5.0, 1.5, 1.0, 1.0, 1.0, 0.8, 0.5);
+		lsm_svg_filter_surface_set_simd_enabled (TRUE);
+		lsm_svg_filter_surface_diffuse_lighting (input, simd, &lights[i], 5.0, 1.5, 1.0, 1.0, 1.0, 0.8, 0.5);
+		_assert_same_pixels (scalar, simd);
+
+		lsm_svg_filter_surface_set_simd_enabled (FALSE);
+		lsm_svg_filter_surface_specular_lighting (input, scalar, &lights[i], 5.0, 1.5, 20.0, 1.0, 1.0, 1.0, 0.8, 0.5);
+		lsm_svg_filter_surface_set_simd_enabled (TRUE);
+		lsm_svg_filter_surface_specular_lighting (input, simd, &lights[i], 5.0, 1.5, 20.0, 1.0, 1.0, 1.0, 0.8, 0.5);
+		_assert_same_pixels (scalar, simd);
+	}
+
+	/* A flat surface lit from above reflects the light color */
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (input);
+	pixels = (guint32 *) cairo_image_surface_get_data (surface);
+	stride = cairo_image_surface_get_stride (surface) / 4;
+
+	for (y = 0; y < 250; y++)
+		for (x = 0; x < 300; x++)
+			pixels[y * stride + x] = 0xff000000;
+	cairo_surface_mark_dirty (surface);
+
+	lsm_svg_filter_surface_diffuse_lighting (input, simd, &zenith, 5.0, 1.0, 1.0, 1.0, 1.0, 0.5, 0.25);
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (simd);
+	pixels = (guint32 *) cairo_image_surface_get_data (surface);
+
+	for (y = subregion.y; y < subregion.y + subregion.height; y++)
+		for (x = subregion.x; x < subregion.x + subregion.width; x++)
+			g_assert_cmphex (pixels[y * stride + x], ==, 0xffff8040);
+
+	lsm_svg_filter_surface_unref (input);
+	lsm_svg_filter_surface_unref (scalar);
+	lsm_svg_filter_surface_unref (simd);
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+static void
+spot_light_exponent (void)
+{
+	static const double exponents[] = {0.0, 0.5, 4.0, 200.0};
+	static const int points[][2] = {{50, 50}, {51, 50}, {53, 54}, {60, 50}};
+	LsmSvgFilterLight light = {.type = LSM_SVG_FILTER_LIGHT_TYPE_SPOT, .x = 50.5, .y = 50.5, .z = 20.0,
+		.points_at_x = 50.5, .points_at_y = 50.5, .points_at_z = 0.0};
+	LsmSvgFilterSurface *input;
+	LsmSvgFilterSurface *output;
+	LsmBox subregion = {0, 0, 101, 101};
+	gboolean simd_enabled;
+	cairo_surface_t *surface;
+	guint32 *pixels;
+	unsigned int i, j, k;
+	int x, y, stride;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	input = lsm_svg_filter_surface_new ("input", 101, 101, &subregion);
+	output = lsm_svg_filter_surface_new_similar ("output", input, NULL);
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (input);
+	pixels = (guint32 *) cairo_image_surface_get_data (surface);
+	stride = cairo_image_surface_get_stride (surface) / 4;
+
+	for (y = 0; y < 101; y++)
+		for (x = 0; x < 101; x++)
+			pixels[y * stride + x] = 0xff000000;
+	cairo_surface_mark_dirty (surface);
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (output);
+	pixels = (guint32 *) cairo_image_surface_get_data (surface);
+
+	/* On a flat surface under a spot light pointing straight down, the light and spot directions make the
+	 * same angle with the normal, and the diffuse factor is cos^(1 + specularExponent). Exponents outside of
+	 * the [1, 128] range of the specular lighting exponent must not be clamped. */
+
+	for (i = 0; i < G_N_ELEMENTS (exponents); i++)
+		for (j = 0; j < 2; j++) {
+			light.specular_exponent = exponents[i];
+
+			lsm_svg_filter_surface_set_simd_enabled (j == 1);
+			lsm_svg_filter_surface_diffuse_lighting (input, output, &light, 0.0, 1.0, 1.0, 1.0,
+								 1.0, 1.0, 1.0);
+			cairo_surface_flush (surface);
+
+			for (k = 0; k < G_N_ELEMENTS (points); k++) {
+				double lx = light.x - (points[k][0] + 0.5);
+				double ly = light.y - (points[k][1] + 0.5);
+				double cos_angle = light.z / sqrt (lx * lx + ly * ly + light.z * light.z);
+				int expected = 255.0 * pow (cos_angle, 1.0 + exponents[i]) + 0.5;
+				int value = pixels[points[k][1] * stride + points[k][0]] & 0xff;
+
+				g_assert_cmpint (ABS (value - expected), <=, 1);
+			}
+		}
+
+	lsm_svg_filter_surface_unref (input);
+	lsm_svg_filter_surface_unref (output);
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
+static void
+component_transfer (void)
+{
+	LsmSvgFilterSurface *input;
+	LsmSvgFilterSurface *scalar;
+	LsmSvgFilterSurface *simd;
+	LsmBox subregion = {10, 20, 250, 200};
+	gboolean simd_enabled;
+	cairo_surface_t *surface;
+	guint8 identity[256];
+	guint8 inverse[256];
+	guint32 *input_pixels;
+	guint32 *output_pixels;
+	unsigned int i;
+	int x, y, stride;
+
+	simd_enabled = lsm_svg_filter_surface_get_simd_enabled ();
+
+	for (i = 0; i < 256; i++) {
+		identity[i] = i;
+		inverse[i] = 255 - i;
+	}
+
+	input = lsm_svg_filter_surface_new ("input", 300, 250, &subregion);
+	scalar = lsm_svg_filter_surface_new_similar ("scalar", input, NULL);
+	simd = lsm_svg_filter_surface_new_similar ("simd", input, NULL);
+
+	_fill_random (input, 1);
+
+	lsm_svg_filter_surface_set_simd_enabled (FALSE);
+	lsm_svg_filter_surface_component_transfer (input, scalar, inverse, identity, inverse, identity);
+	lsm_svg_filter_surface_set_simd_enabled (TRUE);
+	lsm_svg_filter_surface_component_transfer (input, simd, inverse, identity, inverse, identity);
+	_assert_same_pixels (scalar, simd);
+
+	/* Opaque pixels go through the identity tables unchanged, and are inverted by the inverse ones */
+
+	surface = lsm_svg_filter_surface_get_cairo_surface (input);
+	input_pixels = (guint32 *) cairo_image_surface_get_data (surface);
+	stride = cairo_image_surface_get_stride (surface) / 4;
+
+	for (y = 0; y < 250; y++)
+		for (x = 0; x < 300; x++)
+			input_pixels[y * stride + x] |= 0xff000000;
+	cairo_surface_mark_dirty (surface);
+
+	output_pixels = (guint32 *) cairo_image_surface_get_data (lsm_svg_filter_surface_get_cairo_surface (simd));
+
+	lsm_svg_filter_surface_component_transfer (input, simd, identity, identity, identity, identity);
+
+	for (y = subregion.y; y < subregion.y + subregion.height; y++)
+		for (x = subregion.x; x < subregion.x + subregion.width; x++)
+			g_assert_cmphex (output_pixels[y * stride + x], ==, input_pixels[y * stride + x]);
+
+	lsm_svg_filter_surface_component_transfer (input, simd, inverse, inverse, inverse, identity);
+
+	for (y = subregion.y; y < subregion.y + subregion.height; y++)
+		for (x = subregion.x; x < subregion.x + subregion.width; x++)
+			g_assert_cmphex (output_pixels[y * stride + x], ==, input_pixels[y * stride + x] ^ 0x00ffffff);
+
+	lsm_svg_filter_surface_unref (input);
+	lsm_svg_filter_surface_unref (scalar);
+	lsm_svg_filter_surface_unref (simd);
+
+	lsm_svg_filter_surface_set_simd_enabled (simd_enabled);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -144,6 +1132,17 @@ main (int argc, char *argv[])
 	g_test_add_func ("/filter/processing", processing);
 	g_test_add_func ("/filter/processing_mismatch", processing_mismatch);
 	g_test_add_func ("/filter/processing_null", processing_null);
+	g_test_add_func ("/filter/blur_simd", blur_simd);
+	g_test_add_func ("/filter/cleanup", cleanup);
+	g_test_add_func ("/filter/morphology", morphology);
+	g_test_add_func ("/filter/convolve_matrix", convolve_matrix);
+	g_test_add_func ("/filter/convolve_matrix_reference", convolve_matrix_reference);
+	g_test_add_func ("/filter/turbulence", turbulence);
+	g_test_add_func ("/filter/turbulence_reference", turbulence_reference);
+	g_test_add_func ("/filter/turbulence_stitch", turbulence_stitch);
+	g_test_add_func ("/filter/lighting", lighting);
+	g_test_add_func ("/filter/spot_light_exponent", spot_light_exponent);
+	g_test_add_func ("/filter/component_transfer", component_transfer);
 
 	result = g_test_run ();
 
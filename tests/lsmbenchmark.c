@@ -0,0 +1,300 @@
+/* Lasem
+ *
+ * lsm-benchmark - Rendering time measurement utility for Lasem
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1335, USA.
+ *
+ * Usage example, for the mask rendering path:
+ *
+ * lsm-benchmark --zoom 16 tests/data/svg/svg1.1/masking/masking-mask-01-b.svg
+ *
+ * With --mask, each file is rendered with unbounded mask groups and a scalar
+ * luminance pass, then with bounded groups, then with the SSE2 luminance pass,
+ * and the outputs are checked to be identical. Without file, a built-in mask
+ * heavy document is used:
+ *
+ * lsm-benchmark --mask --zoom 16
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <lsm.h>
+#include <lsmsvg.h>
+#include <glib.h>
+#include <glib/gprintf.h>
+
+static char **option_input_filenames = NULL;
+static double option_zoom = 8.0;
+static double option_ppi = 72.0;
+static int option_repeat = 10;
+static gboolean option_mask = FALSE;
+
+static const GOptionEntry entries[] =
+{
+	{ G_OPTION_REMAINING,	' ', 0,	G_OPTION_ARG_FILENAME_ARRAY,
+		&option_input_filenames, 	NULL, NULL},
+	{ "zoom", 		'z', 0, G_OPTION_ARG_DOUBLE,
+		&option_zoom, 			"Zoom factor", NULL },
+	{ "ppi", 		'p', 0, G_OPTION_ARG_DOUBLE,
+		&option_ppi, 			"Pixel per inch", NULL },
+	{ "repeat", 		'r', 0, G_OPTION_ARG_INT,
+		&option_repeat,			"Number of renderings per file", NULL },
+	{ "mask", 		'm', 0, G_OPTION_ARG_NONE,
+		&option_mask,			"Compare the mask rendering paths", NULL },
+	{ NULL }
+};
+
+static void
+lasem_benchmark_time (LsmDomView *view, cairo_surface_t *surface, double *min_time, double *mean_time)
+{
+	cairo_t *cairo;
+	GTimer *timer;
+	double elapsed, total_time = 0.0;
+	int i;
+
+	timer = g_timer_new ();
+	*min_time = G_MAXDOUBLE;
+
+	for (i = 0; i < option_repeat; i++) {
+		cairo = cairo_create (surface);
+		cairo_set_operator (cairo, CAIRO_OPERATOR_CLEAR);
+		cairo_paint (cairo);
+		cairo_set_operator (cairo, CAIRO_OPERATOR_OVER);
+		cairo_scale (cairo, option_zoom, option_zoom);
+
+		g_timer_start (timer);
+		lsm_dom_view_render (view, cairo, 0, 0);
+		cairo_surface_flush (surface);
+		elapsed = g_timer_elapsed (timer, NULL);
+
+		cairo_destroy (cairo);
+
+		*min_time = MIN (*min_time, elapsed);
+		total_time += elapsed;
+	}
+
+	*mean_time = total_time / option_repeat;
+
+	g_timer_destroy (timer);
+}
+
+static LsmDomView *
+lasem_benchmark_create_view (LsmDomDocument *document, unsigned int *width, unsigned int *height)
+{
+	LsmDomView *view;
+
+	view = lsm_dom_document_create_view (document);
+	lsm_dom_view_set_resolution (view, option_ppi);
+	lsm_dom_view_get_size_pixels (view, width, height, NULL);
+
+	*width = *width * option_zoom + 0.5;
+	*height = *height * option_zoom + 0.5;
+
+	return view;
+}
+
+static gboolean
+lasem_benchmark_render (const char *filename)
+{
+	LsmDomDocument *document;
+	LsmDomView *view;
+	cairo_surface_t *surface;
+	GError *error = NULL;
+	unsigned int width, height;
+	double min_time, mean_time;
+
+	document = lsm_dom_document_new_from_path (filename, &error);
+	if (error != NULL) {
+		g_printf ("%s: %s\n", filename, error->message);
+		g_error_free (error);
+		return FALSE;
+	}
+
+	view = lasem_benchmark_create_view (document, &width, &height);
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+
+	lasem_benchmark_time (view, surface, &min_time, &mean_time);
+
+	g_printf ("%s (%ux%u): min %.3f ms, mean %.3f ms\n", filename, width, height,
+		  min_time * 1000.0, mean_time * 1000.0);
+
+	cairo_surface_destroy (surface);
+	g_object_unref (view);
+	g_object_unref (document);
+
+	return TRUE;
+}
+
+/* A grid of rectangles, each one masked by a gradient covering its bounding box. Mask regions are pixel
+ * aligned at integer zoom factors, so bounded and unbounded mask groups give the same output. */
+
+static char *
+lasem_benchmark_mask_document (void)
+{
+	GString *string;
+	int x, y;
+
+	string = g_string_new ("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"128\" height=\"128\">"
+			       "<linearGradient id=\"gradient\">"
+			       "<stop offset=\"0\" stop-color=\"white\"/>"
+			       "<stop offset=\"1\" stop-color=\"black\"/>"
+			       "</linearGradient>"
+			       "<mask id=\"mask\" x=\"0\" y=\"0\" width=\"1\" height=\"1\" "
+			       "maskContentUnits=\"objectBoundingBox\">"
+			       "<rect width=\"1\" height=\"1\" fill=\"url(#gradient)\"/>"
+			       "</mask>");
+
+	for (y = 0; y < 128; y += 8)
+		for (x = 0; x < 128; x += 8)
+			g_string_append_printf (string,
+						"<rect x=\"%d\" y=\"%d\" width=\"8\" height=\"8\" "
+						"fill=\"rgb(%d,%d,255)\" mask=\"url(#mask)\"/>",
+						x, y, x * 2, y * 2);
+
+	g_string_append (string, "</svg>");
+
+	return g_string_free (string, FALSE);
+}
+
+static gboolean
+lasem_benchmark_is_same_surface (cairo_surface_t *a, cairo_surface_t *b)
+{
+	const unsigned char *a_data = cairo_image_surface_get_data (a);
+	const unsigned char *b_data = cairo_image_surface_get_data (b);
+	int width = cairo_image_surface_get_width (a);
+	int height = cairo_image_surface_get_height (a);
+	int stride = cairo_image_surface_get_stride (a);
+	int y;
+
+	for (y = 0; y < height; y++)
+		if (memcmp (a_data + y * stride, b_data + y * stride, width * 4) != 0)
+			return FALSE;
+
+	return TRUE;
+}
+
+static gboolean
+lasem_benchmark_mask (const char *filename)
+{
+	static const struct {
+		const char *name;
+		gboolean is_unbounded;
+		gboolean is_scalar;
+	} modes[] = {
+		{ "unbounded group, scalar luminance",	TRUE,	TRUE },
+		{ "bounded group, scalar luminance",	FALSE,	TRUE },
+		{ "bounded group, simd luminance",	FALSE,	FALSE }
+	};
+	LsmDomDocument *document;
+	LsmDomView *view;
+	cairo_surface_t *reference = NULL;
+	GError *error = NULL;
+	unsigned int width, height;
+	unsigned int i;
+	gboolean success = TRUE;
+
+	if (filename != NULL)
+		document = lsm_dom_document_new_from_path (filename, &error);
+	else {
+		char *buffer;
+
+		buffer = lasem_benchmark_mask_document ();
+		document = lsm_dom_document_new_from_memory (buffer, -1, &error);
+		g_free (buffer);
+
+		filename = "built-in mask document";
+	}
+
+	if (error != NULL) {
+		g_printf ("%s: %s\n", filename, error->message);
+		g_error_free (error);
+		return FALSE;
+	}
+
+	view = lasem_benchmark_create_view (document, &width, &height);
+
+	for (i = 0; i < G_N_ELEMENTS (modes); i++) {
+		cairo_surface_t *surface;
+		double min_time, mean_time;
+		gboolean is_same;
+
+		lsm_dom_view_set_debug (view, "mask-unbounded", modes[i].is_unbounded);
+		lsm_dom_view_set_debug (view, "mask-scalar", modes[i].is_scalar);
+
+		surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+
+		lasem_benchmark_time (view, surface, &min_time, &mean_time);
+
+		is_same = reference == NULL || lasem_benchmark_is_same_surface (reference, surface);
+
+		g_printf ("%s (%ux%u), %s: min %.3f ms, mean %.3f ms%s\n", filename, width, height,
+			  modes[i].name, min_time * 1000.0, mean_time * 1000.0,
+			  is_same ? "" : ", output differs");
+
+		success = success && is_same;
+
+		if (reference == NULL)
+			reference = surface;
+		else
+			cairo_surface_destroy (surface);
+	}
+
+	cairo_surface_destroy (reference);
+	g_object_unref (view);
+	g_object_unref (document);
+
+	return success;
+}
+
+int
+main (int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	unsigned int i;
+	int status = 0;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		g_option_context_free (context);
+		g_print ("Option parsing failed: %s\n", error->message);
+		g_error_free (error);
+		return 1;
+	}
+
+	g_option_context_free (context);
+
+	if ((option_input_filenames == NULL && !option_mask) || option_zoom <= 0.0 || option_repeat < 1) {
+		g_print ("Usage: lsm-benchmark [--zoom=Z] [--repeat=N] [--mask] FILE...\n");
+		return 1;
+	}
+
+	if (option_mask && option_input_filenames == NULL) {
+		if (!lasem_benchmark_mask (NULL))
+			status = 1;
+	} else
+		for (i = 0; option_input_filenames[i] != NULL; i++)
+			if (!(option_mask ?
+			      lasem_benchmark_mask (option_input_filenames[i]) :
+			      lasem_benchmark_render (option_input_filenames[i])))
+				status = 1;
+
+	return status;
+}
+
+/* vim: set sw=8 sts=8: -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 8 -*- */
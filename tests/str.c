@@ -27,6 +27,71 @@ str_consolidate_test (void)
 	g_assert (string == NULL);
 }
 
+static void
+_assert_extents (const LsmExtents *extents, double x1, double y1, double x2, double y2)
+{
+	g_assert_cmpfloat (extents->x1, ==, x1);
+	g_assert_cmpfloat (extents->y1, ==, y1);
+	g_assert_cmpfloat (extents->x2, ==, x2);
+	g_assert_cmpfloat (extents->y2, ==, y2);
+}
+
+static void
+str_point_list_test (void)
+{
+	LsmExtents extents;
+	unsigned int n_points;
+	double *points;
+
+	points = lsm_str_parse_point_list ("1,2 3,4", &n_points, &extents);
+	g_assert (points != NULL);
+	g_assert_cmpint (n_points, ==, 2);
+	g_assert_cmpfloat (points[0], ==, 1.0);
+	g_assert_cmpfloat (points[1], ==, 2.0);
+	g_assert_cmpfloat (points[2], ==, 3.0);
+	g_assert_cmpfloat (points[3], ==, 4.0);
+	_assert_extents (&extents, 1.0, 2.0, 3.0, 4.0);
+	g_free (points);
+
+	/* Signs and exponents separate the coordinates */
+	points = lsm_str_parse_point_list ("10-20-1e1+5.5.5-3", &n_points, &extents);
+	g_assert (points != NULL);
+	g_assert_cmpint (n_points, ==, 3);
+	g_assert_cmpfloat (points[0], ==, 10.0);
+	g_assert_cmpfloat (points[1], ==, -20.0);
+	g_assert_cmpfloat (points[2], ==, -10.0);
+	g_assert_cmpfloat (points[3], ==, 5.5);
+	g_assert_cmpfloat (points[4], ==, 0.5);
+	g_assert_cmpfloat (points[5], ==, -3.0);
+	_assert_extents (&extents, -10.0, -20.0, 10.0, 5.5);
+	g_free (points);
+
+	points = lsm_str_parse_point_list (" \t5 , 6\n", &n_points, NULL);
+	g_assert (points != NULL);
+	g_assert_cmpint (n_points, ==, 1);
+	g_free (points);
+
+	/* An odd number of coordinates is an error, but the extents of the complete pairs are returned */
+	points = lsm_str_parse_point_list ("1 2 3 4 5", &n_points, &extents);
+	g_assert (points == NULL);
+	g_assert_cmpint (n_points, ==, 0);
+	_assert_extents (&extents, 1.0, 2.0, 3.0, 4.0);
+
+	points = lsm_str_parse_point_list ("", &n_points, &extents);
+	g_assert (points == NULL);
+	g_assert_cmpint (n_points, ==, 0);
+	_assert_extents (&extents, 0.0, 0.0, 0.0, 0.0);
+
+	points = lsm_str_parse_point_list (" \t\n ", &n_points, &extents);
+	g_assert (points == NULL);
+	g_assert_cmpint (n_points, ==, 0);
+	_assert_extents (&extents, 0.0, 0.0, 0.0, 0.0);
+
+	points = lsm_str_parse_point_list (NULL, &n_points, &extents);
+	g_assert (points == NULL);
+	g_assert_cmpint (n_points, ==, 0);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -35,6 +100,7 @@ main (int argc, char *argv[])
 	g_test_init (&argc, &argv, NULL);
 
 	g_test_add_func ("/str/str-consolidate", str_consolidate_test);
+	g_test_add_func ("/str/str-point-list", str_point_list_test);
 
 	result = g_test_run();
 
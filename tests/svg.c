@@ -0,0 +1,1427 @@
+#include <glib.h>
+#include <lsmdom.h>
+#include <lsmsvg.h>
+#include <lsmsvgfiltertransferfunction.h>
+#include <math.h>
+
+static cairo_surface_t *
+_render_view (LsmDomView *view)
+{
+	cairo_surface_t *surface;
+	cairo_t *cairo;
+	unsigned int width, height;
+
+	lsm_dom_view_get_size_pixels (view, &width, &height, NULL);
+
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+	cairo = cairo_create (surface);
+	lsm_dom_view_render (view, cairo, 0, 0);
+	g_assert_cmpint (cairo_status (cairo), ==, CAIRO_STATUS_SUCCESS);
+	cairo_destroy (cairo);
+
+	cairo_surface_flush (surface);
+
+	return surface;
+}
+
+static cairo_surface_t *
+_render_view_scaled (LsmDomView *view, double scale)
+{
+	cairo_surface_t *surface;
+	cairo_t *cairo;
+	unsigned int width, height;
+
+	lsm_dom_view_get_size_pixels (view, &width, &height, NULL);
+
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width * scale, height * scale);
+	cairo = cairo_create (surface);
+	cairo_scale (cairo, scale, scale);
+	lsm_dom_view_render (view, cairo, 0, 0);
+	g_assert_cmpint (cairo_status (cairo), ==, CAIRO_STATUS_SUCCESS);
+	cairo_destroy (cairo);
+
+	cairo_surface_flush (surface);
+
+	return surface;
+}
+
+static LsmDomView *
+_create_view (const char *string)
+{
+	LsmDomDocument *document;
+	LsmDomView *view;
+
+	document = lsm_dom_document_new_from_memory (string, -1, NULL);
+	g_assert (LSM_IS_DOM_DOCUMENT (document));
+
+	view = lsm_dom_document_create_view (document);
+	g_assert (LSM_IS_DOM_VIEW (view));
+	g_object_unref (document);
+
+	lsm_dom_view_set_resolution (view, 96);
+
+	return view;
+}
+
+static cairo_surface_t *
+_render_document (const char *string, LsmDomView **view_out)
+{
+	LsmDomView *view;
+	cairo_surface_t *surface;
+
+	view = _create_view (string);
+
+	surface = _render_view (view);
+
+	if (view_out != NULL)
+		*view_out = view;
+	else
+		g_object_unref (view);
+
+	return surface;
+}
+
+static guint32
+_get_pixel (cairo_surface_t *surface, int x, int y)
+{
+	const unsigned char *data = cairo_image_surface_get_data (surface);
+	int stride = cairo_image_surface_get_stride (surface);
+
+	return *((const guint32 *) (data + y * stride) + x);
+}
+
+static unsigned int
+_get_alpha (cairo_surface_t *surface, int x, int y)
+{
+	return _get_pixel (surface, x, y) >> 24;
+}
+
+static void
+_assert_same_surfaces (cairo_surface_t *a, cairo_surface_t *b)
+{
+	int x, y;
+
+	g_assert_cmpint (cairo_image_surface_get_width (a), ==, cairo_image_surface_get_width (b));
+	g_assert_cmpint (cairo_image_surface_get_height (a), ==, cairo_image_surface_get_height (b));
+
+	for (y = 0; y < cairo_image_surface_get_height (a); y++)
+		for (x = 0; x < cairo_image_surface_get_width (a); x++)
+			g_assert_cmphex (_get_pixel (a, x, y), ==, _get_pixel (b, x, y));
+}
+
+static void
+_assert_close_surfaces (cairo_surface_t *a, cairo_surface_t *b, unsigned int tolerance)
+{
+	int x, y, i;
+
+	g_assert_cmpint (cairo_image_surface_get_width (a), ==, cairo_image_surface_get_width (b));
+	g_assert_cmpint (cairo_image_surface_get_height (a), ==, cairo_image_surface_get_height (b));
+
+	for (y = 0; y < cairo_image_surface_get_height (a); y++)
+		for (x = 0; x < cairo_image_surface_get_width (a); x++)
+			for (i = 0; i < 32; i += 8) {
+				int value_a = (_get_pixel (a, x, y) >> i) & 0xff;
+				int value_b = (_get_pixel (b, x, y) >> i) & 0xff;
+
+				g_assert_cmpuint (ABS (value_a - value_b), <=, tolerance);
+			}
+}
+
+static gboolean
+_is_same_surface (cairo_surface_t *a, cairo_surface_t *b)
+{
+	int x, y;
+
+	if (cairo_image_surface_get_width (a) != cairo_image_surface_get_width (b) ||
+	    cairo_image_surface_get_height (a) != cairo_image_surface_get_height (b))
+		return FALSE;
+
+	for (y = 0; y < cairo_image_surface_get_height (a); y++)
+		for (x = 0; x < cairo_image_surface_get_width (a); x++)
+			if (_get_pixel (a, x, y) != _get_pixel (b, x, y))
+				return FALSE;
+
+	return TRUE;
+}
+
+static void
+_set_attribute (LsmDomView *view, const char *id, const char *name, const char *value)
+{
+	LsmSvgElement *element;
+
+	element = lsm_svg_document_get_element_by_id (LSM_SVG_DOCUMENT (view->document), id);
+	g_assert (LSM_IS_SVG_ELEMENT (element));
+
+	lsm_dom_element_set_attribute (LSM_DOM_ELEMENT (element), name, value);
+}
+
+/* Renders @string once, so that the caches of its elements and of the view are filled, then sets an attribute
+ * of the element @id. The next render must match a render of @expected by a new view, and must differ from
+ * the first one. */
+
+static void
+_assert_mutation (const char *string, const char *id, const char *name, const char *value, const char *expected)
+{
+	LsmDomView *view;
+	cairo_surface_t *before;
+	cairo_surface_t *after;
+	cairo_surface_t *reference;
+
+	before = _render_document (string, &view);
+	_set_attribute (view, id, name, value);
+	after = _render_view (view);
+	reference = _render_document (expected, NULL);
+
+	g_assert (!_is_same_surface (before, reference));
+	_assert_same_surfaces (reference, after);
+
+	cairo_surface_destroy (before);
+	cairo_surface_destroy (after);
+	cairo_surface_destroy (reference);
+	g_object_unref (view);
+}
+
+static cairo_path_t *
+_get_svg_path (const char *d)
+{
+	cairo_surface_t *surface;
+	cairo_path_t *path;
+	cairo_t *cairo;
+	LsmCairoPath *cairo_path;
+
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
+	cairo = cairo_create (surface);
+
+	cairo_path = lsm_cairo_path_new_from_svg_path (d);
+	lsm_cairo_emit_path (cairo, cairo_path);
+	lsm_cairo_path_free (cairo_path);
+
+	path = cairo_copy_path (cairo);
+
+	cairo_destroy (cairo);
+	cairo_surface_destroy (surface);
+
+	return path;
+}
+
+/* Compares and destroys two cairo paths */
+
+static void
+_assert_same_cairo_path (cairo_path_t *a, cairo_path_t *b)
+{
+	int i, j;
+
+	g_assert_cmpint (a->status, ==, CAIRO_STATUS_SUCCESS);
+	g_assert_cmpint (b->status, ==, CAIRO_STATUS_SUCCESS);
+	g_assert_cmpint (a->num_data, ==, b->num_data);
+
+	for (i = 0; i < a->num_data; i += a->data[i].header.length) {
+		g_assert_cmpint (a->data[i].header.type, ==, b->data[i].header.type);
+		g_assert_cmpint (a->data[i].header.length, ==, b->data[i].header.length);
+
+		for (j = 1; j < a->data[i].header.length; j++) {
+			g_assert_cmpfloat (fabs (a->data[i + j].point.x - b->data[i + j].point.x), <, 1e-2);
+			g_assert_cmpfloat (fabs (a->data[i + j].point.y - b->data[i + j].point.y), <, 1e-2);
+		}
+	}
+
+	cairo_path_destroy (a);
+	cairo_path_destroy (b);
+}
+
+static void
+_assert_same_path_data (const char *a, const char *b)
+{
+	_assert_same_cairo_path (_get_svg_path (a), _get_svg_path (b));
+}
+
+static void
+path_data (void)
+{
+	cairo_surface_t *surface;
+	cairo_path_t *path;
+	cairo_t *cairo;
+
+	/* Relative commands */
+	_assert_same_path_data ("M 10 10 l 10 0 h 5 v -5 c 1 2 3 4 5 6 q 1 1 2 0 z",
+				"M 10 10 L 20 10 H 25 V 5 C 26 7 28 9 30 11 Q 31 12 32 11 Z");
+	_assert_same_path_data ("M 10 10 l 10 0 z m 5 5 l 1 0", "M 10 10 L 20 10 Z M 15 15 L 16 15");
+
+	/* Implicit repeated commands, line to after a move to */
+	_assert_same_path_data ("M 0 0 10 0 10 10", "M 0 0 L 10 0 L 10 10");
+	_assert_same_path_data ("m 1 1 10 0 0 10", "M 1 1 L 11 1 L 11 11");
+	_assert_same_path_data ("M 0 0 c 1 0 2 1 3 1 1 0 2 1 3 1", "M 0 0 C 1 0 2 1 3 1 C 4 1 5 2 6 2");
+
+	/* Numbers without separators */
+	_assert_same_path_data ("M0-1.5e1L.5.5-2,3", "M 0 -15 L 0.5 0.5 L -2 3");
+
+	/* Smooth curves reflect the previous control point */
+	_assert_same_path_data ("M 0 0 C 10 0 20 10 30 10 S 50 20 60 0",
+				"M 0 0 C 10 0 20 10 30 10 C 40 10 50 20 60 0");
+	_assert_same_path_data ("M 0 0 c 10 0 20 10 30 10 s 20 10 30 -10",
+				"M 0 0 C 10 0 20 10 30 10 C 40 10 50 20 60 0");
+	_assert_same_path_data ("M 0 0 L 5 5 S 10 10 20 0", "M 0 0 L 5 5 C 5 5 10 10 20 0");
+	_assert_same_path_data ("M 0 0 Q 10 10 20 0 T 40 0", "M 0 0 Q 10 10 20 0 Q 30 -10 40 0");
+	_assert_same_path_data ("M 0 0 Q 10 10 20 0 t 20 0 t 20 0",
+				"M 0 0 Q 10 10 20 0 Q 30 -10 40 0 Q 50 10 60 0");
+
+	/* Arcs */
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
+	cairo = cairo_create (surface);
+	cairo_move_to (cairo, 10, 10);
+	lsm_cairo_elliptical_arc (cairo, 20, 10, 30, TRUE, FALSE, 40, 30);
+	path = cairo_copy_path (cairo);
+	g_assert_cmpint (path->num_data, >, 4);
+	_assert_same_cairo_path (path, _get_svg_path ("M 10 10 A 20 10 30 1 0 40 30"));
+	path = cairo_copy_path (cairo);
+	_assert_same_cairo_path (path, _get_svg_path ("M 10 10 a 20 10 30 1 0 30 20"));
+	cairo_destroy (cairo);
+	cairo_surface_destroy (surface);
+
+	/* Arcs with a null radius are lines, arcs ending on their start point are skipped */
+	_assert_same_path_data ("M 10 10 A 0 10 0 0 0 40 30", "M 10 10 L 40 30");
+	_assert_same_path_data ("M 10 10 A 5 5 0 0 0 10 10 L 20 20", "M 10 10 L 20 20");
+
+	/* Malformed path data stops at the incomplete command, or skips unknown ones */
+	_assert_same_path_data ("", NULL);
+	_assert_same_path_data ("  ", NULL);
+	_assert_same_path_data ("M 10 10 L 20", "M 10 10");
+	_assert_same_path_data ("M 10 10 L 20 20 C 1 2 3", "M 10 10 L 20 20");
+	_assert_same_path_data ("M 10 10 L 20 20 X 30 30 L 40 40", "M 10 10 L 20 20 L 40 40");
+
+	path = _get_svg_path (NULL);
+	g_assert_cmpint (path->num_data, ==, 0);
+	cairo_path_destroy (path);
+}
+
+#define PATH_DOCUMENT(d) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">" \
+"<path id=\"path\" d=\"" d "\"/>" \
+"</svg>"
+
+static void
+path_cache (void)
+{
+	/* The compiled path is rebuilt when d changes */
+	_assert_mutation (PATH_DOCUMENT ("M 2 2 H 10 V 10 Z"), "path", "d", "M 10 10 H 18 V 18 Z",
+			  PATH_DOCUMENT ("M 10 10 H 18 V 18 Z"));
+}
+
+#define POINTS_DOCUMENT(element, points) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">" \
+"<" element " id=\"shape\" points=\"" points "\"/>" \
+"</svg>"
+
+static void
+points_cache (void)
+{
+	/* The packed points are rebuilt when the points attribute changes */
+	_assert_mutation (POINTS_DOCUMENT ("polygon", "2,2 10,2 10,10"), "shape", "points", "10,10 18,10 18,18",
+			  POINTS_DOCUMENT ("polygon", "10,10 18,10 18,18"));
+	_assert_mutation (POINTS_DOCUMENT ("polyline", "2,2 10,2 10,10"), "shape", "points", "10,10 18,10 18,18",
+			  POINTS_DOCUMENT ("polyline", "10,10 18,10 18,18"));
+}
+
+#define STYLE_DOCUMENT(group_fill, rect_stroke) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">" \
+"<g id=\"group\" fill=\"" group_fill "\">" \
+"<g><rect id=\"rect\" x=\"4\" y=\"4\" width=\"12\" height=\"12\" stroke=\"" rect_stroke "\" stroke-width=\"2\"/></g>" \
+"</g>" \
+"</svg>"
+
+static void
+computed_style (void)
+{
+	/* An inherited property changed on an ancestor reaches the cached style of its descendants */
+	_assert_mutation (STYLE_DOCUMENT ("red", "none"), "group", "fill", "blue", STYLE_DOCUMENT ("blue", "none"));
+
+	/* A property changed on the element itself */
+	_assert_mutation (STYLE_DOCUMENT ("red", "none"), "rect", "stroke", "green", STYLE_DOCUMENT ("red", "green"));
+	_assert_mutation (STYLE_DOCUMENT ("red", "none"), "rect", "style", "fill:lime", STYLE_DOCUMENT ("lime", "none"));
+}
+
+static const char *clip_path_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">"
+"<clipPath id=\"clip\">"
+"<rect x=\"0\" y=\"0\" width=\"6\" height=\"6\"/>"
+"<rect x=\"12\" y=\"12\" width=\"6\" height=\"6\"/>"
+"</clipPath>"
+"<rect width=\"20\" height=\"20\" fill=\"black\" clip-path=\"url(#clip)\"/>"
+"</svg>";
+
+static void
+clip_path_children (void)
+{
+	cairo_surface_t *surface;
+
+	/* Each clip path child must add to the clip geometry, and must not reset the path gathered from the
+	 * previous ones. */
+	surface = _render_document (clip_path_document, NULL);
+
+	g_assert_cmpint (_get_alpha (surface, 3, 3), ==, 0xff);
+	g_assert_cmpint (_get_alpha (surface, 15, 15), ==, 0xff);
+	g_assert_cmpint (_get_alpha (surface, 9, 9), ==, 0x00);
+	g_assert_cmpint (_get_alpha (surface, 15, 3), ==, 0x00);
+
+	cairo_surface_destroy (surface);
+}
+
+#define CLIP_PATH(id) \
+"<clipPath id=\"" id "\" clipPathUnits=\"objectBoundingBox\">" \
+"<circle cx=\"0.5\" cy=\"0.5\" r=\"0.45\"/>" \
+"<path d=\"M 0.1,0.9 C 0.3,0.6 0.7,1.0 0.9,0.7 L 0.9,1 0.1,1 z\"/>" \
+"</clipPath>"
+
+/* The clip path is shared by objects of different sizes, or has a copy for each of them */
+
+static const char *shared_clip_path_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"30\">"
+CLIP_PATH ("clip")
+"<rect x=\"1\" y=\"1\" width=\"3\" height=\"3\" clip-path=\"url(#clip)\"/>"
+"<rect x=\"5.3\" y=\"1\" width=\"33\" height=\"27\" clip-path=\"url(#clip)\"/>"
+"</svg>";
+
+static const char *copied_clip_path_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"30\">"
+CLIP_PATH ("small")
+CLIP_PATH ("large")
+"<rect x=\"1\" y=\"1\" width=\"3\" height=\"3\" clip-path=\"url(#small)\"/>"
+"<rect x=\"5.3\" y=\"1\" width=\"33\" height=\"27\" clip-path=\"url(#large)\"/>"
+"</svg>";
+
+static void
+clip_path_cache (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *reference;
+	cairo_surface_t *surface;
+
+	/* The geometry cached for the small object is not reused for the large one */
+	surface = _render_document (shared_clip_path_document, NULL);
+	reference = _render_document (copied_clip_path_document, NULL);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (reference);
+
+	/* Nor is the geometry cached at a lower zoom level */
+	view = _create_view (shared_clip_path_document);
+	reference = _render_view_scaled (view, 4.0);
+	g_object_unref (view);
+
+	surface = _render_document (shared_clip_path_document, &view);
+	cairo_surface_destroy (surface);
+	surface = _render_view_scaled (view, 4.0);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+
+	/* Reused geometry gives the same result */
+	surface = _render_view_scaled (view, 4.0);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+
+	cairo_surface_destroy (reference);
+	g_object_unref (view);
+}
+
+static const char *culled_group_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">"
+"<g transform=\"translate(100,0)\">"
+"<rect width=\"5\" height=\"5\"/>"
+"<rect x=\"5\" width=\"5\" height=\"5\" style=\"stroke:black;stroke-width:2\"/>"
+"<g><circle cx=\"3\" cy=\"3\" r=\"2\"/></g>"
+"</g>"
+"<g>"
+"<rect width=\"5\" height=\"5\"/>"
+"<rect x=\"50\" y=\"50\" width=\"5\" height=\"5\"/>"
+"</g>"
+"<g transform=\"translate(100,0)\">"
+"<text x=\"0\" y=\"10\">Lasem</text>"
+"</g>"
+"<g transform=\"translate(-12,0)\">"
+"<rect x=\"0\" y=\"10\" width=\"10\" height=\"5\" style=\"stroke:black;stroke-width:6\"/>"
+"</g>"
+"</svg>";
+
+static void
+culled_group (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *surface;
+
+	surface = _render_document (culled_group_document, &view);
+
+	/* The first group is culled as a whole, without testing its children. In the second one, only the
+	 * second rectangle is culled. Groups containing text are never culled, and the stroke of the last
+	 * rectangle reaches the visible area. */
+	g_assert_cmpint (lsm_svg_view_get_n_culled_elements (LSM_SVG_VIEW (view)), ==, 2);
+
+	g_assert_cmpint (_get_alpha (surface, 2, 2), ==, 0xff);
+	g_assert_cmpint (_get_alpha (surface, 0, 12), ==, 0xff);
+
+	cairo_surface_destroy (surface);
+	g_object_unref (view);
+}
+
+#define CULLED_EXTENTS_DOCUMENT(x) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">" \
+"<g>" \
+"<rect width=\"5\" height=\"5\"/>" \
+"<g><rect id=\"rect\" x=\"" x "\" y=\"10\" width=\"5\" height=\"5\"/></g>" \
+"</g>" \
+"</svg>"
+
+static void
+culled_extents_cache (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *surface;
+	cairo_surface_t *cached;
+
+	surface = _render_document (CULLED_EXTENTS_DOCUMENT ("50"), &view);
+	g_assert_cmpint (lsm_svg_view_get_n_culled_elements (LSM_SVG_VIEW (view)), ==, 1);
+
+	/* Second render with the extents cached during the first one */
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_culled_elements (LSM_SVG_VIEW (view)), ==, 1);
+	_assert_same_surfaces (surface, cached);
+
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (cached);
+	g_object_unref (view);
+
+	/* Moving the culled rectangle into the visible area invalidates the extents of its ancestors */
+	_assert_mutation (CULLED_EXTENTS_DOCUMENT ("50"), "rect", "x", "10", CULLED_EXTENTS_DOCUMENT ("10"));
+}
+
+static const char *tiled_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">"
+"<rect width=\"8\" height=\"8\" fill=\"blue\"/>"
+"<circle cx=\"15\" cy=\"15\" r=\"3\" fill=\"green\"/>"
+"</svg>";
+
+static void
+tiled_render (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *reference;
+	cairo_surface_t *surface;
+
+	reference = _render_document (tiled_document, &view);
+
+	/* Sequential tiles are rendered by the view itself, so the culled element count is the one of the
+	 * last tile, which only contains the circle. */
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 20, 20);
+	lsm_dom_view_render_tiled (view, surface, NULL, 1, 10);
+	g_assert_cmpint (lsm_svg_view_get_n_culled_elements (LSM_SVG_VIEW (view)), ==, 1);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 20, 20);
+	lsm_dom_view_render_tiled (view, surface, NULL, 4, 10);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+
+	cairo_surface_destroy (reference);
+	g_object_unref (view);
+}
+
+static cairo_surface_t *
+_render_view_recorded (LsmDomView *view)
+{
+	cairo_surface_t *surface;
+	cairo_t *cairo;
+	unsigned int width, height;
+
+	lsm_dom_view_get_size_pixels (view, &width, &height, NULL);
+
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+	cairo = cairo_create (surface);
+	lsm_dom_view_render_recorded (view, cairo, 0, 0);
+	g_assert_cmpint (cairo_status (cairo), ==, CAIRO_STATUS_SUCCESS);
+	cairo_destroy (cairo);
+
+	cairo_surface_flush (surface);
+
+	return surface;
+}
+
+#define RECORDED_DOCUMENT(fill) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">" \
+"<rect x=\"2\" y=\"2\" width=\"10\" height=\"6\" fill=\"rgb(200,30,40)\"/>" \
+"<rect id=\"rect\" x=\"8\" y=\"6\" width=\"10\" height=\"12\" fill=\"" fill "\" opacity=\"0.5\"/>" \
+"</svg>"
+
+static void
+render_recorded (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *reference;
+	cairo_surface_t *recorded;
+	cairo_surface_t *replayed;
+	cairo_surface_t *mutated;
+
+	reference = _render_document (RECORDED_DOCUMENT ("blue"), &view);
+
+	recorded = _render_view_recorded (view);
+	g_assert (view->display_list != NULL);
+	g_assert_cmpint (view->display_list_generation, ==, view->document->generation);
+	_assert_same_surfaces (reference, recorded);
+
+	replayed = _render_view_recorded (view);
+	_assert_same_surfaces (reference, replayed);
+
+	/* A document mutation bumps its generation, and the display list is recorded again */
+	_set_attribute (view, "rect", "fill", "green");
+	g_assert_cmpint (view->display_list_generation, !=, view->document->generation);
+	mutated = _render_view_recorded (view);
+	g_assert_cmpint (view->display_list_generation, ==, view->document->generation);
+	g_assert (!_is_same_surface (reference, mutated));
+
+	cairo_surface_destroy (reference);
+	reference = _render_document (RECORDED_DOCUMENT ("green"), NULL);
+	_assert_same_surfaces (reference, mutated);
+
+	cairo_surface_destroy (reference);
+	cairo_surface_destroy (recorded);
+	cairo_surface_destroy (replayed);
+	cairo_surface_destroy (mutated);
+	g_object_unref (view);
+}
+
+#define GRADIENT_DOCUMENT(transform, offset, color) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"24\" height=\"16\">" \
+"<linearGradient id=\"gradient\" gradientTransform=\"" transform "\">" \
+"<stop offset=\"0\" stop-color=\"white\"/>" \
+"<stop id=\"stop\" offset=\"" offset "\" stop-color=\"" color "\"/>" \
+"</linearGradient>" \
+"<rect x=\"0\" y=\"0\" width=\"24\" height=\"8\" fill=\"url(#gradient)\"/>" \
+"<rect x=\"4\" y=\"8\" width=\"12\" height=\"8\" fill=\"url(#gradient)\"/>" \
+"</svg>"
+
+static void
+gradient_cache (void)
+{
+	LsmDomView *view;
+	LsmSvgGradientElement *gradient;
+	cairo_pattern_t *pattern;
+	cairo_surface_t *surface;
+	cairo_surface_t *cached;
+
+	surface = _render_document (GRADIENT_DOCUMENT ("scale(1)", "1", "blue"), &view);
+
+	gradient = LSM_SVG_GRADIENT_ELEMENT (lsm_svg_document_get_element_by_id
+					     (LSM_SVG_DOCUMENT (view->document), "gradient"));
+	pattern = gradient->pattern;
+	g_assert (pattern != NULL);
+
+	/* The pattern is reused by the next render */
+	cached = _render_view (view);
+	g_assert (gradient->pattern == pattern);
+	_assert_same_surfaces (surface, cached);
+
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (cached);
+	g_object_unref (view);
+
+	_assert_mutation (GRADIENT_DOCUMENT ("scale(1)", "1", "blue"), "stop", "offset", "0.5",
+			  GRADIENT_DOCUMENT ("scale(1)", "0.5", "blue"));
+	_assert_mutation (GRADIENT_DOCUMENT ("scale(1)", "1", "blue"), "stop", "stop-color", "red",
+			  GRADIENT_DOCUMENT ("scale(1)", "1", "red"));
+	_assert_mutation (GRADIENT_DOCUMENT ("scale(1)", "1", "blue"), "gradient", "gradientTransform", "rotate(90)",
+			  GRADIENT_DOCUMENT ("rotate(90)", "1", "blue"));
+}
+
+#define PATTERN_TILE(id,color) \
+"<pattern id=\"" id "\" patternUnits=\"userSpaceOnUse\" width=\"8\" height=\"8\">" \
+"<rect id=\"" id "-rect\" width=\"4\" height=\"4\" fill=\"" color "\"/>" \
+"</pattern>"
+
+#define PATTERN_DOCUMENT(color) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"24\" height=\"16\">" \
+PATTERN_TILE ("pattern", color) \
+"<rect width=\"12\" height=\"16\" fill=\"url(#pattern)\"/>" \
+"<rect x=\"14\" width=\"10\" height=\"16\" fill=\"url(#pattern)\"/>" \
+"</svg>"
+
+/* Rectangles paint with pattern a, b, a, then c. Each 8x8 tile takes 256 bytes. */
+
+static const char *pattern_lru_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"32\" height=\"8\">"
+PATTERN_TILE ("a", "red")
+PATTERN_TILE ("b", "green")
+PATTERN_TILE ("c", "blue")
+"<rect width=\"8\" height=\"8\" fill=\"url(#a)\"/>"
+"<rect x=\"8\" width=\"8\" height=\"8\" fill=\"url(#b)\"/>"
+"<rect x=\"16\" width=\"8\" height=\"8\" fill=\"url(#a)\"/>"
+"<rect x=\"24\" width=\"8\" height=\"8\" fill=\"url(#c)\"/>"
+"</svg>";
+
+static void
+pattern_cache (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *surface;
+	cairo_surface_t *cached;
+	cairo_surface_t *reference;
+
+	/* The tile rendered for the first rectangle is reused by the second one */
+	surface = _render_document (PATTERN_DOCUMENT ("blue"), &view);
+	g_assert_cmpint (lsm_svg_view_get_n_pattern_cache_hits (LSM_SVG_VIEW (view)), ==, 1);
+
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_pattern_cache_hits (LSM_SVG_VIEW (view)), ==, 2);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (cached);
+
+	/* A scaled render needs a tile at the new resolution */
+	surface = _render_view_scaled (view, 2.0);
+	g_assert_cmpint (lsm_svg_view_get_n_pattern_cache_hits (LSM_SVG_VIEW (view)), ==, 1);
+	g_object_unref (view);
+
+	cached = _render_document (PATTERN_DOCUMENT ("blue"), &view);
+	reference = _render_view_scaled (view, 2.0);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (cached);
+	cairo_surface_destroy (reference);
+	g_object_unref (view);
+
+	_assert_mutation (PATTERN_DOCUMENT ("blue"), "pattern-rect", "fill", "red", PATTERN_DOCUMENT ("red"));
+
+	/* With room for two tiles, the tile of c evicts the least recently used one, b */
+	surface = _render_document (pattern_lru_document, &view);
+	lsm_svg_view_set_pattern_cache_size (LSM_SVG_VIEW (view), 0);
+	lsm_svg_view_set_pattern_cache_size (LSM_SVG_VIEW (view), 600);
+
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_pattern_cache_hits (LSM_SVG_VIEW (view)), ==, 1);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (cached);
+
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_pattern_cache_hits (LSM_SVG_VIEW (view)), ==, 2);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (cached);
+
+	/* A zero size disables the cache */
+	lsm_svg_view_set_pattern_cache_size (LSM_SVG_VIEW (view), 0);
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_pattern_cache_hits (LSM_SVG_VIEW (view)), ==, 0);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (cached);
+
+	cairo_surface_destroy (surface);
+	g_object_unref (view);
+}
+
+static const char *mask_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"24\" height=\"16\">"
+"<linearGradient id=\"gradient\">"
+"<stop offset=\"0\" stop-color=\"white\"/>"
+"<stop offset=\"1\" stop-color=\"rgb(20,200,90)\"/>"
+"</linearGradient>"
+"<mask id=\"mask\" x=\"0\" y=\"0\" width=\"1\" height=\"1\" maskContentUnits=\"objectBoundingBox\">"
+"<rect width=\"1\" height=\"1\" fill=\"url(#gradient)\"/>"
+"</mask>"
+"<rect x=\"0\" y=\"0\" width=\"8\" height=\"8\" fill=\"red\" mask=\"url(#mask)\"/>"
+"<rect x=\"8\" y=\"0\" width=\"16\" height=\"8\" fill=\"blue\" mask=\"url(#mask)\"/>"
+"<rect x=\"4\" y=\"8\" width=\"13\" height=\"8\" fill=\"green\" mask=\"url(#mask)\"/>"
+"</svg>";
+
+static void
+mask_paths (void)
+{
+	LsmDomView *view;
+	cairo_surface_t *reference;
+	cairo_surface_t *surface;
+
+	/* Bounded mask groups and the vectorized luminance pass must not change the output, for mask regions
+	 * aligned on the pixel grid. */
+	reference = _render_document (mask_document, &view);
+	g_assert_cmpint (_get_alpha (reference, 7, 4), >, 0x00);
+	g_assert_cmpint (_get_alpha (reference, 23, 4), >, 0x00);
+
+	lsm_dom_view_set_debug (view, "mask-unbounded", TRUE);
+	lsm_dom_view_set_debug (view, "mask-scalar", TRUE);
+	surface = _render_view (view);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+
+	lsm_dom_view_set_debug (view, "mask-unbounded", FALSE);
+	surface = _render_view (view);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+
+	cairo_surface_destroy (reference);
+	g_object_unref (view);
+}
+
+#define MARKER(id, color) \
+"<marker id=\"" id "\" markerWidth=\"4\" markerHeight=\"4\" refX=\"2\" refY=\"2\">" \
+"<rect id=\"" id "-rect\" width=\"3\" height=\"4\" fill=\"" color "\"/>" \
+"</marker>"
+
+#define MARKER_DOCUMENT(color, width, second_marker) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"24\">" \
+MARKER ("marker", color) \
+MARKER ("copy", color) \
+"<path id=\"path\" d=\"M 4,5 L 14,5 L 24,5 L 34,5\" stroke=\"black\" stroke-width=\"" width "\"" \
+" marker-mid=\"url(#marker)\"/>" \
+"<path d=\"M 4,16 L 14,16 L 24,16 L 34,16\" stroke=\"black\" stroke-width=\"2\"" \
+" marker-mid=\"url(#" second_marker ")\"/>" \
+"</svg>"
+
+static void
+marker_instances (void)
+{
+	cairo_surface_t *reference;
+	cairo_surface_t *surface;
+
+	/* Paths with different stroke widths don't share their marker instances */
+	surface = _render_document (MARKER_DOCUMENT ("blue", "1", "marker"), NULL);
+	reference = _render_document (MARKER_DOCUMENT ("blue", "1", "copy"), NULL);
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (reference);
+
+	_assert_mutation (MARKER_DOCUMENT ("blue", "1", "marker"), "marker-rect", "fill", "red",
+			  MARKER_DOCUMENT ("red", "1", "copy"));
+	_assert_mutation (MARKER_DOCUMENT ("blue", "1", "marker"), "marker", "refX", "1",
+			  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"24\">"
+			  "<marker id=\"marker\" markerWidth=\"4\" markerHeight=\"4\" refX=\"1\" refY=\"2\">"
+			  "<rect width=\"3\" height=\"4\" fill=\"blue\"/>"
+			  "</marker>"
+			  "<path d=\"M 4,5 L 14,5 L 24,5 L 34,5\" stroke=\"black\" stroke-width=\"1\""
+			  " marker-mid=\"url(#marker)\"/>"
+			  "<path d=\"M 4,16 L 14,16 L 24,16 L 34,16\" stroke=\"black\" stroke-width=\"2\""
+			  " marker-mid=\"url(#marker)\"/>"
+			  "</svg>");
+	_assert_mutation (MARKER_DOCUMENT ("blue", "1", "marker"), "path", "stroke-width", "1.5",
+			  MARKER_DOCUMENT ("blue", "1.5", "copy"));
+}
+
+#define USE_ICON(id, blending) \
+"<g id=\"" id "\">" \
+"<rect x=\"1\" y=\"1\" width=\"6\" height=\"4\" fill=\"blue\" stroke=\"black\" stroke-width=\"1\"" \
+" style=\"comp-op:" blending "\"/>" \
+"<path d=\"M 1,7 L 7,7 L 4,9 z\" fill=\"red\" opacity=\"0.5\"/>" \
+"</g>"
+
+/* The icon is referenced twice under non uniform transforms, or copied in place */
+
+#define USE_DOCUMENT(blending) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\"" \
+" width=\"40\" height=\"30\">" \
+"<rect width=\"40\" height=\"30\" fill=\"rgb(200,220,120)\"/>" \
+"<defs>" USE_ICON ("icon", blending) "</defs>" \
+"<use xlink:href=\"#icon\" transform=\"scale(3,1.5)\"/>" \
+"<use xlink:href=\"#icon\" transform=\"translate(22,2) scale(1,2.5) skewX(20)\"/>" \
+"</svg>"
+
+#define COPY_DOCUMENT(blending) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"30\">" \
+"<rect width=\"40\" height=\"30\" fill=\"rgb(200,220,120)\"/>" \
+"<g transform=\"scale(3,1.5)\">" USE_ICON ("first", blending) "</g>" \
+"<g transform=\"translate(22,2) scale(1,2.5) skewX(20)\">" USE_ICON ("second", blending) "</g>" \
+"</svg>"
+
+static void
+use_instances (void)
+{
+	cairo_surface_t *instanced;
+	cairo_surface_t *reference;
+	cairo_surface_t *surface;
+
+	/* Instances are replayed from a recording, which may go through an intermediate surface */
+	instanced = _render_document (USE_DOCUMENT ("src-over"), NULL);
+	reference = _render_document (COPY_DOCUMENT ("src-over"), NULL);
+	_assert_close_surfaces (reference, instanced, 2);
+	cairo_surface_destroy (reference);
+
+	/* Blending with the backdrop can't be recorded, the icon must be rendered in place */
+	surface = _render_document (USE_DOCUMENT ("multiply"), NULL);
+	reference = _render_document (COPY_DOCUMENT ("multiply"), NULL);
+	g_assert (!_is_same_surface (surface, instanced));
+	_assert_same_surfaces (reference, surface);
+	cairo_surface_destroy (surface);
+	cairo_surface_destroy (reference);
+	cairo_surface_destroy (instanced);
+}
+
+/* 4x4 opaque red and 8x8 translucent blue RGBA images */
+
+static const char *small_image_href =
+"data:image/png;base64,"
+"iVBORw0KGgoAAAANSUhEUgAAAAQAAAAECAYAAACp8Z5+AAAAEklEQVR4nGP4z8DwHxkzkC4AADxAH+HggXe0AAAAAElFTkSuQmCC";
+
+static const char *large_image_href =
+"data:image/png;base64,"
+"iVBORw0KGgoAAAANSUhEUgAAAAgAAAAICAYAAADED76LAAAAEUlEQVR4nGNgYPjfgB+PCAUAEwdfwQtFMKwAAAAASUVORK5CYII=";
+
+static gsize
+_get_image_size (int width, int height)
+{
+	return (gsize) cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, width) * height;
+}
+
+static void
+image_cache (void)
+{
+	LsmDomDocument *document;
+	cairo_surface_t *small_surface;
+	cairo_surface_t *large_surface;
+	cairo_surface_t *surface;
+	gsize max_size;
+
+	max_size = lsm_svg_image_cache_get_max_size ();
+	lsm_svg_image_cache_cleanup ();
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, 0);
+
+	document = lsm_dom_implementation_create_document (NULL, "svg");
+
+	/* Same href: the decoded surface is shared */
+	small_surface = lsm_svg_image_cache_get_surface (document, small_image_href);
+	g_assert (small_surface != NULL);
+	g_assert_cmpint (cairo_image_surface_get_width (small_surface), ==, 4);
+	surface = lsm_svg_image_cache_get_surface (document, small_image_href);
+	g_assert (surface == small_surface);
+	cairo_surface_destroy (surface);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, _get_image_size (4, 4));
+
+	large_surface = lsm_svg_image_cache_get_surface (document, large_image_href);
+	g_assert (large_surface != NULL);
+	g_assert_cmpint (cairo_image_surface_get_width (large_surface), ==, 8);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, _get_image_size (4, 4) + _get_image_size (8, 8));
+
+	/* The least recently used image is evicted, but stays alive while referenced */
+	lsm_svg_image_cache_set_max_size (_get_image_size (8, 8) + 1);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, _get_image_size (8, 8));
+	g_assert_cmpuint (cairo_surface_get_reference_count (small_surface), ==, 1);
+	g_assert_cmpuint (cairo_surface_get_reference_count (large_surface), ==, 2);
+	g_assert_cmpint (cairo_image_surface_get_width (small_surface), ==, 4);
+
+	/* An evicted image is decoded again, and pushes the other one out */
+	surface = lsm_svg_image_cache_get_surface (document, small_image_href);
+	g_assert (surface != NULL && surface != small_surface);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, _get_image_size (4, 4));
+	g_assert_cmpuint (cairo_surface_get_reference_count (large_surface), ==, 1);
+	cairo_surface_destroy (surface);
+
+	/* A zero budget disables the cache */
+	lsm_svg_image_cache_set_max_size (0);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, 0);
+	surface = lsm_svg_image_cache_get_surface (document, large_image_href);
+	g_assert (surface != NULL && surface != large_surface);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, 0);
+	g_assert_cmpuint (cairo_surface_get_reference_count (surface), ==, 1);
+	cairo_surface_destroy (surface);
+
+	cairo_surface_destroy (small_surface);
+	cairo_surface_destroy (large_surface);
+	g_object_unref (document);
+
+	lsm_svg_image_cache_set_max_size (max_size);
+}
+
+static void
+image_mipmap (void)
+{
+	LsmDomDocument *document;
+	cairo_surface_t *surface;
+	cairo_surface_t *level;
+	cairo_t *cairo;
+	gsize max_size;
+
+	surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 64, 48);
+	cairo = cairo_create (surface);
+	cairo_set_source_rgb (cairo, 1.0, 0.0, 0.0);
+	cairo_paint (cairo);
+	cairo_destroy (cairo);
+
+	/* No level is built while the image is not downscaled by at least 2 */
+	level = lsm_cairo_image_surface_get_mipmap (surface, 0.6);
+	g_assert (level == surface);
+	cairo_surface_destroy (level);
+	g_assert_cmpuint (lsm_cairo_image_surface_get_mipmap_size (surface), ==, 0);
+
+	/* 0.2 device pixel per pixel: the 16x12 level is still at least as large as the footprint */
+	level = lsm_cairo_image_surface_get_mipmap (surface, 0.2);
+	g_assert_cmpint (cairo_image_surface_get_width (level), ==, 16);
+	g_assert_cmpint (cairo_image_surface_get_height (level), ==, 12);
+	g_assert_cmphex (_get_pixel (level, 7, 5), ==, 0xffff0000);
+	g_assert_cmpuint (lsm_cairo_image_surface_get_mipmap_size (surface), ==,
+			  _get_image_size (32, 24) + _get_image_size (16, 12));
+	cairo_surface_destroy (level);
+
+	level = lsm_cairo_image_surface_get_mipmap (surface, 0.01);
+	g_assert_cmpint (cairo_image_surface_get_width (level), ==, 1);
+	g_assert_cmpint (cairo_image_surface_get_height (level), ==, 1);
+	g_assert_cmphex (_get_pixel (level, 0, 0), ==, 0xffff0000);
+	cairo_surface_destroy (level);
+
+	cairo_surface_destroy (surface);
+
+	/* Mip levels of cached images count against the cache budget */
+	max_size = lsm_svg_image_cache_get_max_size ();
+	lsm_svg_image_cache_cleanup ();
+	lsm_svg_image_cache_set_max_size (_get_image_size (8, 8) + _get_image_size (4, 4));
+
+	document = lsm_dom_implementation_create_document (NULL, "svg");
+	surface = lsm_svg_image_cache_get_surface (document, large_image_href);
+	g_assert (surface != NULL);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, _get_image_size (8, 8));
+
+	level = lsm_svg_image_cache_get_mipmap (surface, 0.5);
+	g_assert_cmpint (cairo_image_surface_get_width (level), ==, 4);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, _get_image_size (8, 8) + _get_image_size (4, 4));
+	cairo_surface_destroy (level);
+
+	level = lsm_svg_image_cache_get_mipmap (surface, 0.25);
+	g_assert_cmpint (cairo_image_surface_get_width (level), ==, 2);
+	g_assert_cmpuint (lsm_svg_image_cache_get_size (), ==, 0);
+	cairo_surface_destroy (level);
+
+	cairo_surface_destroy (surface);
+	g_object_unref (document);
+
+	lsm_svg_image_cache_set_max_size (max_size);
+}
+
+#define TEXT_CACHE_DOCUMENT(size, first, second) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"80\" height=\"40\" font-family=\"Sans\">" \
+"<text id=\"first\" x=\"2\" y=\"14\" font-size=\"" size "\">" first "</text>" \
+"<text id=\"second\" x=\"2\" y=\"34\" font-size=\"12\">" second "</text>" \
+"</svg>"
+
+static void
+text_cache (void)
+{
+	LsmDomView *view;
+	LsmSvgElement *element;
+	cairo_surface_t *reference;
+	cairo_surface_t *surface;
+	cairo_surface_t *cached;
+
+	surface = _render_document (TEXT_CACHE_DOCUMENT ("12", "Lasem", "SVG"), &view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 2);
+
+	/* Layouts are reused by the next render */
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 0);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (cached);
+
+	/* Text content change */
+	element = lsm_svg_document_get_element_by_id (LSM_SVG_DOCUMENT (view->document), "second");
+	lsm_dom_node_set_node_value (lsm_dom_node_get_first_child (LSM_DOM_NODE (element)), "Text");
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 1);
+	reference = _render_document (TEXT_CACHE_DOCUMENT ("12", "Lasem", "Text"), NULL);
+	_assert_same_surfaces (reference, cached);
+	cairo_surface_destroy (reference);
+	cairo_surface_destroy (cached);
+
+	/* Font change */
+	_set_attribute (view, "first", "font-size", "16");
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 1);
+	reference = _render_document (TEXT_CACHE_DOCUMENT ("16", "Lasem", "Text"), NULL);
+	_assert_same_surfaces (reference, cached);
+	cairo_surface_destroy (reference);
+	cairo_surface_destroy (cached);
+
+	/* Zoom change, layouts are shaped in a new context */
+	cached = _render_view_scaled (view, 2.0);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 2);
+	cairo_surface_destroy (cached);
+	cached = _render_view_scaled (view, 2.0);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 0);
+	cairo_surface_destroy (cached);
+	g_object_unref (view);
+
+	/* With a single entry, the two texts evict each other */
+	cached = _render_document (TEXT_CACHE_DOCUMENT ("12", "Lasem", "SVG"), &view);
+	cairo_surface_destroy (cached);
+	lsm_svg_view_set_text_cache_size (LSM_SVG_VIEW (view), 1);
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 2);
+	cairo_surface_destroy (cached);
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 2);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (cached);
+
+	/* A zero size disables the cache */
+	lsm_svg_view_set_text_cache_size (LSM_SVG_VIEW (view), 0);
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 2);
+	_assert_same_surfaces (surface, cached);
+	cairo_surface_destroy (cached);
+	cached = _render_view (view);
+	g_assert_cmpint (lsm_svg_view_get_n_text_cache_misses (LSM_SVG_VIEW (view)), ==, 2);
+	cairo_surface_destroy (cached);
+
+	cairo_surface_destroy (surface);
+	g_object_unref (view);
+}
+
+static gboolean
+_get_ink_extents (cairo_surface_t *surface, int *x1, int *y1, int *x2, int *y2)
+{
+	int x, y;
+
+	*x1 = *y1 = G_MAXINT;
+	*x2 = *y2 = -1;
+
+	for (y = 0; y < cairo_image_surface_get_height (surface); y++)
+		for (x = 0; x < cairo_image_surface_get_width (surface); x++)
+			if (_get_alpha (surface, x, y) != 0) {
+				*x1 = MIN (*x1, x);
+				*y1 = MIN (*y1, y);
+				*x2 = MAX (*x2, x);
+				*y2 = MAX (*y2, y);
+			}
+
+	return *x2 >= 0;
+}
+
+static void
+_assert_same_rendering (const char *a, const char *b)
+{
+	cairo_surface_t *surface_a;
+	cairo_surface_t *surface_b;
+
+	surface_a = _render_document (a, NULL);
+	surface_b = _render_document (b, NULL);
+
+	_assert_same_surfaces (surface_a, surface_b);
+
+	cairo_surface_destroy (surface_a);
+	cairo_surface_destroy (surface_b);
+}
+
+#define TEXT_DOCUMENT(content) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"50\" font-size=\"16\">" content "</svg>"
+
+static void
+positioned_text (void)
+{
+	cairo_surface_t *surface;
+	int x1, y1, x2, y2;
+	int dy_x1, dy_y1, dy_x2, dy_y2;
+
+	/* Per character x */
+	_assert_same_rendering (TEXT_DOCUMENT ("<text x=\"10 60\" y=\"30\">AB</text>"),
+				TEXT_DOCUMENT ("<text x=\"10 10\" y=\"30\">A</text>"
+					       "<text x=\"60 60\" y=\"30\">B</text>"));
+
+	/* dx and dy of the first character shift the whole text */
+	_assert_same_rendering (TEXT_DOCUMENT ("<text x=\"10\" y=\"30\" dx=\"5\" dy=\"3\">AB</text>"),
+				TEXT_DOCUMENT ("<text x=\"15\" y=\"33\" dx=\"0\">AB</text>"));
+
+	/* dy of the second character only moves it, and the following ones */
+	surface = _render_document (TEXT_DOCUMENT ("<text x=\"10\" y=\"30\" dy=\"0 0\">AB</text>"), NULL);
+	g_assert (_get_ink_extents (surface, &x1, &y1, &x2, &y2));
+	cairo_surface_destroy (surface);
+
+	surface = _render_document (TEXT_DOCUMENT ("<text x=\"10\" y=\"30\" dy=\"0 8\">AB</text>"), NULL);
+	g_assert (_get_ink_extents (surface, &dy_x1, &dy_y1, &dy_x2, &dy_y2));
+	cairo_surface_destroy (surface);
+
+	g_assert_cmpint (dy_x1, ==, x1);
+	g_assert_cmpint (dy_x2, ==, x2);
+	g_assert_cmpint (dy_y1, ==, y1);
+	g_assert_cmpint (dy_y2, ==, y2 + 8);
+}
+
+/* Hebrew letters alef, bet and gimel */
+#define RTL_STRING "\xd7\x90\xd7\x91\xd7\x92"
+
+static void
+positioned_rtl_text (void)
+{
+	cairo_surface_t *surface;
+	int x1, y1, x2, y2;
+
+	surface = _render_document (TEXT_DOCUMENT ("<text x=\"60\" y=\"30\" dx=\"0\">" RTL_STRING "</text>"),
+				    NULL);
+	if (!_get_ink_extents (surface, &x1, &y1, &x2, &y2)) {
+		cairo_surface_destroy (surface);
+		g_test_skip ("No font for hebrew text");
+		return;
+	}
+	cairo_surface_destroy (surface);
+
+	/* Right to left text progresses leftwards from the start position */
+	g_assert_cmpint (x2, <=, 61);
+	g_assert_cmpint (x1, <, 50);
+
+	/* Each character is placed at its own position, in logical order */
+	_assert_same_rendering (TEXT_DOCUMENT ("<text x=\"90 60 30\" y=\"30\">" RTL_STRING "</text>"),
+				TEXT_DOCUMENT ("<text x=\"90 90\" y=\"30\">\xd7\x90</text>"
+					       "<text x=\"60 60\" y=\"30\">\xd7\x91</text>"
+					       "<text x=\"30 30\" y=\"30\">\xd7\x92</text>"));
+}
+
+#define FILTER_DOCUMENT(primitives) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"40\" height=\"40\">" \
+"<filter id=\"filter\">" primitives "</filter>" \
+"<rect x=\"10\" y=\"10\" width=\"20\" height=\"20\" fill=\"blue\" filter=\"url(#filter)\"/>" \
+"</svg>"
+
+#define OFFSET_PRIMITIVE "<feOffset dx=\"1\" dy=\"0\"/>"
+
+static gsize
+_get_filter_peak_size (const char *string)
+{
+	LsmDomView *view;
+	cairo_surface_t *surface;
+	gsize peak_size;
+
+	surface = _render_document (string, &view);
+	peak_size = lsm_svg_view_get_filter_peak_size (LSM_SVG_VIEW (view));
+	cairo_surface_destroy (surface);
+	g_object_unref (view);
+
+	return peak_size;
+}
+
+static void
+filter_peak_size (void)
+{
+	gsize short_peak_size;
+	gsize long_peak_size;
+
+	short_peak_size = _get_filter_peak_size (FILTER_DOCUMENT (OFFSET_PRIMITIVE OFFSET_PRIMITIVE));
+	long_peak_size = _get_filter_peak_size (FILTER_DOCUMENT (OFFSET_PRIMITIVE OFFSET_PRIMITIVE
+								 OFFSET_PRIMITIVE OFFSET_PRIMITIVE
+								 OFFSET_PRIMITIVE OFFSET_PRIMITIVE));
+
+	g_assert_cmpuint (short_peak_size, >, 0);
+
+	/* Each result of the chain is released once the next primitive has read it, so the peak does not grow
+	 * with the chain length. */
+	g_assert_cmpuint (long_peak_size, ==, short_peak_size);
+
+	g_assert_cmpuint (_get_filter_peak_size (TEXT_DOCUMENT ("<rect width=\"10\" height=\"10\"/>")), ==, 0);
+}
+
+/* The bounding box of the rectangle is 56x8 at 4,16, so its normalized diagonal is 40 */
+
+#define LIGHTING_DOCUMENT(units,light) \
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"64\" height=\"40\">" \
+"<filter id=\"filter\" filterUnits=\"userSpaceOnUse\" x=\"0\" y=\"0\" width=\"64\" height=\"40\"" \
+" primitiveUnits=\"" units "\">" \
+"<feDiffuseLighting in=\"SourceAlpha\" surfaceScale=\"3\">" light "</feDiffuseLighting>" \
+"</filter>" \
+"<rect x=\"4\" y=\"16\" width=\"56\" height=\"8\" fill=\"blue\" filter=\"url(#filter)\"/>" \
+"</svg>"
+
+static void
+_assert_same_lighting (const char *bounding_box_document, const char *user_space_document)
+{
+	cairo_surface_t *bounding_box;
+	cairo_surface_t *user_space;
+
+	bounding_box = _render_document (bounding_box_document, NULL);
+	user_space = _render_document (user_space_document, NULL);
+
+	g_assert_cmpuint (_get_alpha (user_space, 32, 20), ==, 255);
+	_assert_close_surfaces (bounding_box, user_space, 1);
+
+	cairo_surface_destroy (bounding_box);
+	cairo_surface_destroy (user_space);
+}
+
+static void
+bounding_box_light (void)
+{
+	_assert_same_lighting (LIGHTING_DOCUMENT ("objectBoundingBox",
+						  "<fePointLight x=\"0.25\" y=\"0.5\" z=\"0.5\"/>"),
+			       LIGHTING_DOCUMENT ("userSpaceOnUse",
+						  "<fePointLight x=\"18\" y=\"20\" z=\"20\"/>"));
+	_assert_same_lighting (LIGHTING_DOCUMENT ("objectBoundingBox",
+						  "<feSpotLight x=\"0.25\" y=\"0.5\" z=\"0.5\""
+						  " pointsAtX=\"0.75\" pointsAtY=\"1\" pointsAtZ=\"0.25\""
+						  " specularExponent=\"4\"/>"),
+			       LIGHTING_DOCUMENT ("userSpaceOnUse",
+						  "<feSpotLight x=\"18\" y=\"20\" z=\"20\""
+						  " pointsAtX=\"46\" pointsAtY=\"24\" pointsAtZ=\"10\""
+						  " specularExponent=\"4\"/>"));
+}
+
+static const char *transfer_function_document =
+"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\">"
+"<filter id=\"filter\">"
+"<feComponentTransfer>"
+"<feFuncR id=\"empty-table\" type=\"table\"/>"
+"<feFuncG id=\"single-table\" type=\"table\" tableValues=\"0.25\"/>"
+"<feFuncB id=\"single-discrete\" type=\"discrete\" tableValues=\"0.75\"/>"
+"<feFuncA id=\"empty-discrete\" type=\"discrete\" tableValues=\"\"/>"
+"</feComponentTransfer>"
+"<feComponentTransfer>"
+"<feFuncR id=\"table\" type=\"table\" tableValues=\"1 0 0.5\"/>"
+"<feFuncG id=\"discrete\" type=\"discrete\" tableValues=\"0.2 0.4 0.8\"/>"
+"<feFuncB id=\"linear\" type=\"linear\" slope=\"2\" intercept=\"-0.5\"/>"
+"<feFuncA id=\"gamma\" type=\"gamma\" amplitude=\"0.5\" exponent=\"2\" offset=\"0.25\"/>"
+"</feComponentTransfer>"
+"<feComponentTransfer>"
+"<feFuncA id=\"clamped-gamma\" type=\"gamma\" amplitude=\"2\" exponent=\"0.5\" offset=\"-0.5\"/>"
+"</feComponentTransfer>"
+"</filter>"
+"</svg>";
+
+/* Expected transfer functions, before clamping */
+
+static double
+_identity (double value)
+{
+	return value;
+}
+
+static double
+_single_table (double value)
+{
+	return 0.25;
+}
+
+static double
+_single_discrete (double value)
+{
+	return 0.75;
+}
+
+static double
+_table (double value)
+{
+	return value < 0.5 ? 1.0 - 2.0 * value : value - 0.5;
+}
+
+static double
+_discrete (double value)
+{
+	static const double values[] = {0.2, 0.4, 0.8};
+
+	return values[MIN ((int) (value * 3), 2)];
+}
+
+static double
+_linear (double value)
+{
+	return 2.0 * value - 0.5;
+}
+
+static double
+_gamma (double value)
+{
+	return 0.5 * value * value + 0.25;
+}
+
+static double
+_clamped_gamma (double value)
+{
+	return 2.0 * sqrt (value) - 0.5;
+}
+
+static void
+_assert_transfer_table (LsmSvgDocument *document, const char *id, double (*function) (double value))
+{
+	LsmSvgElement *element;
+	guint8 table[256];
+	unsigned int i;
+
+	element = lsm_svg_document_get_element_by_id (document, id);
+	g_assert (LSM_IS_SVG_FILTER_TRANSFER_FUNCTION (element));
+
+	lsm_svg_filter_transfer_function_get_table (LSM_SVG_FILTER_TRANSFER_FUNCTION (element), table);
+
+	/* One unit of tolerance, for the values falling on a rounding boundary */
+	for (i = 0; i < 256; i++) {
+		int expected = CLAMP (function (i / 255.0), 0.0, 1.0) * 255.0 + 0.5;
+
+		g_assert_cmpint (ABS ((int) table[i] - expected), <=, 1);
+	}
+}
+
+static void
+transfer_function (void)
+{
+	LsmDomDocument *document;
+	LsmSvgElement *element;
+	guint8 table[256];
+	unsigned int i;
+
+	document = lsm_dom_document_new_from_memory (transfer_function_document, -1, NULL);
+	g_assert (LSM_IS_SVG_DOCUMENT (document));
+
+	/* Empty table values give the identity */
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "empty-table", _identity);
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "empty-discrete", _identity);
+
+	element = lsm_svg_document_get_element_by_id (LSM_SVG_DOCUMENT (document), "empty-table");
+	lsm_svg_filter_transfer_function_get_table (LSM_SVG_FILTER_TRANSFER_FUNCTION (element), table);
+	for (i = 0; i < 256; i++)
+		g_assert_cmpint (table[i], ==, i);
+
+	/* A single value is a constant function */
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "single-table", _single_table);
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "single-discrete", _single_discrete);
+
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "table", _table);
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "discrete", _discrete);
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "linear", _linear);
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "gamma", _gamma);
+	_assert_transfer_table (LSM_SVG_DOCUMENT (document), "clamped-gamma", _clamped_gamma);
+
+	/* Results out of [0, 1] are clamped */
+	element = lsm_svg_document_get_element_by_id (LSM_SVG_DOCUMENT (document), "linear");
+	lsm_svg_filter_transfer_function_get_table (LSM_SVG_FILTER_TRANSFER_FUNCTION (element), table);
+	g_assert_cmpint (table[0], ==, 0);
+	g_assert_cmpint (table[255], ==, 255);
+
+	element = lsm_svg_document_get_element_by_id (LSM_SVG_DOCUMENT (document), "clamped-gamma");
+	lsm_svg_filter_transfer_function_get_table (LSM_SVG_FILTER_TRANSFER_FUNCTION (element), table);
+	g_assert_cmpint (table[0], ==, 0);
+	g_assert_cmpint (table[255], ==, 255);
+
+	g_object_unref (document);
+}
+
+int
+main (int argc, char *argv[])
+{
+	int result;
+
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/svg/path-data", path_data);
+	g_test_add_func ("/svg/path-cache", path_cache);
+	g_test_add_func ("/svg/points-cache", points_cache);
+	g_test_add_func ("/svg/computed-style", computed_style);
+	g_test_add_func ("/svg/clip-path-children", clip_path_children);
+	g_test_add_func ("/svg/clip-path-cache", clip_path_cache);
+	g_test_add_func ("/svg/culled-group", culled_group);
+	g_test_add_func ("/svg/culled-extents-cache", culled_extents_cache);
+	g_test_add_func ("/svg/tiled-render", tiled_render);
+	g_test_add_func ("/svg/render-recorded", render_recorded);
+	g_test_add_func ("/svg/gradient-cache", gradient_cache);
+	g_test_add_func ("/svg/pattern-cache", pattern_cache);
+	g_test_add_func ("/svg/mask-paths", mask_paths);
+	g_test_add_func ("/svg/marker-instances", marker_instances);
+	g_test_add_func ("/svg/use-instances", use_instances);
+	g_test_add_func ("/svg/image-cache", image_cache);
+	g_test_add_func ("/svg/image-mipmap", image_mipmap);
+	g_test_add_func ("/svg/text-cache", text_cache);
+	g_test_add_func ("/svg/positioned-text", positioned_text);
+	g_test_add_func ("/svg/positioned-rtl-text", positioned_rtl_text);
+	g_test_add_func ("/svg/filter-peak-size", filter_peak_size);
+	g_test_add_func ("/svg/bounding-box-light", bounding_box_light);
+	g_test_add_func ("/svg/transfer-function", transfer_function);
+
+	result = g_test_run();
+
+	lsm_shutdown ();
+
+	return result;
+}